@@ -30,6 +30,10 @@ Engine::Engine(EngineInit const& init) : window(init.window), vsync{init.vsync}
     CreateBackBufferResources(window->Width(), window->Height());
 
     g_TextureManager.Initialize(m_device, m_context);
+    g_GeometryArena.Initialize(m_device, m_context);
+    m_registry.on_construct<Mesh>().connect<&AcquireMeshGeometry>();
+    m_registry.on_destroy<Mesh>().connect<&ReleaseMeshGeometry>();
+    m_registry.on_destroy<Relationship>().connect<&UnlinkRelationship>();
 
     CameraParameters cp = ParseCameraParam();
     cp.position = Vector3(0.0f, 0.2f, -1.0f);
@@ -95,6 +99,7 @@ Engine::~Engine()
     SAFE_DELETE(backBufferRTV);
 
     g_TextureManager.Destroy();
+    g_GeometryArena.Destroy();
 
     SAFE_RELEASE(pAnnotation);
     SAFE_RELEASE(m_swapChain);
@@ -161,6 +166,8 @@ void Engine::CreateBackBufferResources(uint32 width, uint32 height)
 {
     SAFE_DELETE(backBufferDSV);
     SAFE_DELETE(backBufferRTV);
+    g_StateCache.ReleaseRenderTargets();
+    g_StateCache.Flush(m_context);
     m_context->Flush();
     m_swapChain->ResizeBuffers(0, width, height, DXGI_FORMAT_UNKNOWN, 0);
 
@@ -229,6 +236,7 @@ DXRenderTarget* Engine::GetBackbufferRTV()
 
 void Engine::Update(float dt)
 {
+    g_TextureManager.ProcessUploads();
     camera->Tick(dt);
     renderer->Tick(camera);
     renderer->SetSceneViewport(sceneViewportData);
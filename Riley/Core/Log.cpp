@@ -1,7 +1,9 @@
 #include "Log.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/sinks/basic_file_sink.h"
+#ifdef _WIN32
 #include <conio.h>
+#endif
 
 namespace Riley
 {
@@ -11,9 +13,11 @@ std::shared_ptr<spdlog::logger> Log::s_ClientLogger;
 
 void Log::Initialize()
 {
+#ifdef _WIN32
    // print Console Window
    AllocConsole();
    std::ignore = freopen("CONOUT$", "wt", stdout);
+#endif
 
    std::vector<spdlog::sink_ptr> logSinks;
    logSinks.emplace_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
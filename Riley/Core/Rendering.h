@@ -2,7 +2,9 @@
 
 // DirectX Helper
 #include "../Utilities/Timer.h"
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
@@ -39,6 +41,7 @@ static RileyTimer AppTimer;
     _type _name{};                                                                                                                    \
     memset(&_name, 0, sizeof(_type));
 
+#ifdef _WIN32
 inline bool HR(HRESULT hr)
 {
     if (FAILED(hr))
@@ -47,5 +50,6 @@ inline bool HR(HRESULT hr)
     }
     return true;
 }
+#endif
 
 } // namespace Riley
\ No newline at end of file
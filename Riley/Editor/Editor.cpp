@@ -4,6 +4,7 @@
 #include "../Math/BoundingVolume.h"
 #include "../Math/MatrixMath.h"
 #include "../Rendering/Camera.h"
+#include "../Rendering/OcclusionCuller.h"
 #include "../Rendering/Renderer.h"
 #include "../Rendering/SceneViewport.h"
 #include "../Utilities/Delegate.h"
@@ -67,6 +68,7 @@ void Editor::Run()
         ImGui::DockSpaceOverViewport(0, ImGui::GetMainViewport(), ImGuiDockNodeFlags_PassthruCentralNode);
         MenuBar();
         Camera();
+        Profiler();
         Scene();
         RenderSetting();
         ListEntities();
@@ -112,6 +114,78 @@ void Editor::Camera()
     ImGui::End();
 }
 
+void Editor::Profiler()
+{
+    if (ImGui::Begin("Profiler", &window_flags[Flag_Profiler]))
+    {
+        if (ImGui::CollapsingHeader("Draws per View", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            auto renderer = engine->GetRenderer();
+            ViewDrawStats const& cameraStats = renderer->GetCameraDrawStats();
+            ImGui::Text("Camera : %u in %u draw calls", cameraStats.draws, cameraStats.drawCalls);
+            for (auto const& stats : renderer->GetShadowDrawStats())
+            {
+                ImGui::Text("Light %u [%u] : %u", static_cast<uint32>(entt::to_integral(stats.light)), stats.face, stats.draws);
+            }
+        }
+        if (ImGui::CollapsingHeader("State Cache", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            DXStateCacheStats const& stats = g_StateCache.FrameStats();
+            ImGui::Text("Submitted : %llu", stats.submitted);
+            ImGui::Text("Forwarded : %llu", stats.forwarded);
+            ImGui::Text("Elided    : %llu (%.1f%%)", stats.elided, stats.submitted ? 100.0 * stats.elided / stats.submitted : 0.0);
+            ImGui::Text("Hazards   : %llu", stats.hazards);
+        }
+        if (ImGui::CollapsingHeader("GBuffer Queue", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            RenderQueueStats const& stats = engine->GetRenderer()->GetGBufferQueueStats();
+            ImGui::Text("Draws : %u, Sort %.3fms", stats.draws, stats.sortMs);
+            ImGui::Text("Programs  : %u -> %u", stats.unsorted.programs, stats.sorted.programs);
+            ImGui::Text("Materials : %u -> %u", stats.unsorted.materials, stats.sorted.materials);
+            ImGui::Text("Meshes    : %u -> %u", stats.unsorted.meshes, stats.sorted.meshes);
+        }
+        if (ImGui::CollapsingHeader("Geometry Arena", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            GeometryArenaStats const stats = g_GeometryArena.Stats();
+            ImGui::Text("Allocations : %u in %u vertex pools", stats.allocations, stats.pools);
+            ImGui::Text("Vertices : %llu / %llu KB", stats.vertexBytes / 1024, stats.vertexCapacityBytes / 1024);
+            ImGui::Text("Indices  : %llu / %llu KB", stats.indexBytes / 1024, stats.indexCapacityBytes / 1024);
+            ImGui::Text("Free blocks : %u, largest %llu KB", stats.freeBlocks, stats.largestFreeBytes / 1024);
+            ImGui::Text("Compacted : %llu KB", stats.movedBytes / 1024);
+        }
+        if (renderSetting.occlusionCulling && ImGui::CollapsingHeader("Occlusion Culling", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            OcclusionStats const& stats = engine->GetRenderer()->GetOcclusionCuller().Stats();
+            ImGui::Text("Occluders : %u (%u triangles)", stats.occluders, stats.occluderTriangles);
+            ImGui::Text("Rejected : %u / %u (%.1f%%)", stats.rejected, stats.candidates, stats.RejectedRatio() * 100.0f);
+            ImGui::Text("Raster %.3fms, Test %.3fms", stats.rasterMs, stats.testMs);
+        }
+        if (renderSetting.clusterCulling && ImGui::CollapsingHeader("Cluster Culling", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            auto ClusterStats = [](const char* name, ClusterCullStats const& stats) {
+                ImGui::Text("%s : %u meshlets of %u meshes, %u draws", name, stats.clusters, stats.meshes, stats.ranges);
+                ImGui::Text("  Rejected %.1f%% : frustum %u, backface %u, occlusion %u", stats.RejectedRatio() * 100.0f,
+                            stats.frustumRejected, stats.backfaceRejected, stats.occlusionRejected);
+            };
+            ClusterStats("Camera", engine->GetRenderer()->GetCameraClusterStats());
+            ClusterStats("Shadows", engine->GetRenderer()->GetShadowClusterStats());
+        }
+        if (ImGui::CollapsingHeader("Benchmarks"))
+        {
+            // results are written to the log
+            if (ImGui::Button("Occlusion Culling (camera path)"))
+                RunOcclusionBenchmark(engine->m_registry, engine->GetRenderer()->GetTransformSystem());
+
+            if (ImGui::Button("Command List Recording (null backend)"))
+                engine->GetRenderer()->RunCommandListBenchmark();
+
+            if (ImGui::Button("Render Graph Memory (1080p/1440p/4K)"))
+                engine->GetRenderer()->ReportFrameGraphMemory();
+        }
+    }
+    ImGui::End();
+}
+
 void Editor::Scene()
 {
     ImGui::Begin("Scene");
@@ -147,6 +221,16 @@ void Editor::RenderSetting()
     ImGui::Begin("Render Setting");
     {
         ImGui::Checkbox("FXAA", &renderSetting.fxaa);
+        ImGui::Checkbox("GPU Picking", &renderSetting.gpuPicking);
+        ImGui::Checkbox("Occlusion Culling", &renderSetting.occlusionCulling);
+        ImGui::Checkbox("Mesh LODs", &renderSetting.meshLODs);
+        if (renderSetting.meshLODs)
+        {
+            ImGui::SliderFloat("LOD Pixel Error", &renderSetting.lodPixelError, 0.25f, 8.0f);
+            static constexpr uint32 minLODBias = 0, maxLODBias = MAX_MESH_LODS;
+            ImGui::SliderScalar("Shadow LOD Bias", ImGuiDataType_U32, &renderSetting.shadowLODBias, &minLODBias, &maxLODBias);
+        }
+        ImGui::Checkbox("Cluster Culling", &renderSetting.clusterCulling);
 
         if (ImGui::TreeNode("Lighting"))
         {
@@ -240,9 +324,10 @@ void Editor::ListEntities()
             {
                 if (relationship)
                 {
-                    for (size_t i = 0; i < relationship->childrenCount; ++i)
+                    for (entt::entity child = relationship->firstChild; child != entt::null;
+                         child = engine->m_registry.get<Relationship>(child).nextSibling)
                     {
-                        ShowEntity(relationship->children[i], false);
+                        ShowEntity(child, false);
                     }
                 }
                 ImGui::TreePop();
@@ -346,17 +431,13 @@ void Editor::Properties()
 
             auto transform = engine->m_registry.try_get<Transform>(selected_entity);
             if (light)
+            {
                 transform->currentTransform = Matrix::CreateTranslation(Vector3(light->position));
+                transform->dirty = true;
+            }
 
             if (!light && transform && ImGui::CollapsingHeader("Transform"))
             {
-                Matrix parent = Matrix::Identity;
-                if (auto root = engine->m_registry.try_get<Relationship>(selected_entity))
-                {
-                    if (auto rootTransform = engine->m_registry.try_get<Transform>(root->parent))
-                        parent = rootTransform->currentTransform;
-                }
-
                 Matrix tr = transform->currentTransform;
                 Vector3 translation = tr.Translation();
                 Quaternion q = Quaternion::CreateFromRotationMatrix(ExtractRoationMatrix(tr));
@@ -367,17 +448,14 @@ void Editor::Properties()
                 shadowMappingFlag += ImGui::SliderFloat3("Rotate", &rotation.x, -1.0f, 1.0f);
                 shadowMappingFlag += ImGui::SliderFloat3("Scale", &scale.x, 0.1f, 10.0f);
 
-                tr = Matrix::CreateScale(scale) * Matrix::CreateFromQuaternion(Quaternion::CreateFromYawPitchRoll(rotation)) *
-                     Matrix::CreateTranslation(translation);
-
-                auto aabb = engine->m_registry.try_get<AABB>(selected_entity);
-                if (aabb)
+                if (shadowMappingFlag)
                 {
-                    aabb->boundingBox = aabb->orginalBox;
-                    aabb->boundingBox.Transform(aabb->boundingBox, tr);
-                    aabb->UpdateBuffer(engine->GetDevice());
+                    // World matrix and AABB of this entity and its children are refreshed by the TransformSystem
+                    transform->currentTransform = Matrix::CreateScale(scale) *
+                                                  Matrix::CreateFromQuaternion(Quaternion::CreateFromYawPitchRoll(rotation)) *
+                                                  Matrix::CreateTranslation(translation);
+                    transform->dirty = true;
                 }
-                transform->currentTransform = tr;
             }
 
             auto material = engine->m_registry.try_get<Material>(selected_entity);
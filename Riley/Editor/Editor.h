@@ -43,6 +43,7 @@ class Editor {
   private:
     void MenuBar(); 
     void Camera();
+    void Profiler();
     void ListEntities();
     void Properties();
     void RenderSetting();
@@ -1,7 +1,9 @@
 #pragma once
+#include "DXCommandList.h"
 #include "DXFormat.h"
 #include "DXResource.h"
 #include "DXResourceCommon.h"
+#include "DXStateCache.h"
 
 namespace Riley
 {
@@ -18,12 +20,12 @@ struct DXBufferDesc
     std::strong_ordering operator<=>(DXBufferDesc const& other) const = default;
 };
 
-static DXBufferDesc VertexBufferDesc(uint64 vertex_count, uint32 stride)
+static DXBufferDesc VertexBufferDesc(uint64 vertex_count, uint32 stride, bool dynamic = false)
 {
     DXBufferDesc desc{};
     desc.bindFlags = DXBindFlag::VertexBuffer;
-    desc.cpuAccess = DXCpuAccess::None;
-    desc.resourceUsage = DXResourceUsage::Immutable;
+    desc.cpuAccess = !dynamic ? DXCpuAccess::None : DXCpuAccess::Write;
+    desc.resourceUsage = !dynamic ? DXResourceUsage::Immutable : DXResourceUsage::Dynamic;
     desc.size = vertex_count * stride;
     desc.stride = stride;
     desc.miscFlags = DXBufferMiscFlag::None;
@@ -115,6 +117,13 @@ class DXBuffer : public DXResource
         }
     }
 
+    // records the update, the data is copied into the list and uploaded when the list is executed
+    template <typename T_DATA> void Update(DXCommandList& list, const T_DATA* srcData, uint64 dataSize)
+    {
+        if (m_desc.resourceUsage == DXResourceUsage::Dynamic)
+            list.UpdateBuffer(this, srcData, static_cast<uint32>(dataSize));
+    }
+
     template <typename T> void Update(const T* src_data)
     {
         Update(src_data, sizeof(T));
@@ -126,22 +135,17 @@ class DXBuffer : public DXResource
 
 static void BindIndexBuffer(ID3D11DeviceContext* context, DXBuffer* ib, uint32 offset = 0)
 {
-    context->IASetIndexBuffer(ib->GetNative(), ConvertDXFormat(ib->GetDesc().format), offset);
+    g_StateCache.SetIndexBuffer(context, ib->GetNative(), ConvertDXFormat(ib->GetDesc().format), offset);
 }
 
 static void BindVertexBuffer(ID3D11DeviceContext* context, DXBuffer* vb, uint32 slot = 0, uint32 offset = 0)
 {
-    ID3D11Buffer* const vbs = vb->GetNative();
-    uint32 strides = vb->GetDesc().stride;
-    context->IASetVertexBuffers(slot, 1, &vbs, &strides, &offset);
+    g_StateCache.SetVertexBuffer(context, slot, vb->GetNative(), vb->GetDesc().stride, offset);
 }
 
 static void BindNullVertexBuffer(ID3D11DeviceContext* context)
 {
-    static ID3D11Buffer* vb = nullptr;
-    static const UINT stride = 0;
-    static const UINT offset = 0;
-    context->IASetVertexBuffers(0, 1, &vb, &stride, &offset);
+    g_StateCache.SetVertexBuffer(context, 0, nullptr, 0, 0);
 }
 
 } // namespace Riley
\ No newline at end of file
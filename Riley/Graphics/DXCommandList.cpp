@@ -0,0 +1,167 @@
+#include "DXCommandList.h"
+
+namespace Riley
+{
+
+void DXCommandList::BeginEvent(char const* name)
+{
+    Allocate<DXCommandBeginEvent>(DXCommandType::BeginEvent).name = name;
+}
+
+void DXCommandList::EndEvent()
+{
+    Allocate<DXCommand>(DXCommandType::EndEvent);
+}
+
+void DXCommandList::SetViewport(float width, float height, float minDepth, float maxDepth, float topLeftX, float topLeftY)
+{
+    Allocate<DXCommandSetViewport>(DXCommandType::SetViewport).viewport =
+        DXViewport{topLeftX, topLeftY, width, height, minDepth, maxDepth};
+}
+
+void DXCommandList::BeginRenderPass(DXRenderPassDesc* pass, bool clearRTVs, bool clearDSV, uint8 stencil)
+{
+    auto& command = Allocate<DXCommandBeginRenderPass>(DXCommandType::BeginRenderPass);
+    command.pass = pass;
+    command.clearRTVs = clearRTVs;
+    command.clearDSV = clearDSV;
+    command.stencil = stencil;
+}
+
+void DXCommandList::EndRenderPass(DXRenderPassDesc* pass)
+{
+    Allocate<DXCommandEndRenderPass>(DXCommandType::EndRenderPass).pass = pass;
+}
+
+void DXCommandList::BindProgram(DXShaderProgram* program)
+{
+    Allocate<DXCommandBindProgram>(DXCommandType::BindProgram).program = program;
+}
+
+void DXCommandList::UnbindProgram(DXShaderProgram* program)
+{
+    Allocate<DXCommandBindProgram>(DXCommandType::UnbindProgram).program = program;
+}
+
+void DXCommandList::BindSRV(DXResource* resource, uint32 slot, DXShaderStage stage)
+{
+    auto& command = Allocate<DXCommandBindSRV>(DXCommandType::BindSRV);
+    command.resource = resource;
+    command.slot = slot;
+    command.stage = stage;
+}
+
+void DXCommandList::UnbindSRV(DXResource* resource, uint32 slot, DXShaderStage stage)
+{
+    auto& command = Allocate<DXCommandBindSRV>(DXCommandType::UnbindSRV);
+    command.resource = resource;
+    command.slot = slot;
+    command.stage = stage;
+}
+
+void DXCommandList::BindConstants(DXBuffer* buffer, DXShaderStage stage, uint32 slot, uint32 offset, uint32 size)
+{
+    auto& command = Allocate<DXCommandBindConstants>(DXCommandType::BindConstants);
+    command.buffer = buffer;
+    command.offset = offset;
+    command.windowSize = size;
+    command.slot = slot;
+    command.stage = stage;
+}
+
+void DXCommandList::UpdateBuffer(DXBuffer* buffer, void const* data, uint32 dataSize)
+{
+    auto& command = Allocate<DXCommandUpdateBuffer>(DXCommandType::UpdateBuffer, dataSize);
+    command.buffer = buffer;
+    command.dataSize = dataSize;
+    memcpy(&command + 1, data, dataSize);
+}
+
+void DXCommandList::DrawIndexed(DXCommandDrawIndexed const& draw)
+{
+    auto& command = Allocate<DXCommandDrawIndexed>(DXCommandType::DrawIndexed);
+    const DXCommand header = command;
+    command = draw;
+    static_cast<DXCommand&>(command) = header;
+}
+
+void DXCommandList::Draw(uint32 vertexCount, uint32 startVertexLoc, DXPrimitiveTopology topology)
+{
+    auto& command = Allocate<DXCommandDraw>(DXCommandType::Draw);
+    command.vertexCount = vertexCount;
+    command.startVertexLoc = startVertexLoc;
+    command.topology = topology;
+}
+
+void DXCommandList::Dispatch(uint32 groupCountX, uint32 groupCountY, uint32 groupCountZ)
+{
+    auto& command = Allocate<DXCommandDispatch>(DXCommandType::Dispatch);
+    command.groupCountX = groupCountX;
+    command.groupCountY = groupCountY;
+    command.groupCountZ = groupCountZ;
+}
+
+void DXCommandList::CopyResource(DXResource* dst, DXResource* src)
+{
+    auto& command = Allocate<DXCommandCopyResource>(DXCommandType::CopyResource);
+    command.dst = dst;
+    command.src = src;
+}
+
+void DXNullBackend::Execute(DXCommandList const& list)
+{
+    stats.bytes += list.SizeInBytes();
+    list.ForEach([this](DXCommand const& command) {
+        ++stats.commands[static_cast<size_t>(command.type)];
+        if (command.type == DXCommandType::UpdateBuffer)
+        {
+            stats.uploadBytes += static_cast<DXCommandUpdateBuffer const&>(command).dataSize;
+        }
+        else if (command.type == DXCommandType::DrawIndexed)
+        {
+            auto const& cmd = static_cast<DXCommandDrawIndexed const&>(command);
+            stats.primitives += uint64(cmd.indexBuffer ? cmd.indexCount : cmd.vertexCount) / 3 * cmd.instanceCount;
+        }
+    });
+}
+
+char const* ToString(DXCommandType type)
+{
+    switch (type)
+    {
+    case DXCommandType::BeginEvent:
+        return "BeginEvent";
+    case DXCommandType::EndEvent:
+        return "EndEvent";
+    case DXCommandType::SetViewport:
+        return "SetViewport";
+    case DXCommandType::BeginRenderPass:
+        return "BeginRenderPass";
+    case DXCommandType::EndRenderPass:
+        return "EndRenderPass";
+    case DXCommandType::BindProgram:
+        return "BindProgram";
+    case DXCommandType::UnbindProgram:
+        return "UnbindProgram";
+    case DXCommandType::BindSRV:
+        return "BindSRV";
+    case DXCommandType::UnbindSRV:
+        return "UnbindSRV";
+    case DXCommandType::BindConstants:
+        return "BindConstants";
+    case DXCommandType::UpdateBuffer:
+        return "UpdateBuffer";
+    case DXCommandType::DrawIndexed:
+        return "DrawIndexed";
+    case DXCommandType::Draw:
+        return "Draw";
+    case DXCommandType::Dispatch:
+        return "Dispatch";
+    case DXCommandType::CopyResource:
+        return "CopyResource";
+    default:
+        return "Unknown";
+    }
+}
+
+} // namespace Riley
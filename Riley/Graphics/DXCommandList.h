@@ -0,0 +1,290 @@
+#pragma once
+#include "DXShader.h"
+
+struct ID3D11DeviceContext;
+struct ID3D11DeviceContext1;
+struct ID3DUserDefinedAnnotation;
+
+namespace Riley
+{
+
+class DXBuffer;
+class DXResource;
+struct DXRenderPassDesc;
+struct DXShaderProgram;
+
+enum class DXCommandType : uint8
+{
+    BeginEvent,
+    EndEvent,
+    SetViewport,
+    BeginRenderPass,
+    EndRenderPass,
+    BindProgram,
+    UnbindProgram,
+    BindSRV,
+    UnbindSRV,
+    BindConstants,
+    UpdateBuffer,
+    DrawIndexed,
+    Draw,
+    Dispatch,
+    CopyResource,
+    Count
+};
+
+// Same layout as D3D11_VIEWPORT, so lists can be recorded and consumed without d3d11
+struct DXViewport
+{
+    float topLeftX;
+    float topLeftY;
+    float width;
+    float height;
+    float minDepth;
+    float maxDepth;
+};
+
+// Same values as D3D11_PRIMITIVE_TOPOLOGY for the topologies the engine draws with
+enum class DXPrimitiveTopology : uint32
+{
+    Undefined = 0,
+    PointList = 1,
+    LineList = 2,
+    LineStrip = 3,
+    TriangleList = 4,
+    TriangleStrip = 5
+};
+
+// Every command starts with this header, size covers the header, the command and any inline data
+struct DXCommand
+{
+    DXCommandType type;
+    uint8 _dummy[3];
+    uint32 size;
+};
+
+struct DXCommandBeginEvent : DXCommand
+{
+    char const* name; // must outlive the list, string literals only
+};
+struct DXCommandSetViewport : DXCommand
+{
+    DXViewport viewport;
+};
+struct DXCommandBeginRenderPass : DXCommand
+{
+    DXRenderPassDesc* pass;
+    bool clearRTVs;
+    bool clearDSV;
+    uint8 stencil;
+};
+struct DXCommandEndRenderPass : DXCommand
+{
+    DXRenderPassDesc* pass;
+};
+struct DXCommandBindProgram : DXCommand
+{
+    DXShaderProgram* program;
+};
+struct DXCommandBindSRV : DXCommand
+{
+    DXResource* resource; // null clears the slot
+    uint32 slot;
+    DXShaderStage stage;
+};
+struct DXCommandBindConstants : DXCommand
+{
+    DXBuffer* buffer;
+    uint32 offset;     // bytes, a window of a DXConstantRing
+    uint32 windowSize; // 0 binds the whole buffer
+    uint32 slot;
+    DXShaderStage stage;
+};
+struct DXCommandUpdateBuffer : DXCommand
+{
+    DXBuffer* buffer;
+    uint32 dataSize; // bytes following the command
+};
+struct DXCommandDrawIndexed : DXCommand
+{
+    DXBuffer* vertexBuffer;
+    DXBuffer* indexBuffer; // null for a non indexed draw
+    DXBuffer* instanceBuffer;
+    uint32 vertexCount;
+    uint32 startVertexLoc;
+    uint32 indexCount;
+    uint32 startIndexLoc;
+    int32 baseVertexLoc;
+    uint32 instanceCount;
+    uint32 startInstanceLoc;
+    DXPrimitiveTopology topology;
+};
+struct DXCommandDraw : DXCommand
+{
+    uint32 vertexCount;
+    uint32 startVertexLoc;
+    DXPrimitiveTopology topology;
+};
+struct DXCommandDispatch : DXCommand
+{
+    uint32 groupCountX, groupCountY, groupCountZ;
+};
+struct DXCommandCopyResource : DXCommand
+{
+    DXResource* dst;
+    DXResource* src;
+};
+
+/* Linear buffer of commands recorded on any thread without a device context.
+ * Commands hold raw pointers to engine objects and copy constant data inline, so a list stays valid
+ * until the objects it refers to are destroyed. Lists are replayed in order by a DXCommandBackend. */
+class DXCommandList
+{
+  public:
+    static constexpr uint32 COMMAND_ALIGNMENT = 8;
+
+    void Reset()
+    {
+        storage.clear();
+        commandCount = 0;
+    }
+
+    void BeginEvent(char const* name);
+    void EndEvent();
+    void SetViewport(float width, float height, float minDepth = 0.0f, float maxDepth = 1.0f, float topLeftX = 0.0f,
+                     float topLeftY = 0.0f);
+    void BeginRenderPass(DXRenderPassDesc* pass, bool clearRTVs = true, bool clearDSV = true, uint8 stencil = 0);
+    void EndRenderPass(DXRenderPassDesc* pass);
+    void BindProgram(DXShaderProgram* program);
+    void UnbindProgram(DXShaderProgram* program);
+    void BindSRV(DXResource* resource, uint32 slot, DXShaderStage stage);
+    void UnbindSRV(DXResource* resource, uint32 slot, DXShaderStage stage);
+    void BindConstants(DXBuffer* buffer, DXShaderStage stage, uint32 slot, uint32 offset = 0, uint32 size = 0);
+    void UpdateBuffer(DXBuffer* buffer, void const* data, uint32 dataSize);
+    void DrawIndexed(DXCommandDrawIndexed const& draw);
+    void Draw(uint32 vertexCount, uint32 startVertexLoc, DXPrimitiveTopology topology);
+    void Dispatch(uint32 groupCountX, uint32 groupCountY, uint32 groupCountZ);
+    void CopyResource(DXResource* dst, DXResource* src);
+
+    // Calls f(DXCommand const&) for every command in recording order
+    template <typename F>
+    void ForEach(F&& f) const
+    {
+        for (size_t offset = 0; offset < storage.size();)
+        {
+            DXCommand const& command = *reinterpret_cast<DXCommand const*>(storage.data() + offset);
+            f(command);
+            offset += command.size;
+        }
+    }
+
+    uint32 CommandCount() const
+    {
+        return commandCount;
+    }
+    size_t SizeInBytes() const
+    {
+        return storage.size();
+    }
+
+  private:
+    template <typename T>
+    T& Allocate(DXCommandType type, uint32 extraBytes = 0)
+    {
+        static_assert(alignof(T) <= COMMAND_ALIGNMENT);
+        const uint32 size = (sizeof(T) + extraBytes + COMMAND_ALIGNMENT - 1) & ~(COMMAND_ALIGNMENT - 1);
+        const size_t offset = storage.size();
+        storage.resize(offset + size);
+
+        T& command = *reinterpret_cast<T*>(storage.data() + offset);
+        command.type = type;
+        command.size = size;
+        ++commandCount;
+        return command;
+    }
+
+  private:
+    // aligned blocks keep every command 8 byte aligned
+    struct alignas(COMMAND_ALIGNMENT) Block
+    {
+        uint8 bytes[COMMAND_ALIGNMENT];
+    };
+    struct Storage
+    {
+        std::vector<Block> blocks;
+
+        size_t size() const
+        {
+            return blocks.size() * COMMAND_ALIGNMENT;
+        }
+        void resize(size_t bytes)
+        {
+            blocks.resize(bytes / COMMAND_ALIGNMENT);
+        }
+        void clear()
+        {
+            blocks.clear();
+        }
+        uint8* data()
+        {
+            return reinterpret_cast<uint8*>(blocks.data());
+        }
+        uint8 const* data() const
+        {
+            return reinterpret_cast<uint8 const*>(blocks.data());
+        }
+    } storage;
+    uint32 commandCount = 0;
+};
+
+class DXCommandBackend
+{
+  public:
+    virtual ~DXCommandBackend() = default;
+    virtual void Execute(DXCommandList const& list) = 0;
+};
+
+// Replays lists on a D3D11 context through the same objects the immediate code paths use, see DXContextBackend.cpp
+class DXContextBackend final : public DXCommandBackend
+{
+  public:
+    DXContextBackend(ID3D11DeviceContext* context, ID3DUserDefinedAnnotation* annotation);
+    ~DXContextBackend();
+    virtual void Execute(DXCommandList const& list) override;
+
+  private:
+    ID3D11DeviceContext* context;
+    ID3D11DeviceContext1* context1 = nullptr; // constant buffer windows
+    ID3DUserDefinedAnnotation* annotation;
+};
+
+struct DXNullBackendStats
+{
+    std::array<uint64, static_cast<size_t>(DXCommandType::Count)> commands{};
+    uint64 bytes = 0;
+    uint64 uploadBytes = 0;
+    uint64 primitives = 0;
+};
+
+// Consumes lists without a device, only counting what would have been submitted. Used for headless runs
+class DXNullBackend final : public DXCommandBackend
+{
+  public:
+    virtual void Execute(DXCommandList const& list) override;
+
+    DXNullBackendStats const& Stats() const
+    {
+        return stats;
+    }
+    void ResetStats()
+    {
+        stats = DXNullBackendStats{};
+    }
+
+  private:
+    DXNullBackendStats stats;
+};
+
+char const* ToString(DXCommandType type);
+
+} // namespace Riley
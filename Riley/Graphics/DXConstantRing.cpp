@@ -0,0 +1,90 @@
+#include "DXConstantRing.h"
+
+namespace Riley
+{
+
+DXConstantRing::DXConstantRing(ID3D11Device* device, uint32 frameCapacity, uint32 framesInFlight)
+    : DXUploadRing(frameCapacity, framesInFlight), device(device)
+{
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+    if (SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+    {
+        supported = options.ConstantBufferOffsetting;
+        mapNoOverwrite = options.MapNoOverwriteOnDynamicConstantBuffer;
+    }
+    if (!supported)
+        RI_WARN("Constant buffer offsetting is not supported, per draw constants are updated one Map at a time");
+    CreateBuffer();
+}
+
+DXConstantRing::~DXConstantRing()
+{
+    SAFE_DELETE(buffer);
+}
+
+void DXConstantRing::CreateBuffer()
+{
+    SAFE_DELETE(buffer);
+    DXBufferDesc desc{};
+    desc.size = RingSize();
+    desc.resourceUsage = DXResourceUsage::Dynamic;
+    desc.cpuAccess = DXCpuAccess::Write;
+    desc.bindFlags = DXBindFlag::ConstantBuffer;
+    buffer = new DXBuffer(device, desc);
+}
+
+void DXConstantRing::BeginFrame()
+{
+    DXUploadRing::BeginFrame();
+    if (buffer->GetDesc().size != RingSize())
+        CreateBuffer();
+}
+
+void DXConstantRing::Upload(ID3D11DeviceContext* context)
+{
+    std::span<uint8 const> data = FrameData();
+    if (data.empty())
+        return;
+
+    const D3D11_MAP mapType = (mapNoOverwrite && FrameIndex() != 0) ? D3D11_MAP_WRITE_NO_OVERWRITE : D3D11_MAP_WRITE_DISCARD;
+    D3D11_MAPPED_SUBRESOURCE mapped{};
+    HR(context->Map(buffer->GetNative(), 0, mapType, 0, &mapped));
+    memcpy(static_cast<uint8*>(mapped.pData) + RegionOffset(), data.data(), data.size());
+    context->Unmap(buffer->GetNative(), 0);
+}
+
+void SetConstantBufferWindow(ID3D11DeviceContext1* context, DXShaderStage stage, uint32 slot, ID3D11Buffer* buffer, uint32 offset,
+                             uint32 size)
+{
+    // offsets and sizes are in 16 byte constants, null ranges bind the whole buffer
+    const uint32 firstConstant = offset / 16;
+    const uint32 numConstants = size / 16;
+    const uint32* first = size ? &firstConstant : nullptr;
+    const uint32* num = size ? &numConstants : nullptr;
+    switch (stage)
+    {
+    case DXShaderStage::VS:
+        context->VSSetConstantBuffers1(slot, 1, &buffer, first, num);
+        break;
+    case DXShaderStage::PS:
+        context->PSSetConstantBuffers1(slot, 1, &buffer, first, num);
+        break;
+    case DXShaderStage::HS:
+        context->HSSetConstantBuffers1(slot, 1, &buffer, first, num);
+        break;
+    case DXShaderStage::DS:
+        context->DSSetConstantBuffers1(slot, 1, &buffer, first, num);
+        break;
+    case DXShaderStage::GS:
+        context->GSSetConstantBuffers1(slot, 1, &buffer, first, num);
+        break;
+    case DXShaderStage::CS:
+        context->CSSetConstantBuffers1(slot, 1, &buffer, first, num);
+        break;
+    default:
+        assert(false && "Unsupported Shader Stage!");
+        break;
+    }
+}
+
+} // namespace Riley
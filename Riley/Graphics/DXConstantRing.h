@@ -0,0 +1,49 @@
+#pragma once
+#include "DXBuffer.h"
+#include "DXUploadRing.h"
+
+namespace Riley
+{
+
+/* Upload ring backed by one dynamic constant buffer of RingSize() bytes. The frame's constants are copied with a
+ * single Map: NO_OVERWRITE into the region of the frame, DISCARD when the ring wraps so the driver renames it
+ * instead of waiting on frames still in flight. Windows are bound with the D3D11.1 *SetConstantBuffers1 calls,
+ * which also lift the 64KB limit on the buffer itself. */
+class DXConstantRing : public DXUploadRing
+{
+  public:
+    static constexpr uint32 FRAMES_IN_FLIGHT = 3;
+
+    DXConstantRing(ID3D11Device* device, uint32 frameCapacity, uint32 framesInFlight = FRAMES_IN_FLIGHT);
+    ~DXConstantRing();
+
+    // Recreates the buffer when the ring grew, lists recorded after this refer to GetBuffer()
+    virtual void BeginFrame() override;
+    // Copies the constants of the frame to the GPU, once per frame before the lists using them execute
+    void Upload(ID3D11DeviceContext* context);
+
+    DXBuffer* GetBuffer() const
+    {
+        return buffer;
+    }
+    // false when the runtime cannot bind constant buffer windows, the constant buffers have to be updated per draw
+    bool IsSupported() const
+    {
+        return supported;
+    }
+
+  private:
+    void CreateBuffer();
+
+  private:
+    ID3D11Device* device;
+    DXBuffer* buffer = nullptr;
+    bool supported = false;
+    bool mapNoOverwrite = false;
+};
+
+// Binds [offset, offset + size) of a constant buffer, the whole buffer when size is 0
+void SetConstantBufferWindow(ID3D11DeviceContext1* context, DXShaderStage stage, uint32 slot, ID3D11Buffer* buffer, uint32 offset,
+                             uint32 size);
+
+} // namespace Riley
@@ -0,0 +1,132 @@
+#include "DXCommandList.h"
+#include "../Core/Rendering.h"
+#include "../Utilities/StringUtil.h"
+#include "DXBuffer.h"
+#include "DXConstantRing.h"
+#include "DXRenderPass.h"
+#include "DXShaderProgram.h"
+#include "DXStateCache.h"
+
+namespace Riley
+{
+
+static_assert(sizeof(DXViewport) == sizeof(D3D11_VIEWPORT) && offsetof(DXViewport, topLeftX) == offsetof(D3D11_VIEWPORT, TopLeftX) &&
+              offsetof(DXViewport, maxDepth) == offsetof(D3D11_VIEWPORT, MaxDepth));
+static_assert(static_cast<uint32>(DXPrimitiveTopology::PointList) == D3D11_PRIMITIVE_TOPOLOGY_POINTLIST &&
+              static_cast<uint32>(DXPrimitiveTopology::LineList) == D3D11_PRIMITIVE_TOPOLOGY_LINELIST &&
+              static_cast<uint32>(DXPrimitiveTopology::LineStrip) == D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP &&
+              static_cast<uint32>(DXPrimitiveTopology::TriangleList) == D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST &&
+              static_cast<uint32>(DXPrimitiveTopology::TriangleStrip) == D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+
+DXContextBackend::DXContextBackend(ID3D11DeviceContext* context, ID3DUserDefinedAnnotation* annotation)
+    : context(context), annotation(annotation)
+{
+    context->QueryInterface(IID_PPV_ARGS(&context1));
+}
+
+DXContextBackend::~DXContextBackend()
+{
+    SAFE_RELEASE(context1);
+}
+
+void DXContextBackend::Execute(DXCommandList const& list)
+{
+    list.ForEach([this](DXCommand const& command) {
+        switch (command.type)
+        {
+        case DXCommandType::BeginEvent:
+            annotation->BeginEvent(ToWideString(static_cast<DXCommandBeginEvent const&>(command).name).c_str());
+            break;
+        case DXCommandType::EndEvent:
+            annotation->EndEvent();
+            break;
+        case DXCommandType::SetViewport:
+            context->RSSetViewports(
+                1, reinterpret_cast<D3D11_VIEWPORT const*>(&static_cast<DXCommandSetViewport const&>(command).viewport));
+            break;
+        case DXCommandType::BeginRenderPass: {
+            auto const& cmd = static_cast<DXCommandBeginRenderPass const&>(command);
+            cmd.pass->BeginRenderPass(context, cmd.clearRTVs, cmd.clearDSV, cmd.stencil);
+            break;
+        }
+        case DXCommandType::EndRenderPass:
+            static_cast<DXCommandEndRenderPass const&>(command).pass->EndRenderPass(context);
+            break;
+        case DXCommandType::BindProgram:
+            static_cast<DXCommandBindProgram const&>(command).program->Bind(context);
+            break;
+        case DXCommandType::UnbindProgram:
+            static_cast<DXCommandBindProgram const&>(command).program->Unbind(context);
+            break;
+        case DXCommandType::BindSRV: {
+            auto const& cmd = static_cast<DXCommandBindSRV const&>(command);
+            if (cmd.resource)
+            {
+                cmd.resource->BindSRV(context, cmd.slot, cmd.stage);
+            }
+            else
+            {
+                ID3D11ShaderResourceView* nullSRV = nullptr;
+                g_StateCache.SetShaderResources(context, cmd.stage, cmd.slot, 1, &nullSRV);
+            }
+            break;
+        }
+        case DXCommandType::UnbindSRV: {
+            auto const& cmd = static_cast<DXCommandBindSRV const&>(command);
+            if (cmd.resource)
+                cmd.resource->UnbindSRV(context, cmd.slot, cmd.stage);
+            break;
+        }
+        case DXCommandType::BindConstants: {
+            auto const& cmd = static_cast<DXCommandBindConstants const&>(command);
+            assert(context1 && "Binding constants needs a D3D11.1 context!");
+            SetConstantBufferWindow(context1, cmd.stage, cmd.slot, cmd.buffer->GetNative(), cmd.offset, cmd.windowSize);
+            break;
+        }
+        case DXCommandType::UpdateBuffer: {
+            auto const& cmd = static_cast<DXCommandUpdateBuffer const&>(command);
+            cmd.buffer->Update(context, reinterpret_cast<uint8 const*>(&cmd + 1), cmd.dataSize);
+            break;
+        }
+        case DXCommandType::DrawIndexed: {
+            auto const& cmd = static_cast<DXCommandDrawIndexed const&>(command);
+            g_StateCache.SetPrimitiveTopology(context, static_cast<D3D11_PRIMITIVE_TOPOLOGY>(cmd.topology));
+            BindVertexBuffer(context, cmd.vertexBuffer, 0, 0);
+            if (cmd.instanceBuffer)
+                BindVertexBuffer(context, cmd.instanceBuffer, 1, 0);
+            if (cmd.indexBuffer)
+            {
+                BindIndexBuffer(context, cmd.indexBuffer);
+                context->DrawIndexedInstanced(cmd.indexCount, cmd.instanceCount, cmd.startIndexLoc, cmd.baseVertexLoc,
+                                              cmd.startInstanceLoc);
+            }
+            else
+            {
+                context->DrawInstanced(cmd.vertexCount, cmd.instanceCount, cmd.startVertexLoc, cmd.startInstanceLoc);
+            }
+            break;
+        }
+        case DXCommandType::Draw: {
+            auto const& cmd = static_cast<DXCommandDraw const&>(command);
+            g_StateCache.SetPrimitiveTopology(context, static_cast<D3D11_PRIMITIVE_TOPOLOGY>(cmd.topology));
+            context->Draw(cmd.vertexCount, cmd.startVertexLoc);
+            break;
+        }
+        case DXCommandType::Dispatch: {
+            auto const& cmd = static_cast<DXCommandDispatch const&>(command);
+            context->Dispatch(cmd.groupCountX, cmd.groupCountY, cmd.groupCountZ);
+            break;
+        }
+        case DXCommandType::CopyResource: {
+            auto const& cmd = static_cast<DXCommandCopyResource const&>(command);
+            context->CopyResource(cmd.dst->GetResource(), cmd.src->GetResource());
+            break;
+        }
+        default:
+            assert(false && "Unknown command!");
+            break;
+        }
+    });
+}
+
+} // namespace Riley
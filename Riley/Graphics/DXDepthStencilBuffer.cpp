@@ -46,6 +46,26 @@ DXDepthStencilBuffer::DXDepthStencilBuffer(ID3D11Device* device, uint32 width, u
    m_height = height;
 }
 
+DXDepthStencilBuffer::DXDepthStencilBuffer(ID3D11Device* device, ID3D11Texture2D* texture, bool isStencilEnable)
+{
+   m_isStencilEnabled = isStencilEnable;
+   m_isTextureCube = false;
+   m_resource = texture;
+
+   D3D11_TEXTURE2D_DESC bufferDesc;
+   texture->GetDesc(&bufferDesc);
+   m_width = bufferDesc.Width;
+   m_height = bufferDesc.Height;
+
+   D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc;
+   ZeroMemory(&dsvDesc, sizeof(dsvDesc));
+   dsvDesc.Format = m_isStencilEnabled ? DXGI_FORMAT_D24_UNORM_S8_UINT : DXGI_FORMAT_D32_FLOAT;
+   dsvDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+   dsvDesc.Texture2D.MipSlice = 0;
+
+   HR(device->CreateDepthStencilView(texture, &dsvDesc, &m_dsv));
+}
+
 void DXDepthStencilBuffer::Initialize(ID3D11Device* device, uint32 width, uint32 height, bool isStencilEnable,
                                       D3D11_TEXTURE2D_DESC* texDesc /*= nullptr*/,
                                       D3D11_DEPTH_STENCIL_VIEW_DESC* dsvDesc /*= nullptr*/)
@@ -1,5 +1,6 @@
 #pragma once
 #include "DXResource.h"
+#include "DXStateCache.h"
 
 namespace Riley
 {
@@ -8,6 +9,8 @@ class DXDepthStencilBuffer : public DXResource
    public:
    DXDepthStencilBuffer() = default;
    DXDepthStencilBuffer(ID3D11Device* device, uint32 width, uint32 height, bool isStencilEnable = true, bool isTextureCube = false);
+   // views a texture created elsewhere, the buffer takes over the caller's reference
+   DXDepthStencilBuffer(ID3D11Device* device, ID3D11Texture2D* texture, bool isStencilEnable = true);
    virtual ~DXDepthStencilBuffer()
    {
       SAFE_RELEASE(m_dsv);
@@ -22,8 +25,7 @@ class DXDepthStencilBuffer : public DXResource
    }
    void BindOnlyDSV(ID3D11DeviceContext* context) const
    {
-      ID3D11RenderTargetView* nullViews[] = {nullptr};
-      context->OMSetRenderTargets(0, nullViews, m_dsv);
+      g_StateCache.SetRenderTargets(context, 0, nullptr, m_dsv);
    }
    void Clear(ID3D11DeviceContext* context, float depth, uint8 stencil);
 
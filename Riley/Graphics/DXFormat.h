@@ -1,5 +1,7 @@
 #pragma once
+#ifdef _WIN32
 #include <dxgiformat.h>
+#endif
 
 namespace Riley {
 enum class DXFormat {
@@ -72,6 +74,8 @@ enum class DXFormat {
     BC7_UNORM,
     BC7_UNORM_SRGB
 };
+// Conversions from and to DXGI_FORMAT, only where dxgi is
+#ifdef _WIN32
 inline constexpr DXGI_FORMAT ConvertDXFormat(DXFormat _format) {
     switch (_format) {
     case DXFormat::UNKNOWN:
@@ -476,89 +480,90 @@ inline constexpr DXFormat ConvertDXGIFormat(DXGI_FORMAT _format) {
     }
     return DXFormat::UNKNOWN;
 }
+#endif
 inline constexpr uint32 GetDXFormatStride(DXFormat _format) {
-    DXGI_FORMAT format = ConvertDXFormat(_format);
-    switch (format) {
-    case DXGI_FORMAT_BC1_UNORM:
-    case DXGI_FORMAT_BC1_UNORM_SRGB:
-    case DXGI_FORMAT_BC4_SNORM:
-    case DXGI_FORMAT_BC4_UNORM:
+    switch (_format) {
+    case DXFormat::BC1_UNORM:
+    case DXFormat::BC1_UNORM_SRGB:
+    case DXFormat::BC4_SNORM:
+    case DXFormat::BC4_UNORM:
         return 8u;
-    case DXGI_FORMAT_R32G32B32A32_FLOAT:
-    case DXGI_FORMAT_R32G32B32A32_UINT:
-    case DXGI_FORMAT_R32G32B32A32_SINT:
-    case DXGI_FORMAT_BC2_UNORM:
-    case DXGI_FORMAT_BC2_UNORM_SRGB:
-    case DXGI_FORMAT_BC3_UNORM:
-    case DXGI_FORMAT_BC3_UNORM_SRGB:
-    case DXGI_FORMAT_BC5_SNORM:
-    case DXGI_FORMAT_BC5_UNORM:
-    case DXGI_FORMAT_BC6H_UF16:
-    case DXGI_FORMAT_BC6H_SF16:
-    case DXGI_FORMAT_BC7_UNORM:
-    case DXGI_FORMAT_BC7_UNORM_SRGB:
+    case DXFormat::R32G32B32A32_FLOAT:
+    case DXFormat::R32G32B32A32_UINT:
+    case DXFormat::R32G32B32A32_SINT:
+    case DXFormat::BC2_UNORM:
+    case DXFormat::BC2_UNORM_SRGB:
+    case DXFormat::BC3_UNORM:
+    case DXFormat::BC3_UNORM_SRGB:
+    case DXFormat::BC5_SNORM:
+    case DXFormat::BC5_UNORM:
+    case DXFormat::BC6H_UF16:
+    case DXFormat::BC6H_SF16:
+    case DXFormat::BC7_UNORM:
+    case DXFormat::BC7_UNORM_SRGB:
         return 16u;
-    case DXGI_FORMAT_R32G32B32_FLOAT:
-    case DXGI_FORMAT_R32G32B32_UINT:
-    case DXGI_FORMAT_R32G32B32_SINT:
+    case DXFormat::R32G32B32_FLOAT:
+    case DXFormat::R32G32B32_UINT:
+    case DXFormat::R32G32B32_SINT:
         return 12u;
-    case DXGI_FORMAT_R16G16B16A16_FLOAT:
-    case DXGI_FORMAT_R16G16B16A16_UNORM:
-    case DXGI_FORMAT_R16G16B16A16_UINT:
-    case DXGI_FORMAT_R16G16B16A16_SNORM:
-    case DXGI_FORMAT_R16G16B16A16_SINT:
+    case DXFormat::R16G16B16A16_FLOAT:
+    case DXFormat::R16G16B16A16_UNORM:
+    case DXFormat::R16G16B16A16_UINT:
+    case DXFormat::R16G16B16A16_SNORM:
+    case DXFormat::R16G16B16A16_SINT:
         return 8u;
-    case DXGI_FORMAT_R32G32_FLOAT:
-    case DXGI_FORMAT_R32G32_UINT:
-    case DXGI_FORMAT_R32G32_SINT:
-    case DXGI_FORMAT_R32G8X24_TYPELESS:
-    case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+    case DXFormat::R32G32_FLOAT:
+    case DXFormat::R32G32_UINT:
+    case DXFormat::R32G32_SINT:
+    case DXFormat::R32G8X24_TYPELESS:
+    case DXFormat::D32_FLOAT_S8X24_UINT:
         return 8u;
-    case DXGI_FORMAT_R10G10B10A2_UNORM:
-    case DXGI_FORMAT_R10G10B10A2_UINT:
-    case DXGI_FORMAT_R11G11B10_FLOAT:
-    case DXGI_FORMAT_R8G8B8A8_UNORM:
-    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
-    case DXGI_FORMAT_R8G8B8A8_UINT:
-    case DXGI_FORMAT_R8G8B8A8_SNORM:
-    case DXGI_FORMAT_R8G8B8A8_SINT:
-    case DXGI_FORMAT_B8G8R8A8_UNORM:
-    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
-    case DXGI_FORMAT_R16G16_FLOAT:
-    case DXGI_FORMAT_R16G16_UNORM:
-    case DXGI_FORMAT_R16G16_UINT:
-    case DXGI_FORMAT_R16G16_SNORM:
-    case DXGI_FORMAT_R16G16_SINT:
-    case DXGI_FORMAT_R32_TYPELESS:
-    case DXGI_FORMAT_D32_FLOAT:
-    case DXGI_FORMAT_R32_FLOAT:
-    case DXGI_FORMAT_R32_UINT:
-    case DXGI_FORMAT_R32_SINT:
-    case DXGI_FORMAT_R24G8_TYPELESS:
-    case DXGI_FORMAT_D24_UNORM_S8_UINT:
+    case DXFormat::R10G10B10A2_UNORM:
+    case DXFormat::R10G10B10A2_UINT:
+    case DXFormat::R11G11B10_FLOAT:
+    case DXFormat::R8G8B8A8_UNORM:
+    case DXFormat::R8G8B8A8_UNORM_SRGB:
+    case DXFormat::R8G8B8A8_UINT:
+    case DXFormat::R8G8B8A8_SNORM:
+    case DXFormat::R8G8B8A8_SINT:
+    case DXFormat::B8G8R8A8_UNORM:
+    case DXFormat::B8G8R8A8_UNORM_SRGB:
+    case DXFormat::R16G16_FLOAT:
+    case DXFormat::R16G16_UNORM:
+    case DXFormat::R16G16_UINT:
+    case DXFormat::R16G16_SNORM:
+    case DXFormat::R16G16_SINT:
+    case DXFormat::R32_TYPELESS:
+    case DXFormat::D32_FLOAT:
+    case DXFormat::R32_FLOAT:
+    case DXFormat::R32_UINT:
+    case DXFormat::R32_SINT:
+    case DXFormat::R24G8_TYPELESS:
+    case DXFormat::D24_UNORM_S8_UINT:
         return 4u;
-    case DXGI_FORMAT_R8G8_UNORM:
-    case DXGI_FORMAT_R8G8_UINT:
-    case DXGI_FORMAT_R8G8_SNORM:
-    case DXGI_FORMAT_R8G8_SINT:
-    case DXGI_FORMAT_R16_TYPELESS:
-    case DXGI_FORMAT_R16_FLOAT:
-    case DXGI_FORMAT_D16_UNORM:
-    case DXGI_FORMAT_R16_UNORM:
-    case DXGI_FORMAT_R16_UINT:
-    case DXGI_FORMAT_R16_SNORM:
-    case DXGI_FORMAT_R16_SINT:
+    case DXFormat::R8G8_UNORM:
+    case DXFormat::R8G8_UINT:
+    case DXFormat::R8G8_SNORM:
+    case DXFormat::R8G8_SINT:
+    case DXFormat::R16_TYPELESS:
+    case DXFormat::R16_FLOAT:
+    case DXFormat::D16_UNORM:
+    case DXFormat::R16_UNORM:
+    case DXFormat::R16_UINT:
+    case DXFormat::R16_SNORM:
+    case DXFormat::R16_SINT:
         return 2u;
-    case DXGI_FORMAT_R8_UNORM:
-    case DXGI_FORMAT_R8_UINT:
-    case DXGI_FORMAT_R8_SNORM:
-    case DXGI_FORMAT_R8_SINT:
+    case DXFormat::R8_UNORM:
+    case DXFormat::R8_UINT:
+    case DXFormat::R8_SNORM:
+    case DXFormat::R8_SINT:
         return 1u;
     default:
         break;
     }
     return 16u;
 }
+#ifdef _WIN32
 inline constexpr uint32 GetFormatStride(DXGI_FORMAT format) {
     switch (format) {
     case DXGI_FORMAT_BC1_UNORM:
@@ -642,4 +647,5 @@ inline constexpr uint32 GetFormatStride(DXGI_FORMAT format) {
 
     return 16u;
 }
+#endif
 } // namespace adria
\ No newline at end of file
@@ -24,10 +24,20 @@ void DXRenderPassDesc::BeginRenderPass(ID3D11DeviceContext* context, bool isClea
 
 void DXRenderPassDesc::EndRenderPass(ID3D11DeviceContext* context)
 {
+    // The targets stay bound until another pass binds its own or reads them as SRVs.
+    // Flush the state cache before resizing the swap chain
     // https://stackoverflow.com/questions/69996893/d3d11-warning-when-resizing-the-window
-    ID3D11RenderTargetView* nullViews[1] = {nullptr};
+    g_StateCache.ReleaseRenderTargets();
+}
 
-    context->OMSetRenderTargets(1, nullViews, nullptr);
+void DXRenderPassDesc::BeginRenderPass(DXCommandList& list, bool isClearRTV, bool isClearDSV, uint8 isStencil)
+{
+    list.BeginRenderPass(this, isClearRTV, isClearDSV, isStencil);
+}
+
+void DXRenderPassDesc::EndRenderPass(DXCommandList& list)
+{
+    list.EndRenderPass(this);
 }
 
 void DXRenderPassDesc::Destroy()
@@ -1,6 +1,7 @@
 #pragma once
 #include "../Core/Rendering.h"
 #include "../Math/MathTypes.h"
+#include "DXCommandList.h"
 #include "DXDepthStencilBuffer.h"
 #include "DXRenderTarget.h"
 #include "DXStates.h"
@@ -19,6 +20,8 @@ struct DXRenderPassDesc
     void BeginRenderPass(ID3D11DeviceContext* context, bool isClearRTVs = true,
                          bool isClearDSV = true, uint8 isStencil = 0);
     void EndRenderPass(ID3D11DeviceContext* context);
+    void BeginRenderPass(DXCommandList& list, bool isClearRTVs = true, bool isClearDSV = true, uint8 isStencil = 0);
+    void EndRenderPass(DXCommandList& list);
     void Destroy();
 };
 } // namespace Riley
\ No newline at end of file
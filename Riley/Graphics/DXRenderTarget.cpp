@@ -1,4 +1,5 @@
 #include "DXRenderTarget.h"
+#include "DXStateCache.h"
 
 namespace Riley
 {
@@ -165,7 +166,7 @@ void DXRenderTarget::CreateRenderTarget(ID3D11Device* device, ID3D11RenderTarget
 void DXRenderTarget::BindRenderTargets(ID3D11DeviceContext* context)
 {
    if (!m_RTVs.empty())
-      context->OMSetRenderTargets(uint32(m_RTVs.size()), m_RTVs.data(), m_depthStencilBuffer->DSV());
+      g_StateCache.SetRenderTargets(context, uint32(m_RTVs.size()), m_RTVs.data(), m_depthStencilBuffer->DSV());
 }
 
 void DXRenderTarget::Clear(ID3D11DeviceContext* context, const float* clearColor)
@@ -1,4 +1,5 @@
 #include "DXResource.h"
+#include "DXStateCache.h"
 
 namespace Riley
 {
@@ -60,64 +61,18 @@ bool DXResource::BindSRV(ID3D11DeviceContext* context, unsigned int bindSlot, DX
 {
    if (!m_SRVs.empty())
       {
-         switch (bindShader)
-            {
-            case DXShaderStage::VS:
-               context->VSSetShaderResources(bindSlot, uint32(m_SRVs.size()), m_SRVs.data());
-               break;
-            case DXShaderStage::PS:
-               context->PSSetShaderResources(bindSlot, uint32(m_SRVs.size()), m_SRVs.data());
-               break;
-            case DXShaderStage::HS:
-               context->HSSetShaderResources(bindSlot, uint32(m_SRVs.size()), m_SRVs.data());
-               break;
-            case DXShaderStage::DS:
-               context->DSSetShaderResources(bindSlot, uint32(m_SRVs.size()), m_SRVs.data());
-               break;
-            case DXShaderStage::GS:
-               context->GSSetShaderResources(bindSlot, uint32(m_SRVs.size()), m_SRVs.data());
-               break;
-            case DXShaderStage::CS:
-               context->CSSetShaderResources(bindSlot, uint32(m_SRVs.size()), m_SRVs.data());
-               break;
-            default:
-               break;
-            }
+         g_StateCache.SetShaderResources(context, bindShader, bindSlot, uint32(m_SRVs.size()), m_SRVs.data());
          return true;
       }
    return false;
 }
 
+// Unbinding is deferred to the state cache, the views stay bound until their resource is used as an output
 void DXResource::UnbindSRV(ID3D11DeviceContext* context, unsigned int boundSlot, DXShaderStage boundShader)
 {
    if (!m_SRVs.empty())
       {
-         std::vector<ID3D11ShaderResourceView*> nullSRV;
-         nullSRV.resize(m_SRVs.size(), nullptr);
-
-         switch (boundShader)
-            {
-            case DXShaderStage::VS:
-               context->VSSetShaderResources(boundSlot, uint32(m_SRVs.size()), nullSRV.data());
-               break;
-            case DXShaderStage::PS:
-               context->PSSetShaderResources(boundSlot, uint32(m_SRVs.size()), nullSRV.data());
-               break;
-            case DXShaderStage::HS:
-               context->HSSetShaderResources(boundSlot, uint32(m_SRVs.size()), nullSRV.data());
-               break;
-            case DXShaderStage::DS:
-               context->DSSetShaderResources(boundSlot, uint32(m_SRVs.size()), nullSRV.data());
-               break;
-            case DXShaderStage::GS:
-               context->GSSetShaderResources(boundSlot, uint32(m_SRVs.size()), nullSRV.data());
-               break;
-            case DXShaderStage::CS:
-               context->CSSetShaderResources(boundSlot, uint32(m_SRVs.size()), nullSRV.data());
-               break;
-            default:
-               break;
-            }
+         g_StateCache.ReleaseShaderResources(boundShader, boundSlot, uint32(m_SRVs.size()));
       }
 }
 
@@ -125,7 +80,7 @@ bool DXResource::BindUAV(ID3D11DeviceContext* context, unsigned int bindSlot)
 {
    if (!m_UAVs.empty())
       {
-         context->CSSetUnorderedAccessViews(bindSlot, uint32(m_UAVs.size()), m_UAVs.data(), nullptr);
+         g_StateCache.SetUnorderedAccessViews(context, bindSlot, uint32(m_UAVs.size()), m_UAVs.data());
          return true;
       }
    return false;
@@ -135,8 +90,7 @@ void DXResource::UnbindUAV(ID3D11DeviceContext* context, unsigned int boundSlot)
 {
    if (!m_UAVs.empty())
       {
-         ID3D11UnorderedAccessView* nullView = nullptr;
-         context->CSSetUnorderedAccessViews(boundSlot, uint32(m_UAVs.size()), &nullView, nullptr);
+         g_StateCache.ReleaseUnorderedAccessViews(boundSlot, uint32(m_UAVs.size()));
       }
 }
 
@@ -24,6 +24,52 @@ enum class DXBindFlag : uint32 {
 };
 DEFINE_ENUM_BIT_OPERATORS(DXBindFlag);
 
+enum class DXResourceUsage : uint8 {
+    Default,
+    Immutable,
+    Dynamic,
+    Staging,
+};
+
+enum class DXCpuAccess : uint8 {
+    None = 0b00,
+    Write = 0b01,
+    Read = 0b10,
+    ReadWrite = 0b11
+};
+DEFINE_ENUM_BIT_OPERATORS(DXCpuAccess);
+
+enum class DXTextureMiscFlag : uint32 {
+    None = 0,
+    TextureCube = 1 << 0,
+    GenerateMips = 1 << 1
+};
+DEFINE_ENUM_BIT_OPERATORS(DXTextureMiscFlag);
+
+enum class DXBufferMiscFlag : uint32 {
+    None,
+    IndirectArgs = 1 << 0,
+    BufferRaw = 1 << 1,
+    BufferStructured = 1 << 2
+};
+DEFINE_ENUM_BIT_OPERATORS(DXBufferMiscFlag);
+
+enum class DXMapType : uint32 {
+    Read = 1,
+    Write = 2,
+    ReadWrite = 3,
+    WriteDiscard = 4,
+    WriteNoOverwrite = 5
+};
+
+struct DXMappedSubresource {
+    void* p_data;
+    uint32 row_pitch;
+    uint32 depth_pitch;
+};
+
+// Conversions to the d3d11 values, the enums above are also used where there is no d3d11
+#ifdef _WIN32
 inline constexpr uint32 ParseBindFlags(DXBindFlag flags) {
     uint32 result = 0;
     if (HasAnyFlag(flags, DXBindFlag::VertexBuffer))
@@ -43,13 +89,6 @@ inline constexpr uint32 ParseBindFlags(DXBindFlag flags) {
     return result;
 }
 
-enum class DXResourceUsage : uint8 {
-    Default,
-    Immutable,
-    Dynamic,
-    Staging,
-};
-
 inline constexpr D3D11_USAGE ConvertUsage(DXResourceUsage value) {
     switch (value) {
     case DXResourceUsage::Default:
@@ -70,14 +109,6 @@ inline constexpr D3D11_USAGE ConvertUsage(DXResourceUsage value) {
     return D3D11_USAGE_DEFAULT;
 }
 
-enum class DXCpuAccess : uint8 {
-    None = 0b00,
-    Write = 0b01,
-    Read = 0b10,
-    ReadWrite = 0b11
-};
-DEFINE_ENUM_BIT_OPERATORS(DXCpuAccess);
-
 inline constexpr uint32 ParseCPUAccessFlags(DXCpuAccess value) {
     uint32 result = 0;
     if (HasAnyFlag(value, DXCpuAccess::Write))
@@ -87,13 +118,6 @@ inline constexpr uint32 ParseCPUAccessFlags(DXCpuAccess value) {
     return result;
 }
 
-enum class DXTextureMiscFlag : uint32 {
-    None = 0,
-    TextureCube = 1 << 0,
-    GenerateMips = 1 << 1
-};
-DEFINE_ENUM_BIT_OPERATORS(DXTextureMiscFlag);
-
 inline constexpr uint32 ParseMiscFlags(DXTextureMiscFlag value) {
     uint32 result = 0;
     if (HasAnyFlag(value, DXTextureMiscFlag::TextureCube))
@@ -103,14 +127,6 @@ inline constexpr uint32 ParseMiscFlags(DXTextureMiscFlag value) {
     return result;
 }
 
-enum class DXBufferMiscFlag : uint32 {
-    None,
-    IndirectArgs = 1 << 0,
-    BufferRaw = 1 << 1,
-    BufferStructured = 1 << 2
-};
-DEFINE_ENUM_BIT_OPERATORS(DXBufferMiscFlag);
-
 inline constexpr uint32 ParseMiscFlags(DXBufferMiscFlag value) {
     uint32 result = 0;
     if (HasAnyFlag(value, DXBufferMiscFlag::IndirectArgs))
@@ -122,13 +138,6 @@ inline constexpr uint32 ParseMiscFlags(DXBufferMiscFlag value) {
     return result;
 }
 
-enum class DXMapType : uint32 {
-    Read = 1,
-    Write = 2,
-    ReadWrite = 3,
-    WriteDiscard = 4,
-    WriteNoOverwrite = 5
-};
 inline constexpr D3D11_MAP ConvertMapType(DXMapType value) {
     switch (value) {
     case DXMapType::Read:
@@ -146,10 +155,5 @@ inline constexpr D3D11_MAP ConvertMapType(DXMapType value) {
     }
     return D3D11_MAP_WRITE;
 }
-
-struct DXMappedSubresource {
-    void* p_data;
-    uint32 row_pitch;
-    uint32 depth_pitch;
-};
+#endif
 } // namespace adria
\ No newline at end of file
@@ -183,6 +183,26 @@ bool CompileShader(DXShaderDesc const& input, DXShaderCompileOutput& output)
     return true;
 }
 
+// Semantics ending in _UNORM, _SNORM or _HALF are fed from 16 bit components, the shader still declares floats.
+// Three component inputs read four, there are no three component 16 bit formats
+static bool PackedInputFormat(std::string const& semantic_name, uint32 mask, DXFormat& format)
+{
+    static constexpr std::array<std::pair<char const*, std::array<DXFormat, 3>>, 3> packed_formats = {{
+        {"_UNORM", {DXFormat::R16_UNORM, DXFormat::R16G16_UNORM, DXFormat::R16G16B16A16_UNORM}},
+        {"_SNORM", {DXFormat::R16_SNORM, DXFormat::R16G16_SNORM, DXFormat::R16G16B16A16_SNORM}},
+        {"_HALF", {DXFormat::R16_FLOAT, DXFormat::R16G16_FLOAT, DXFormat::R16G16B16A16_FLOAT}},
+    }};
+    for (auto const& [suffix, formats] : packed_formats)
+    {
+        if (semantic_name.ends_with(suffix))
+        {
+            format = mask == 1 ? formats[0] : mask <= 3 ? formats[1] : formats[2];
+            return true;
+        }
+    }
+    return false;
+}
+
 void FillInputLayoutDesc(DXShaderBytecode const& blob, DXInputLayoutDesc& input_desc)
 {
     ID3D11ShaderReflection* vertex_shader_reflection = nullptr;
@@ -210,6 +230,10 @@ void FillInputLayoutDesc(DXShaderBytecode const& blob, DXInputLayoutDesc& input_
             input_desc.elements[i].input_slot_class = DXInputClassification::PerInstanceData;
         }
 
+        if (param_desc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32 &&
+            PackedInputFormat(input_desc.elements[i].semantic_name, param_desc.Mask, input_desc.elements[i].format))
+            continue;
+
         if (param_desc.Mask == 1)
         {
             if (param_desc.ComponentType == D3D_REGISTER_COMPONENT_UINT32)
@@ -132,36 +132,21 @@ namespace Riley
     return *this;
   }
 
+  // Every stage is set, to null when the program does not use it, so the cache can drop
+  // both the unbind and the rebind when consecutive draws use the same program
   void DXGraphicsShaderProgram::Bind(ID3D11DeviceContext *context)
   {
-    if(inputLayout)
-      context->IASetInputLayout(*inputLayout);
-    if(vs)
-      context->VSSetShader(*vs, nullptr, 0);
-    if(gs)
-      context->GSSetShader(*gs, nullptr, 0);
-    if(hs)
-      context->HSSetShader(*hs, nullptr, 0);
-    if(ds)
-      context->DSSetShader(*ds, nullptr, 0);
-    if(ps)
-      context->PSSetShader(*ps, nullptr, 0);
+    g_StateCache.SetInputLayout(context, inputLayout ? *inputLayout : nullptr);
+    g_StateCache.SetVertexShader(context, vs ? *vs : nullptr);
+    g_StateCache.SetGeometryShader(context, gs ? *gs : nullptr);
+    g_StateCache.SetHullShader(context, hs ? *hs : nullptr);
+    g_StateCache.SetDomainShader(context, ds ? *ds : nullptr);
+    g_StateCache.SetPixelShader(context, ps ? *ps : nullptr);
   }
 
   void DXGraphicsShaderProgram::Unbind(ID3D11DeviceContext *context)
   {
-    if(inputLayout)
-      context->IASetInputLayout(nullptr);
-    if(vs)
-      context->VSSetShader(nullptr, nullptr, 0);
-    if(gs)
-      context->GSSetShader(nullptr, nullptr, 0);
-    if(hs)
-      context->HSSetShader(nullptr, nullptr, 0);
-    if(ds)
-      context->DSSetShader(nullptr, nullptr, 0);
-    if(ps)
-      context->PSSetShader(nullptr, nullptr, 0);
+    g_StateCache.ReleaseShaders();
   }
 
   void DXComputeShaderProgram::SetComputeShader(DXComputeShader *cs)
@@ -170,13 +155,11 @@ namespace Riley
   }
   void DXComputeShaderProgram::Bind(ID3D11DeviceContext *context)
   {
-    if(shader)
-      context->CSSetShader(*shader, nullptr, 0);
+    g_StateCache.SetComputeShader(context, shader ? *shader : nullptr);
   }
   void DXComputeShaderProgram::Unbind(ID3D11DeviceContext *context)
   {
-    if(shader)
-      context->CSSetShader(nullptr, nullptr, 0);
+    g_StateCache.ReleaseShaders();
   }
 
 } // namespace Riley
\ No newline at end of file
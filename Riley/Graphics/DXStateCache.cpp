@@ -0,0 +1,538 @@
+#include "DXStateCache.h"
+
+namespace Riley
+{
+
+DXStateCache::DXStateCache()
+{
+   Invalidate();
+}
+
+void DXStateCache::Invalidate()
+{
+   vs = Unknown<ID3D11VertexShader>();
+   ps = Unknown<ID3D11PixelShader>();
+   gs = Unknown<ID3D11GeometryShader>();
+   hs = Unknown<ID3D11HullShader>();
+   ds = Unknown<ID3D11DomainShader>();
+   cs = Unknown<ID3D11ComputeShader>();
+
+   inputLayout = Unknown<ID3D11InputLayout>();
+   topology = static_cast<D3D11_PRIMITIVE_TOPOLOGY>(-1);
+   for (VertexBufferSlot& vb : vertexBuffers)
+      vb = VertexBufferSlot{Unknown<ID3D11Buffer>(), 0, 0};
+   indexBuffer = Unknown<ID3D11Buffer>();
+
+   rasterizerState = Unknown<ID3D11RasterizerState>();
+   depthStencilState = Unknown<ID3D11DepthStencilState>();
+   blendState = Unknown<ID3D11BlendState>();
+
+   for (auto& stage : shaderResources)
+      stage.fill(ViewSlot{Unknown<void>(), nullptr, false});
+   for (auto& stage : samplers)
+      stage.fill(Unknown<ID3D11SamplerState>());
+   unorderedAccessViews.fill(ViewSlot{Unknown<void>(), nullptr, false});
+
+   renderTargetCount = 0;
+   renderTargets.fill(nullptr);
+   outputResources.fill(nullptr);
+   depthStencilView = Unknown<ID3D11DepthStencilView>();
+   outputsStale = false;
+}
+
+void DXStateCache::Flush(ID3D11DeviceContext* context)
+{
+   static ID3D11ShaderResourceView* const nullSRVs[SRV_SLOTS] = {};
+   static ID3D11UnorderedAccessView* const nullUAVs[UAV_SLOTS] = {};
+
+   // one call per run of consecutive stale slots
+   for (uint32 stage = 0; stage < STAGE_COUNT; ++stage)
+   {
+      auto& slots = shaderResources[stage];
+      for (uint32 first = 0; first < SRV_SLOTS; ++first)
+      {
+         if (!slots[first].stale)
+            continue;
+         uint32 last = first;
+         while (last + 1 < SRV_SLOTS && slots[last + 1].stale)
+            ++last;
+         for (uint32 i = first; i <= last; ++i)
+            slots[i] = ViewSlot{};
+         ForwardShaderResources(context, static_cast<DXShaderStage>(stage), first, last - first + 1, nullSRVs);
+         Forward();
+         first = last;
+      }
+   }
+
+   for (uint32 first = 0; first < UAV_SLOTS; ++first)
+   {
+      if (!unorderedAccessViews[first].stale)
+         continue;
+      uint32 last = first;
+      while (last + 1 < UAV_SLOTS && unorderedAccessViews[last + 1].stale)
+         ++last;
+      for (uint32 i = first; i <= last; ++i)
+         unorderedAccessViews[i] = ViewSlot{};
+      context->CSSetUnorderedAccessViews(first, last - first + 1, nullUAVs, nullptr);
+      Forward();
+      first = last;
+   }
+
+   if (outputsStale)
+      ClearStaleOutputs(context);
+}
+
+void DXStateCache::BeginFrame()
+{
+   frameStats = stats;
+   stats = DXStateCacheStats{};
+   Invalidate();
+}
+
+bool DXStateCache::Submit(bool changed)
+{
+   ++stats.submitted;
+   if (!changed)
+      ++stats.elided;
+   return changed;
+}
+
+void DXStateCache::SetVertexShader(ID3D11DeviceContext* context, ID3D11VertexShader* shader)
+{
+   if (Submit(vs != shader))
+   {
+      vs = shader;
+      context->VSSetShader(shader, nullptr, 0);
+      Forward();
+   }
+}
+
+void DXStateCache::SetPixelShader(ID3D11DeviceContext* context, ID3D11PixelShader* shader)
+{
+   if (Submit(ps != shader))
+   {
+      ps = shader;
+      context->PSSetShader(shader, nullptr, 0);
+      Forward();
+   }
+}
+
+void DXStateCache::SetGeometryShader(ID3D11DeviceContext* context, ID3D11GeometryShader* shader)
+{
+   if (Submit(gs != shader))
+   {
+      gs = shader;
+      context->GSSetShader(shader, nullptr, 0);
+      Forward();
+   }
+}
+
+void DXStateCache::SetHullShader(ID3D11DeviceContext* context, ID3D11HullShader* shader)
+{
+   if (Submit(hs != shader))
+   {
+      hs = shader;
+      context->HSSetShader(shader, nullptr, 0);
+      Forward();
+   }
+}
+
+void DXStateCache::SetDomainShader(ID3D11DeviceContext* context, ID3D11DomainShader* shader)
+{
+   if (Submit(ds != shader))
+   {
+      ds = shader;
+      context->DSSetShader(shader, nullptr, 0);
+      Forward();
+   }
+}
+
+void DXStateCache::SetComputeShader(ID3D11DeviceContext* context, ID3D11ComputeShader* shader)
+{
+   if (Submit(cs != shader))
+   {
+      cs = shader;
+      context->CSSetShader(shader, nullptr, 0);
+      Forward();
+   }
+}
+
+void DXStateCache::ReleaseShaders()
+{
+   Submit(false);
+}
+
+void DXStateCache::SetInputLayout(ID3D11DeviceContext* context, ID3D11InputLayout* layout)
+{
+   if (Submit(inputLayout != layout))
+   {
+      inputLayout = layout;
+      context->IASetInputLayout(layout);
+      Forward();
+   }
+}
+
+void DXStateCache::SetPrimitiveTopology(ID3D11DeviceContext* context, D3D11_PRIMITIVE_TOPOLOGY primitiveTopology)
+{
+   if (Submit(topology != primitiveTopology))
+   {
+      topology = primitiveTopology;
+      context->IASetPrimitiveTopology(primitiveTopology);
+      Forward();
+   }
+}
+
+void DXStateCache::SetVertexBuffer(ID3D11DeviceContext* context, uint32 slot, ID3D11Buffer* buffer, uint32 stride, uint32 offset)
+{
+   if (slot >= VERTEX_BUFFER_SLOTS)
+   {
+      Submit(true);
+      context->IASetVertexBuffers(slot, 1, &buffer, &stride, &offset);
+      Forward();
+      return;
+   }
+
+   VertexBufferSlot& vb = vertexBuffers[slot];
+   if (Submit(vb.buffer != buffer || vb.stride != stride || vb.offset != offset))
+   {
+      vb = VertexBufferSlot{buffer, stride, offset};
+      context->IASetVertexBuffers(slot, 1, &buffer, &stride, &offset);
+      Forward();
+   }
+}
+
+void DXStateCache::SetIndexBuffer(ID3D11DeviceContext* context, ID3D11Buffer* buffer, DXGI_FORMAT format, uint32 offset)
+{
+   if (Submit(indexBuffer != buffer || indexFormat != format || indexOffset != offset))
+   {
+      indexBuffer = buffer;
+      indexFormat = format;
+      indexOffset = offset;
+      context->IASetIndexBuffer(buffer, format, offset);
+      Forward();
+   }
+}
+
+void DXStateCache::SetRasterizerState(ID3D11DeviceContext* context, ID3D11RasterizerState* state)
+{
+   if (Submit(rasterizerState != state))
+   {
+      rasterizerState = state;
+      context->RSSetState(state);
+      Forward();
+   }
+}
+
+void DXStateCache::SetDepthStencilState(ID3D11DeviceContext* context, ID3D11DepthStencilState* state, uint32 ref)
+{
+   if (Submit(depthStencilState != state || stencilRef != ref))
+   {
+      depthStencilState = state;
+      stencilRef = ref;
+      context->OMSetDepthStencilState(state, ref);
+      Forward();
+   }
+}
+
+void DXStateCache::SetBlendState(ID3D11DeviceContext* context, ID3D11BlendState* state, const float* factor, uint32 mask)
+{
+   // a null factor means {1, 1, 1, 1} to the runtime
+   const std::array<float, 4> newFactor = factor ? std::array<float, 4>{factor[0], factor[1], factor[2], factor[3]}
+                                                 : std::array<float, 4>{1.0f, 1.0f, 1.0f, 1.0f};
+   if (Submit(blendState != state || blendFactor != newFactor || sampleMask != mask))
+   {
+      blendState = state;
+      blendFactor = newFactor;
+      sampleMask = mask;
+      context->OMSetBlendState(state, factor, mask);
+      Forward();
+   }
+}
+
+void DXStateCache::SetShaderResources(ID3D11DeviceContext* context, DXShaderStage stage, uint32 slot, uint32 count,
+                                      ID3D11ShaderResourceView* const* views)
+{
+   if (slot + count > SRV_SLOTS)
+   {
+      Submit(true);
+      ForwardShaderResources(context, stage, slot, count, views);
+      Forward();
+      return;
+   }
+
+   auto& slots = shaderResources[static_cast<uint32>(stage)];
+   uint32 first = count, last = 0;
+   for (uint32 i = 0; i < count; ++i)
+   {
+      ViewSlot& s = slots[slot + i];
+      if (s.view == views[i])
+      {
+         s.stale = false;
+         continue;
+      }
+      first = std::min(first, i);
+      last = i;
+   }
+   if (!Submit(first < count))
+      return;
+
+   for (uint32 i = first; i <= last; ++i)
+   {
+      ID3D11Resource* resource = ResourceOf(views[i]);
+      ClearStaleOutputsOf(context, resource);
+      ClearUnorderedAccessViewsOf(context, resource, true);
+      // the runtime drops inputs that are still live outputs, keep the shadow in sync with that
+      slots[slot + i] = IsBoundAsOutput(resource) ? ViewSlot{} : ViewSlot{views[i], resource, false};
+   }
+   ForwardShaderResources(context, stage, slot + first, last - first + 1, views + first);
+   Forward();
+}
+
+void DXStateCache::ReleaseShaderResources(DXShaderStage stage, uint32 slot, uint32 count)
+{
+   Submit(false);
+   auto& slots = shaderResources[static_cast<uint32>(stage)];
+   for (uint32 i = slot; i < std::min(slot + count, SRV_SLOTS); ++i)
+   {
+      if (slots[i].view != nullptr && slots[i].view != Unknown<void>())
+         slots[i].stale = true;
+   }
+}
+
+void DXStateCache::SetSamplers(ID3D11DeviceContext* context, DXShaderStage stage, uint32 slot, uint32 count,
+                               ID3D11SamplerState* const* states)
+{
+   auto& slots = samplers[static_cast<uint32>(stage)];
+   bool changed = slot + count > SAMPLER_SLOTS;
+   for (uint32 i = 0; i < count && !changed; ++i)
+      changed = slots[slot + i] != states[i];
+   if (!Submit(changed))
+      return;
+
+   for (uint32 i = 0; i < count && slot + i < SAMPLER_SLOTS; ++i)
+      slots[slot + i] = states[i];
+   switch (stage)
+   {
+   case DXShaderStage::VS:
+      context->VSSetSamplers(slot, count, states);
+      break;
+   case DXShaderStage::PS:
+      context->PSSetSamplers(slot, count, states);
+      break;
+   case DXShaderStage::HS:
+      context->HSSetSamplers(slot, count, states);
+      break;
+   case DXShaderStage::DS:
+      context->DSSetSamplers(slot, count, states);
+      break;
+   case DXShaderStage::GS:
+      context->GSSetSamplers(slot, count, states);
+      break;
+   case DXShaderStage::CS:
+      context->CSSetSamplers(slot, count, states);
+      break;
+   default:
+      break;
+   }
+   Forward();
+}
+
+void DXStateCache::SetUnorderedAccessViews(ID3D11DeviceContext* context, uint32 slot, uint32 count,
+                                           ID3D11UnorderedAccessView* const* views)
+{
+   assert(slot + count <= UAV_SLOTS);
+
+   uint32 first = count, last = 0;
+   for (uint32 i = 0; i < count; ++i)
+   {
+      ViewSlot& s = unorderedAccessViews[slot + i];
+      if (s.view == views[i])
+      {
+         s.stale = false;
+         continue;
+      }
+      first = std::min(first, i);
+      last = i;
+   }
+   if (!Submit(first < count))
+      return;
+
+   for (uint32 i = first; i <= last; ++i)
+   {
+      ID3D11Resource* resource = ResourceOf(views[i]);
+      ClearShaderResourcesOf(context, resource);
+      ClearStaleOutputsOf(context, resource);
+      unorderedAccessViews[slot + i] = ViewSlot{views[i], resource, false};
+   }
+   context->CSSetUnorderedAccessViews(slot + first, last - first + 1, views + first, nullptr);
+   Forward();
+}
+
+void DXStateCache::ReleaseUnorderedAccessViews(uint32 slot, uint32 count)
+{
+   Submit(false);
+   for (uint32 i = slot; i < std::min(slot + count, UAV_SLOTS); ++i)
+   {
+      if (unorderedAccessViews[i].view != nullptr && unorderedAccessViews[i].view != Unknown<void>())
+         unorderedAccessViews[i].stale = true;
+   }
+}
+
+void DXStateCache::SetRenderTargets(ID3D11DeviceContext* context, uint32 count, ID3D11RenderTargetView* const* views,
+                                    ID3D11DepthStencilView* dsv)
+{
+   bool changed = count != renderTargetCount || dsv != depthStencilView;
+   for (uint32 i = 0; i < count && !changed; ++i)
+      changed = renderTargets[i] != views[i];
+   if (!Submit(changed))
+   {
+      outputsStale = false;
+      return;
+   }
+
+   // whatever was bound before is replaced by this call, so only the new outputs can conflict
+   outputResources.fill(nullptr);
+   renderTargets.fill(nullptr);
+   for (uint32 i = 0; i < count; ++i)
+   {
+      renderTargets[i] = views[i];
+      outputResources[i] = ResourceOf(views[i]);
+   }
+   outputResources[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT] = ResourceOf(dsv);
+   renderTargetCount = count;
+   depthStencilView = dsv;
+   outputsStale = false;
+
+   for (ID3D11Resource* resource : outputResources)
+   {
+      ClearShaderResourcesOf(context, resource);
+      ClearUnorderedAccessViewsOf(context, resource, false);
+   }
+
+   context->OMSetRenderTargets(count, views, dsv);
+   Forward();
+}
+
+void DXStateCache::ReleaseRenderTargets()
+{
+   Submit(false);
+   outputsStale = renderTargetCount > 0 || (depthStencilView != nullptr && depthStencilView != Unknown<ID3D11DepthStencilView>());
+}
+
+ID3D11Resource* DXStateCache::ResourceOf(ID3D11View* view)
+{
+   if (view == nullptr)
+      return nullptr;
+
+   // the view holds its own reference, the pointer is only compared
+   ID3D11Resource* resource = nullptr;
+   view->GetResource(&resource);
+   SAFE_RELEASE(resource);
+   return resource;
+}
+
+void DXStateCache::ForwardShaderResources(ID3D11DeviceContext* context, DXShaderStage stage, uint32 slot, uint32 count,
+                                          ID3D11ShaderResourceView* const* views)
+{
+   switch (stage)
+   {
+   case DXShaderStage::VS:
+      context->VSSetShaderResources(slot, count, views);
+      break;
+   case DXShaderStage::PS:
+      context->PSSetShaderResources(slot, count, views);
+      break;
+   case DXShaderStage::HS:
+      context->HSSetShaderResources(slot, count, views);
+      break;
+   case DXShaderStage::DS:
+      context->DSSetShaderResources(slot, count, views);
+      break;
+   case DXShaderStage::GS:
+      context->GSSetShaderResources(slot, count, views);
+      break;
+   case DXShaderStage::CS:
+      context->CSSetShaderResources(slot, count, views);
+      break;
+   default:
+      break;
+   }
+}
+
+void DXStateCache::ClearShaderResourcesOf(ID3D11DeviceContext* context, ID3D11Resource* resource)
+{
+   if (resource == nullptr)
+      return;
+
+   ID3D11ShaderResourceView* const nullSRV = nullptr;
+   for (uint32 stage = 0; stage < STAGE_COUNT; ++stage)
+   {
+      auto& slots = shaderResources[stage];
+      for (uint32 i = 0; i < SRV_SLOTS; ++i)
+      {
+         if (slots[i].resource != resource)
+            continue;
+         slots[i] = ViewSlot{};
+         ForwardShaderResources(context, static_cast<DXShaderStage>(stage), i, 1, &nullSRV);
+         Forward();
+         ++stats.hazards;
+      }
+   }
+}
+
+void DXStateCache::ClearUnorderedAccessViewsOf(ID3D11DeviceContext* context, ID3D11Resource* resource, bool staleOnly)
+{
+   if (resource == nullptr)
+      return;
+
+   ID3D11UnorderedAccessView* const nullUAV = nullptr;
+   for (uint32 i = 0; i < UAV_SLOTS; ++i)
+   {
+      if (unorderedAccessViews[i].resource != resource || (staleOnly && !unorderedAccessViews[i].stale))
+         continue;
+      unorderedAccessViews[i] = ViewSlot{};
+      context->CSSetUnorderedAccessViews(i, 1, &nullUAV, nullptr);
+      Forward();
+      ++stats.hazards;
+   }
+}
+
+bool DXStateCache::IsBoundAsOutput(ID3D11Resource* resource) const
+{
+   if (resource == nullptr)
+      return false;
+   if (!outputsStale && std::find(outputResources.begin(), outputResources.end(), resource) != outputResources.end())
+      return true;
+   for (ViewSlot const& uav : unorderedAccessViews)
+   {
+      if (uav.resource == resource && !uav.stale)
+         return true;
+   }
+   return false;
+}
+
+void DXStateCache::ClearStaleOutputsOf(ID3D11DeviceContext* context, ID3D11Resource* resource)
+{
+   if (resource == nullptr || !outputsStale)
+      return;
+   if (std::find(outputResources.begin(), outputResources.end(), resource) == outputResources.end())
+      return;
+
+   ClearStaleOutputs(context);
+   ++stats.hazards;
+}
+
+void DXStateCache::ClearStaleOutputs(ID3D11DeviceContext* context)
+{
+   ID3D11RenderTargetView* nullViews[1] = {nullptr};
+   context->OMSetRenderTargets(0, nullViews, nullptr);
+   Forward();
+
+   renderTargetCount = 0;
+   renderTargets.fill(nullptr);
+   outputResources.fill(nullptr);
+   depthStencilView = nullptr;
+   outputsStale = false;
+}
+
+} // namespace Riley
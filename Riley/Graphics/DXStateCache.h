@@ -0,0 +1,153 @@
+#pragma once
+#include "../Core/Rendering.h"
+#include "../Utilities/Singleton.h"
+#include "DXShader.h"
+
+namespace Riley
+{
+
+struct DXStateCacheStats
+{
+   uint64 submitted = 0; // calls made into the cache
+   uint64 forwarded = 0; // calls that reached the device context
+   uint64 elided = 0;    // calls dropped because the state was already set or the unbind was deferred
+   uint64 hazards = 0;   // stale bindings cleared because their resource was bound as an output
+};
+
+/* Shadows the pipeline state of the immediate context and only forwards real changes.
+ * Unbinding SRVs, UAVs and render targets is lazy: the view stays on the device and is marked stale.
+ * A stale binding is cleared only when it would conflict, i.e. its resource gets bound as a render target,
+ * depth target or UAV (or the other way round), or when Flush() is called before the context is handed to
+ * code that does not go through the cache. Shadow state always matches the device, so every pointer in it
+ * is kept alive by the device's own reference. */
+class DXStateCache : public Singleton<DXStateCache>
+{
+   friend class Singleton<DXStateCache>;
+
+   public:
+   static constexpr uint32 SRV_SLOTS = 32;
+   static constexpr uint32 UAV_SLOTS = D3D11_PS_CS_UAV_REGISTER_COUNT;
+   static constexpr uint32 SAMPLER_SLOTS = D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT;
+   static constexpr uint32 VERTEX_BUFFER_SLOTS = 4;
+   static constexpr uint32 STAGE_COUNT = static_cast<uint32>(DXShaderStage::StageCount);
+
+   // Forgets the shadow state, the next call of each kind always reaches the device
+   void Invalidate();
+   // Clears every stale binding on the device
+   void Flush(ID3D11DeviceContext* context);
+   // Invalidates and moves the counters of the last frame to FrameStats()
+   void BeginFrame();
+
+   void SetVertexShader(ID3D11DeviceContext* context, ID3D11VertexShader* shader);
+   void SetPixelShader(ID3D11DeviceContext* context, ID3D11PixelShader* shader);
+   void SetGeometryShader(ID3D11DeviceContext* context, ID3D11GeometryShader* shader);
+   void SetHullShader(ID3D11DeviceContext* context, ID3D11HullShader* shader);
+   void SetDomainShader(ID3D11DeviceContext* context, ID3D11DomainShader* shader);
+   void SetComputeShader(ID3D11DeviceContext* context, ID3D11ComputeShader* shader);
+   // Shaders carry no hazards, unbinding them is only counted
+   void ReleaseShaders();
+
+   void SetInputLayout(ID3D11DeviceContext* context, ID3D11InputLayout* inputLayout);
+   void SetPrimitiveTopology(ID3D11DeviceContext* context, D3D11_PRIMITIVE_TOPOLOGY topology);
+   void SetVertexBuffer(ID3D11DeviceContext* context, uint32 slot, ID3D11Buffer* buffer, uint32 stride, uint32 offset);
+   void SetIndexBuffer(ID3D11DeviceContext* context, ID3D11Buffer* buffer, DXGI_FORMAT format, uint32 offset);
+
+   void SetRasterizerState(ID3D11DeviceContext* context, ID3D11RasterizerState* state);
+   void SetDepthStencilState(ID3D11DeviceContext* context, ID3D11DepthStencilState* state, uint32 stencilRef);
+   void SetBlendState(ID3D11DeviceContext* context, ID3D11BlendState* state, const float* blendFactor, uint32 sampleMask);
+
+   void SetShaderResources(ID3D11DeviceContext* context, DXShaderStage stage, uint32 slot, uint32 count,
+                           ID3D11ShaderResourceView* const* views);
+   void ReleaseShaderResources(DXShaderStage stage, uint32 slot, uint32 count);
+   void SetSamplers(ID3D11DeviceContext* context, DXShaderStage stage, uint32 slot, uint32 count, ID3D11SamplerState* const* samplers);
+   // compute stage only, like the rest of the engine
+   void SetUnorderedAccessViews(ID3D11DeviceContext* context, uint32 slot, uint32 count, ID3D11UnorderedAccessView* const* views);
+   void ReleaseUnorderedAccessViews(uint32 slot, uint32 count);
+
+   void SetRenderTargets(ID3D11DeviceContext* context, uint32 count, ID3D11RenderTargetView* const* views,
+                         ID3D11DepthStencilView* dsv);
+   void ReleaseRenderTargets();
+
+   DXStateCacheStats const& FrameStats() const
+   {
+      return frameStats;
+   }
+
+   private:
+   DXStateCache();
+
+   struct ViewSlot
+   {
+      void* view = nullptr;
+      ID3D11Resource* resource = nullptr; // only used for identity, never dereferenced
+      bool stale = false;
+   };
+
+   // shadow value of a binding whose device state is not known, never equal to a real object
+   template <typename T>
+   static T* Unknown()
+   {
+      return reinterpret_cast<T*>(~uintptr_t(0));
+   }
+
+   bool Submit(bool changed);
+   void Forward()
+   {
+      ++stats.forwarded;
+   }
+
+   static ID3D11Resource* ResourceOf(ID3D11View* view);
+   static void ForwardShaderResources(ID3D11DeviceContext* context, DXShaderStage stage, uint32 slot, uint32 count,
+                                      ID3D11ShaderResourceView* const* views);
+
+   // clear stale or live bindings of a resource that is about to be used in a conflicting way
+   void ClearShaderResourcesOf(ID3D11DeviceContext* context, ID3D11Resource* resource);
+   void ClearUnorderedAccessViewsOf(ID3D11DeviceContext* context, ID3D11Resource* resource, bool staleOnly);
+   void ClearStaleOutputsOf(ID3D11DeviceContext* context, ID3D11Resource* resource);
+   void ClearStaleOutputs(ID3D11DeviceContext* context);
+   bool IsBoundAsOutput(ID3D11Resource* resource) const;
+
+   private:
+   ID3D11VertexShader* vs = nullptr;
+   ID3D11PixelShader* ps = nullptr;
+   ID3D11GeometryShader* gs = nullptr;
+   ID3D11HullShader* hs = nullptr;
+   ID3D11DomainShader* ds = nullptr;
+   ID3D11ComputeShader* cs = nullptr;
+
+   ID3D11InputLayout* inputLayout = nullptr;
+   D3D11_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+   struct VertexBufferSlot
+   {
+      ID3D11Buffer* buffer = nullptr;
+      uint32 stride = 0;
+      uint32 offset = 0;
+   };
+   std::array<VertexBufferSlot, VERTEX_BUFFER_SLOTS> vertexBuffers;
+   ID3D11Buffer* indexBuffer = nullptr;
+   DXGI_FORMAT indexFormat = DXGI_FORMAT_UNKNOWN;
+   uint32 indexOffset = 0;
+
+   ID3D11RasterizerState* rasterizerState = nullptr;
+   ID3D11DepthStencilState* depthStencilState = nullptr;
+   uint32 stencilRef = 0;
+   ID3D11BlendState* blendState = nullptr;
+   std::array<float, 4> blendFactor{};
+   uint32 sampleMask = 0;
+
+   std::array<std::array<ViewSlot, SRV_SLOTS>, STAGE_COUNT> shaderResources;
+   std::array<std::array<ID3D11SamplerState*, SAMPLER_SLOTS>, STAGE_COUNT> samplers;
+   std::array<ViewSlot, UAV_SLOTS> unorderedAccessViews;
+
+   std::array<ID3D11RenderTargetView*, D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT> renderTargets{};
+   std::array<ID3D11Resource*, D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT + 1> outputResources{}; // RTVs then the DSV
+   uint32 renderTargetCount = 0;
+   ID3D11DepthStencilView* depthStencilView = nullptr;
+   bool outputsStale = false;
+
+   DXStateCacheStats stats;
+   DXStateCacheStats frameStats;
+};
+#define g_StateCache DXStateCache::Get()
+
+} // namespace Riley
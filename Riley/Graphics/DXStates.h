@@ -4,6 +4,7 @@
 #include "../Core/CoreTypes.h"
 #include "../Core/Rendering.h"
 #include "DXShader.h"
+#include "DXStateCache.h"
 
 namespace Riley
 {
@@ -198,7 +199,7 @@ class DXRasterizerState
 
    void Bind(ID3D11DeviceContext* context)
    {
-      context->RSSetState(rasterizerState);
+      g_StateCache.SetRasterizerState(context, rasterizerState);
    }
 
    private:
@@ -216,7 +217,7 @@ class DXDepthStencilState
 
    void Bind(ID3D11DeviceContext* context, uint8 stencilRef)
    {
-      context->OMSetDepthStencilState(depthStencilState, stencilRef);
+      g_StateCache.SetDepthStencilState(context, depthStencilState, stencilRef);
    }
 
    private:
@@ -234,12 +235,12 @@ class DXBlendState
 
    void Bind(ID3D11DeviceContext* context, const float* blendFactor = nullptr, uint32 sampleMask = 0xffffff)
    {
-      context->OMSetBlendState(blendState, blendFactor, sampleMask);
+      g_StateCache.SetBlendState(context, blendState, blendFactor, sampleMask);
    }
 
    void Unbind(ID3D11DeviceContext* context, const float* blendFactor = nullptr, uint32 sampleMask = 0xffffff)
    {
-      context->OMSetBlendState(nullptr, blendFactor, sampleMask);
+      g_StateCache.SetBlendState(context, nullptr, blendFactor, sampleMask);
    }
 
    private:
@@ -318,20 +319,9 @@ class DXSampler
 
    void Bind(ID3D11DeviceContext* context, uint32 slot, DXShaderStage const& stage)
    {
-      switch (stage)
-         {
-         case DXShaderStage::VS:
-            context->VSSetSamplers(slot, 1, &sampler);
-            break;
-         case DXShaderStage::PS:
-            context->PSSetSamplers(slot, 1, &sampler);
-            break;
-         case DXShaderStage::CS:
-             context->CSSetSamplers(slot, 1, &sampler);
-             break;
-         default:
-            assert(false && "Unsupported Blend Shader Stage!");
-         }
+      assert((stage == DXShaderStage::VS || stage == DXShaderStage::PS || stage == DXShaderStage::CS) &&
+             "Unsupported Blend Shader Stage!");
+      g_StateCache.SetSamplers(context, stage, slot, 1, &sampler);
    }
 
    operator ID3D11SamplerState* const() const
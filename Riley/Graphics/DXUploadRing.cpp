@@ -0,0 +1,46 @@
+#include "DXUploadRing.h"
+
+namespace Riley
+{
+
+DXUploadRing::DXUploadRing(uint32 frameCapacity, uint32 framesInFlight)
+    : frameCapacity(AlignedSize(frameCapacity)), framesInFlight(framesInFlight), frameIndex(framesInFlight - 1)
+{
+    assert(framesInFlight > 0);
+    staging.resize(this->frameCapacity);
+}
+
+void DXUploadRing::BeginFrame()
+{
+    if (Overflowed())
+    {
+        frameCapacity *= 2;
+        staging.resize(frameCapacity);
+        frameIndex = 0;
+    }
+    else
+    {
+        frameIndex = (frameIndex + 1) % framesInFlight;
+    }
+    Rewind();
+}
+
+void DXUploadRing::Rewind()
+{
+    head.store(0, std::memory_order_relaxed);
+    overflowed.store(false, std::memory_order_relaxed);
+}
+
+DXUploadAllocation DXUploadRing::Allocate(uint32 size)
+{
+    const uint32 alignedSize = AlignedSize(size);
+    const uint32 offset = head.fetch_add(alignedSize, std::memory_order_relaxed);
+    if (offset + alignedSize > frameCapacity)
+    {
+        overflowed.store(true, std::memory_order_relaxed);
+        return {};
+    }
+    return {RegionOffset() + offset, alignedSize, staging.data() + offset};
+}
+
+} // namespace Riley
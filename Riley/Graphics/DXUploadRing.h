@@ -0,0 +1,99 @@
+#pragma once
+#include "../Core/Rendering.h"
+#include <atomic>
+
+namespace Riley
+{
+
+struct DXUploadAllocation
+{
+    uint32 offset = 0;     // from the start of the ring, what the window is bound at
+    uint32 size = 0;       // window size, a multiple of the alignment
+    uint8* data = nullptr; // CPU copy, written until the frame is uploaded
+
+    bool IsValid() const
+    {
+        return data != nullptr;
+    }
+};
+
+/* Frame scoped linear allocator for per draw constants. The ring is split in one region per frame in flight and
+ * the allocations of a frame are packed into its region at CONSTANT_ALIGNMENT, the granularity constant buffer
+ * windows are bound at (16 constants). Allocating is lock free so lists can be recorded in parallel.
+ * There is no device here: the data lands in a CPU copy of the current region, see DXConstantRing for the upload. */
+class DXUploadRing
+{
+  public:
+    static constexpr uint32 CONSTANT_ALIGNMENT = 256;
+
+    DXUploadRing(uint32 frameCapacity, uint32 framesInFlight);
+    DXUploadRing(DXUploadRing const&) = delete;
+    DXUploadRing& operator=(DXUploadRing const&) = delete;
+    virtual ~DXUploadRing() = default;
+
+    // Moves to the next region. A frame that ran out of space doubles the region size for the next ones,
+    // which restarts the ring at region 0
+    virtual void BeginFrame();
+    // Forgets the allocations of the current frame without moving to the next region
+    void Rewind();
+
+    // Returns an invalid allocation when the region is full, the caller has to fall back to something else
+    DXUploadAllocation Allocate(uint32 size);
+    template <typename T>
+    DXUploadAllocation Push(T const& data)
+    {
+        DXUploadAllocation allocation = Allocate(sizeof(T));
+        if (allocation.IsValid())
+            memcpy(allocation.data, &data, sizeof(T));
+        return allocation;
+    }
+
+    static constexpr uint32 AlignedSize(uint32 size)
+    {
+        return (size + CONSTANT_ALIGNMENT - 1) & ~(CONSTANT_ALIGNMENT - 1);
+    }
+
+    uint32 FrameIndex() const
+    {
+        return frameIndex;
+    }
+    uint32 FramesInFlight() const
+    {
+        return framesInFlight;
+    }
+    uint32 FrameCapacity() const
+    {
+        return frameCapacity;
+    }
+    uint64 RingSize() const
+    {
+        return uint64(frameCapacity) * framesInFlight;
+    }
+    uint32 RegionOffset() const
+    {
+        return frameIndex * frameCapacity;
+    }
+    uint32 UsedBytes() const
+    {
+        return std::min(head.load(std::memory_order_relaxed), frameCapacity);
+    }
+    bool Overflowed() const
+    {
+        return overflowed.load(std::memory_order_relaxed);
+    }
+    // what the current frame allocated, to be copied at RegionOffset()
+    std::span<uint8 const> FrameData() const
+    {
+        return {staging.data(), UsedBytes()};
+    }
+
+  private:
+    std::vector<uint8> staging;
+    std::atomic<uint32> head = 0;
+    std::atomic<bool> overflowed = false;
+    uint32 frameCapacity;
+    uint32 framesInFlight;
+    uint32 frameIndex;
+};
+
+} // namespace Riley
@@ -0,0 +1,192 @@
+#include "Culling.h"
+#include "../Core/Rendering.h"
+#include "../Rendering/RenderSetting.h"
+#include <bit>
+#include <execution>
+#include <numeric>
+#include <xmmintrin.h>
+
+namespace Riley
+{
+
+static Vector4 NormalizePlane(DirectX::XMVECTOR plane)
+{
+    return Vector4(DirectX::XMPlaneNormalize(plane));
+}
+
+CullPlanes CullPlanes::FromFrustum(DirectX::BoundingFrustum const& frustum)
+{
+    DirectX::XMVECTOR n, f, r, l, t, b;
+    frustum.GetPlanes(&n, &f, &r, &l, &t, &b);
+
+    CullPlanes result{};
+    result.planes[0] = NormalizePlane(n);
+    result.planes[1] = NormalizePlane(f);
+    result.planes[2] = NormalizePlane(r);
+    result.planes[3] = NormalizePlane(l);
+    result.planes[4] = NormalizePlane(t);
+    result.planes[5] = NormalizePlane(b);
+    return result;
+}
+
+CullPlanes CullPlanes::FromBox(DirectX::BoundingBox const& box)
+{
+    const Vector3 minCorner = Vector3(box.Center) - Vector3(box.Extents);
+    const Vector3 maxCorner = Vector3(box.Center) + Vector3(box.Extents);
+
+    CullPlanes result{};
+    result.planes[0] = Vector4(1.0f, 0.0f, 0.0f, -maxCorner.x);
+    result.planes[1] = Vector4(-1.0f, 0.0f, 0.0f, minCorner.x);
+    result.planes[2] = Vector4(0.0f, 1.0f, 0.0f, -maxCorner.y);
+    result.planes[3] = Vector4(0.0f, -1.0f, 0.0f, minCorner.y);
+    result.planes[4] = Vector4(0.0f, 0.0f, 1.0f, -maxCorner.z);
+    result.planes[5] = Vector4(0.0f, 0.0f, -1.0f, minCorner.z);
+    return result;
+}
+
+void BoundsSoA::Resize(uint32 newCount)
+{
+    const uint32 padded = (newCount + CULL_BATCH - 1) / CULL_BATCH * CULL_BATCH;
+    count = newCount;
+    for (auto* v : {&centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ})
+        v->resize(padded);
+    for (uint32 i = newCount; i < padded; ++i)
+        SetEmpty(i);
+}
+
+void BoundsSoA::Set(uint32 slot, DirectX::BoundingBox const& box)
+{
+    centerX[slot] = box.Center.x;
+    centerY[slot] = box.Center.y;
+    centerZ[slot] = box.Center.z;
+    extentX[slot] = box.Extents.x;
+    extentY[slot] = box.Extents.y;
+    extentZ[slot] = box.Extents.z;
+}
+
+void BoundsSoA::SetEmpty(uint32 slot)
+{
+    // A hugely negative radius makes every plane reject the slot without producing NaNs
+    centerX[slot] = centerY[slot] = centerZ[slot] = 0.0f;
+    extentX[slot] = extentY[slot] = extentZ[slot] = -1e30f;
+}
+
+namespace Culling
+{
+
+void FrustumCullScalar(BoundsSoA const& bounds, CullPlanes const& planes, VisibilityBits& visibility)
+{
+    visibility.assign((bounds.PaddedCount() + 63) / 64, 0ull);
+
+    for (uint32 i = 0; i < bounds.count; ++i)
+    {
+        bool visible = true;
+        for (Vector4 const& p : planes.planes)
+        {
+            const float dist = p.x * bounds.centerX[i] + p.y * bounds.centerY[i] + p.z * bounds.centerZ[i] + p.w;
+            const float radius = fabs(p.x) * bounds.extentX[i] + fabs(p.y) * bounds.extentY[i] + fabs(p.z) * bounds.extentZ[i];
+            if (dist > radius)
+            {
+                visible = false;
+                break;
+            }
+        }
+        if (visible)
+            SetVisible(visibility, i);
+    }
+}
+
+namespace
+{
+constexpr uint32 CULL_CHUNK = 64 * 64;
+
+struct PlaneBatch
+{
+    __m128 nx[6], ny[6], nz[6], nd[6], ax[6], ay[6], az[6];
+};
+
+PlaneBatch LoadPlanes(CullPlanes const& planes)
+{
+    PlaneBatch batch;
+    for (uint32 p = 0; p < 6; ++p)
+    {
+        Vector4 const& plane = planes.planes[p];
+        batch.nx[p] = _mm_set1_ps(plane.x);
+        batch.ny[p] = _mm_set1_ps(plane.y);
+        batch.nz[p] = _mm_set1_ps(plane.z);
+        batch.nd[p] = _mm_set1_ps(plane.w);
+        batch.ax[p] = _mm_set1_ps(fabs(plane.x));
+        batch.ay[p] = _mm_set1_ps(fabs(plane.y));
+        batch.az[p] = _mm_set1_ps(fabs(plane.z));
+    }
+    return batch;
+}
+
+// [begin, end) must be multiples of CULL_BATCH, visible bits are OR-ed into a zeroed bitset
+void CullRange(BoundsSoA const& bounds, PlaneBatch const& b, uint32 begin, uint32 end, VisibilityBits& visibility)
+{
+    for (uint32 i = begin; i < end; i += BoundsSoA::CULL_BATCH)
+    {
+        const __m128 cx0 = _mm_loadu_ps(&bounds.centerX[i]), cx1 = _mm_loadu_ps(&bounds.centerX[i + 4]);
+        const __m128 cy0 = _mm_loadu_ps(&bounds.centerY[i]), cy1 = _mm_loadu_ps(&bounds.centerY[i + 4]);
+        const __m128 cz0 = _mm_loadu_ps(&bounds.centerZ[i]), cz1 = _mm_loadu_ps(&bounds.centerZ[i + 4]);
+        const __m128 ex0 = _mm_loadu_ps(&bounds.extentX[i]), ex1 = _mm_loadu_ps(&bounds.extentX[i + 4]);
+        const __m128 ey0 = _mm_loadu_ps(&bounds.extentY[i]), ey1 = _mm_loadu_ps(&bounds.extentY[i + 4]);
+        const __m128 ez0 = _mm_loadu_ps(&bounds.extentZ[i]), ez1 = _mm_loadu_ps(&bounds.extentZ[i + 4]);
+
+        __m128 outside0 = _mm_setzero_ps();
+        __m128 outside1 = _mm_setzero_ps();
+        for (uint32 p = 0; p < 6; ++p)
+        {
+            // same summation order as the scalar path so both produce identical bits
+            __m128 dist0 = _mm_add_ps(_mm_mul_ps(b.nx[p], cx0), _mm_mul_ps(b.ny[p], cy0));
+            __m128 dist1 = _mm_add_ps(_mm_mul_ps(b.nx[p], cx1), _mm_mul_ps(b.ny[p], cy1));
+            dist0 = _mm_add_ps(_mm_add_ps(dist0, _mm_mul_ps(b.nz[p], cz0)), b.nd[p]);
+            dist1 = _mm_add_ps(_mm_add_ps(dist1, _mm_mul_ps(b.nz[p], cz1)), b.nd[p]);
+            __m128 radius0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b.ax[p], ex0), _mm_mul_ps(b.ay[p], ey0)), _mm_mul_ps(b.az[p], ez0));
+            __m128 radius1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b.ax[p], ex1), _mm_mul_ps(b.ay[p], ey1)), _mm_mul_ps(b.az[p], ez1));
+
+            outside0 = _mm_or_ps(outside0, _mm_cmpgt_ps(dist0, radius0));
+            outside1 = _mm_or_ps(outside1, _mm_cmpgt_ps(dist1, radius1));
+        }
+
+        const uint32 outsideMask = static_cast<uint32>(_mm_movemask_ps(outside0) | (_mm_movemask_ps(outside1) << 4));
+        visibility[i >> 6] |= static_cast<uint64>(~outsideMask & 0xFFu) << (i & 63);
+    }
+}
+} // namespace
+
+void FrustumCullSIMD(BoundsSoA const& bounds, CullPlanes const& planes, VisibilityBits& visibility)
+{
+    const uint32 padded = bounds.PaddedCount();
+    visibility.assign((padded + 63) / 64, 0ull);
+    CullRange(bounds, LoadPlanes(planes), 0, padded, visibility);
+}
+
+void FrustumCullViews(BoundsSoA const& bounds, std::span<CullPlanes const> views, VisibilityTable& visibility)
+{
+    const uint32 padded = bounds.PaddedCount();
+    const uint32 viewCount = static_cast<uint32>(views.size());
+
+    visibility.resize(viewCount);
+    std::vector<PlaneBatch> batches(viewCount);
+    for (uint32 v = 0; v < viewCount; ++v)
+    {
+        visibility[v].assign((padded + 63) / 64, 0ull);
+        batches[v] = LoadPlanes(views[v]);
+    }
+
+    // every chunk runs all views back to back while its bounds are still in cache
+    std::vector<uint32> chunks((padded + CULL_CHUNK - 1) / CULL_CHUNK);
+    std::iota(chunks.begin(), chunks.end(), 0u);
+    std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](uint32 chunk) {
+        const uint32 begin = chunk * CULL_CHUNK;
+        const uint32 end = std::min(padded, begin + CULL_CHUNK);
+        for (uint32 v = 0; v < viewCount; ++v)
+            CullRange(bounds, batches[v], begin, end, visibility[v]);
+    });
+}
+
+} // namespace Culling
+
+} // namespace Riley
@@ -0,0 +1,90 @@
+#pragma once
+#include "MathTypes.h"
+#include <bit>
+
+namespace Riley
+{
+
+// One bit per bounds slot, 1 = visible
+using VisibilityBits = std::vector<uint64>;
+
+static inline bool IsVisible(VisibilityBits const& bits, uint32 slot)
+{
+    return (bits[slot >> 6] >> (slot & 63)) & 1ull;
+}
+
+static inline void SetVisible(VisibilityBits& bits, uint32 slot)
+{
+    bits[slot >> 6] |= 1ull << (slot & 63);
+}
+
+// One bitset per view, indexed [view][slot]
+using VisibilityTable = std::vector<VisibilityBits>;
+
+/* Calls f(slot, viewMask) for every slot visible in at least one of views [firstView, firstView + viewCount),
+ * bit i of viewMask is set when the slot is visible in view firstView + i. */
+template <typename F>
+void ForEachVisible(VisibilityTable const& table, uint32 firstView, uint32 viewCount, F&& f)
+{
+    assert(viewCount > 0 && viewCount <= 32);
+    const size_t wordCount = table[firstView].size();
+    for (size_t w = 0; w < wordCount; ++w)
+    {
+        uint64 any = 0;
+        for (uint32 v = 0; v < viewCount; ++v)
+            any |= table[firstView + v][w];
+
+        for (; any; any &= any - 1)
+        {
+            const uint32 bit = static_cast<uint32>(std::countr_zero(any));
+            uint32 viewMask = 0;
+            for (uint32 v = 0; v < viewCount; ++v)
+                viewMask |= static_cast<uint32>((table[firstView + v][w] >> bit) & 1ull) << v;
+            f(static_cast<uint32>(w * 64 + bit), viewMask);
+        }
+    }
+}
+
+/* Six planes with normalized, outward facing normals.
+ * A box is outside when dot(n, center) + d > dot(|n|, extents) for any plane. */
+struct CullPlanes
+{
+    Vector4 planes[6];
+
+    static CullPlanes FromFrustum(DirectX::BoundingFrustum const& frustum);
+    static CullPlanes FromBox(DirectX::BoundingBox const& box);
+};
+
+/* World space AABBs in structure-of-arrays layout.
+ * The arrays are padded to a multiple of CULL_BATCH so the SIMD kernel never needs a tail loop;
+ * padding and empty slots are never visible. */
+struct BoundsSoA
+{
+    static constexpr uint32 CULL_BATCH = 8;
+
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+    uint32 count = 0;
+
+    void Resize(uint32 newCount);
+    void Set(uint32 slot, DirectX::BoundingBox const& box);
+    void SetEmpty(uint32 slot);
+
+    uint32 PaddedCount() const
+    {
+        return static_cast<uint32>(centerX.size());
+    }
+};
+
+namespace Culling
+{
+// Reference implementation, one box at a time
+void FrustumCullScalar(BoundsSoA const& bounds, CullPlanes const& planes, VisibilityBits& visibility);
+// SSE implementation, 8 boxes per iteration (two 4-wide lanes)
+void FrustumCullSIMD(BoundsSoA const& bounds, CullPlanes const& planes, VisibilityBits& visibility);
+/* Culls every view of the frame in one parallel sweep over chunks of slots, producing one bitset per view.
+ * Chunks are a multiple of 64 slots so no two workers ever write the same bitset word. */
+void FrustumCullViews(BoundsSoA const& bounds, std::span<CullPlanes const> views, VisibilityTable& visibility);
+} // namespace Culling
+
+} // namespace Riley
@@ -0,0 +1,601 @@
+#include "DynamicAABBTree.h"
+#include "../Core/Rendering.h"
+
+namespace Riley
+{
+
+static constexpr float FAT_MARGIN_SCALE = 0.1f;
+static constexpr float FAT_MARGIN_MIN = 0.01f;
+static constexpr uint32 SAH_BINS = 12;
+
+namespace
+{
+struct Bounds
+{
+    Vector3 lower = Vector3(FLT_MAX);
+    Vector3 upper = Vector3(-FLT_MAX);
+
+    void Grow(Vector3 const& lo, Vector3 const& hi)
+    {
+        lower = Vector3::Min(lower, lo);
+        upper = Vector3::Max(upper, hi);
+    }
+    float Area() const
+    {
+        const Vector3 d = upper - lower;
+        return d.x < 0.0f ? 0.0f : 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+};
+
+float Area(Vector3 const& lower, Vector3 const& upper)
+{
+    const Vector3 d = upper - lower;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+float UnionArea(Vector3 const& lower0, Vector3 const& upper0, Vector3 const& lower1, Vector3 const& upper1)
+{
+    return Area(Vector3::Min(lower0, lower1), Vector3::Max(upper0, upper1));
+}
+
+bool Overlaps(Vector3 const& lower0, Vector3 const& upper0, Vector3 const& lower1, Vector3 const& upper1)
+{
+    return lower0.x <= upper1.x && lower1.x <= upper0.x && lower0.y <= upper1.y && lower1.y <= upper0.y &&
+           lower0.z <= upper1.z && lower1.z <= upper0.z;
+}
+
+// 0 = outside, 1 = intersecting, 2 = fully inside
+int32 Classify(CullPlanes const& planes, Vector3 const& lower, Vector3 const& upper)
+{
+    const Vector3 center = (lower + upper) * 0.5f;
+    const Vector3 extents = (upper - lower) * 0.5f;
+
+    int32 result = 2;
+    for (Vector4 const& p : planes.planes)
+    {
+        const float dist = p.x * center.x + p.y * center.y + p.z * center.z + p.w;
+        const float radius = fabs(p.x) * extents.x + fabs(p.y) * extents.y + fabs(p.z) * extents.z;
+        if (dist > radius)
+            return 0;
+        if (dist > -radius)
+            result = 1;
+    }
+    return result;
+}
+
+// slab test, returns the entry distance or FLT_MAX on a miss
+float RayBox(Vector3 const& origin, Vector3 const& invDir, Vector3 const& lower, Vector3 const& upper, float maxDistance)
+{
+    float tMin = 0.0f;
+    float tMax = maxDistance;
+    for (uint32 axis = 0; axis < 3; ++axis)
+    {
+        const float o = (&origin.x)[axis];
+        const float inv = (&invDir.x)[axis];
+        float t0 = ((&lower.x)[axis] - o) * inv;
+        float t1 = ((&upper.x)[axis] - o) * inv;
+        if (t0 > t1)
+            std::swap(t0, t1);
+        tMin = std::max(tMin, t0);
+        tMax = std::min(tMax, t1);
+        if (tMin > tMax)
+            return FLT_MAX;
+    }
+    return tMin;
+}
+} // namespace
+
+int32 DynamicAABBTree::AllocateNode()
+{
+    if (freeList == NULL_NODE)
+    {
+        nodes.emplace_back();
+        return static_cast<int32>(nodes.size() - 1);
+    }
+
+    const int32 node = freeList;
+    freeList = nodes[node].parent;
+    nodes[node] = Node{};
+    return node;
+}
+
+void DynamicAABBTree::FreeNode(int32 node)
+{
+    nodes[node].parent = freeList;
+    nodes[node].height = -1;
+    freeList = node;
+}
+
+int32 DynamicAABBTree::CreateProxy(BoundingBox const& box, uint32 userData)
+{
+    const int32 proxy = AllocateNode();
+    const Vector3 margin = Vector3(box.Extents) * FAT_MARGIN_SCALE + Vector3(FAT_MARGIN_MIN);
+
+    Node& node = nodes[proxy];
+    node.lower = Vector3(box.Center) - Vector3(box.Extents) - margin;
+    node.upper = Vector3(box.Center) + Vector3(box.Extents) + margin;
+    node.userData = userData;
+    node.height = 0;
+
+    InsertLeaf(proxy);
+    ++proxyCount;
+    return proxy;
+}
+
+void DynamicAABBTree::DestroyProxy(int32 proxy)
+{
+    assert(proxy >= 0 && proxy < (int32)nodes.size() && nodes[proxy].IsLeaf());
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    --proxyCount;
+}
+
+bool DynamicAABBTree::MoveProxy(int32 proxy, BoundingBox const& box)
+{
+    assert(proxy >= 0 && proxy < (int32)nodes.size() && nodes[proxy].IsLeaf());
+
+    const Vector3 lower = Vector3(box.Center) - Vector3(box.Extents);
+    const Vector3 upper = Vector3(box.Center) + Vector3(box.Extents);
+
+    Node& node = nodes[proxy];
+    if (node.lower.x <= lower.x && node.lower.y <= lower.y && node.lower.z <= lower.z && upper.x <= node.upper.x &&
+        upper.y <= node.upper.y && upper.z <= node.upper.z)
+        return false;
+
+    RemoveLeaf(proxy);
+    const Vector3 margin = Vector3(box.Extents) * FAT_MARGIN_SCALE + Vector3(FAT_MARGIN_MIN);
+    nodes[proxy].lower = lower - margin;
+    nodes[proxy].upper = upper + margin;
+    InsertLeaf(proxy);
+    return true;
+}
+
+void DynamicAABBTree::Clear()
+{
+    nodes.clear();
+    root = NULL_NODE;
+    freeList = NULL_NODE;
+    proxyCount = 0;
+}
+
+void DynamicAABBTree::InsertLeaf(int32 leaf)
+{
+    if (root == NULL_NODE)
+    {
+        root = leaf;
+        nodes[root].parent = NULL_NODE;
+        return;
+    }
+
+    // Descend towards the sibling with the cheapest SAH cost
+    const Vector3 leafLower = nodes[leaf].lower;
+    const Vector3 leafUpper = nodes[leaf].upper;
+    int32 index = root;
+    while (!nodes[index].IsLeaf())
+    {
+        Node const& node = nodes[index];
+        const float area = Area(node.lower, node.upper);
+        const float combinedArea = UnionArea(node.lower, node.upper, leafLower, leafUpper);
+
+        // cost of making a new parent for this node and the leaf
+        const float cost = 2.0f * combinedArea;
+        // minimum cost of pushing the leaf further down the tree
+        const float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto ChildCost = [&](int32 child) {
+            Node const& c = nodes[child];
+            const float unionArea = UnionArea(c.lower, c.upper, leafLower, leafUpper);
+            return (c.IsLeaf() ? unionArea : unionArea - Area(c.lower, c.upper)) + inheritanceCost;
+        };
+        const float cost1 = ChildCost(node.child1);
+        const float cost2 = ChildCost(node.child2);
+
+        if (cost < cost1 && cost < cost2)
+            break;
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    const int32 sibling = index;
+    const int32 oldParent = nodes[sibling].parent;
+    const int32 newParent = AllocateNode();
+
+    Node& parent = nodes[newParent];
+    parent.parent = oldParent;
+    parent.lower = Vector3::Min(leafLower, nodes[sibling].lower);
+    parent.upper = Vector3::Max(leafUpper, nodes[sibling].upper);
+    parent.height = nodes[sibling].height + 1;
+    parent.child1 = sibling;
+    parent.child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent != NULL_NODE)
+    {
+        if (nodes[oldParent].child1 == sibling)
+            nodes[oldParent].child1 = newParent;
+        else
+            nodes[oldParent].child2 = newParent;
+    }
+    else
+    {
+        root = newParent;
+    }
+
+    FixUpwards(nodes[leaf].parent);
+}
+
+void DynamicAABBTree::RemoveLeaf(int32 leaf)
+{
+    if (leaf == root)
+    {
+        root = NULL_NODE;
+        return;
+    }
+
+    const int32 parent = nodes[leaf].parent;
+    const int32 grandParent = nodes[parent].parent;
+    const int32 sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent != NULL_NODE)
+    {
+        if (nodes[grandParent].child1 == parent)
+            nodes[grandParent].child1 = sibling;
+        else
+            nodes[grandParent].child2 = sibling;
+        nodes[sibling].parent = grandParent;
+        FreeNode(parent);
+        FixUpwards(grandParent);
+    }
+    else
+    {
+        root = sibling;
+        nodes[sibling].parent = NULL_NODE;
+        FreeNode(parent);
+    }
+}
+
+void DynamicAABBTree::FixUpwards(int32 index)
+{
+    // Refit the ancestors, rotating where the subtrees got unbalanced
+    while (index != NULL_NODE)
+    {
+        index = Balance(index);
+
+        Node& node = nodes[index];
+        Node const& child1 = nodes[node.child1];
+        Node const& child2 = nodes[node.child2];
+        node.height = 1 + std::max(child1.height, child2.height);
+        node.lower = Vector3::Min(child1.lower, child2.lower);
+        node.upper = Vector3::Max(child1.upper, child2.upper);
+
+        index = node.parent;
+    }
+}
+
+// Rotates A up if it is imbalanced, returns the new root of the subtree
+int32 DynamicAABBTree::Balance(int32 iA)
+{
+    Node& A = nodes[iA];
+    if (A.IsLeaf() || A.height < 2)
+        return iA;
+
+    const int32 iB = A.child1;
+    const int32 iC = A.child2;
+    Node& B = nodes[iB];
+    Node& C = nodes[iC];
+    const int32 balance = C.height - B.height;
+
+    auto Rotate = [&](Node& low, int32 iHigh, Node& high, bool highIsChild2) {
+        // promote high, A becomes a child of high
+        const int32 iF = high.child1;
+        const int32 iG = high.child2;
+        Node& F = nodes[iF];
+        Node& G = nodes[iG];
+
+        high.child1 = iA;
+        high.parent = A.parent;
+        A.parent = iHigh;
+
+        if (high.parent != NULL_NODE)
+        {
+            if (nodes[high.parent].child1 == iA)
+                nodes[high.parent].child1 = iHigh;
+            else
+                nodes[high.parent].child2 = iHigh;
+        }
+        else
+        {
+            root = iHigh;
+        }
+
+        // the taller grandchild stays with high, the other one moves under A
+        const bool keepF = F.height > G.height;
+        const int32 iKeep = keepF ? iF : iG;
+        const int32 iMove = keepF ? iG : iF;
+        Node& moved = nodes[iMove];
+        Node const& kept = nodes[iKeep];
+
+        high.child2 = iKeep;
+        if (highIsChild2)
+            A.child2 = iMove;
+        else
+            A.child1 = iMove;
+        moved.parent = iA;
+
+        A.lower = Vector3::Min(low.lower, moved.lower);
+        A.upper = Vector3::Max(low.upper, moved.upper);
+        high.lower = Vector3::Min(A.lower, kept.lower);
+        high.upper = Vector3::Max(A.upper, kept.upper);
+        A.height = 1 + std::max(low.height, moved.height);
+        high.height = 1 + std::max(A.height, kept.height);
+    };
+
+    if (balance > 1)
+    {
+        Rotate(B, iC, C, true);
+        return iC;
+    }
+    if (balance < -1)
+    {
+        Rotate(C, iB, B, false);
+        return iB;
+    }
+    return iA;
+}
+
+void DynamicAABBTree::Rebuild()
+{
+    if (proxyCount == 0)
+        return;
+
+    std::vector<int32> leaves;
+    leaves.reserve(proxyCount);
+    for (int32 i = 0; i < (int32)nodes.size(); ++i)
+    {
+        if (nodes[i].height < 0)
+            continue;
+        if (nodes[i].IsLeaf())
+            leaves.push_back(i);
+        else
+            FreeNode(i);
+    }
+
+    root = BuildRange(leaves.data(), static_cast<uint32>(leaves.size()));
+    nodes[root].parent = NULL_NODE;
+}
+
+// Top-down binned SAH build over the leaf range
+int32 DynamicAABBTree::BuildRange(int32* leaves, uint32 count)
+{
+    if (count == 1)
+        return leaves[0];
+
+    Bounds centroids;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        const Vector3 c = (nodes[leaves[i]].lower + nodes[leaves[i]].upper) * 0.5f;
+        centroids.Grow(c, c);
+    }
+
+    const Vector3 size = centroids.upper - centroids.lower;
+    const uint32 axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+    const float axisLower = (&centroids.lower.x)[axis];
+    const float axisSize = (&size.x)[axis];
+
+    auto Centroid = [&](int32 leaf) { return ((&nodes[leaf].lower.x)[axis] + (&nodes[leaf].upper.x)[axis]) * 0.5f; };
+
+    uint32 mid = count / 2;
+    if (axisSize > 1e-6f)
+    {
+        const float binScale = SAH_BINS / axisSize;
+        auto BinOf = [&](int32 leaf) {
+            return std::min(SAH_BINS - 1, static_cast<uint32>((Centroid(leaf) - axisLower) * binScale));
+        };
+
+        Bounds bins[SAH_BINS];
+        uint32 binCounts[SAH_BINS] = {};
+        for (uint32 i = 0; i < count; ++i)
+        {
+            const uint32 b = BinOf(leaves[i]);
+            bins[b].Grow(nodes[leaves[i]].lower, nodes[leaves[i]].upper);
+            ++binCounts[b];
+        }
+
+        // sweep from the right to get the cost of every right side, then from the left to pick the split
+        float rightArea[SAH_BINS];
+        uint32 rightCount[SAH_BINS];
+        Bounds accum;
+        uint32 accumCount = 0;
+        for (uint32 b = SAH_BINS - 1; b > 0; --b)
+        {
+            accum.Grow(bins[b].lower, bins[b].upper);
+            accumCount += binCounts[b];
+            rightArea[b] = accum.Area();
+            rightCount[b] = accumCount;
+        }
+
+        float bestCost = FLT_MAX;
+        uint32 bestSplit = 0;
+        accum = Bounds{};
+        accumCount = 0;
+        for (uint32 b = 1; b < SAH_BINS; ++b)
+        {
+            accum.Grow(bins[b - 1].lower, bins[b - 1].upper);
+            accumCount += binCounts[b - 1];
+            if (accumCount == 0 || rightCount[b] == 0)
+                continue;
+            const float cost = accumCount * accum.Area() + rightCount[b] * rightArea[b];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestSplit = b;
+            }
+        }
+
+        if (bestSplit != 0)
+        {
+            int32* pivot = std::partition(leaves, leaves + count, [&](int32 leaf) { return BinOf(leaf) < bestSplit; });
+            mid = static_cast<uint32>(pivot - leaves);
+        }
+        else
+        {
+            std::nth_element(leaves, leaves + mid, leaves + count,
+                             [&](int32 lhs, int32 rhs) { return Centroid(lhs) < Centroid(rhs); });
+        }
+    }
+
+    const int32 child1 = BuildRange(leaves, mid);
+    const int32 child2 = BuildRange(leaves + mid, count - mid);
+
+    const int32 index = AllocateNode();
+    Node& node = nodes[index];
+    node.child1 = child1;
+    node.child2 = child2;
+    node.lower = Vector3::Min(nodes[child1].lower, nodes[child2].lower);
+    node.upper = Vector3::Max(nodes[child1].upper, nodes[child2].upper);
+    node.height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+    nodes[child1].parent = index;
+    nodes[child2].parent = index;
+    return index;
+}
+
+void DynamicAABBTree::QueryBox(BoundingBox const& box, std::vector<uint32>& out) const
+{
+    if (root == NULL_NODE)
+        return;
+
+    const Vector3 lower = Vector3(box.Center) - Vector3(box.Extents);
+    const Vector3 upper = Vector3(box.Center) + Vector3(box.Extents);
+
+    std::vector<int32> stack;
+    stack.reserve(64);
+    stack.push_back(root);
+    while (!stack.empty())
+    {
+        Node const& node = nodes[stack.back()];
+        stack.pop_back();
+        if (!Overlaps(node.lower, node.upper, lower, upper))
+            continue;
+
+        if (node.IsLeaf())
+        {
+            out.push_back(node.userData);
+        }
+        else
+        {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+void DynamicAABBTree::QuerySphere(BoundingSphere const& sphere, std::vector<uint32>& out) const
+{
+    if (root == NULL_NODE)
+        return;
+
+    const Vector3 center = sphere.Center;
+    const float radiusSq = sphere.Radius * sphere.Radius;
+
+    std::vector<int32> stack;
+    stack.reserve(64);
+    stack.push_back(root);
+    while (!stack.empty())
+    {
+        Node const& node = nodes[stack.back()];
+        stack.pop_back();
+
+        const Vector3 closest = Vector3::Max(node.lower, Vector3::Min(center, node.upper));
+        if (Vector3::DistanceSquared(closest, center) > radiusSq)
+            continue;
+
+        if (node.IsLeaf())
+        {
+            out.push_back(node.userData);
+        }
+        else
+        {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+void DynamicAABBTree::QueryFrustum(CullPlanes const& planes, std::vector<uint32>& out) const
+{
+    if (root == NULL_NODE)
+        return;
+
+    // second member marks subtrees already known to be fully inside
+    std::vector<std::pair<int32, bool>> stack;
+    stack.reserve(64);
+    stack.emplace_back(root, false);
+    while (!stack.empty())
+    {
+        auto [index, inside] = stack.back();
+        stack.pop_back();
+        Node const& node = nodes[index];
+
+        if (!inside)
+        {
+            const int32 result = Classify(planes, node.lower, node.upper);
+            if (result == 0)
+                continue;
+            inside = result == 2;
+        }
+
+        if (node.IsLeaf())
+        {
+            out.push_back(node.userData);
+        }
+        else
+        {
+            stack.emplace_back(node.child1, inside);
+            stack.emplace_back(node.child2, inside);
+        }
+    }
+}
+
+void DynamicAABBTree::RayCast(Ray const& ray, float maxDistance, std::function<float(uint32, float)> const& callback) const
+{
+    if (root == NULL_NODE)
+        return;
+
+    const Vector3 origin = ray.position;
+    const Vector3 invDir(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+
+    std::vector<int32> stack;
+    stack.reserve(64);
+    stack.push_back(root);
+    while (!stack.empty())
+    {
+        Node const& node = nodes[stack.back()];
+        stack.pop_back();
+
+        const float distance = RayBox(origin, invDir, node.lower, node.upper, maxDistance);
+        if (distance == FLT_MAX)
+            continue;
+
+        if (node.IsLeaf())
+        {
+            maxDistance = callback(node.userData, distance);
+            if (maxDistance <= 0.0f)
+                return;
+        }
+        else
+        {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+void DynamicAABBTree::QueryRay(Ray const& ray, float maxDistance, std::vector<uint32>& out) const
+{
+    RayCast(ray, maxDistance, [&](uint32 userData, float) {
+        out.push_back(userData);
+        return maxDistance;
+    });
+}
+
+} // namespace Riley
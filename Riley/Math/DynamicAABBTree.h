@@ -0,0 +1,78 @@
+#pragma once
+#include "Culling.h"
+
+namespace Riley
+{
+
+/* Dynamic bounding volume hierarchy over fattened AABBs.
+ * Leaves are inserted with a surface area heuristic descent and kept balanced with AVL style rotations;
+ * Rebuild() does a full top-down binned SAH build, used after bulk loading.
+ * MoveProxy only touches the tree when the new box leaves the fat box, so static and slowly moving
+ * objects cost nothing. Queries return the user data (entity ids) of overlapping leaves. */
+class DynamicAABBTree
+{
+  public:
+    static constexpr int32 NULL_NODE = -1;
+
+    DynamicAABBTree() = default;
+
+    int32 CreateProxy(BoundingBox const& box, uint32 userData);
+    void DestroyProxy(int32 proxy);
+    // returns true if the proxy had to be reinserted
+    bool MoveProxy(int32 proxy, BoundingBox const& box);
+    void Rebuild();
+    void Clear();
+
+    void QueryBox(BoundingBox const& box, std::vector<uint32>& out) const;
+    void QuerySphere(BoundingSphere const& sphere, std::vector<uint32>& out) const;
+    void QueryFrustum(CullPlanes const& planes, std::vector<uint32>& out) const;
+    // callback gets (userData, distance to the fat box) and returns the new max distance to clip the ray
+    void RayCast(Ray const& ray, float maxDistance, std::function<float(uint32, float)> const& callback) const;
+    void QueryRay(Ray const& ray, float maxDistance, std::vector<uint32>& out) const;
+
+    uint32 GetUserData(int32 proxy) const
+    {
+        return nodes[proxy].userData;
+    }
+    uint32 GetProxyCount() const
+    {
+        return proxyCount;
+    }
+    int32 GetHeight() const
+    {
+        return root == NULL_NODE ? 0 : nodes[root].height;
+    }
+
+  private:
+    struct Node
+    {
+        Vector3 lower;
+        Vector3 upper;
+        int32 parent = NULL_NODE; // next free node while on the free list
+        int32 child1 = NULL_NODE;
+        int32 child2 = NULL_NODE;
+        int32 height = -1; // leaf = 0, free node = -1
+        uint32 userData = 0;
+
+        bool IsLeaf() const
+        {
+            return child1 == NULL_NODE;
+        }
+    };
+
+    int32 AllocateNode();
+    void FreeNode(int32 node);
+    void InsertLeaf(int32 leaf);
+    void RemoveLeaf(int32 leaf);
+    int32 Balance(int32 a);
+    void FixUpwards(int32 index);
+    int32 BuildRange(int32* leaves, uint32 count);
+
+  private:
+    std::vector<Node> nodes;
+    int32 root = NULL_NODE;
+    int32 freeList = NULL_NODE;
+    uint32 proxyCount = 0;
+};
+
+} // namespace Riley
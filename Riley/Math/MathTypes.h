@@ -1,5 +1,15 @@
 #pragma once
+#ifdef _WIN32
 #define __d3d11_h__
+#else
+// SimpleMath's Rectangle and Viewport are written against these win32 types
+using LONG = int32_t;
+using UINT = uint32_t;
+struct RECT {
+    LONG left, top, right, bottom;
+};
+#define __cdecl
+#endif
 #include "SimpleMath.h"
 
 namespace Riley {
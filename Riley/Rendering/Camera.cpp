@@ -120,11 +120,13 @@ void Camera::RotateYaw(int64 dx)
 void Camera::SetprojRow(float fov, float aspect, float zn, float zf)
 {
     projRow = DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(fov), aspect, zn, zf);
+    frustumDirty = true;
 }
 
 void Camera::SetviewRow()
 {
     viewRow = DirectX::XMMatrixLookToLH(position, lookVector, upVector);
+    frustumDirty = true;
 }
 
 } // namespace Riley
\ No newline at end of file
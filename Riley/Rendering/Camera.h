@@ -33,6 +33,10 @@ class Camera
     float speedFactor = 1.0f;
     float sensitivity = 0.3f;
 
+    // world space frustum, rebuilt lazily when view or projection changes
+    DirectX::BoundingFrustum frustum;
+    bool frustumDirty = true;
+
   public:
     Camera() = default;
     explicit Camera(CameraParameters const&);
@@ -86,10 +90,14 @@ class Camera
         return aspectRatio;
     }
 
-    const DirectX::BoundingFrustum Frustum()
+    DirectX::BoundingFrustum const& Frustum()
     {
-        DirectX::BoundingFrustum frustum(GetProj().Transpose());
-        frustum.Transform(frustum, viewRow.Invert());
+        if (frustumDirty)
+        {
+            DirectX::BoundingFrustum::CreateFromMatrix(frustum, projRow);
+            frustum.Transform(frustum, viewRow.Invert());
+            frustumDirty = false;
+        }
         return frustum;
     }
 
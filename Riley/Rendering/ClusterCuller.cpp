@@ -0,0 +1,120 @@
+#include "ClusterCuller.h"
+#include "OcclusionCuller.h"
+#include <algorithm>
+
+namespace Riley
+{
+namespace ClusterCulling
+{
+
+static bool InsideAny(std::span<CullPlanes const> views, Vector3 const& center, float radius)
+{
+    for (CullPlanes const& view : views)
+    {
+        bool inside = true;
+        for (Vector4 const& plane : view.planes)
+        {
+            if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w > radius)
+            {
+                inside = false;
+                break;
+            }
+        }
+        if (inside)
+            return true;
+    }
+    return false;
+}
+
+// Closes the smallest gaps between the ranges appended after first until at most maxRanges are left
+static void MergeRanges(std::vector<ClusterRange>& ranges, size_t first, uint32 maxRanges)
+{
+    const size_t count = ranges.size() - first;
+    if (count <= maxRanges)
+        return;
+
+    std::vector<std::pair<uint32, uint32>> gaps; // size, range before the gap
+    gaps.reserve(count - 1);
+    for (size_t i = first; i + 1 < ranges.size(); ++i)
+    {
+        const uint32 end = ranges[i].startIndexLoc + ranges[i].indexCount;
+        gaps.emplace_back(ranges[i + 1].startIndexLoc - end, static_cast<uint32>(i));
+    }
+    std::sort(gaps.begin(), gaps.end());
+
+    std::vector<uint8> closed(count, 0);
+    for (size_t i = 0; i < count - maxRanges; ++i)
+        closed[gaps[i].second - first] = 1;
+
+    size_t out = first;
+    for (size_t i = first; i < ranges.size(); ++i)
+    {
+        if (i > first && closed[i - 1 - first])
+            ranges[out - 1].indexCount = ranges[i].startIndexLoc + ranges[i].indexCount - ranges[out - 1].startIndexLoc;
+        else
+            ranges[out++] = ranges[i];
+    }
+    ranges.resize(out);
+}
+
+uint32 Cull(MeshClusters const& clusters, Mesh const& mesh, WorldTransform const& world, ClusterCullView const& view,
+            std::vector<ClusterRange>& ranges, ClusterCullStats& stats)
+{
+    assert(clusters.meshlets && clusters.firstMeshlet + clusters.meshletCount <= clusters.meshlets->size());
+    const Matrix worldRow = world.world.Transpose();
+    const float scaleX = Vector3(worldRow._11, worldRow._12, worldRow._13).Length();
+    const float scaleY = Vector3(worldRow._21, worldRow._22, worldRow._23).Length();
+    const float scaleZ = Vector3(worldRow._31, worldRow._32, worldRow._33).Length();
+    const float maxScale = std::max({scaleX, scaleY, scaleZ});
+    // cones only survive uniform scales, mirrored transforms flip which side of the triangles is culled
+    const bool uniform = maxScale - std::min({scaleX, scaleY, scaleZ}) <= 0.01f * maxScale && worldRow.Determinant() > 0.0f;
+    const bool backface = view.eye.has_value() && uniform;
+
+    const size_t first = ranges.size();
+    stats.meshes++;
+    for (uint32 i = clusters.firstMeshlet; i < clusters.firstMeshlet + clusters.meshletCount; ++i)
+    {
+        Meshlet const& meshlet = (*clusters.meshlets)[i];
+        stats.clusters++;
+
+        const Vector3 center = Vector3::Transform(meshlet.center, worldRow);
+        const float radius = meshlet.radius * maxScale;
+        if (!InsideAny(view.planes, center, radius))
+        {
+            stats.frustumRejected++;
+            continue;
+        }
+        if (backface && meshlet.coneCutoff <= 1.0f)
+        {
+            Vector3 axis = Vector3::TransformNormal(meshlet.coneAxis, worldRow);
+            axis.Normalize();
+            Vector3 direction = Vector3::Transform(meshlet.coneApex, worldRow) - *view.eye;
+            direction.Normalize();
+            if (direction.Dot(axis) >= meshlet.coneCutoff)
+            {
+                stats.backfaceRejected++;
+                continue;
+            }
+        }
+        if (view.occlusion && view.occlusion->IsOccluded(DirectX::BoundingBox(center, Vector3(radius, radius, radius))))
+        {
+            stats.occlusionRejected++;
+            continue;
+        }
+
+        const uint32 start = mesh.startIndexLoc + meshlet.firstIndex;
+        const uint32 count = meshlet.triangleCount * 3u;
+        if (ranges.size() > first && ranges.back().startIndexLoc + ranges.back().indexCount == start)
+            ranges.back().indexCount += count;
+        else
+            ranges.push_back(ClusterRange{start, count});
+    }
+    MergeRanges(ranges, first, MAX_RANGES);
+
+    const uint32 appended = static_cast<uint32>(ranges.size() - first);
+    stats.ranges += appended;
+    return appended;
+}
+
+} // namespace ClusterCulling
+} // namespace Riley
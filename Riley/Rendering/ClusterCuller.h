@@ -0,0 +1,68 @@
+#pragma once
+#include "../Math/Culling.h"
+#include "MeshletBuilder.h"
+#include "TransformSystem.h"
+
+namespace Riley
+{
+
+class OcclusionCuller;
+
+// Indices of the visible clusters of a mesh, located in the geometry allocation like Mesh::startIndexLoc
+struct ClusterRange
+{
+    uint32 startIndexLoc = 0;
+    uint32 indexCount = 0;
+};
+
+struct ClusterCullStats
+{
+    uint32 meshes = 0;
+    uint32 clusters = 0;
+    uint32 frustumRejected = 0;
+    uint32 backfaceRejected = 0;
+    uint32 occlusionRejected = 0;
+    uint32 ranges = 0; // draws issued for the surviving clusters
+
+    uint32 Rejected() const
+    {
+        return frustumRejected + backfaceRejected + occlusionRejected;
+    }
+    float RejectedRatio() const
+    {
+        return clusters ? static_cast<float>(Rejected()) / clusters : 0.0f;
+    }
+    ClusterCullStats& operator+=(ClusterCullStats const& other)
+    {
+        meshes += other.meshes;
+        clusters += other.clusters;
+        frustumRejected += other.frustumRejected;
+        backfaceRejected += other.backfaceRejected;
+        occlusionRejected += other.occlusionRejected;
+        ranges += other.ranges;
+        return *this;
+    }
+};
+
+// What the clusters are tested against, tests without their input are skipped
+struct ClusterCullView
+{
+    std::span<CullPlanes const> planes;         // a cluster is kept when it is inside any of them
+    std::optional<Vector3> eye;                 // world position for the backface cone test, perspective views only
+    OcclusionCuller const* occlusion = nullptr; // rendered for this frame's camera
+};
+
+/* CPU culling of the meshlets of a mesh in world space, by bounding sphere against the view planes, by normal cone
+ * against the eye and by the sphere's box against the occlusion depth buffer. Nothing runs on the GPU: the surviving
+ * clusters come back as index ranges drawn with the regular vertex shaders. */
+namespace ClusterCulling
+{
+// neighbouring ranges are merged over the smallest gaps beyond this, a few culled triangles are cheaper than a draw
+inline constexpr uint32 MAX_RANGES = 8;
+
+// Appends the ranges of the clusters that survive, consecutive ones merged, and returns how many were appended
+uint32 Cull(MeshClusters const& clusters, Mesh const& mesh, WorldTransform const& world, ClusterCullView const& view,
+            std::vector<ClusterRange>& ranges, ClusterCullStats& stats);
+} // namespace ClusterCulling
+
+} // namespace Riley
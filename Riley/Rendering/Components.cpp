@@ -6,24 +6,157 @@ void Mesh::Draw(ID3D11DeviceContext* context) const { Draw(context, topology); }
 
 void Mesh::Draw(ID3D11DeviceContext* context,
                 D3D11_PRIMITIVE_TOPOLOGY topology) const {
+    GeometryView const view = g_GeometryArena.Resolve(geometry);
 
-    context->IASetPrimitiveTopology(topology);
-    BindVertexBuffer(context, vertexBuffer.get(), 0, 0);
+    g_StateCache.SetPrimitiveTopology(context, topology);
+    BindVertexBuffer(context, view.vertexBuffer, 0, 0);
 
-    if (indexBuffer != nullptr) {
-        BindIndexBuffer(context, indexBuffer.get());
+    if (view.indexBuffer != nullptr) {
+        BindIndexBuffer(context, view.indexBuffer);
         if (instanceBuffer != nullptr) {
             BindVertexBuffer(context, instanceBuffer.get(), 1, 0);
         }
-        context->DrawIndexedInstanced(indexCount, instanceCount, startIndexLoc,
-                                      baseVertexLoc, startInstanceLoc);
+        context->DrawIndexedInstanced(indexCount, instanceCount,
+                                      view.firstIndex + startIndexLoc,
+                                      view.firstVertex + baseVertexLoc,
+                                      startInstanceLoc);
     } else {
         if (instanceBuffer != nullptr) {
             BindVertexBuffer(context, instanceBuffer.get(), 1, 0);
         }
-        context->DrawInstanced(vertexCount, instanceCount, startVertexLoc,
+        context->DrawInstanced(vertexCount, instanceCount,
+                               view.firstVertex + startVertexLoc,
                                startInstanceLoc);
     }
 }
 
+// indices are located relative to the allocation, like Mesh::startIndexLoc
+static void RecordDraw(Mesh const& mesh, DXCommandList& list,
+                       DXBuffer* instances, uint32 count, uint32 startInstance,
+                       D3D11_PRIMITIVE_TOPOLOGY topology, uint32 startIndex,
+                       uint32 indexCount) {
+    GeometryView const view = g_GeometryArena.Resolve(mesh.geometry);
+
+    DXCommandDrawIndexed draw{};
+    draw.vertexBuffer = view.vertexBuffer;
+    draw.indexBuffer = view.indexBuffer;
+    draw.instanceBuffer = instances;
+    draw.vertexCount = mesh.vertexCount;
+    draw.startVertexLoc = view.firstVertex + mesh.startVertexLoc;
+    draw.indexCount = indexCount;
+    draw.startIndexLoc = view.firstIndex + startIndex;
+    draw.baseVertexLoc = view.firstVertex + mesh.baseVertexLoc;
+    draw.instanceCount = count;
+    draw.startInstanceLoc = startInstance;
+    draw.topology = static_cast<DXPrimitiveTopology>(topology);
+    list.DrawIndexed(draw);
+}
+
+void Mesh::Draw(DXCommandList& list) const { Draw(list, topology); }
+
+void Mesh::Draw(DXCommandList& list, D3D11_PRIMITIVE_TOPOLOGY topology) const {
+    DrawInstanced(list, instanceBuffer.get(), instanceCount, startInstanceLoc,
+                  topology);
+}
+
+void Mesh::DrawLOD(DXCommandList& list, uint32 lod) const {
+    DrawInstanced(list, instanceBuffer.get(), instanceCount, startInstanceLoc,
+                  topology, lod);
+}
+
+void Mesh::DrawRange(DXCommandList& list, uint32 startIndex,
+                     uint32 count) const {
+    RecordDraw(*this, list, instanceBuffer.get(), instanceCount,
+               startInstanceLoc, topology, startIndex, count);
+}
+
+void Mesh::DrawInstanced(DXCommandList& list, DXBuffer* instances, uint32 count,
+                         uint32 startInstance, uint32 lod) const {
+    DrawInstanced(list, instances, count, startInstance, topology, lod);
+}
+
+void Mesh::DrawInstanced(DXCommandList& list, DXBuffer* instances, uint32 count,
+                         uint32 startInstance, D3D11_PRIMITIVE_TOPOLOGY topology,
+                         uint32 lod) const {
+    assert(lod <= lodCount);
+    MeshLOD const level = lod > 0 ? lods[lod - 1]
+                                  : MeshLOD{startIndexLoc, indexCount, 0.0f};
+    RecordDraw(*this, list, instances, count, startInstance, topology,
+               level.startIndexLoc, level.indexCount);
+}
+
+void AcquireMeshGeometry(entt::registry& reg, entt::entity e) {
+    g_GeometryArena.AddRef(reg.get<Mesh>(e).geometry);
+}
+
+void ReleaseMeshGeometry(entt::registry& reg, entt::entity e) {
+    g_GeometryArena.Release(reg.get<Mesh>(e).geometry);
+}
+
+void AttachChild(entt::registry& reg, entt::entity parent, entt::entity child) {
+    reg.get_or_emplace<Relationship>(parent);
+    reg.get_or_emplace<Relationship>(child);
+    assert(reg.get<Relationship>(child).parent == entt::null && "Entity already has a parent!");
+
+    // every link goes through patch so on_update<Relationship> reaches the TransformSystem
+    const entt::entity previous = reg.get<Relationship>(parent).lastChild;
+    if (previous != entt::null)
+        reg.patch<Relationship>(previous, [child](Relationship& r) { r.nextSibling = child; });
+    reg.patch<Relationship>(child, [parent](Relationship& r) {
+        r.parent = parent;
+        r.nextSibling = entt::null;
+    });
+    reg.patch<Relationship>(parent, [child](Relationship& r) {
+        if (r.firstChild == entt::null)
+            r.firstChild = child;
+        r.lastChild = child;
+        r.childrenCount++;
+    });
+}
+
+void DetachChild(entt::registry& reg, entt::entity child) {
+    Relationship const& childRelationship = reg.get<Relationship>(child);
+    const entt::entity parent = childRelationship.parent;
+    const entt::entity next = childRelationship.nextSibling;
+    if (parent == entt::null)
+        return;
+
+    if (reg.valid(parent) && reg.all_of<Relationship>(parent)) {
+        // the links only go forward, find the sibling before the child from the first one
+        entt::entity previous = entt::null;
+        for (entt::entity e = reg.get<Relationship>(parent).firstChild; e != child;
+             e = reg.get<Relationship>(e).nextSibling) {
+            assert(e != entt::null && "Child is missing from its parent's list!");
+            previous = e;
+        }
+        if (previous != entt::null)
+            reg.patch<Relationship>(previous, [next](Relationship& r) { r.nextSibling = next; });
+        reg.patch<Relationship>(parent, [child, previous, next](Relationship& r) {
+            if (r.firstChild == child)
+                r.firstChild = next;
+            if (r.lastChild == child)
+                r.lastChild = previous;
+            r.childrenCount--;
+        });
+    }
+    reg.patch<Relationship>(child, [](Relationship& r) {
+        r.parent = entt::null;
+        r.nextSibling = entt::null;
+    });
+}
+
+void UnlinkRelationship(entt::registry& reg, entt::entity e) {
+    DetachChild(reg, e);
+
+    // the children become roots, none of them may keep pointing at e or at each other
+    for (entt::entity child = reg.get<Relationship>(e).firstChild; child != entt::null;) {
+        const entt::entity next = reg.get<Relationship>(child).nextSibling;
+        reg.patch<Relationship>(child, [](Relationship& r) {
+            r.parent = entt::null;
+            r.nextSibling = entt::null;
+        });
+        child = next;
+    }
+}
+
 } // namespace Riley
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 #include "../Graphics/DXBuffer.h"
+#include "../Graphics/DXCommandList.h"
 #include "../Graphics/DXShaderProgram.h"
+#include "../Rendering/GeometryArena.h"
+#include "../Rendering/MeshCommon.h"
 #include "../Rendering/ShaderManager.h"
 #include "../Rendering/TextureManager.h"
 
@@ -11,25 +14,11 @@ namespace Riley
 
 static constexpr float pie = 3.141592654f;
 
-struct Vertex
-{
-    Vector3 position;
-    Vector3 normal;
-    Vector2 texcoord;
-    Vector3 tangent;
-    Vector3 bitangent;
-};
-
-struct SimpleVertex
-{
-    Vector3 position;
-    Vector2 texcoord;
-};
-
 struct COMPONENT Transform
 {
     Matrix startingTransform = Matrix::Identity;
     Matrix currentTransform = Matrix::Identity;
+    bool dirty = true; // set when currentTransform changes, cleared by TransformSystem
 };
 
 struct COMPONENT Material
@@ -55,11 +44,13 @@ struct COMPONENT Material
 
 struct COMPONENT Mesh
 {
-    std::shared_ptr<DXBuffer> vertexBuffer = nullptr;
-    std::shared_ptr<DXBuffer> indexBuffer = nullptr;
+    // vertices and indices in g_GeometryArena, the locations below are relative to the allocation
+    GeometryHandle geometry = INVALID_GEOMETRY_HANDLE;
     std::shared_ptr<DXBuffer> instanceBuffer = nullptr;
+    // maps the 16 bit positions of a CompactVertex back to model space, unused by other vertex types
+    Vector3 positionBias = Vector3(0, 0, 0);
+    Vector3 positionScale = Vector3(1, 1, 1);
 
-    // vertex buffer and index buffer
     uint32 vertexCount = 0;
     uint32 startVertexLoc = 0; // Index of the first vertex
 
@@ -76,8 +67,37 @@ struct COMPONENT Mesh
 
     D3D11_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 
+    // levels 1..lodCount, level 0 is the range above
+    std::array<MeshLOD, MAX_MESH_LODS> lods{};
+    uint32 lodCount = 0;
+
     void Draw(ID3D11DeviceContext* _context) const;
     void Draw(ID3D11DeviceContext* _context, D3D11_PRIMITIVE_TOPOLOGY override_topology) const;
+    void Draw(DXCommandList& list) const;
+    void Draw(DXCommandList& list, D3D11_PRIMITIVE_TOPOLOGY override_topology) const;
+    void DrawLOD(DXCommandList& list, uint32 lod) const;
+    // Draws count indices from startIndex, located in the allocation like startIndexLoc, e.g. the visible clusters
+    void DrawRange(DXCommandList& list, uint32 startIndex, uint32 count) const;
+    // Draws the mesh once per instance of an instance buffer the caller owns, bound at slot 1
+    void DrawInstanced(DXCommandList& list, DXBuffer* instances, uint32 count, uint32 startInstance, uint32 lod = 0) const;
+    void DrawInstanced(DXCommandList& list, DXBuffer* instances, uint32 count, uint32 startInstance,
+                       D3D11_PRIMITIVE_TOPOLOGY override_topology, uint32 lod = 0) const;
+};
+
+// Mesh components hold a reference to their geometry while they are in the registry
+void AcquireMeshGeometry(entt::registry& reg, entt::entity e);
+void ReleaseMeshGeometry(entt::registry& reg, entt::entity e);
+
+// Model space triangles kept on the CPU for ray queries, shared between the submeshes of a model like the GPU buffers
+struct COMPONENT MeshCollider
+{
+    std::shared_ptr<std::vector<Vector3>> positions = nullptr;
+    std::shared_ptr<std::vector<uint32>> indices = nullptr;
+
+    uint32 vertexCount = 0;
+    uint32 indexCount = 0;
+    uint32 startIndexLoc = 0;
+    int32 baseVertexLoc = 0;
 };
 
 struct COMPONENT Light
@@ -117,36 +137,26 @@ struct COMPONENT AABB
     DirectX::BoundingBox boundingBox;
     DirectX::BoundingBox orginalBox;
     bool isCameraVisible = true;
-    bool isLightVisible = false;
     bool isDrawAABB = false;
-    std::shared_ptr<DXBuffer> aabbVertexBuffer = nullptr;
-    std::shared_ptr<DXBuffer> aabbIndexBuffer = nullptr;
-
-    void UpdateBuffer(ID3D11Device* device)
-    {
-        Vector3 corners[8];
-        boundingBox.GetCorners(corners);
-        SimpleVertex vertices[] = {SimpleVertex{corners[0]}, SimpleVertex{corners[1]}, SimpleVertex{corners[2]},
-                                   SimpleVertex{corners[3]}, SimpleVertex{corners[4]}, SimpleVertex{corners[5]},
-                                   SimpleVertex{corners[6]}, SimpleVertex{corners[7]}};
-        aabbVertexBuffer = std::make_shared<DXBuffer>(device, VertexBufferDesc(ARRAYSIZE(vertices), sizeof(SimpleVertex)), vertices);
-    }
-
-    void SetAABBIndexBuffer(ID3D11Device* device)
-    {
-        const uint16 aabb_indices[] = {0, 1, 1, 2, 2, 3, 3, 0, 0, 4, 1, 5, 2, 6, 3, 7, 4, 5, 5, 6, 6, 7, 7, 4};
-        aabbIndexBuffer = std::make_shared<DXBuffer>(device, IndexBufferDesc(ARRAYSIZE(aabb_indices), true), aabb_indices);
-    }
+    int32 treeProxy = -1; // leaf in TransformSystem's DynamicAABBTree
 };
 
+// first-child / next-sibling links, children are visited in the order they were attached
 struct COMPONENT Relationship
 {
-    static constexpr size_t MAX_CHILDREN = 2048;
     entt::entity parent = entt::null;
+    entt::entity firstChild = entt::null;
+    entt::entity lastChild = entt::null;
+    entt::entity nextSibling = entt::null;
     uint32 childrenCount = 0;
-    entt::entity children[MAX_CHILDREN] = {entt::null};
 };
 
+void AttachChild(entt::registry& reg, entt::entity parent, entt::entity child);
+// Takes the child out of its parent's list, the child keeps its own children
+void DetachChild(entt::registry& reg, entt::entity child);
+// on_destroy<Relationship> hook: detaches the entity and turns its children into roots so no link dangles
+void UnlinkRelationship(entt::registry& reg, entt::entity e);
+
 struct COMPONENT Tag
 {
     std::string name = "default";
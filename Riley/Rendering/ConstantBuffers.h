@@ -69,6 +69,10 @@ struct ObjectConsts
 {
     Matrix world;
     Matrix worldInvTranspose;
+    uint32 viewMask; // cascades / cube faces the object is drawn into
+    Vector3 positionBias; // Mesh::positionBias/positionScale, decode the CompactVertex positions
+    Vector3 positionScale;
+    float _dummy;
 };
 
 struct MaterialConsts
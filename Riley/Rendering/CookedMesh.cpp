@@ -0,0 +1,224 @@
+#include "CookedMesh.h"
+#include "../Utilities/FileUtil.h"
+#include "../Utilities/HashUtil.h"
+#include "cereal/archives/binary.hpp"
+#include "cereal/types/array.hpp"
+#include "cereal/types/string.hpp"
+#include "cereal/types/vector.hpp"
+#include <fstream>
+#include <sstream>
+
+namespace Riley
+{
+namespace CookedMesh
+{
+
+namespace
+{
+struct Header
+{
+    uint32 magic = MAGIC;
+    uint32 version = VERSION;
+    uint64 key = 0;
+    float importSeconds = 0.0f;
+    uint64 tableSize = 0;
+    uint64 vertexOffset = 0, vertexCount = 0;
+    uint64 indexOffset = 0, indexCount = 0;
+    uint64 positionOffset = 0, positionCount = 0;
+    uint64 meshletOffset = 0, meshletCount = 0;
+
+    template <class Archive>
+    void serialize(Archive& archive)
+    {
+        archive(magic, version, key, importSeconds, tableSize);
+        archive(vertexOffset, vertexCount, indexOffset, indexCount, positionOffset, positionCount, meshletOffset, meshletCount);
+    }
+};
+
+// Lets cereal read the header and the table in place from the mapped pages
+struct MemoryBuffer : std::streambuf
+{
+    MemoryBuffer(uint8 const* data, uint64 size)
+    {
+        char* begin = const_cast<char*>(reinterpret_cast<char const*>(data));
+        setg(begin, begin, begin + size);
+    }
+    uint64 Position() const
+    {
+        return static_cast<uint64>(gptr() - eback());
+    }
+};
+
+uint64 AlignUp(uint64 offset)
+{
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+uint64 HashFile(std::string const& path, uint64 seed)
+{
+    MappedFile file(path);
+    return file.IsOpen() ? HashBytes(file.Data(), file.Size(), seed) : seed;
+}
+
+template <typename T>
+std::span<T const> Section(MappedFile const& file, uint64 offset, uint64 count)
+{
+    if (offset % SECTION_ALIGNMENT != 0 || offset > file.Size() || count > (file.Size() - offset) / sizeof(T))
+        return {};
+    return std::span<T const>(reinterpret_cast<T const*>(file.Data() + offset), count);
+}
+} // namespace
+
+std::string CachePath(std::string const& filename)
+{
+    return std::string(CACHE_DIRECTORY) + filename + ".rmesh";
+}
+
+uint64 Key(std::string const& basePath, std::string const& filename, bool revertNormals, bool nativeGLTF,
+           LODChainSettings const& lodSettings)
+{
+    uint64 key = HashFile(basePath + filename, HashBytes(&VERSION, sizeof(VERSION)));
+    // glTF keeps its geometry in separate buffers, any of them changing has to miss the cache as well
+    std::vector<std::string> buffers;
+    std::error_code error;
+    for (fs::directory_entry const& entry : fs::directory_iterator(basePath, error))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".bin")
+            buffers.push_back(entry.path().filename().string());
+    }
+    std::sort(buffers.begin(), buffers.end());
+    for (std::string const& buffer : buffers)
+        key = HashFile(basePath + buffer, HashBytes(buffer.data(), buffer.size(), key));
+
+    // which loader read the file changes what gets cooked, GLTFLoader reads materials assimp does not
+    const uint32 options[] = {revertNormals, nativeGLTF, lodSettings.lodCount, MeshletBuilder::MAX_VERTICES,
+                              MeshletBuilder::MAX_TRIANGLES, sizeof(CompactVertex), sizeof(Meshlet)};
+    const float lodOptions[] = {lodSettings.reduction, lodSettings.errorBudget, lodSettings.minReduction};
+    key = HashBytes(options, sizeof(options), key);
+    return HashBytes(lodOptions, sizeof(lodOptions), key);
+}
+
+bool Write(std::string const& path, uint64 key, CookedModelView const& model)
+{
+    std::ostringstream table(std::ios::binary);
+    {
+        cereal::BinaryOutputArchive archive(table);
+        archive(model.submeshes, model.nodes);
+    }
+    const std::string tableBytes = table.str();
+
+    Header header{};
+    header.key = key;
+    header.importSeconds = model.importSeconds;
+    header.tableSize = tableBytes.size();
+    header.vertexCount = model.vertices.size();
+    header.indexCount = model.indices.size();
+    header.positionCount = model.positions.size();
+    header.meshletCount = model.meshlets.size();
+
+    // the header has a fixed size, the offsets it holds do not change it
+    std::ostringstream headerSize(std::ios::binary);
+    {
+        cereal::BinaryOutputArchive archive(headerSize);
+        archive(header);
+    }
+    uint64 offset = headerSize.str().size() + tableBytes.size();
+    auto Place = [&offset](uint64& sectionOffset, uint64 bytes) {
+        sectionOffset = AlignUp(offset);
+        offset = sectionOffset + bytes;
+    };
+    Place(header.vertexOffset, model.vertices.size_bytes());
+    Place(header.indexOffset, model.indices.size_bytes());
+    Place(header.positionOffset, model.positions.size_bytes());
+    Place(header.meshletOffset, model.meshlets.size_bytes());
+
+    std::error_code error;
+    fs::create_directories(fs::path(path).parent_path(), error);
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream os(temporary, std::ios::binary | std::ios::trunc);
+        if (!os)
+            return false;
+        {
+            cereal::BinaryOutputArchive archive(os);
+            archive(header);
+        }
+        os.write(tableBytes.data(), tableBytes.size());
+
+        auto WriteSection = [&os](uint64 sectionOffset, void const* data, uint64 bytes) {
+            static constexpr char padding[SECTION_ALIGNMENT] = {};
+            os.write(padding, sectionOffset - static_cast<uint64>(os.tellp()));
+            os.write(static_cast<char const*>(data), bytes);
+        };
+        WriteSection(header.vertexOffset, model.vertices.data(), model.vertices.size_bytes());
+        WriteSection(header.indexOffset, model.indices.data(), model.indices.size_bytes());
+        WriteSection(header.positionOffset, model.positions.data(), model.positions.size_bytes());
+        WriteSection(header.meshletOffset, model.meshlets.data(), model.meshlets.size_bytes());
+        if (!os)
+            return false;
+    }
+    fs::rename(temporary, path, error);
+    return !error;
+}
+
+std::optional<CookedModelView> Read(MappedFile const& file, uint64 key)
+{
+    if (!file.IsOpen())
+        return std::nullopt;
+
+    MemoryBuffer buffer(file.Data(), file.Size());
+    std::istream is(&buffer);
+    Header header{};
+    CookedModelView model{};
+    try
+    {
+        cereal::BinaryInputArchive archive(is);
+        archive(header);
+        if (header.magic != MAGIC || header.version != VERSION || header.key != key)
+            return std::nullopt;
+        archive(model.submeshes, model.nodes);
+    }
+    catch (cereal::Exception const&)
+    {
+        return std::nullopt;
+    }
+
+    model.importSeconds = header.importSeconds;
+    model.vertices = Section<CompactVertex>(file, header.vertexOffset, header.vertexCount);
+    model.indices = Section<uint32>(file, header.indexOffset, header.indexCount);
+    model.positions = Section<Vector3>(file, header.positionOffset, header.positionCount);
+    model.meshlets = Section<Meshlet>(file, header.meshletOffset, header.meshletCount);
+    if (model.vertices.size() != header.vertexCount || model.indices.size() != header.indexCount ||
+        model.positions.size() != header.positionCount || model.meshlets.size() != header.meshletCount ||
+        model.positions.size() != model.vertices.size())
+        return std::nullopt;
+
+    // a truncated or foreign file must not send the renderer out of its buffers
+    for (CookedSubmesh const& submesh : model.submeshes)
+    {
+        if (uint64(submesh.baseVertexLoc) + submesh.vertexCount > header.vertexCount ||
+            uint64(submesh.startIndexLoc) + submesh.indexCount > header.indexCount || submesh.lodCount > MAX_MESH_LODS ||
+            uint64(submesh.firstMeshlet) + submesh.meshletCount > header.meshletCount)
+            return std::nullopt;
+        for (uint32 level = 0; level < submesh.lodCount; ++level)
+        {
+            if (uint64(submesh.lods[level].startIndexLoc) + submesh.lods[level].indexCount > header.indexCount)
+                return std::nullopt;
+        }
+    }
+    for (uint32 i = 0; i < model.nodes.size(); ++i)
+    {
+        CookedNode const& node = model.nodes[i];
+        if (node.parent != CookedNode::NO_PARENT && node.parent >= i)
+            return std::nullopt;
+        for (uint32 submesh : node.submeshes)
+        {
+            if (submesh >= model.submeshes.size())
+                return std::nullopt;
+        }
+    }
+    return model;
+}
+
+} // namespace CookedMesh
+} // namespace Riley
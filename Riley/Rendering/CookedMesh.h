@@ -0,0 +1,113 @@
+#pragma once
+#include "../Utilities/MappedFile.h"
+#include "MeshletBuilder.h"
+#include "MeshSimplifier.h"
+#include "VertexCompression.h"
+
+namespace Riley
+{
+
+// One submesh of a cooked model, locations are relative to the model's streams like the ones of Mesh
+struct CookedSubmesh
+{
+    std::string name;
+
+    std::string albedoTexture;
+    std::string normalTexture;
+    std::string metallicRoughnessTexture;
+    std::string emissiveTexture;
+    std::string alphaMode = "OPAQUE";
+    float alphaCutoff = 0.5f;
+    bool doubleSided = false;
+
+    uint32 vertexCount = 0;
+    uint32 indexCount = 0;
+    uint32 baseVertexLoc = 0;
+    uint32 startIndexLoc = 0;
+    std::array<float, 3> positionBias{};
+    std::array<float, 3> positionScale{};
+    std::array<float, 3> boundsCenter{};
+    std::array<float, 3> boundsExtents{};
+    std::array<MeshLOD, MAX_MESH_LODS> lods{};
+    uint32 lodCount = 0;
+    uint32 firstMeshlet = 0;
+    uint32 meshletCount = 0;
+
+    template <class Archive>
+    void serialize(Archive& archive)
+    {
+        archive(name, albedoTexture, normalTexture, metallicRoughnessTexture, emissiveTexture, alphaMode, alphaCutoff, doubleSided);
+        archive(vertexCount, indexCount, baseVertexLoc, startIndexLoc, positionBias, positionScale, boundsCenter, boundsExtents);
+        for (MeshLOD& lod : lods)
+            archive(lod.startIndexLoc, lod.indexCount, lod.error);
+        archive(lodCount, firstMeshlet, meshletCount);
+    }
+};
+
+// A node of a cooked model, it draws the submeshes it lists with the transform accumulated from its parents
+struct CookedNode
+{
+    static constexpr uint32 NO_PARENT = uint32(-1);
+
+    std::string name;
+    uint32 parent = NO_PARENT;         // nodes always come after their parent
+    std::array<float, 16> transform{}; // relative to the parent, row major like Matrix
+    std::vector<uint32> submeshes;
+
+    template <class Archive>
+    void serialize(Archive& archive)
+    {
+        archive(name, parent, transform, submeshes);
+    }
+};
+
+// A fully processed model, either pointing into the buffers of a fresh import or into a mapped cache file
+struct CookedModelView
+{
+    std::vector<CookedSubmesh> submeshes; // every mesh of the model once, the nodes instance them
+    std::vector<CookedNode> nodes;
+    std::span<CompactVertex const> vertices;
+    std::span<uint32 const> indices;      // base triangles and LODs of every submesh
+    std::span<Vector3 const> positions;   // uncompressed, for the collider
+    std::span<Meshlet const> meshlets;
+    float importSeconds = 0.0f;           // of the import that cooked it
+};
+
+// Owns the streams of a fresh import until they are written out and uploaded
+struct CookedModel
+{
+    std::vector<CookedSubmesh> submeshes;
+    std::vector<CookedNode> nodes;
+    std::vector<CompactVertex> vertices;
+    std::vector<uint32> indices;
+    std::vector<Vector3> positions;
+    std::vector<Meshlet> meshlets;
+
+    CookedModelView View(float importSeconds) const
+    {
+        return CookedModelView{submeshes, nodes, vertices, indices, positions, meshlets, importSeconds};
+    }
+};
+
+/* Cache of imported models, one file per model under CACHE_DIRECTORY. The header and the submesh table are written
+ * with cereal, the streams follow as raw arrays aligned to SECTION_ALIGNMENT so they can be used straight from the
+ * mapped pages. A file is only used when its key matches: the key hashes the bytes of the source file, of the glTF
+ * buffers next to it, and every import option and format version that changes what gets cooked. */
+namespace CookedMesh
+{
+inline constexpr char const* CACHE_DIRECTORY = "Resources/Cache/";
+inline constexpr uint32 MAGIC = 0x48534D52; // "RMSH"
+inline constexpr uint32 VERSION = 3;
+inline constexpr uint64 SECTION_ALIGNMENT = 16;
+
+std::string CachePath(std::string const& filename);
+uint64 Key(std::string const& basePath, std::string const& filename, bool revertNormals, bool nativeGLTF,
+           LODChainSettings const& lodSettings);
+
+// Writes to a temporary file first, a cache is never seen half written. Returns false when it could not be written
+bool Write(std::string const& path, uint64 key, CookedModelView const& model);
+// The streams of the view point into file, which has to stay open while they are used
+std::optional<CookedModelView> Read(MappedFile const& file, uint64 key);
+} // namespace CookedMesh
+
+} // namespace Riley
@@ -0,0 +1,52 @@
+#include "DebugDraw.h"
+
+namespace Riley
+{
+
+void DebugDraw::AddLine(Vector3 const& from, Vector3 const& to, Vector4 const& color)
+{
+    vertices.push_back(DebugVertex{from, color});
+    vertices.push_back(DebugVertex{to, color});
+}
+
+void DebugDraw::AddBox(DirectX::BoundingBox const& box, Vector4 const& color)
+{
+    Vector3 corners[8];
+    box.GetCorners(corners);
+    AddCorners(corners, color);
+}
+
+void DebugDraw::AddFrustum(DirectX::BoundingFrustum const& frustum, Vector4 const& color)
+{
+    Vector3 corners[8];
+    frustum.GetCorners(corners);
+    AddCorners(corners, color);
+}
+
+void DebugDraw::AddSphere(Vector3 const& center, float radius, Vector4 const& color, uint32 segments)
+{
+    assert(segments >= 3);
+    const float dTheta = DirectX::XM_2PI / static_cast<float>(segments);
+
+    // three great circles on the XY, XZ and YZ planes
+    for (uint32 i = 0; i < segments; ++i)
+    {
+        const float c0 = radius * cos(dTheta * i), s0 = radius * sin(dTheta * i);
+        const float c1 = radius * cos(dTheta * (i + 1)), s1 = radius * sin(dTheta * (i + 1));
+
+        AddLine(center + Vector3(c0, s0, 0.0f), center + Vector3(c1, s1, 0.0f), color);
+        AddLine(center + Vector3(c0, 0.0f, s0), center + Vector3(c1, 0.0f, s1), color);
+        AddLine(center + Vector3(0.0f, c0, s0), center + Vector3(0.0f, c1, s1), color);
+    }
+}
+
+void DebugDraw::AddCorners(Vector3 const (&corners)[8], Vector4 const& color)
+{
+    static constexpr uint8 edges[] = {0, 1, 1, 2, 2, 3, 3, 0, 0, 4, 1, 5, 2, 6, 3, 7, 4, 5, 5, 6, 6, 7, 7, 4};
+    for (uint32 i = 0; i < ARRAYSIZE(edges); i += 2)
+    {
+        AddLine(corners[edges[i]], corners[edges[i + 1]], color);
+    }
+}
+
+} // namespace Riley
@@ -0,0 +1,51 @@
+#pragma once
+#include "../Math/MathTypes.h"
+
+namespace Riley
+{
+
+struct DebugVertex
+{
+    Vector3 position;
+    Vector4 color;
+};
+
+/* Immediate-mode debug lines.
+ * Every shape is expanded into a LINELIST on the CPU and collected in one arena that is
+ * cleared (not freed) each frame, so the renderer can upload everything with a single Map. */
+class DebugDraw
+{
+  public:
+    DebugDraw() = default;
+
+    void AddLine(Vector3 const& from, Vector3 const& to, Vector4 const& color);
+    void AddBox(DirectX::BoundingBox const& box, Vector4 const& color);
+    void AddFrustum(DirectX::BoundingFrustum const& frustum, Vector4 const& color);
+    void AddSphere(Vector3 const& center, float radius, Vector4 const& color, uint32 segments = 24);
+
+    void Clear()
+    {
+        vertices.clear();
+    }
+    bool Empty() const
+    {
+        return vertices.empty();
+    }
+    uint32 VertexCount() const
+    {
+        return static_cast<uint32>(vertices.size());
+    }
+    DebugVertex const* Data() const
+    {
+        return vertices.data();
+    }
+
+  private:
+    // corners are expected in DirectXCollision order (near quad 0-3, far quad 4-7)
+    void AddCorners(Vector3 const (&corners)[8], Vector4 const& color);
+
+  private:
+    std::vector<DebugVertex> vertices;
+};
+
+} // namespace Riley
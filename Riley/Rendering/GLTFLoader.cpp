@@ -0,0 +1,731 @@
+#include "GLTFLoader.h"
+#include "../Utilities/FileUtil.h"
+#include "../Utilities/MappedFile.h"
+#include "cereal/external/rapidjson/document.h"
+#include <cctype>
+#include <cstring>
+#include <execution>
+#include <limits>
+#include <numeric>
+
+namespace Riley
+{
+namespace GLTFLoader
+{
+
+namespace
+{
+using Json = CEREAL_RAPIDJSON_NAMESPACE::Value;
+
+constexpr uint32 COMPONENT_BYTE = 5120;
+constexpr uint32 COMPONENT_UNSIGNED_BYTE = 5121;
+constexpr uint32 COMPONENT_SHORT = 5122;
+constexpr uint32 COMPONENT_UNSIGNED_SHORT = 5123;
+constexpr uint32 COMPONENT_UNSIGNED_INT = 5125;
+constexpr uint32 COMPONENT_FLOAT = 5126;
+
+constexpr uint32 MODE_TRIANGLES = 4;
+constexpr uint32 MODE_TRIANGLE_STRIP = 5;
+constexpr uint32 MODE_TRIANGLE_FAN = 6;
+
+constexpr uint32 NONE = UINT32_MAX;
+
+// extensions the loader reads, a file requiring any other one goes to assimp
+constexpr char const* SUPPORTED_EXTENSIONS[] = {"KHR_mesh_quantization"};
+
+struct Buffer
+{
+    MappedFile file;
+    std::vector<uint8> decoded; // of a data: URI
+    std::span<uint8 const> bytes;
+};
+
+struct Document
+{
+    CEREAL_RAPIDJSON_NAMESPACE::Document json;
+    std::vector<Buffer> buffers;
+    std::string basePath;
+};
+
+// Where the elements of an accessor or of its sparse part lie, checked against the buffer they are read from
+struct ElementView
+{
+    uint8 const* data = nullptr;
+    uint32 stride = 0;
+};
+
+Json const* Member(Json const& object, char const* name)
+{
+    if (!object.IsObject())
+        return nullptr;
+    auto member = object.FindMember(name);
+    return member != object.MemberEnd() ? &member->value : nullptr;
+}
+
+Json const* Element(Json const& object, char const* name, uint32 index)
+{
+    Json const* array = Member(object, name);
+    return array && array->IsArray() && index < array->Size() ? &(*array)[index] : nullptr;
+}
+
+uint32 GetUint(Json const& object, char const* name, uint32 fallback)
+{
+    Json const* value = Member(object, name);
+    return value && value->IsUint() ? value->GetUint() : fallback;
+}
+
+float GetFloat(Json const& object, char const* name, float fallback)
+{
+    Json const* value = Member(object, name);
+    return value && value->IsNumber() ? value->GetFloat() : fallback;
+}
+
+bool GetBool(Json const& object, char const* name, bool fallback)
+{
+    Json const* value = Member(object, name);
+    return value && value->IsBool() ? value->GetBool() : fallback;
+}
+
+std::string GetString(Json const& object, char const* name, std::string const& fallback = "")
+{
+    Json const* value = Member(object, name);
+    return value && value->IsString() ? std::string(value->GetString(), value->GetStringLength()) : fallback;
+}
+
+// out is left as it is unless the member is an array of exactly N numbers
+template <uint32 N>
+bool GetFloats(Json const& object, char const* name, float (&out)[N])
+{
+    Json const* array = Member(object, name);
+    if (!array || !array->IsArray() || array->Size() != N)
+        return false;
+    for (uint32 i = 0; i < N; ++i)
+    {
+        if (!(*array)[i].IsNumber())
+            return false;
+    }
+    for (uint32 i = 0; i < N; ++i)
+        out[i] = (*array)[i].GetFloat();
+    return true;
+}
+
+uint32 ComponentSize(uint32 componentType)
+{
+    switch (componentType)
+    {
+    case COMPONENT_BYTE:
+    case COMPONENT_UNSIGNED_BYTE:
+        return 1;
+    case COMPONENT_SHORT:
+    case COMPONENT_UNSIGNED_SHORT:
+        return 2;
+    case COMPONENT_UNSIGNED_INT:
+    case COMPONENT_FLOAT:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+uint32 ComponentCount(std::string const& type)
+{
+    if (type == "SCALAR")
+        return 1;
+    if (type == "VEC2")
+        return 2;
+    if (type == "VEC3")
+        return 3;
+    if (type == "VEC4" || type == "MAT2")
+        return 4;
+    if (type == "MAT3")
+        return 9;
+    if (type == "MAT4")
+        return 16;
+    return 0;
+}
+
+std::string DecodeURI(std::string const& uri)
+{
+    std::string decoded;
+    decoded.reserve(uri.size());
+    for (size_t i = 0; i < uri.size(); ++i)
+    {
+        if (uri[i] == '%' && i + 2 < uri.size() && std::isxdigit(uint8(uri[i + 1])) && std::isxdigit(uint8(uri[i + 2])))
+        {
+            decoded.push_back(static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16)));
+            i += 2;
+        }
+        else
+        {
+            decoded.push_back(uri[i]);
+        }
+    }
+    return decoded;
+}
+
+bool DecodeBase64(std::string_view text, std::vector<uint8>& out)
+{
+    auto Value = [](char c) -> int32 {
+        if (c >= 'A' && c <= 'Z')
+            return c - 'A';
+        if (c >= 'a' && c <= 'z')
+            return c - 'a' + 26;
+        if (c >= '0' && c <= '9')
+            return c - '0' + 52;
+        if (c == '+')
+            return 62;
+        if (c == '/')
+            return 63;
+        return -1;
+    };
+
+    out.clear();
+    out.reserve(text.size() / 4 * 3);
+    uint32 bits = 0;
+    uint32 bitCount = 0;
+    for (char c : text)
+    {
+        if (c == '=')
+            break;
+        const int32 value = Value(c);
+        if (value < 0)
+            return false;
+        bits = (bits << 6) | uint32(value);
+        bitCount += 6;
+        if (bitCount >= 8)
+        {
+            bitCount -= 8;
+            out.push_back(uint8(bits >> bitCount));
+        }
+    }
+    return true;
+}
+
+bool LoadBuffers(Document& document)
+{
+    Json const* buffers = Member(document.json, "buffers");
+    if (!buffers || !buffers->IsArray())
+        return true;
+
+    document.buffers.resize(buffers->Size());
+    for (uint32 i = 0; i < buffers->Size(); ++i)
+    {
+        Json const& json = (*buffers)[i];
+        Buffer& buffer = document.buffers[i];
+        const std::string uri = GetString(json, "uri");
+        const uint64 byteLength = GetUint(json, "byteLength", 0);
+        // a buffer without a URI is the binary chunk of a .glb
+        if (uri.empty())
+            return false;
+
+        if (uri.rfind("data:", 0) == 0)
+        {
+            const size_t data = uri.find(";base64,");
+            if (data == std::string::npos || !DecodeBase64(std::string_view(uri).substr(data + 8), buffer.decoded))
+                return false;
+            buffer.bytes = buffer.decoded;
+        }
+        else
+        {
+            buffer.file = MappedFile(document.basePath + DecodeURI(uri));
+            buffer.bytes = buffer.file.Bytes();
+        }
+        if (buffer.bytes.size() < byteLength)
+            return false;
+        buffer.bytes = buffer.bytes.first(byteLength);
+    }
+    return true;
+}
+
+// strided is false for the sparse parts, their views are always tightly packed
+bool ResolveView(Document const& document, uint32 bufferViewIndex, uint64 byteOffset, uint32 count, uint32 elementSize, bool strided,
+                 ElementView& view)
+{
+    Json const* bufferView = Element(document.json, "bufferViews", bufferViewIndex);
+    if (!bufferView || elementSize == 0)
+        return false;
+    const uint32 buffer = GetUint(*bufferView, "buffer", NONE);
+    if (buffer >= document.buffers.size())
+        return false;
+
+    std::span<uint8 const> bytes = document.buffers[buffer].bytes;
+    const uint64 viewOffset = GetUint(*bufferView, "byteOffset", 0);
+    const uint64 viewLength = GetUint(*bufferView, "byteLength", 0);
+    const uint32 stride = strided ? GetUint(*bufferView, "byteStride", 0) : 0;
+    view.stride = stride ? stride : elementSize;
+    if (viewOffset + viewLength > bytes.size())
+        return false;
+    if (count > 0 && byteOffset + uint64(count - 1) * view.stride + elementSize > viewLength)
+        return false;
+    view.data = bytes.data() + viewOffset + byteOffset;
+    return true;
+}
+
+template <typename Out, typename T, bool NORMALIZED>
+Out ConvertComponent(T value)
+{
+    if constexpr (std::is_floating_point_v<Out> && !std::is_floating_point_v<T> && NORMALIZED)
+    {
+        if constexpr (std::is_signed_v<T>)
+            return std::max(static_cast<float>(value) / std::numeric_limits<T>::max(), -1.0f);
+        else
+            return static_cast<float>(value) / std::numeric_limits<T>::max();
+    }
+    else
+    {
+        return static_cast<Out>(value);
+    }
+}
+
+// The loop every accessor ends up in, its types are known at compile time so nothing is left to branch on per element
+template <typename Out, uint32 N, typename T, bool NORMALIZED>
+void ConvertElements(uint8 const* source, uint32 sourceStride, uint32 count, uint8* target, uint32 targetStride)
+{
+    for (uint32 i = 0; i < count; ++i)
+    {
+        T element[N];
+        std::memcpy(element, source + uint64(i) * sourceStride, sizeof(element));
+        Out* out = reinterpret_cast<Out*>(target + uint64(i) * targetStride);
+        for (uint32 c = 0; c < N; ++c)
+            out[c] = ConvertComponent<Out, T, NORMALIZED>(element[c]);
+    }
+}
+
+template <typename Out, uint32 N>
+bool Convert(uint32 componentType, bool normalized, uint8 const* source, uint32 sourceStride, uint32 count, uint8* target,
+             uint32 targetStride)
+{
+    switch (componentType)
+    {
+    case COMPONENT_BYTE:
+        normalized ? ConvertElements<Out, N, int8, true>(source, sourceStride, count, target, targetStride)
+                   : ConvertElements<Out, N, int8, false>(source, sourceStride, count, target, targetStride);
+        return true;
+    case COMPONENT_UNSIGNED_BYTE:
+        normalized ? ConvertElements<Out, N, uint8, true>(source, sourceStride, count, target, targetStride)
+                   : ConvertElements<Out, N, uint8, false>(source, sourceStride, count, target, targetStride);
+        return true;
+    case COMPONENT_SHORT:
+        normalized ? ConvertElements<Out, N, int16, true>(source, sourceStride, count, target, targetStride)
+                   : ConvertElements<Out, N, int16, false>(source, sourceStride, count, target, targetStride);
+        return true;
+    case COMPONENT_UNSIGNED_SHORT:
+        normalized ? ConvertElements<Out, N, uint16, true>(source, sourceStride, count, target, targetStride)
+                   : ConvertElements<Out, N, uint16, false>(source, sourceStride, count, target, targetStride);
+        return true;
+    case COMPONENT_UNSIGNED_INT:
+        ConvertElements<Out, N, uint32, false>(source, sourceStride, count, target, targetStride);
+        return true;
+    case COMPONENT_FLOAT:
+        ConvertElements<Out, N, float, false>(source, sourceStride, count, target, targetStride);
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Converts the first N components of the count elements of an accessor, element i is written at target + i * targetStride
+template <typename Out, uint32 N>
+bool ReadAccessor(Document const& document, uint32 index, uint32 count, void* target, uint32 targetStride)
+{
+    Json const* accessor = Element(document.json, "accessors", index);
+    if (!accessor)
+        return false;
+    const uint32 componentType = GetUint(*accessor, "componentType", 0);
+    const uint32 components = ComponentCount(GetString(*accessor, "type"));
+    const uint32 elementSize = ComponentSize(componentType) * components;
+    const bool normalized = GetBool(*accessor, "normalized", false);
+    if (GetUint(*accessor, "count", NONE) != count || elementSize == 0 || components < N)
+        return false;
+
+    uint8* out = static_cast<uint8*>(target);
+    if (Member(*accessor, "bufferView"))
+    {
+        ElementView view;
+        const uint32 bufferView = GetUint(*accessor, "bufferView", NONE);
+        if (!ResolveView(document, bufferView, GetUint(*accessor, "byteOffset", 0), count, elementSize, true, view))
+            return false;
+        Convert<Out, N>(componentType, normalized, view.data, view.stride, count, out, targetStride);
+    }
+    else
+    {
+        // without a buffer view the elements are zeros, only the sparse ones below are set
+        for (uint32 i = 0; i < count; ++i)
+            std::fill_n(reinterpret_cast<Out*>(out + uint64(i) * targetStride), N, Out(0));
+    }
+
+    Json const* sparse = Member(*accessor, "sparse");
+    if (!sparse)
+        return true;
+    Json const* sparseIndices = Member(*sparse, "indices");
+    Json const* sparseValues = Member(*sparse, "values");
+    const uint32 sparseCount = GetUint(*sparse, "count", 0);
+    if (!sparseIndices || !sparseValues)
+        return false;
+    const uint32 indexType = GetUint(*sparseIndices, "componentType", 0);
+    ElementView indexView;
+    ElementView valueView;
+    if (!ResolveView(document, GetUint(*sparseIndices, "bufferView", NONE), GetUint(*sparseIndices, "byteOffset", 0), sparseCount,
+                     ComponentSize(indexType), false, indexView) ||
+        !ResolveView(document, GetUint(*sparseValues, "bufferView", NONE), GetUint(*sparseValues, "byteOffset", 0), sparseCount,
+                     elementSize, false, valueView))
+        return false;
+
+    std::vector<uint32> targets(sparseCount);
+    Convert<uint32, 1>(indexType, false, indexView.data, indexView.stride, sparseCount, reinterpret_cast<uint8*>(targets.data()),
+                       sizeof(uint32));
+    for (uint32 i = 0; i < sparseCount; ++i)
+    {
+        if (targets[i] >= count)
+            return false;
+        Convert<Out, N>(componentType, normalized, valueView.data + uint64(i) * valueView.stride, elementSize, 1,
+                        out + uint64(targets[i]) * targetStride, targetStride);
+    }
+    return true;
+}
+
+std::string TextureFilename(Document const& document, Json const* textureInfo)
+{
+    if (!textureInfo)
+        return "";
+    Json const* texture = Element(document.json, "textures", GetUint(*textureInfo, "index", NONE));
+    Json const* image = texture ? Element(document.json, "images", GetUint(*texture, "source", NONE)) : nullptr;
+    const std::string uri = image ? GetString(*image, "uri") : "";
+    // images in buffer views or data: URIs have no file the texture manager could load
+    if (uri.empty() || uri.rfind("data:", 0) == 0)
+        return "";
+    return document.basePath + DecodeURI(uri);
+}
+
+MaterialData ReadMaterial(Document const& document, Json const& json)
+{
+    MaterialData material{};
+    material.name = GetString(json, "name");
+    material.alphaMode = GetString(json, "alphaMode", material.alphaMode);
+    material.alphaCutoff = GetFloat(json, "alphaCutoff", material.alphaCutoff);
+    material.doubleSided = GetBool(json, "doubleSided", material.doubleSided);
+
+    if (Json const* pbr = Member(json, "pbrMetallicRoughness"))
+    {
+        material.albeodoTextureFilename = TextureFilename(document, Member(*pbr, "baseColorTexture"));
+        material.pbrMetallicRoughnessTextureFilename = TextureFilename(document, Member(*pbr, "metallicRoughnessTexture"));
+    }
+    material.normalTextureFilename = TextureFilename(document, Member(json, "normalTexture"));
+    material.occlusionTextureFilename = TextureFilename(document, Member(json, "occlusionTexture"));
+    material.emissiveTextureFilename = TextureFilename(document, Member(json, "emissiveTexture"));
+    if (Json const* extensions = Member(json, "extensions"))
+    {
+        if (Json const* clearcoat = Member(*extensions, "KHR_materials_clearcoat"))
+            material.pbrClearcoatTextureFilename = TextureFilename(document, Member(*clearcoat, "clearcoatTexture"));
+        if (Json const* sheen = Member(*extensions, "KHR_materials_sheen"))
+            material.pbrSheenTextureFilename = TextureFilename(document, Member(*sheen, "sheenColorTexture"));
+    }
+    return material;
+}
+
+bool HasTriangles(uint32 mode)
+{
+    return mode == MODE_TRIANGLES || mode == MODE_TRIANGLE_STRIP || mode == MODE_TRIANGLE_FAN;
+}
+
+// Strips and fans become lists, glTF winds their triangles like the ones of a list
+void Triangulate(uint32 mode, std::vector<uint32>& indices)
+{
+    if (mode == MODE_TRIANGLES)
+    {
+        indices.resize(indices.size() / 3 * 3);
+        return;
+    }
+
+    std::vector<uint32> list;
+    list.reserve(indices.size() >= 3 ? (indices.size() - 2) * 3 : 0);
+    for (size_t i = 0; i + 2 < indices.size(); ++i)
+    {
+        if (mode == MODE_TRIANGLE_FAN)
+            list.insert(list.end(), {indices[0], indices[i + 1], indices[i + 2]});
+        else if (i % 2 == 0)
+            list.insert(list.end(), {indices[i], indices[i + 1], indices[i + 2]});
+        else
+            list.insert(list.end(), {indices[i + 1], indices[i], indices[i + 2]});
+    }
+    indices.swap(list);
+}
+
+// Area weighted vertex normals of counter clockwise triangles, for primitives that come without any
+void ComputeNormals(std::vector<uint32> const& indices, std::vector<Vertex>& vertices)
+{
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        Vertex& v0 = vertices[indices[i + 0]];
+        Vertex& v1 = vertices[indices[i + 1]];
+        Vertex& v2 = vertices[indices[i + 2]];
+        const Vector3 normal = (v1.position - v0.position).Cross(v2.position - v0.position);
+        v0.normal += normal;
+        v1.normal += normal;
+        v2.normal += normal;
+    }
+}
+
+bool ReadPrimitive(Document const& document, Json const& primitive, bool revertNormals, MeshData& mesh)
+{
+    Json const* attributes = Member(primitive, "attributes");
+    if (!attributes)
+        return false;
+    const uint32 positionAccessor = GetUint(*attributes, "POSITION", NONE);
+    Json const* positions = Element(document.json, "accessors", positionAccessor);
+    const uint32 vertexCount = positions ? GetUint(*positions, "count", 0) : 0;
+    if (vertexCount == 0)
+        return false;
+
+    std::vector<Vertex>& vertices = mesh.vertices;
+    vertices.resize(vertexCount);
+    constexpr uint32 stride = sizeof(Vertex);
+    if (!ReadAccessor<float, 3>(document, positionAccessor, vertexCount, &vertices[0].position.x, stride))
+        return false;
+    const uint32 normalAccessor = GetUint(*attributes, "NORMAL", NONE);
+    if (normalAccessor != NONE && !ReadAccessor<float, 3>(document, normalAccessor, vertexCount, &vertices[0].normal.x, stride))
+        return false;
+    const uint32 texcoordAccessor = GetUint(*attributes, "TEXCOORD_0", NONE);
+    if (texcoordAccessor != NONE && !ReadAccessor<float, 2>(document, texcoordAccessor, vertexCount, &vertices[0].texcoord.x, stride))
+        return false;
+    // the w of glTF's tangents is the handedness, the tangents are computed again after the import anyway
+    const uint32 tangentAccessor = GetUint(*attributes, "TANGENT", NONE);
+    if (tangentAccessor != NONE && !ReadAccessor<float, 3>(document, tangentAccessor, vertexCount, &vertices[0].tangent.x, stride))
+        return false;
+
+    std::vector<uint32>& indices = mesh.indices;
+    const uint32 indexAccessor = GetUint(primitive, "indices", NONE);
+    if (indexAccessor != NONE)
+    {
+        Json const* accessor = Element(document.json, "accessors", indexAccessor);
+        indices.resize(accessor ? GetUint(*accessor, "count", 0) : 0);
+        if (indices.empty() || !ReadAccessor<uint32, 1>(document, indexAccessor, static_cast<uint32>(indices.size()), indices.data(),
+                                                        sizeof(uint32)))
+            return false;
+    }
+    else
+    {
+        indices.resize(vertexCount);
+        std::iota(indices.begin(), indices.end(), 0u);
+    }
+    if (std::any_of(indices.begin(), indices.end(), [vertexCount](uint32 index) { return index >= vertexCount; }))
+        return false;
+    Triangulate(GetUint(primitive, "mode", MODE_TRIANGLES), indices);
+    if (normalAccessor == NONE)
+        ComputeNormals(indices, vertices);
+
+    // what aiProcess_ConvertToLeftHanded does: z is mirrored and the triangles are wound the other way. Its uv flip
+    // cancels the one assimp's glTF importer makes, the texcoords are used as they are stored
+    for (Vertex& vertex : vertices)
+    {
+        vertex.position.z = -vertex.position.z;
+        vertex.normal.z = -vertex.normal.z;
+        vertex.tangent.z = -vertex.tangent.z;
+        if (revertNormals)
+        {
+            vertex.normal *= -1.0f;
+        }
+        vertex.normal.Normalize();
+        vertex.tangent.Normalize();
+    }
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        std::swap(indices[i], indices[i + 2]);
+    return true;
+}
+
+// The transform of a node relative to its parent for row vectors, mirrored on both sides like aiProcess_MakeLeftHanded
+// mirrors them so the determinant keeps its sign
+Matrix NodeTransform(Json const& node)
+{
+    Matrix transform = Matrix::Identity;
+    float matrix[16];
+    if (GetFloats(node, "matrix", matrix))
+    {
+        // column major for column vectors, read row by row it is the same transform for row vectors
+        transform = Matrix(matrix);
+    }
+    else
+    {
+        float scale[3] = {1.0f, 1.0f, 1.0f};
+        float rotation[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+        float translation[3] = {0.0f, 0.0f, 0.0f};
+        GetFloats(node, "scale", scale);
+        GetFloats(node, "rotation", rotation);
+        GetFloats(node, "translation", translation);
+        transform = Matrix::CreateScale(scale[0], scale[1], scale[2]) * Matrix::CreateFromQuaternion(Quaternion(rotation)) *
+                    Matrix::CreateTranslation(translation[0], translation[1], translation[2]);
+    }
+    const Matrix mirror = Matrix::CreateScale(1.0f, 1.0f, -1.0f);
+    return mirror * transform * mirror;
+}
+
+// Walks the node tree like ModelLoader::ProcessNode, the primitives of a mesh are registered the first time a node uses it
+struct NodeWalker
+{
+    Document const& document;
+    SceneData& scene;
+    std::map<uint32, std::vector<uint32>> meshPrimitives; // glTF mesh -> its primitives in scene.meshes
+    std::vector<std::pair<uint32, uint32>> primitives; // scene.meshes -> glTF mesh and primitive
+    std::vector<uint8> visited;
+
+    void Walk(uint32 index, uint32 parent)
+    {
+        Json const* node = Element(document.json, "nodes", index);
+        // a node is only ever read once, which also breaks cycles in broken files
+        if (!node || visited[index])
+            return;
+        visited[index] = 1;
+
+        const uint32 nodeId = static_cast<uint32>(scene.nodes.size());
+        NodeData& data = scene.nodes.emplace_back();
+        data.name = GetString(*node, "name");
+        data.transform = NodeTransform(*node);
+        data.parent = parent;
+        data.meshes = Primitives(GetUint(*node, "mesh", NONE));
+
+        if (Json const* children = Member(*node, "children"); children && children->IsArray())
+        {
+            for (auto const& child : children->GetArray())
+            {
+                if (child.IsUint())
+                    Walk(child.GetUint(), nodeId);
+            }
+        }
+    }
+
+    std::vector<uint32> Primitives(uint32 mesh)
+    {
+        Json const* json = Element(document.json, "meshes", mesh);
+        Json const* list = json ? Member(*json, "primitives") : nullptr;
+        if (!list || !list->IsArray())
+            return {};
+        auto [found, inserted] = meshPrimitives.try_emplace(mesh);
+        if (!inserted)
+            return found->second;
+
+        const std::string name = GetString(*json, "name");
+        for (uint32 p = 0; p < list->Size(); ++p)
+        {
+            const uint32 mode = GetUint((*list)[p], "mode", MODE_TRIANGLES);
+            if (!HasTriangles(mode))
+            {
+                RI_WARN("glTF mesh {:s} primitive {:d} skipped, mode {:d} has no triangles", name, p, mode);
+                continue;
+            }
+            found->second.push_back(static_cast<uint32>(primitives.size()));
+            primitives.emplace_back(mesh, p);
+
+            // named like assimp names the meshes it splits off the primitives
+            Model& model = scene.meshes.emplace_back();
+            model.meshData.name = list->Size() > 1 ? name + "-" + std::to_string(p) : name;
+        }
+        return found->second;
+    }
+};
+} // namespace
+
+std::optional<SceneData> Load(std::string const& basePath, std::string const& filename, bool revertNormals)
+{
+    MappedFile file(basePath + filename);
+    if (!file.IsOpen())
+        return std::nullopt;
+
+    Document document;
+    document.basePath = basePath;
+    document.json.Parse(reinterpret_cast<char const*>(file.Data()), file.Size());
+    if (document.json.HasParseError() || !document.json.IsObject())
+    {
+        RI_WARN("{:s} is not valid glTF JSON", filename);
+        return std::nullopt;
+    }
+    Json const* asset = Member(document.json, "asset");
+    if (!asset || GetString(*asset, "version").rfind("2.", 0) != 0)
+    {
+        RI_WARN("{:s} is not glTF 2.0", filename);
+        return std::nullopt;
+    }
+    if (Json const* required = Member(document.json, "extensionsRequired"); required && required->IsArray())
+    {
+        for (auto const& extension : required->GetArray())
+        {
+            const bool supported =
+                extension.IsString() && std::any_of(std::begin(SUPPORTED_EXTENSIONS), std::end(SUPPORTED_EXTENSIONS),
+                                                    [&](char const* name) { return extension == name; });
+            if (!supported)
+            {
+                RI_INFO("{:s} requires {:s}, left to assimp", filename, extension.IsString() ? extension.GetString() : "?");
+                return std::nullopt;
+            }
+        }
+    }
+    if (!LoadBuffers(document))
+    {
+        RI_WARN("{:s} has a buffer that could not be read", filename);
+        return std::nullopt;
+    }
+
+    SceneData scene{};
+    Json const* nodes = Member(document.json, "nodes");
+    const uint32 nodeCount = nodes && nodes->IsArray() ? nodes->Size() : 0;
+    NodeWalker walker{document, scene, {}, {}, std::vector<uint8>(nodeCount, 0)};
+
+    // the nodes of the default scene, without scenes every node nobody has as a child is a root
+    Json const* sceneJson = Element(document.json, "scenes", GetUint(document.json, "scene", 0));
+    if (Json const* roots = sceneJson ? Member(*sceneJson, "nodes") : nullptr; roots && roots->IsArray())
+    {
+        for (auto const& root : roots->GetArray())
+        {
+            if (root.IsUint())
+                walker.Walk(root.GetUint(), NodeData::NO_PARENT);
+        }
+    }
+    else if (!sceneJson)
+    {
+        std::vector<uint8> isChild(nodeCount, 0);
+        for (uint32 i = 0; i < nodeCount; ++i)
+        {
+            Json const* children = Member((*nodes)[i], "children");
+            for (uint32 c = 0; children && children->IsArray() && c < children->Size(); ++c)
+            {
+                if ((*children)[c].IsUint() && (*children)[c].GetUint() < nodeCount)
+                    isChild[(*children)[c].GetUint()] = 1;
+            }
+        }
+        for (uint32 i = 0; i < nodeCount; ++i)
+        {
+            if (!isChild[i])
+                walker.Walk(i, NodeData::NO_PARENT);
+        }
+    }
+
+    std::vector<MaterialData> materials;
+    if (Json const* materialList = Member(document.json, "materials"); materialList && materialList->IsArray())
+    {
+        for (auto const& material : materialList->GetArray())
+            materials.push_back(ReadMaterial(document, material));
+    }
+
+    // the document is only read from here on, every primitive is converted on its own
+    std::vector<uint8> valid(walker.primitives.size(), 0);
+    std::vector<uint32> jobs(walker.primitives.size());
+    std::iota(jobs.begin(), jobs.end(), 0u);
+    std::for_each(std::execution::par, jobs.begin(), jobs.end(), [&](uint32 i) {
+        auto const [mesh, p] = walker.primitives[i];
+        Json const& primitive = (*Element(document.json, "meshes", mesh))["primitives"][p];
+        Model& model = scene.meshes[i];
+        valid[i] = ReadPrimitive(document, primitive, revertNormals, model.meshData);
+
+        const uint32 material = GetUint(primitive, "material", NONE);
+        if (material < materials.size())
+            model.materialData = materials[material];
+    });
+    if (std::find(valid.begin(), valid.end(), 0) != valid.end())
+    {
+        RI_WARN("{:s} has a primitive whose accessors could not be read", filename);
+        return std::nullopt;
+    }
+    return scene;
+}
+
+} // namespace GLTFLoader
+} // namespace Riley
@@ -0,0 +1,17 @@
+#pragma once
+#include "MeshData.h"
+
+namespace Riley
+{
+
+/* Reads .gltf files without assimp. The JSON is parsed once, the .bin buffers are mapped and every accessor, strided,
+ * sparse or quantized (KHR_mesh_quantization), is converted straight into the Vertex layout. What comes out matches
+ * what ModelLoader makes of the same file with aiProcess_ConvertToLeftHanded: z is mirrored in the vertices and the
+ * node transforms and the triangles are wound the other way. Every primitive becomes a mesh of its own. */
+namespace GLTFLoader
+{
+// std::nullopt when the file needs something only assimp reads, e.g. a required extension, a .glb or a missing buffer
+std::optional<SceneData> Load(std::string const& basePath, std::string const& filename, bool revertNormals);
+} // namespace GLTFLoader
+
+} // namespace Riley
@@ -0,0 +1,380 @@
+#include "GeometryArena.h"
+#include <algorithm>
+#include <numeric>
+
+namespace Riley
+{
+
+RangeAllocator::RangeAllocator(uint32 capacity)
+{
+    Grow(capacity);
+}
+
+uint32 RangeAllocator::Allocate(uint32 count)
+{
+    auto fit = freeBySize.lower_bound(count);
+    if (fit == freeBySize.end())
+        return INVALID_OFFSET;
+
+    const uint32 offset = fit->second;
+    Claim(offset, count);
+    return offset;
+}
+
+void RangeAllocator::Free(uint32 offset, uint32 count)
+{
+    assert(offset + count <= capacity);
+    used -= count;
+
+    // merge with the neighbours on both sides
+    auto next = freeByOffset.lower_bound(offset);
+    if (next != freeByOffset.end() && offset + count == next->first)
+    {
+        count += next->second;
+        Erase(next);
+    }
+    auto prev = freeByOffset.lower_bound(offset);
+    if (prev != freeByOffset.begin() && std::prev(prev)->first + std::prev(prev)->second == offset)
+    {
+        --prev;
+        offset = prev->first;
+        count += prev->second;
+        Erase(prev);
+    }
+    Insert(offset, count);
+}
+
+void RangeAllocator::Grow(uint32 newCapacity)
+{
+    if (newCapacity <= capacity)
+        return;
+
+    const uint32 offset = capacity;
+    const uint32 count = newCapacity - capacity;
+    capacity = newCapacity;
+    used += count;
+    Free(offset, count);
+}
+
+uint32 RangeAllocator::FindLowest(uint32 count, uint32 limit) const
+{
+    for (auto const& [offset, blockCount] : freeByOffset)
+    {
+        if (offset >= limit)
+            break;
+        if (blockCount >= count)
+            return offset;
+    }
+    return INVALID_OFFSET;
+}
+
+void RangeAllocator::Claim(uint32 offset, uint32 count)
+{
+    auto block = freeByOffset.upper_bound(offset);
+    assert(block != freeByOffset.begin() && "Range is not free!");
+    --block;
+    const uint32 blockOffset = block->first;
+    const uint32 blockCount = block->second;
+    assert(offset + count <= blockOffset + blockCount && "Range is not free!");
+
+    Erase(block);
+    if (offset > blockOffset)
+        Insert(blockOffset, offset - blockOffset);
+    if (offset + count < blockOffset + blockCount)
+        Insert(offset + count, blockOffset + blockCount - offset - count);
+    used += count;
+}
+
+bool RangeAllocator::IsCompact() const
+{
+    if (freeByOffset.empty())
+        return true;
+    auto const& [offset, count] = *freeByOffset.begin();
+    return freeByOffset.size() == 1 && offset + count == capacity;
+}
+
+void RangeAllocator::Insert(uint32 offset, uint32 count)
+{
+    freeByOffset.emplace(offset, count);
+    freeBySize.emplace(count, offset);
+}
+
+void RangeAllocator::Erase(std::map<uint32, uint32>::iterator block)
+{
+    auto [first, last] = freeBySize.equal_range(block->second);
+    for (auto it = first; it != last; ++it)
+    {
+        if (it->second == block->first)
+        {
+            freeBySize.erase(it);
+            break;
+        }
+    }
+    freeByOffset.erase(block);
+}
+
+void GeometryArena::Initialize(ID3D11Device* device, ID3D11DeviceContext* context)
+{
+    m_device = device;
+    m_context = context;
+    indexPool.stride = sizeof(uint32);
+    shortIndexPool.stride = sizeof(uint16);
+}
+
+void GeometryArena::Destroy()
+{
+    for (Pool& pool : vertexPools)
+        SAFE_DELETE(pool.buffer);
+    SAFE_DELETE(indexPool.buffer);
+    SAFE_DELETE(shortIndexPool.buffer);
+    SAFE_DELETE(scratch);
+    vertexPools.clear();
+    indexPool = Pool{};
+    shortIndexPool = Pool{};
+    allocations.clear();
+    freeSlots.clear();
+}
+
+GeometryHandle GeometryArena::Allocate(void const* vertices, uint32 vertexCount, uint32 stride, uint32 const* indices,
+                                       uint32 indexCount)
+{
+    assert(vertexCount > 0 && stride > 0);
+
+    uint32 slot = static_cast<uint32>(allocations.size());
+    if (!freeSlots.empty())
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        assert(slot < (1u << INDEX_BITS) && "Too many geometry allocations!");
+        allocations.emplace_back();
+    }
+
+    Allocation& allocation = allocations[slot];
+    allocation.vertexPool = PoolForStride(stride);
+    allocation.vertexCount = vertexCount;
+    allocation.indexCount = indexCount;
+    allocation.refCount = 0;
+    allocation.live = true;
+
+    Pool& vertexPool = vertexPools[allocation.vertexPool];
+    allocation.firstVertex = AllocateRange(vertexPool, vertexCount, false);
+    Upload(vertexPool, allocation.firstVertex, vertices, vertexCount);
+    allocation.firstIndex = 0;
+    allocation.shortIndices = indexCount > 0 && *std::max_element(indices, indices + indexCount) <= 0xFFFF;
+    if (allocation.shortIndices)
+    {
+        std::vector<uint16> shortIndices(indices, indices + indexCount);
+        allocation.firstIndex = AllocateRange(shortIndexPool, indexCount, true);
+        Upload(shortIndexPool, allocation.firstIndex, shortIndices.data(), indexCount);
+    }
+    else if (indexCount > 0)
+    {
+        allocation.firstIndex = AllocateRange(indexPool, indexCount, true);
+        Upload(indexPool, allocation.firstIndex, indices, indexCount);
+    }
+    return (allocation.generation << INDEX_BITS) | slot;
+}
+
+void GeometryArena::AddRef(GeometryHandle handle)
+{
+    Allocation& allocation = allocations[Index(handle)];
+    assert(allocation.live && allocation.generation == Generation(handle) && "Stale geometry handle!");
+    ++allocation.refCount;
+}
+
+void GeometryArena::Release(GeometryHandle handle)
+{
+    // meshes outliving the arena, the pools are gone already
+    if (Index(handle) >= allocations.size())
+        return;
+
+    Allocation& allocation = allocations[Index(handle)];
+    assert(allocation.live && allocation.generation == Generation(handle) && "Stale geometry handle!");
+    assert(allocation.refCount > 0);
+    if (--allocation.refCount > 0)
+        return;
+
+    vertexPools[allocation.vertexPool].ranges.Free(allocation.firstVertex, allocation.vertexCount);
+    if (allocation.indexCount > 0)
+        IndexPool(allocation).ranges.Free(allocation.firstIndex, allocation.indexCount);
+    allocation.live = false;
+    allocation.generation = (allocation.generation + 1) & ((1u << (32 - INDEX_BITS)) - 1);
+    freeSlots.push_back(Index(handle));
+}
+
+void GeometryArena::Compact()
+{
+    const uint64 budget = COMPACTION_BUDGET;
+    uint64 moved = 0;
+    for (uint32 i = 0; i < vertexPools.size() && moved < budget; ++i)
+        moved += CompactPool(vertexPools[i], i, false, budget - moved);
+    if (moved < budget)
+        moved += CompactPool(indexPool, 0, true, budget - moved);
+    if (moved < budget)
+        CompactPool(shortIndexPool, 0, true, budget - moved);
+}
+
+std::vector<RangeMove> PlanCompaction(RangeAllocator& allocator, std::vector<std::pair<uint32, uint32>> const& ranges,
+                                      uint64 budget)
+{
+    std::vector<uint32> order(ranges.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32 lhs, uint32 rhs) { return ranges[lhs].first > ranges[rhs].first; });
+
+    std::vector<RangeMove> moves;
+    uint64 moved = 0;
+    for (uint32 range : order)
+    {
+        auto const [first, count] = ranges[range];
+        if (moved > 0 && moved + count > budget)
+            break;
+
+        const uint32 to = allocator.FindLowest(count, first);
+        if (to == RangeAllocator::INVALID_OFFSET)
+            continue;
+
+        allocator.Claim(to, count);
+        allocator.Free(first, count);
+        moves.push_back(RangeMove{range, first, to});
+        moved += count;
+    }
+    return moves;
+}
+
+// Moves the highest ranges of the pool into the lowest holes below them, returns the bytes moved
+uint64 GeometryArena::CompactPool(Pool& pool, uint32 poolIndex, bool indices, uint64 budget)
+{
+    if (pool.ranges.IsCompact())
+        return 0;
+
+    std::vector<std::pair<uint32, uint32>> ranges; // first element, count
+    std::vector<uint32> owners;                    // allocation of every range
+    for (uint32 i = 0; i < allocations.size(); ++i)
+    {
+        Allocation const& allocation = allocations[i];
+        if (!allocation.live)
+            continue;
+        if (indices && allocation.indexCount > 0 && &IndexPool(allocation) == &pool)
+            ranges.emplace_back(allocation.firstIndex, allocation.indexCount);
+        else if (!indices && allocation.vertexPool == poolIndex)
+            ranges.emplace_back(allocation.firstVertex, allocation.vertexCount);
+        else
+            continue;
+        owners.push_back(i);
+    }
+
+    uint64 moved = 0;
+    for (RangeMove const& move : PlanCompaction(pool.ranges, ranges, budget / pool.stride))
+    {
+        const uint32 count = ranges[move.range].second;
+        Move(pool, move.from, move.to, count);
+        Allocation& allocation = allocations[owners[move.range]];
+        (indices ? allocation.firstIndex : allocation.firstVertex) = move.to;
+        moved += uint64(count) * pool.stride;
+    }
+    movedBytes += moved;
+    return moved;
+}
+
+uint32 GeometryArena::PoolForStride(uint32 stride)
+{
+    for (uint32 i = 0; i < vertexPools.size(); ++i)
+    {
+        if (vertexPools[i].stride == stride)
+            return i;
+    }
+    vertexPools.emplace_back().stride = stride;
+    return static_cast<uint32>(vertexPools.size() - 1);
+}
+
+// Grows the pool by doubling when no free block fits, the old contents are copied on the GPU
+uint32 GeometryArena::AllocateRange(Pool& pool, uint32 count, bool indices)
+{
+    uint32 offset = pool.ranges.Allocate(count);
+    if (offset != RangeAllocator::INVALID_OFFSET)
+        return offset;
+
+    uint32 capacity = std::max(pool.ranges.Capacity(), static_cast<uint32>(MIN_POOL_BYTES / pool.stride));
+    while (capacity < pool.ranges.Capacity() + count)
+        capacity *= 2;
+    CreatePoolBuffer(pool, capacity, indices);
+    pool.ranges.Grow(capacity);
+
+    offset = pool.ranges.Allocate(count);
+    assert(offset != RangeAllocator::INVALID_OFFSET);
+    return offset;
+}
+
+void GeometryArena::CreatePoolBuffer(Pool& pool, uint32 capacity, bool indices)
+{
+    DXBufferDesc desc = indices ? IndexBufferDesc(capacity, pool.stride == sizeof(uint16)) : VertexBufferDesc(capacity, pool.stride);
+    desc.resourceUsage = DXResourceUsage::Default;
+    DXBuffer* buffer = new DXBuffer(m_device, desc);
+    if (pool.buffer)
+    {
+        m_context->CopySubresourceRegion(buffer->GetNative(), 0, 0, 0, 0, pool.buffer->GetNative(), 0, nullptr);
+        SAFE_DELETE(pool.buffer);
+        // the cache may still hold the old buffer and a new one can be created at the same address
+        g_StateCache.Invalidate();
+    }
+    pool.buffer = buffer;
+    RI_INFO("Geometry pool ({:d} byte stride) resized to {:d} KB", pool.stride, uint64(capacity) * pool.stride / 1024);
+}
+
+void GeometryArena::Upload(Pool& pool, uint32 offset, void const* data, uint32 count)
+{
+    D3D11_BOX box{offset * pool.stride, 0, 0, (offset + count) * pool.stride, 1, 1};
+    m_context->UpdateSubresource(pool.buffer->GetNative(), 0, &box, data, 0, 0);
+}
+
+void GeometryArena::Move(Pool& pool, uint32 from, uint32 to, uint32 count)
+{
+    /* Copying a buffer onto itself is only defined where the driver reports CopyWithOverlap, elsewhere the copy is
+     * dropped. The range goes through the scratch buffer instead, source and destination never overlap there */
+    const uint32 bytes = count * pool.stride;
+    ReserveScratch(bytes);
+    D3D11_BOX source{from * pool.stride, 0, 0, from * pool.stride + bytes, 1, 1};
+    m_context->CopySubresourceRegion(scratch->GetNative(), 0, 0, 0, 0, pool.buffer->GetNative(), 0, &source);
+    D3D11_BOX staged{0, 0, 0, bytes, 1, 1};
+    m_context->CopySubresourceRegion(pool.buffer->GetNative(), 0, to * pool.stride, 0, 0, scratch->GetNative(), 0, &staged);
+}
+
+void GeometryArena::ReserveScratch(uint64 bytes)
+{
+    if (scratch && scratch->GetDesc().size >= bytes)
+        return;
+
+    SAFE_DELETE(scratch);
+    DXBufferDesc desc{};
+    desc.size = std::max(bytes, COMPACTION_BUDGET);
+    desc.resourceUsage = DXResourceUsage::Default;
+    scratch = new DXBuffer(m_device, desc);
+}
+
+GeometryArenaStats GeometryArena::Stats() const
+{
+    GeometryArenaStats stats{};
+    stats.allocations = static_cast<uint32>(allocations.size() - freeSlots.size());
+    stats.pools = static_cast<uint32>(vertexPools.size());
+    for (Pool const& pool : vertexPools)
+    {
+        stats.vertexBytes += uint64(pool.ranges.Used()) * pool.stride;
+        stats.vertexCapacityBytes += uint64(pool.ranges.Capacity()) * pool.stride;
+        stats.freeBlocks += pool.ranges.FreeBlockCount();
+        stats.largestFreeBytes = std::max(stats.largestFreeBytes, uint64(pool.ranges.LargestFreeBlock()) * pool.stride);
+    }
+    for (Pool const* pool : {&indexPool, &shortIndexPool})
+    {
+        stats.indexBytes += uint64(pool->ranges.Used()) * pool->stride;
+        stats.indexCapacityBytes += uint64(pool->ranges.Capacity()) * pool->stride;
+        stats.freeBlocks += pool->ranges.FreeBlockCount();
+        stats.largestFreeBytes = std::max(stats.largestFreeBytes, uint64(pool->ranges.LargestFreeBlock()) * pool->stride);
+    }
+    stats.movedBytes = movedBytes;
+    return stats;
+}
+
+} // namespace Riley
@@ -0,0 +1,212 @@
+#pragma once
+#include "../Graphics/DXBuffer.h"
+#include "../Utilities/Singleton.h"
+
+namespace Riley
+{
+using GeometryHandle = uint32;
+inline constexpr GeometryHandle const INVALID_GEOMETRY_HANDLE = uint32(-1);
+
+/* Free list over [0, capacity) in elements. Free blocks are kept by offset to coalesce neighbours
+ * and by size to find the best fit, both in O(log n). */
+class RangeAllocator
+{
+  public:
+    static constexpr uint32 INVALID_OFFSET = uint32(-1);
+
+    explicit RangeAllocator(uint32 capacity = 0);
+
+    // best fit, INVALID_OFFSET when no block is large enough
+    uint32 Allocate(uint32 count);
+    void Free(uint32 offset, uint32 count);
+    // appends [Capacity(), capacity) to the free space
+    void Grow(uint32 capacity);
+    // lowest free block that holds count elements and starts below limit
+    uint32 FindLowest(uint32 count, uint32 limit) const;
+    // takes [offset, offset + count) out of a free block, the range must lie inside one
+    void Claim(uint32 offset, uint32 count);
+
+    uint32 Capacity() const
+    {
+        return capacity;
+    }
+    uint32 Used() const
+    {
+        return used;
+    }
+    uint32 FreeBlockCount() const
+    {
+        return static_cast<uint32>(freeByOffset.size());
+    }
+    uint32 LargestFreeBlock() const
+    {
+        return freeBySize.empty() ? 0 : freeBySize.rbegin()->first;
+    }
+    // true when all the free space is one block at the end, nothing left to compact
+    bool IsCompact() const;
+
+  private:
+    void Insert(uint32 offset, uint32 count);
+    void Erase(std::map<uint32, uint32>::iterator block);
+
+  private:
+    std::map<uint32, uint32> freeByOffset;    // offset -> count
+    std::multimap<uint32, uint32> freeBySize; // count -> offset
+    uint32 capacity = 0;
+    uint32 used = 0;
+};
+
+struct RangeMove
+{
+    uint32 range = 0; // index of the range in the ones given to PlanCompaction
+    uint32 from = 0;
+    uint32 to = 0;
+};
+
+/* One step of compaction over the live ranges {offset, count} of allocator: from the highest down, a range moves into
+ * the lowest free block below it that holds it, until budget elements have moved. A range larger than the whole
+ * budget still moves, alone in its step. The allocator is updated, copying the data is left to the caller */
+std::vector<RangeMove> PlanCompaction(RangeAllocator& allocator, std::vector<std::pair<uint32, uint32>> const& ranges,
+                                      uint64 budget);
+
+// Where an allocation lives this frame, offsets are in vertices and indices
+struct GeometryView
+{
+    DXBuffer* vertexBuffer = nullptr;
+    DXBuffer* indexBuffer = nullptr; // null without indices
+    uint32 firstVertex = 0;
+    uint32 firstIndex = 0;
+};
+
+struct GeometryArenaStats
+{
+    uint32 allocations = 0;
+    uint32 pools = 0; // vertex pools, one per vertex stride
+    uint32 freeBlocks = 0;
+    uint64 vertexBytes = 0;
+    uint64 vertexCapacityBytes = 0;
+    uint64 indexBytes = 0;
+    uint64 indexCapacityBytes = 0;
+    uint64 largestFreeBytes = 0;
+    uint64 movedBytes = 0; // by compaction since start up
+};
+
+/* Every mesh's vertices and indices are sub-allocated from a few large buffers: one vertex pool per vertex stride
+ * and two index pools, allocations whose indices all fit in 16 bits go to the 16 bit one. Meshes only hold a
+ * GeometryHandle and resolve it when they are drawn, so ranges can move. Freed ranges are compacted a little every
+ * frame by moving the highest range of a pool into the lowest hole below it with a GPU copy, which lets the free
+ * space gather at the end of the pools.
+ * References are counted by hand, Mesh components take one while they are in the registry. */
+class GeometryArena : public Singleton<GeometryArena>
+{
+    friend class Singleton<GeometryArena>;
+
+  public:
+    static constexpr uint64 MIN_POOL_BYTES = 1 << 20;
+    static constexpr uint64 COMPACTION_BUDGET = 4 << 20; // bytes moved per frame at most
+
+    void Initialize(ID3D11Device* device, ID3D11DeviceContext* context);
+    void Destroy();
+
+    // Uploads the geometry, the allocation has no references yet
+    GeometryHandle Allocate(void const* vertices, uint32 vertexCount, uint32 stride, uint32 const* indices, uint32 indexCount);
+    template <typename V>
+    GeometryHandle Allocate(std::vector<V> const& vertices, std::vector<uint32> const& indices)
+    {
+        return Allocate(vertices.data(), static_cast<uint32>(vertices.size()), sizeof(V), indices.data(),
+                        static_cast<uint32>(indices.size()));
+    }
+    void AddRef(GeometryHandle handle);
+    // Frees the ranges with the last reference
+    void Release(GeometryHandle handle);
+
+    // Moves ranges down into the holes left by freed geometry, up to COMPACTION_BUDGET bytes.
+    // Call between frames, never while recorded lists still refer to the old ranges
+    void Compact();
+
+    GeometryView Resolve(GeometryHandle handle) const
+    {
+        Allocation const& allocation = allocations[Index(handle)];
+        assert(allocation.generation == Generation(handle) && "Stale geometry handle!");
+        GeometryView view{};
+        view.vertexBuffer = vertexPools[allocation.vertexPool].buffer;
+        view.indexBuffer = allocation.indexCount ? IndexPool(allocation).buffer : nullptr;
+        view.firstVertex = allocation.firstVertex;
+        view.firstIndex = allocation.firstIndex;
+        return view;
+    }
+    GeometryArenaStats Stats() const;
+
+    // Dense id of the allocation, kept while it is live even when compaction moves its ranges.
+    // Draw keys group the draws of the same geometry with it
+    static uint32 SlotIndex(GeometryHandle handle)
+    {
+        return Index(handle);
+    }
+
+  private:
+    static constexpr uint32 INDEX_BITS = 20;
+
+    struct Pool
+    {
+        DXBuffer* buffer = nullptr;
+        RangeAllocator ranges;
+        uint32 stride = 0;
+    };
+    struct Allocation
+    {
+        uint32 vertexPool = 0;
+        uint32 firstVertex = 0;
+        uint32 vertexCount = 0;
+        uint32 firstIndex = 0;
+        uint32 indexCount = 0;
+        uint32 refCount = 0;
+        uint32 generation = 0;
+        bool live = false;
+        bool shortIndices = false;
+    };
+
+    static uint32 Index(GeometryHandle handle)
+    {
+        return handle & ((1u << INDEX_BITS) - 1);
+    }
+    static uint32 Generation(GeometryHandle handle)
+    {
+        return handle >> INDEX_BITS;
+    }
+
+    Pool& IndexPool(Allocation const& allocation)
+    {
+        return allocation.shortIndices ? shortIndexPool : indexPool;
+    }
+    Pool const& IndexPool(Allocation const& allocation) const
+    {
+        return allocation.shortIndices ? shortIndexPool : indexPool;
+    }
+    uint32 PoolForStride(uint32 stride);
+    uint32 AllocateRange(Pool& pool, uint32 count, bool indices);
+    void CreatePoolBuffer(Pool& pool, uint32 capacity, bool indices);
+    void Upload(Pool& pool, uint32 offset, void const* data, uint32 count);
+    void Move(Pool& pool, uint32 from, uint32 to, uint32 count);
+    void ReserveScratch(uint64 bytes);
+    uint64 CompactPool(Pool& pool, uint32 poolIndex, bool indices, uint64 budget);
+
+  private:
+    ID3D11Device* m_device = nullptr;
+    ID3D11DeviceContext* m_context = nullptr;
+    std::vector<Pool> vertexPools;
+    Pool indexPool;      // 32 bit
+    Pool shortIndexPool; // 16 bit
+    std::vector<Allocation> allocations;
+    std::vector<uint32> freeSlots;
+    DXBuffer* scratch = nullptr; // moves go through it, a buffer cannot be copied onto itself everywhere
+    uint64 movedBytes = 0;
+
+  private:
+    GeometryArena() = default;
+    GeometryArena(GeometryArena const&) = delete;
+    GeometryArena& operator=(GeometryArena const&) = delete;
+    ~GeometryArena() = default;
+};
+#define g_GeometryArena GeometryArena::Get()
+} // namespace Riley
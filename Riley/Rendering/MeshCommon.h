@@ -0,0 +1,35 @@
+#pragma once
+#include "../Core/CoreTypes.h"
+#include "../Math/MathTypes.h"
+
+namespace Riley
+{
+
+// Vertex layouts and LOD ranges shared by the loaders and the Mesh component, without the device behind the latter
+
+struct Vertex
+{
+    Vector3 position;
+    Vector3 normal;
+    Vector2 texcoord;
+    Vector3 tangent;
+    Vector3 bitangent;
+};
+
+struct SimpleVertex
+{
+    Vector3 position;
+    Vector2 texcoord;
+};
+
+inline constexpr uint32 MAX_MESH_LODS = 3;
+
+// Coarser index list of a mesh, drawn with the vertices of the full resolution mesh
+struct MeshLOD
+{
+    uint32 startIndexLoc = 0;
+    uint32 indexCount = 0;
+    float error = 0.0f; // surface deviation relative to the bounding sphere radius of the mesh
+};
+
+} // namespace Riley
@@ -1,5 +1,5 @@
 #pragma once
-#include "Components.h"
+#include "MeshCommon.h"
 
 namespace Riley
 {
@@ -52,4 +52,22 @@ struct Model
     MaterialData materialData;
 };
 
+// A node of the model's hierarchy, it draws its meshes with the transform accumulated from its parents
+struct NodeData
+{
+    static constexpr uint32 NO_PARENT = uint32(-1);
+
+    std::string name;
+    Matrix transform = Matrix::Identity; // relative to the parent
+    uint32 parent = NO_PARENT;           // nodes always come after their parent
+    std::vector<uint32> meshes;          // indices into SceneData::meshes
+};
+
+// Every mesh of a model once, however many nodes draw it
+struct SceneData
+{
+    std::vector<Model> meshes;
+    std::vector<NodeData> nodes;
+};
+
 } // namespace Riley
\ No newline at end of file
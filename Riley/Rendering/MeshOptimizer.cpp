@@ -0,0 +1,360 @@
+#include "MeshOptimizer.h"
+#include "../Utilities/HashUtil.h"
+#include <algorithm>
+#include <numeric>
+
+namespace Riley
+{
+namespace MeshOptimizer
+{
+
+namespace
+{
+// vertices compare by their bytes, -0 and 0 or differing NaNs are kept apart which only costs a missed weld
+struct VertexBytesHash
+{
+    size_t operator()(Vertex const& vertex) const
+    {
+        return static_cast<size_t>(HashBytes(&vertex, sizeof(Vertex)));
+    }
+};
+struct VertexBytesEqual
+{
+    bool operator()(Vertex const& lhs, Vertex const& rhs) const
+    {
+        return memcmp(&lhs, &rhs, sizeof(Vertex)) == 0;
+    }
+};
+
+// FIFO post-transform cache, a vertex is cached while fewer than VERTEX_CACHE_SIZE misses happened since its own
+class FifoCache
+{
+  public:
+    explicit FifoCache(uint32 vertexCount) : timestamps(vertexCount, 0)
+    {
+    }
+
+    // true on a miss
+    bool Access(uint32 vertex)
+    {
+        if (time - timestamps[vertex] <= VERTEX_CACHE_SIZE)
+            return false;
+        timestamps[vertex] = time++;
+        return true;
+    }
+    uint32 AccessTriangle(uint32 const* triangle)
+    {
+        return Access(triangle[0]) + Access(triangle[1]) + Access(triangle[2]);
+    }
+    void Flush()
+    {
+        time += VERTEX_CACHE_SIZE + 1;
+    }
+
+  private:
+    std::vector<uint32> timestamps;
+    uint32 time = VERTEX_CACHE_SIZE + 1;
+};
+
+// Forsyth's scoring, the cache modelled here is LRU and a little larger than the FIFO it optimizes for
+constexpr uint32 SCORE_CACHE_SIZE = 32;
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+float VertexScore(int32 cachePosition, uint32 liveTriangles)
+{
+    if (liveTriangles == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        // the vertices of the last triangle score the same whatever their order, so it is not favoured twice
+        if (cachePosition < 3)
+            score = LAST_TRIANGLE_SCORE;
+        else
+            score = std::pow(1.0f - float(cachePosition - 3) / (SCORE_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+    }
+    // vertices with few triangles left are finished first
+    return score + VALENCE_BOOST_SCALE * std::pow(float(liveTriangles), -VALENCE_BOOST_POWER);
+}
+} // namespace
+
+uint32 WeldVertices(std::vector<Vertex>& vertices, std::vector<uint32>& indices)
+{
+    std::unordered_map<Vertex, uint32, VertexBytesHash, VertexBytesEqual> unique;
+    unique.reserve(vertices.size());
+    std::vector<uint32> remap(vertices.size());
+    std::vector<Vertex> welded;
+    welded.reserve(vertices.size());
+
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        auto [it, inserted] = unique.try_emplace(vertices[i], static_cast<uint32>(welded.size()));
+        if (inserted)
+            welded.push_back(vertices[i]);
+        remap[i] = it->second;
+    }
+    for (uint32& index : indices)
+        index = remap[index];
+
+    const uint32 removed = static_cast<uint32>(vertices.size() - welded.size());
+    vertices.swap(welded);
+    return removed;
+}
+
+void OptimizeVertexCache(std::vector<uint32>& indices, uint32 vertexCount)
+{
+    const uint32 triangleCount = static_cast<uint32>(indices.size() / 3);
+    if (triangleCount == 0)
+        return;
+
+    // triangles of every vertex, the live ones are kept in front: [offsets[v], offsets[v] + liveTriangles[v])
+    std::vector<uint32> liveTriangles(vertexCount, 0);
+    for (uint32 index : indices)
+        ++liveTriangles[index];
+    std::vector<uint32> offsets(vertexCount + 1, 0);
+    std::inclusive_scan(liveTriangles.begin(), liveTriangles.end(), offsets.begin() + 1);
+    std::vector<uint32> adjacency(indices.size());
+    {
+        std::vector<uint32> cursor(offsets.begin(), offsets.end() - 1);
+        for (uint32 i = 0; i < indices.size(); ++i)
+            adjacency[cursor[indices[i]]++] = i / 3;
+    }
+
+    std::vector<int32> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (uint32 v = 0; v < vertexCount; ++v)
+        vertexScore[v] = VertexScore(-1, liveTriangles[v]);
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    int64 best = -1;
+    float bestScore = -1.0f;
+    for (uint32 t = 0; t < triangleCount; ++t)
+    {
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+        if (triangleScore[t] > bestScore)
+        {
+            bestScore = triangleScore[t];
+            best = t;
+        }
+    }
+
+    std::vector<uint32> result;
+    result.reserve(indices.size());
+    std::vector<uint32> cache, nextCache;
+    cache.reserve(SCORE_CACHE_SIZE + 3);
+    nextCache.reserve(SCORE_CACHE_SIZE + 3);
+    uint32 fallback = 0; // next triangle in input order when nothing in the cache is left to draw
+
+    while (result.size() < indices.size())
+    {
+        if (best < 0)
+        {
+            while (emitted[fallback])
+                ++fallback;
+            best = fallback;
+        }
+        const uint32 triangle = static_cast<uint32>(best);
+        uint32 const* corners = &indices[triangle * 3];
+        emitted[triangle] = true;
+        result.insert(result.end(), corners, corners + 3);
+
+        // the triangle goes to the front of the cache, the rest keeps its order
+        nextCache.clear();
+        for (uint32 i = 0; i < 3; ++i)
+        {
+            const uint32 v = corners[i];
+            uint32* first = &adjacency[offsets[v]];
+            uint32* last = first + liveTriangles[v];
+            std::iter_swap(std::find(first, last, triangle), last - 1);
+            --liveTriangles[v];
+
+            if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end())
+                nextCache.push_back(v);
+        }
+        for (uint32 v : cache)
+        {
+            if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end())
+                nextCache.push_back(v);
+        }
+
+        for (uint32 i = 0; i < nextCache.size(); ++i)
+        {
+            const uint32 v = nextCache[i];
+            cachePosition[v] = i < SCORE_CACHE_SIZE ? static_cast<int32>(i) : -1;
+            vertexScore[v] = VertexScore(cachePosition[v], liveTriangles[v]);
+        }
+
+        // only triangles around the cache change score, the next one is picked among them
+        best = -1;
+        bestScore = -1.0f;
+        for (uint32 v : nextCache)
+        {
+            for (uint32 a = offsets[v]; a < offsets[v] + liveTriangles[v]; ++a)
+            {
+                const uint32 t = adjacency[a];
+                triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+                if (triangleScore[t] > bestScore)
+                {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+
+        if (nextCache.size() > SCORE_CACHE_SIZE)
+            nextCache.resize(SCORE_CACHE_SIZE);
+        cache.swap(nextCache);
+    }
+    indices.swap(result);
+}
+
+/* Splits the cache optimized order into clusters and sorts them front to back from the outside of the mesh:
+ * a cluster whose average normal points away from the mesh centroid is more likely to occlude the others.
+ * Clusters start where the FIFO cache has nothing of the previous triangles left, and are split further as long as
+ * each piece, drawn from a cold cache, stays below threshold times the ACMR the cluster had in that order. */
+void OptimizeOverdraw(std::vector<uint32>& indices, std::vector<Vertex> const& vertices, float threshold)
+{
+    const uint32 triangleCount = static_cast<uint32>(indices.size() / 3);
+    if (triangleCount < 2)
+        return;
+
+    // the misses of the cache optimized order are what the clusters are measured against
+    FifoCache cache(static_cast<uint32>(vertices.size()));
+    std::vector<uint32> hardBoundaries;
+    std::vector<uint32> missesBefore(triangleCount + 1, 0); // misses of the triangles before t
+    for (uint32 t = 0; t < triangleCount; ++t)
+    {
+        const uint32 misses = cache.AccessTriangle(&indices[t * 3]);
+        if (misses == 3)
+            hardBoundaries.push_back(t);
+        missesBefore[t + 1] = missesBefore[t] + misses;
+    }
+    hardBoundaries.push_back(triangleCount);
+
+    std::vector<uint32> clusters; // first triangle of every cluster, followed by triangleCount
+    for (uint32 h = 0; h + 1 < hardBoundaries.size(); ++h)
+    {
+        const uint32 start = hardBoundaries[h];
+        const uint32 end = hardBoundaries[h + 1];
+        const float targetACMR = threshold * (missesBefore[end] - missesBefore[start]) / (end - start);
+
+        // a cluster starts with a cold cache wherever it ends up, so its misses are counted from one
+        cache.Flush();
+        clusters.push_back(start);
+        uint32 clusterStart = start;
+        uint32 misses = 0;
+        for (uint32 t = start; t < end; ++t)
+        {
+            misses += cache.AccessTriangle(&indices[t * 3]);
+            if (t + 1 < end && misses <= targetACMR * (t + 1 - clusterStart))
+            {
+                clusterStart = t + 1;
+                clusters.push_back(clusterStart);
+                cache.Flush();
+                misses = 0;
+            }
+        }
+        // the rest of the cluster did not get below the target, it stays with the piece before it
+        if (clusterStart != start && misses > targetACMR * (end - clusterStart))
+            clusters.pop_back();
+    }
+    clusters.push_back(triangleCount);
+
+    const uint32 clusterCount = static_cast<uint32>(clusters.size() - 1);
+    std::vector<Vector3> centroids(clusterCount, Vector3(0.0f));
+    std::vector<Vector3> normals(clusterCount, Vector3(0.0f));
+    std::vector<float> areas(clusterCount, 0.0f);
+    Vector3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (uint32 c = 0; c < clusterCount; ++c)
+    {
+        for (uint32 t = clusters[c]; t < clusters[c + 1]; ++t)
+        {
+            Vector3 const& p0 = vertices[indices[t * 3]].position;
+            Vector3 const& p1 = vertices[indices[t * 3 + 1]].position;
+            Vector3 const& p2 = vertices[indices[t * 3 + 2]].position;
+            const Vector3 normal = (p1 - p0).Cross(p2 - p0); // length is twice the area
+            const float area = normal.Length();
+            centroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+            normals[c] += normal;
+            areas[c] += area;
+        }
+        meshCentroid += centroids[c];
+        meshArea += areas[c];
+        if (areas[c] > 0.0f)
+            centroids[c] /= areas[c];
+        normals[c].Normalize();
+    }
+    if (meshArea > 0.0f)
+        meshCentroid /= meshArea;
+
+    std::vector<float> sortKeys(clusterCount);
+    for (uint32 c = 0; c < clusterCount; ++c)
+        sortKeys[c] = (centroids[c] - meshCentroid).Dot(normals[c]);
+
+    std::vector<uint32> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32 lhs, uint32 rhs) { return sortKeys[lhs] > sortKeys[rhs]; });
+
+    std::vector<uint32> result;
+    result.reserve(indices.size());
+    for (uint32 c : order)
+        result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+    indices.swap(result);
+}
+
+// Vertices never referenced by the indices are dropped
+void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32>& indices)
+{
+    constexpr uint32 UNUSED = uint32(-1);
+    std::vector<uint32> remap(vertices.size(), UNUSED);
+    std::vector<Vertex> result;
+    result.reserve(vertices.size());
+
+    for (uint32& index : indices)
+    {
+        if (remap[index] == UNUSED)
+        {
+            remap[index] = static_cast<uint32>(result.size());
+            result.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(result);
+}
+
+VertexCacheStats AnalyzeVertexCache(std::vector<uint32> const& indices, uint32 vertexCount)
+{
+    VertexCacheStats stats{};
+    stats.triangles = static_cast<uint32>(indices.size() / 3);
+
+    FifoCache cache(vertexCount);
+    std::vector<bool> referenced(vertexCount, false);
+    for (uint32 index : indices)
+    {
+        stats.misses += cache.Access(index);
+        if (!referenced[index])
+        {
+            referenced[index] = true;
+            ++stats.vertices;
+        }
+    }
+    return stats;
+}
+
+VertexCacheStats Optimize(std::vector<Vertex>& vertices, std::vector<uint32>& indices)
+{
+    WeldVertices(vertices, indices);
+    OptimizeVertexCache(indices, static_cast<uint32>(vertices.size()));
+    OptimizeOverdraw(indices, vertices);
+    OptimizeVertexFetch(vertices, indices);
+    return AnalyzeVertexCache(indices, static_cast<uint32>(vertices.size()));
+}
+
+} // namespace MeshOptimizer
+} // namespace Riley
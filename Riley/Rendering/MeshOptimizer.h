@@ -0,0 +1,55 @@
+#pragma once
+#include "MeshCommon.h"
+
+namespace Riley
+{
+
+// Post-transform vertex cache efficiency of an index buffer, simulated with a FIFO of VERTEX_CACHE_SIZE entries
+struct VertexCacheStats
+{
+    uint32 triangles = 0;
+    uint32 vertices = 0; // referenced by the indices
+    uint32 misses = 0;   // vertex shader invocations
+
+    // average cache miss ratio, transformed vertices per triangle: 0.5 at best for large grids, 3 at worst
+    float ACMR() const
+    {
+        return triangles ? float(misses) / triangles : 0.0f;
+    }
+    // average transform to vertex ratio, 1 means every vertex is shaded exactly once
+    float ATVR() const
+    {
+        return vertices ? float(misses) / vertices : 0.0f;
+    }
+    VertexCacheStats& operator+=(VertexCacheStats const& other)
+    {
+        triangles += other.triangles;
+        vertices += other.vertices;
+        misses += other.misses;
+        return *this;
+    }
+};
+
+/* CPU passes run on every submesh before it is uploaded, in this order:
+ * WeldVertices merges bitwise identical vertices, OptimizeVertexCache reorders triangles for the post-transform cache
+ * (Forsyth's linear-speed algorithm), OptimizeOverdraw reorders clusters of those triangles so outward facing ones
+ * are drawn first and OptimizeVertexFetch renumbers vertices in the order they are first used. */
+namespace MeshOptimizer
+{
+inline constexpr uint32 VERTEX_CACHE_SIZE = 16;
+// clusters may raise the ACMR of the cache optimized order by this much at most
+inline constexpr float OVERDRAW_THRESHOLD = 1.05f;
+
+// Returns the number of vertices removed
+uint32 WeldVertices(std::vector<Vertex>& vertices, std::vector<uint32>& indices);
+void OptimizeVertexCache(std::vector<uint32>& indices, uint32 vertexCount);
+void OptimizeOverdraw(std::vector<uint32>& indices, std::vector<Vertex> const& vertices, float threshold = OVERDRAW_THRESHOLD);
+void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32>& indices);
+
+VertexCacheStats AnalyzeVertexCache(std::vector<uint32> const& indices, uint32 vertexCount);
+
+// All of the above, returns the cache stats of the result
+VertexCacheStats Optimize(std::vector<Vertex>& vertices, std::vector<uint32>& indices);
+} // namespace MeshOptimizer
+
+} // namespace Riley
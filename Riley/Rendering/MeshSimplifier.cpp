@@ -0,0 +1,417 @@
+#include "MeshSimplifier.h"
+#include "../Utilities/HashUtil.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cfloat>
+#include <numeric>
+
+namespace Riley
+{
+namespace MeshSimplifier
+{
+
+namespace
+{
+// Sum of squared distances to weighted planes, the symmetric 4x4 matrix stored as its upper triangle
+struct Quadric
+{
+    double a2 = 0, b2 = 0, c2 = 0, ab = 0, ac = 0, bc = 0, ad = 0, bd = 0, cd = 0, d2 = 0;
+    double weight = 0;
+
+    void AddPlane(Vector3 const& n, float d, double w)
+    {
+        a2 += w * n.x * n.x;
+        b2 += w * n.y * n.y;
+        c2 += w * n.z * n.z;
+        ab += w * n.x * n.y;
+        ac += w * n.x * n.z;
+        bc += w * n.y * n.z;
+        ad += w * n.x * d;
+        bd += w * n.y * d;
+        cd += w * n.z * d;
+        d2 += w * d * d;
+        weight += w;
+    }
+    Quadric& operator+=(Quadric const& q)
+    {
+        a2 += q.a2, b2 += q.b2, c2 += q.c2, ab += q.ab, ac += q.ac, bc += q.bc;
+        ad += q.ad, bd += q.bd, cd += q.cd, d2 += q.d2, weight += q.weight;
+        return *this;
+    }
+    // weighted mean of the squared distances of p to the planes
+    double Error(Vector3 const& p) const
+    {
+        if (weight <= 0.0)
+            return 0.0;
+        const double x = p.x, y = p.y, z = p.z;
+        const double e = a2 * x * x + b2 * y * y + c2 * z * z + 2.0 * (ab * x * y + ac * x * z + bc * y * z) +
+                         2.0 * (ad * x + bd * y + cd * z) + d2;
+        return std::max(e, 0.0) / weight;
+    }
+};
+
+struct Collapse
+{
+    uint32 from;
+    uint32 to;
+    double cost;
+};
+
+struct PositionHash
+{
+    size_t operator()(Vector3 const& p) const
+    {
+        size_t seed = 0;
+        HashCombine(seed, p.x);
+        HashCombine(seed, p.y);
+        HashCombine(seed, p.z);
+        return seed;
+    }
+};
+struct PositionEqual
+{
+    bool operator()(Vector3 const& lhs, Vector3 const& rhs) const
+    {
+        return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z;
+    }
+};
+
+float BoundingRadius(std::vector<Vertex> const& vertices)
+{
+    if (vertices.empty())
+        return 0.0f;
+    Vector3 lower = vertices[0].position, upper = vertices[0].position;
+    for (Vertex const& v : vertices)
+    {
+        lower = Vector3::Min(lower, v.position);
+        upper = Vector3::Max(upper, v.position);
+    }
+    return 0.5f * (upper - lower).Length();
+}
+
+// Vertices that must not move: attribute seams share their position with another vertex, borders and
+// non-manifold edges are used by one or more than two triangles once seams are welded
+std::vector<uint8> LockedVertices(std::vector<Vertex> const& vertices, std::vector<uint32> const& indices)
+{
+    std::unordered_map<Vector3, uint32, PositionHash, PositionEqual> positions;
+    positions.reserve(vertices.size());
+    std::vector<uint32> canonical(vertices.size());
+    std::vector<uint32> shared(vertices.size(), 0);
+    for (uint32 v = 0; v < vertices.size(); ++v)
+    {
+        canonical[v] = positions.try_emplace(vertices[v].position, v).first->second;
+        ++shared[canonical[v]];
+    }
+
+    std::unordered_map<uint64, uint32> edges;
+    edges.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        for (uint32 k = 0; k < 3; ++k)
+        {
+            const uint32 a = canonical[indices[i + k]];
+            const uint32 b = canonical[indices[i + (k + 1) % 3]];
+            ++edges[uint64(std::min(a, b)) << 32 | std::max(a, b)];
+        }
+    }
+
+    std::vector<uint8> lockedCanonical(vertices.size(), 0);
+    for (auto const& [edge, count] : edges)
+    {
+        if (count != 2)
+        {
+            lockedCanonical[uint32(edge >> 32)] = 1;
+            lockedCanonical[uint32(edge)] = 1;
+        }
+    }
+
+    std::vector<uint8> locked(vertices.size());
+    for (uint32 v = 0; v < vertices.size(); ++v)
+        locked[v] = shared[canonical[v]] > 1 || lockedCanonical[canonical[v]];
+    return locked;
+}
+
+// Triangles around every vertex, rebuilt after each round of collapses
+void BuildAdjacency(std::vector<uint32> const& indices, uint32 vertexCount, std::vector<uint32>& offsets,
+                    std::vector<uint32>& triangles)
+{
+    offsets.assign(vertexCount + 1, 0);
+    for (uint32 index : indices)
+        ++offsets[index + 1];
+    std::inclusive_scan(offsets.begin(), offsets.end(), offsets.begin());
+    triangles.resize(indices.size());
+    std::vector<uint32> cursor(offsets.begin(), offsets.end() - 1);
+    for (uint32 i = 0; i < indices.size(); ++i)
+        triangles[cursor[indices[i]]++] = i / 3;
+}
+
+// True when moving from onto to turns a triangle around from upside down
+bool Flips(std::vector<Vertex> const& vertices, std::vector<uint32> const& indices, std::vector<uint32> const& offsets,
+           std::vector<uint32> const& triangles, uint32 from, uint32 to)
+{
+    for (uint32 a = offsets[from]; a < offsets[from + 1]; ++a)
+    {
+        uint32 const* corners = &indices[triangles[a] * 3];
+        if (corners[0] == to || corners[1] == to || corners[2] == to)
+            continue;
+
+        Vector3 p[3], q[3];
+        for (uint32 k = 0; k < 3; ++k)
+        {
+            p[k] = vertices[corners[k]].position;
+            q[k] = corners[k] == from ? vertices[to].position : p[k];
+        }
+        const Vector3 before = (p[1] - p[0]).Cross(p[2] - p[0]);
+        const Vector3 after = (q[1] - q[0]).Cross(q[2] - q[0]);
+        if (before.Dot(after) <= 0.0f)
+            return true;
+    }
+    return false;
+}
+
+Vector3 ClosestPointOnTriangle(Vector3 const& p, Vector3 const& a, Vector3 const& b, Vector3 const& c)
+{
+    // Real-Time Collision Detection 5.1.5
+    const Vector3 ab = b - a, ac = c - a, ap = p - a;
+    const float d1 = ab.Dot(ap), d2 = ac.Dot(ap);
+    if (d1 <= 0.0f && d2 <= 0.0f)
+        return a;
+
+    const Vector3 bp = p - b;
+    const float d3 = ab.Dot(bp), d4 = ac.Dot(bp);
+    if (d3 >= 0.0f && d4 <= d3)
+        return b;
+
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        return a + ab * (d1 / (d1 - d3));
+
+    const Vector3 cp = p - c;
+    const float d5 = ab.Dot(cp), d6 = ac.Dot(cp);
+    if (d6 >= 0.0f && d5 <= d6)
+        return c;
+
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        return a + ac * (d2 / (d2 - d6));
+
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    const float denom = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+// Largest distance from the vertices of from to the surface of to, triangles are bucketed in a uniform grid
+float OneSidedDistance(std::vector<Vertex> const& vertices, std::vector<uint32> const& from, std::vector<uint32> const& to)
+{
+    const uint32 triangleCount = static_cast<uint32>(to.size() / 3);
+    if (from.empty() || triangleCount == 0)
+        return 0.0f;
+
+    Vector3 lower = vertices[to[0]].position, upper = lower;
+    for (uint32 index : to)
+    {
+        lower = Vector3::Min(lower, vertices[index].position);
+        upper = Vector3::Max(upper, vertices[index].position);
+    }
+    const Vector3 extent = upper - lower;
+    const float cellSize = std::max({extent.x, extent.y, extent.z, 1e-6f}) / std::max(1.0f, std::cbrt(float(triangleCount)));
+    int32 dims[3];
+    for (uint32 k = 0; k < 3; ++k)
+        dims[k] = std::clamp(int32(std::ceil((&extent.x)[k] / cellSize)), 1, 128);
+
+    auto CellOf = [&](Vector3 const& p, uint32 k) {
+        return std::clamp(int32(((&p.x)[k] - (&lower.x)[k]) / cellSize), 0, dims[k] - 1);
+    };
+    auto CellIndex = [&](int32 x, int32 y, int32 z) { return (z * dims[1] + y) * dims[0] + x; };
+
+    std::vector<std::vector<uint32>> cells(size_t(dims[0]) * dims[1] * dims[2]);
+    for (uint32 t = 0; t < triangleCount; ++t)
+    {
+        Vector3 const& a = vertices[to[t * 3]].position;
+        Vector3 const& b = vertices[to[t * 3 + 1]].position;
+        Vector3 const& c = vertices[to[t * 3 + 2]].position;
+        const Vector3 tlower = Vector3::Min(Vector3::Min(a, b), c);
+        const Vector3 tupper = Vector3::Max(Vector3::Max(a, b), c);
+        for (int32 z = CellOf(tlower, 2); z <= CellOf(tupper, 2); ++z)
+            for (int32 y = CellOf(tlower, 1); y <= CellOf(tupper, 1); ++y)
+                for (int32 x = CellOf(tlower, 0); x <= CellOf(tupper, 0); ++x)
+                    cells[CellIndex(x, y, z)].push_back(t);
+    }
+
+    std::vector<uint8> visited(vertices.size(), 0);
+    const int32 maxRing = std::max({dims[0], dims[1], dims[2]});
+    float distance = 0.0f;
+    for (uint32 index : from)
+    {
+        if (visited[index])
+            continue;
+        visited[index] = 1;
+
+        Vector3 const& p = vertices[index].position;
+        const int32 cx = CellOf(p, 0), cy = CellOf(p, 1), cz = CellOf(p, 2);
+        float best = FLT_MAX;
+        // cells of ring r + 1 are at least r cells away from p
+        for (int32 r = 0; r <= maxRing && best > (r - 1) * cellSize * (r - 1) * cellSize; ++r)
+        {
+            for (int32 z = cz - r; z <= cz + r; ++z)
+                for (int32 y = cy - r; y <= cy + r; ++y)
+                    for (int32 x = cx - r; x <= cx + r; ++x)
+                    {
+                        if (std::max({std::abs(x - cx), std::abs(y - cy), std::abs(z - cz)}) != r)
+                            continue;
+                        if (x < 0 || y < 0 || z < 0 || x >= dims[0] || y >= dims[1] || z >= dims[2])
+                            continue;
+                        for (uint32 t : cells[CellIndex(x, y, z)])
+                        {
+                            const Vector3 closest = ClosestPointOnTriangle(p, vertices[to[t * 3]].position,
+                                                                           vertices[to[t * 3 + 1]].position,
+                                                                           vertices[to[t * 3 + 2]].position);
+                            best = std::min(best, (closest - p).LengthSquared());
+                        }
+                    }
+        }
+        distance = std::max(distance, std::sqrt(best));
+    }
+    return distance;
+}
+} // namespace
+
+float Simplify(std::vector<uint32>& indices, std::vector<Vertex> const& vertices, uint32 targetIndexCount, float targetError)
+{
+    const uint32 vertexCount = static_cast<uint32>(vertices.size());
+    const float radius = BoundingRadius(vertices);
+    if (radius <= 0.0f || indices.size() <= targetIndexCount)
+        return 0.0f;
+
+    const std::vector<uint8> locked = LockedVertices(vertices, indices);
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        Vector3 const& p0 = vertices[indices[i]].position;
+        Vector3 normal = (vertices[indices[i + 1]].position - p0).Cross(vertices[indices[i + 2]].position - p0);
+        const float area = 0.5f * normal.Length();
+        if (area <= 0.0f)
+            continue;
+        normal.Normalize();
+        // weighted by area so that slivers do not pin their vertices
+        for (uint32 k = 0; k < 3; ++k)
+            quadrics[indices[i + k]].AddPlane(normal, -normal.Dot(p0), area);
+    }
+
+    const double maxCost = double(targetError) * radius * targetError * radius;
+    double reachedCost = 0.0;
+    std::vector<uint32> offsets, triangles;
+    std::vector<Collapse> collapses;
+    std::vector<uint8> touched;
+    std::vector<uint32> remap(vertexCount);
+
+    while (indices.size() > targetIndexCount)
+    {
+        BuildAdjacency(indices, vertexCount, offsets, triangles);
+
+        collapses.clear();
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (uint32 k = 0; k < 3; ++k)
+            {
+                const uint32 a = indices[i + k];
+                const uint32 b = indices[i + (k + 1) % 3];
+                for (auto [from, to] : {std::pair{a, b}, std::pair{b, a}})
+                {
+                    if (locked[from] || from == to)
+                        continue;
+                    Quadric q = quadrics[from];
+                    q += quadrics[to];
+                    collapses.push_back(Collapse{from, to, q.Error(vertices[to].position)});
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](Collapse const& lhs, Collapse const& rhs) { return lhs.cost < rhs.cost; });
+
+        // an interior collapse removes two triangles, the round stops short of the target rather than past it
+        const size_t budget = std::max<size_t>(1, (indices.size() - targetIndexCount) / 6);
+        size_t collapsed = 0;
+        touched.assign(vertexCount, 0);
+        std::iota(remap.begin(), remap.end(), 0);
+        for (Collapse const& collapse : collapses)
+        {
+            if (collapse.cost > maxCost)
+                break;
+            if (touched[collapse.from] || touched[collapse.to])
+                continue;
+            if (Flips(vertices, indices, offsets, triangles, collapse.from, collapse.to))
+                continue;
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            reachedCost = std::max(reachedCost, collapse.cost);
+            // the neighbourhood changes shape, later collapses of this round would be checked against stale triangles
+            for (uint32 a = offsets[collapse.from]; a < offsets[collapse.from + 1]; ++a)
+            {
+                uint32 const* corners = &indices[triangles[a] * 3];
+                touched[corners[0]] = touched[corners[1]] = touched[corners[2]] = 1;
+            }
+            if (++collapsed >= budget)
+                break;
+        }
+        if (collapsed == 0)
+            break;
+
+        size_t write = 0;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const uint32 a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+            if (a == b || b == c || c == a)
+                continue;
+            indices[write++] = a;
+            indices[write++] = b;
+            indices[write++] = c;
+        }
+        indices.resize(write);
+    }
+    return float(std::sqrt(reachedCost)) / radius;
+}
+
+float HausdorffDistance(std::vector<Vertex> const& vertices, std::vector<uint32> const& lhs, std::vector<uint32> const& rhs)
+{
+    return std::max(OneSidedDistance(vertices, lhs, rhs), OneSidedDistance(vertices, rhs, lhs));
+}
+
+std::vector<MeshLODLevel> BuildLODChain(std::vector<Vertex> const& vertices, std::vector<uint32> const& indices,
+                                        LODChainSettings const& settings)
+{
+    std::vector<MeshLODLevel> levels;
+    levels.reserve(MAX_MESH_LODS); // source points into the previous level
+    const float radius = BoundingRadius(vertices);
+    std::vector<uint32> const* source = &indices;
+    float error = 0.0f;
+    for (uint32 level = 0; level < std::min(settings.lodCount, MAX_MESH_LODS); ++level)
+    {
+        const float budget = settings.errorBudget - error;
+        if (budget <= 0.0f)
+            break;
+
+        const uint32 target = static_cast<uint32>(source->size() / 3 * settings.reduction) * 3;
+        std::vector<uint32> simplified = *source;
+        // each level starts from fresh quadrics, its error adds to the one of the level it came from
+        const float levelError = Simplify(simplified, vertices, target, budget);
+        if (simplified.size() > source->size() * settings.minReduction)
+            break;
+
+        MeshOptimizer::OptimizeVertexCache(simplified, static_cast<uint32>(vertices.size()));
+        MeshLODLevel& lod = levels.emplace_back();
+        lod.indices = std::move(simplified);
+        error += levelError;
+        lod.error = error;
+        if (settings.measureError && radius > 0.0f)
+            lod.hausdorff = HausdorffDistance(vertices, indices, lod.indices) / radius;
+        source = &lod.indices;
+    }
+    return levels;
+}
+
+} // namespace MeshSimplifier
+} // namespace Riley
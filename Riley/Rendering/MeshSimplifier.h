@@ -0,0 +1,40 @@
+#pragma once
+#include "MeshCommon.h"
+
+namespace Riley
+{
+
+struct LODChainSettings
+{
+    uint32 lodCount = MAX_MESH_LODS; // coarser levels built after the base mesh at most
+    float reduction = 0.5f;          // triangles of a level relative to the previous one
+    float errorBudget = 0.02f;       // of the whole chain, relative to the bounding sphere radius of the submesh
+    float minReduction = 0.85f;      // a level keeping more of the previous one's triangles than this is dropped
+    bool measureError = false;       // Hausdorff distance of every level to the base mesh, slow on large models
+};
+
+struct MeshLODLevel
+{
+    std::vector<uint32> indices; // into the vertices of the base mesh
+    float error = 0.0f;          // estimated by the quadrics, relative like LODChainSettings::errorBudget
+    float hausdorff = 0.0f;      // measured when LODChainSettings::measureError is set, relative as well
+};
+
+/* Quadric error metric simplifier (Garland & Heckbert). Edges are collapsed into one of their vertices, so levels
+ * only need indices and share the vertex range of the base mesh. Vertices on borders, attribute seams or
+ * non-manifold edges never move, which keeps submeshes watertight against each other and their texture charts. */
+namespace MeshSimplifier
+{
+// Collapses edges until indices holds targetIndexCount indices at most or the next collapse would move the surface
+// more than targetError, relative to the bounding sphere radius of the vertices. Returns the error reached
+float Simplify(std::vector<uint32>& indices, std::vector<Vertex> const& vertices, uint32 targetIndexCount, float targetError);
+
+// Symmetric Hausdorff distance between two triangle sets over the same vertices, sampled at their vertices
+float HausdorffDistance(std::vector<Vertex> const& vertices, std::vector<uint32> const& lhs, std::vector<uint32> const& rhs);
+
+// Levels from finest to coarsest, each simplified from the previous one and reordered for the vertex cache
+std::vector<MeshLODLevel> BuildLODChain(std::vector<Vertex> const& vertices, std::vector<uint32> const& indices,
+                                        LODChainSettings const& settings);
+} // namespace MeshSimplifier
+
+} // namespace Riley
@@ -0,0 +1,251 @@
+#include "MeshletBuilder.h"
+#include <algorithm>
+#include <cfloat>
+
+namespace Riley
+{
+namespace MeshletBuilder
+{
+
+namespace
+{
+// how much a meshlet prefers triangles facing its way over ones close to it, both rank after the new vertex count
+constexpr float DISTANCE_WEIGHT = 2.0f;
+constexpr float CONE_WEIGHT = 1.0f;
+// a triangle facing away from the cone axis by more than this (dot product) never lets the cone cull
+constexpr float MIN_CONE_DOT = 0.1f;
+
+Vector3 TriangleNormal(std::vector<Vertex> const& vertices, uint32 i0, uint32 i1, uint32 i2)
+{
+    Vector3 const& p0 = vertices[i0].position;
+    return (vertices[i1].position - p0).Cross(vertices[i2].position - p0);
+}
+} // namespace
+
+Meshlet ComputeBounds(std::vector<Vertex> const& vertices, std::span<uint32 const> indices)
+{
+    Meshlet meshlet{};
+    if (indices.empty())
+        return meshlet;
+
+    Vector3 minimum(FLT_MAX, FLT_MAX, FLT_MAX);
+    Vector3 maximum(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (uint32 index : indices)
+    {
+        minimum = Vector3::Min(minimum, vertices[index].position);
+        maximum = Vector3::Max(maximum, vertices[index].position);
+    }
+    meshlet.center = (minimum + maximum) * 0.5f;
+    for (uint32 index : indices)
+        meshlet.radius = std::max(meshlet.radius, Vector3::Distance(meshlet.center, vertices[index].position));
+
+    // the axis averages the unit normals, degenerate triangles have no say
+    std::vector<Vector3> normals;
+    normals.reserve(indices.size() / 3);
+    Vector3 axis(0.0f, 0.0f, 0.0f);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        Vector3 normal = TriangleNormal(vertices, indices[i], indices[i + 1], indices[i + 2]);
+        if (normal.LengthSquared() <= 1e-20f)
+        {
+            normals.push_back(Vector3(0.0f, 0.0f, 0.0f));
+            continue;
+        }
+        normal.Normalize();
+        normals.push_back(normal);
+        axis += normal;
+    }
+    if (axis.LengthSquared() <= 1e-12f)
+        return meshlet;
+    axis.Normalize();
+
+    float minDot = 1.0f;
+    for (Vector3 const& normal : normals)
+    {
+        if (normal.LengthSquared() > 0.0f)
+            minDot = std::min(minDot, normal.Dot(axis));
+    }
+    if (minDot <= MIN_CONE_DOT)
+        return meshlet;
+
+    // the apex moves back along the axis until it is behind the plane of every triangle
+    float maxT = 0.0f;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        Vector3 const& normal = normals[i / 3];
+        if (normal.LengthSquared() == 0.0f)
+            continue;
+        const float t = (meshlet.center - vertices[indices[i]].position).Dot(normal) / axis.Dot(normal);
+        maxT = std::max(maxT, t);
+    }
+    meshlet.coneApex = meshlet.center - axis * maxT;
+    meshlet.coneAxis = axis;
+    meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    return meshlet;
+}
+
+std::vector<Meshlet> Build(std::vector<Vertex> const& vertices, std::vector<uint32>& indices, uint32 maxVertices,
+                           uint32 maxTriangles)
+{
+    assert(maxVertices >= 3 && maxTriangles >= 1 && maxTriangles <= UINT16_MAX);
+    std::vector<Meshlet> meshlets;
+    const uint32 triangleCount = static_cast<uint32>(indices.size() / 3);
+    const uint32 vertexCount = static_cast<uint32>(vertices.size());
+    if (triangleCount == 0)
+        return meshlets;
+
+    // triangles around each vertex
+    std::vector<uint32> offsets(vertexCount + 1, 0);
+    for (uint32 i = 0; i < triangleCount * 3; ++i)
+        ++offsets[indices[i] + 1];
+    for (uint32 v = 0; v < vertexCount; ++v)
+        offsets[v + 1] += offsets[v];
+    std::vector<uint32> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32> cursor(offsets.begin(), offsets.end() - 1);
+        for (uint32 i = 0; i < triangleCount * 3; ++i)
+            adjacency[cursor[indices[i]]++] = i / 3;
+    }
+
+    std::vector<Vector3> centroids(triangleCount);
+    std::vector<Vector3> normals(triangleCount);
+    double edgeSum = 0.0;
+    for (uint32 t = 0; t < triangleCount; ++t)
+    {
+        Vector3 const& p0 = vertices[indices[t * 3 + 0]].position;
+        Vector3 const& p1 = vertices[indices[t * 3 + 1]].position;
+        Vector3 const& p2 = vertices[indices[t * 3 + 2]].position;
+        centroids[t] = (p0 + p1 + p2) / 3.0f;
+        normals[t] = (p1 - p0).Cross(p2 - p0);
+        normals[t].Normalize();
+        edgeSum += Vector3::Distance(p0, p1) + Vector3::Distance(p1, p2) + Vector3::Distance(p2, p0);
+    }
+    // distances are measured against the size a full meshlet of average triangles would have
+    const float meshletSize = std::max(static_cast<float>(edgeSum / (triangleCount * 3)) * std::sqrt(float(maxTriangles)), 1e-6f);
+
+    constexpr uint32 NONE = UINT32_MAX;
+    std::vector<uint8> emitted(triangleCount, 0);
+    std::vector<uint32> vertexMeshlet(vertexCount, NONE);  // last meshlet a vertex was added to
+    std::vector<uint32> candidateMeshlet(triangleCount, NONE); // last meshlet a triangle was a candidate of
+    std::vector<uint32> order;
+    std::vector<uint32> members;
+    std::vector<uint32> candidates;
+    order.reserve(triangleCount);
+    uint32 seed = 0;
+
+    for (;;)
+    {
+        while (seed < triangleCount && emitted[seed])
+            ++seed;
+        if (seed == triangleCount)
+            break;
+
+        const uint32 id = static_cast<uint32>(meshlets.size());
+        uint32 meshletVertices = 0;
+        Vector3 centroidSum(0.0f, 0.0f, 0.0f);
+        Vector3 normalSum(0.0f, 0.0f, 0.0f);
+        members.clear();
+        candidates.clear();
+
+        auto NewVertices = [&](uint32 t) {
+            return uint32(vertexMeshlet[indices[t * 3 + 0]] != id) + uint32(vertexMeshlet[indices[t * 3 + 1]] != id) +
+                   uint32(vertexMeshlet[indices[t * 3 + 2]] != id);
+        };
+        auto Add = [&](uint32 t) {
+            emitted[t] = 1;
+            members.push_back(t);
+            centroidSum += centroids[t];
+            normalSum += normals[t];
+            for (uint32 k = 0; k < 3; ++k)
+            {
+                const uint32 v = indices[t * 3 + k];
+                if (vertexMeshlet[v] == id)
+                    continue;
+                vertexMeshlet[v] = id;
+                ++meshletVertices;
+                for (uint32 a = offsets[v]; a < offsets[v + 1]; ++a)
+                {
+                    const uint32 neighbour = adjacency[a];
+                    if (!emitted[neighbour] && candidateMeshlet[neighbour] != id)
+                    {
+                        candidateMeshlet[neighbour] = id;
+                        candidates.push_back(neighbour);
+                    }
+                }
+            }
+        };
+
+        Add(seed);
+        while (members.size() < maxTriangles)
+        {
+            const Vector3 center = centroidSum / static_cast<float>(members.size());
+            Vector3 axis = normalSum;
+            axis.Normalize();
+
+            uint32 best = NONE;
+            float bestScore = FLT_MAX;
+            size_t kept = 0;
+            for (uint32 t : candidates)
+            {
+                if (emitted[t])
+                    continue;
+                candidates[kept++] = t;
+                const uint32 added = NewVertices(t);
+                if (meshletVertices + added > maxVertices)
+                    continue;
+                const float score = added + DISTANCE_WEIGHT * Vector3::Distance(centroids[t], center) / meshletSize +
+                                    CONE_WEIGHT * (1.0f - normals[t].Dot(axis));
+                if (score < bestScore)
+                {
+                    bestScore = score;
+                    best = t;
+                }
+            }
+            candidates.resize(kept);
+
+            // nothing connected fits, islands in the triangle order join the meshlet when they are close to it
+            if (best == NONE)
+            {
+                while (seed < triangleCount && emitted[seed])
+                    ++seed;
+                if (seed == triangleCount || meshletVertices + NewVertices(seed) > maxVertices ||
+                    Vector3::Distance(centroids[seed], center) > meshletSize)
+                    break;
+                best = seed;
+            }
+            Add(best);
+        }
+
+        // the vertex cache order of the triangles is kept within the meshlet
+        std::sort(members.begin(), members.end());
+        Meshlet meshlet{};
+        meshlet.firstIndex = static_cast<uint32>(order.size() * 3);
+        meshlet.triangleCount = static_cast<uint16>(members.size());
+        meshlet.vertexCount = static_cast<uint16>(meshletVertices);
+        order.insert(order.end(), members.begin(), members.end());
+        meshlets.push_back(meshlet);
+    }
+
+    std::vector<uint32> reordered(indices);
+    for (uint32 i = 0; i < triangleCount; ++i)
+    {
+        for (uint32 k = 0; k < 3; ++k)
+            reordered[i * 3 + k] = indices[order[i] * 3 + k];
+    }
+    indices.swap(reordered);
+
+    for (Meshlet& meshlet : meshlets)
+    {
+        const Meshlet bounds =
+            ComputeBounds(vertices, std::span<uint32 const>(indices).subspan(meshlet.firstIndex, meshlet.triangleCount * 3));
+        meshlet.center = bounds.center;
+        meshlet.radius = bounds.radius;
+        meshlet.coneApex = bounds.coneApex;
+        meshlet.coneAxis = bounds.coneAxis;
+        meshlet.coneCutoff = bounds.coneCutoff;
+    }
+    return meshlets;
+}
+
+} // namespace MeshletBuilder
+} // namespace Riley
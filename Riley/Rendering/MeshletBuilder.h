@@ -0,0 +1,46 @@
+#pragma once
+#include "Components.h"
+
+namespace Riley
+{
+
+// A cluster of at most MeshletBuilder::MAX_TRIANGLES triangles, stored as one contiguous range of the submesh's indices.
+// Bounds are in model space.
+struct Meshlet
+{
+    Vector3 center;
+    float radius = 0.0f;
+    // backfacing for every eye with dot(normalize(coneApex - eye), coneAxis) >= coneCutoff, above 1 when never
+    Vector3 coneApex;
+    float coneCutoff = 2.0f;
+    Vector3 coneAxis;
+    uint32 firstIndex = 0; // relative to the startIndexLoc of the submesh
+    uint16 triangleCount = 0;
+    uint16 vertexCount = 0;
+};
+
+// The clusters of a submesh, shared between the submeshes of a model like MeshCollider
+struct COMPONENT MeshClusters
+{
+    std::shared_ptr<std::vector<Meshlet>> meshlets = nullptr;
+    uint32 firstMeshlet = 0;
+    uint32 meshletCount = 0;
+};
+
+/* Meshlets are grown greedily from a seed triangle, preferring connected triangles that add few new vertices, sit
+ * close to the meshlet and face the same way, so their bounding spheres stay tight and their normal cones narrow.
+ * Seeds follow the triangle order, which keeps the vertex cache order of MeshOptimizer mostly intact. */
+namespace MeshletBuilder
+{
+inline constexpr uint32 MAX_VERTICES = 64;
+inline constexpr uint32 MAX_TRIANGLES = 124;
+
+// Reorders indices so every meshlet is a contiguous range of it, the vertices are left untouched
+std::vector<Meshlet> Build(std::vector<Vertex> const& vertices, std::vector<uint32>& indices, uint32 maxVertices = MAX_VERTICES,
+                           uint32 maxTriangles = MAX_TRIANGLES);
+
+// Bounding sphere and normal cone of a triangle list
+Meshlet ComputeBounds(std::vector<Vertex> const& vertices, std::span<uint32 const> indices);
+} // namespace MeshletBuilder
+
+} // namespace Riley
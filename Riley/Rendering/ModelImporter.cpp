@@ -4,8 +4,14 @@
 #include "../Math/ComputeVectors.h"
 #include "../Utilities/FileUtil.h"
 #include "../Utilities/StringUtil.h"
+#include "CookedMesh.h"
 #include "Enums.h"
+#include "MeshOptimizer.h"
 #include "ModelLoader.h"
+#include "OcclusionCuller.h"
+#include "VertexCompression.h"
+#include <execution>
+#include <numeric>
 
 namespace Riley
 {
@@ -14,7 +20,69 @@ ModelImporter::ModelImporter(ID3D11Device* device, entt::registry& reg) : m_devi
 {
 }
 
-std::vector<entt::entity> ModelImporter::LoadSquare(const Vector3& pos, const float& scale, const float& rotate)
+ModelImporter::~ModelImporter()
+{
+    for (auto const& [key, geometry] : m_primitives)
+        g_GeometryArena.Release(geometry.mesh.geometry);
+}
+
+static MeshCollider CreateCollider(std::span<Vector3 const> positions, std::span<uint32 const> indices)
+{
+    MeshCollider collider{};
+    collider.positions = std::make_shared<std::vector<Vector3>>(positions.begin(), positions.end());
+    collider.indices = std::make_shared<std::vector<uint32>>(indices.begin(), indices.end());
+    collider.vertexCount = static_cast<uint32>(positions.size());
+    collider.indexCount = static_cast<uint32>(indices.size());
+    return collider;
+}
+
+static MeshCollider CreateCollider(std::vector<Vertex> const& vertices, std::vector<uint32> const& indices)
+{
+    std::vector<Vector3> positions;
+    positions.reserve(vertices.size());
+    for (Vertex const& v : vertices)
+        positions.push_back(v.position);
+    return CreateCollider(positions, indices);
+}
+
+// Logs the round trip error of an encoded vertex set, exceeding the bounds means the encoders are broken
+static void CheckCompressionError(std::string const& name, CompressionError const& error)
+{
+    if (error.WithinBounds())
+        return;
+    RI_WARN("{:s} vertex compression error out of bounds : position {:g}, normal {:g}, tangent {:g}, texcoord {:g}, {:d} flips",
+            name, error.position, error.normal, error.tangent, error.texcoord, error.bitangentFlips);
+    assert(false && "Vertex compression error out of bounds!");
+}
+
+PrimitiveGeometry const& ModelImporter::GetPrimitive(PrimitiveKey const& key, PrimitiveBuilder const& build)
+{
+    auto [it, inserted] = m_primitives.try_emplace(key);
+    if (inserted)
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32> indices;
+        build(vertices, indices);
+
+        PrimitiveGeometry& geometry = it->second;
+        geometry.bounds = AABBFromVertices(vertices);
+        std::vector<CompactVertex> compactVertices;
+        VertexCompression::Encode(vertices, geometry.bounds, compactVertices);
+        CheckCompressionError("Primitive", VertexCompression::MeasureError(vertices, compactVertices, geometry.bounds));
+
+        // the cache keeps its own reference, primitives outlive the entities using them
+        geometry.mesh.geometry = g_GeometryArena.Allocate(compactVertices, indices);
+        g_GeometryArena.AddRef(geometry.mesh.geometry);
+        geometry.mesh.positionBias = VertexCompression::PositionBias(geometry.bounds);
+        geometry.mesh.positionScale = VertexCompression::PositionScale(geometry.bounds);
+        geometry.mesh.vertexCount = static_cast<uint32>(vertices.size());
+        geometry.mesh.indexCount = static_cast<uint32>(indices.size());
+        geometry.collider = CreateCollider(vertices, indices);
+    }
+    return it->second;
+}
+
+static void SquareGeometry(float scale, std::vector<Vertex>& vertices, std::vector<uint32>& indices)
 {
     std::vector<Vector3> positions;
     std::vector<Vector3> normals;
@@ -37,8 +105,7 @@ std::vector<entt::entity> ModelImporter::LoadSquare(const Vector3& pos, const fl
     texcoords.push_back(Vector2(1.0f, 1.0f));
     texcoords.push_back(Vector2(0.0f, 1.0f));
 
-    std::vector<Vertex> vertices;
-    std::vector<uint32> indices{0, 1, 2, 0, 2, 3};
+    indices = {0, 1, 2, 0, 2, 3};
 
     ComputeAndSetTangets(indices, vertices);
 
@@ -53,15 +120,16 @@ std::vector<entt::entity> ModelImporter::LoadSquare(const Vector3& pos, const fl
 
         vertices.push_back(v);
     }
+}
 
-    entt::entity entity = m_registry.create();
-    Mesh mesh{};
-    mesh.vertexBuffer = std::make_shared<DXBuffer>(m_device, VertexBufferDesc(vertices.size(), sizeof(Vertex)), vertices.data());
-    mesh.indexBuffer = std::make_shared<DXBuffer>(m_device, IndexBufferDesc(indices.size(), false), indices.data());
-    mesh.vertexCount = static_cast<uint32>(vertices.size());
-    mesh.indexCount = static_cast<uint32>(indices.size());
+std::vector<entt::entity> ModelImporter::LoadSquare(const Vector3& pos, const float& scale, const float& rotate)
+{
+    PrimitiveGeometry const& geometry = GetPrimitive({PrimitiveType::Square, scale, 0.0f, 0, 0},
+                                                     [&](auto& vertices, auto& indices) { SquareGeometry(scale, vertices, indices); });
 
-    m_registry.emplace<Mesh>(entity, mesh);
+    entt::entity entity = m_registry.create();
+    m_registry.emplace<Mesh>(entity, geometry.mesh);
+    m_registry.emplace<MeshCollider>(entity, geometry.collider);
 
     Material material{};
     material.diffuse = Vector3(0.2f, 0.3f, 0.2f);
@@ -78,12 +146,11 @@ std::vector<entt::entity> ModelImporter::LoadSquare(const Vector3& pos, const fl
     m_registry.emplace<Transform>(entity, transform);
 
     AABB aabb{};
-    BoundingBox _boundingBox = AABBFromVertices(vertices);
+    BoundingBox _boundingBox = geometry.bounds;
     aabb.orginalBox = _boundingBox;
     _boundingBox.Transform(_boundingBox, transform.currentTransform);
     aabb.boundingBox = _boundingBox;
     aabb.isDrawAABB = false;
-    aabb.UpdateBuffer(m_device);
 
     m_registry.emplace<AABB>(entity, aabb);
 
@@ -94,13 +161,8 @@ std::vector<entt::entity> ModelImporter::LoadSquare(const Vector3& pos, const fl
     return std::vector{entity};
 }
 
-std::vector<entt::entity> ModelImporter::LoadBox(const Vector3& pos, const float& scale /*1.0f*/,
-                                                 const Vector2& texScale /*Vector2(1.0f)*/, bool invertNormals /*false*/)
+static void BoxGeometry(float scale, float flag, std::vector<Vertex>& vertices, std::vector<uint32>& indices)
 {
-    float flag = 1.0f;
-    if (invertNormals)
-        flag *= -1.0f;
-
     std::vector<Vector3> positions;
     std::vector<Vector3> normals;
     std::vector<Vector2> texcoords;
@@ -191,7 +253,7 @@ std::vector<entt::entity> ModelImporter::LoadBox(const Vector3& pos, const float
     texcoords.push_back(Vector2(1.0f, 1.0f));
     texcoords.push_back(Vector2(0.0f, 1.0f));
 
-    std::vector<uint32> indices{
+    indices = {
         0,  1,  2,  0,  2,  3,  // À­¸é
         4,  5,  6,  4,  6,  7,  // ¾Æ·§
         8,  9,  10, 8,  10, 11, // ¾Õ¸é
@@ -200,8 +262,6 @@ std::vector<entt::entity> ModelImporter::LoadBox(const Vector3& pos, const float
         20, 21, 22, 20, 22, 23  // ¿À¸¥
     };
 
-    std::vector<Vertex> vertices;
-
     ComputeAndSetTangets(indices, vertices);
 
     for (uint32 i = 0; i < positions.size(); ++i)
@@ -215,15 +275,22 @@ std::vector<entt::entity> ModelImporter::LoadBox(const Vector3& pos, const float
 
         vertices.push_back(v);
     }
+}
 
-    entt::entity entity = m_registry.create();
-    Mesh mesh{};
-    mesh.vertexBuffer = std::make_shared<DXBuffer>(m_device, VertexBufferDesc(vertices.size(), sizeof(Vertex)), vertices.data());
-    mesh.indexBuffer = std::make_shared<DXBuffer>(m_device, IndexBufferDesc(indices.size(), false), indices.data());
-    mesh.vertexCount = static_cast<uint32>(vertices.size());
-    mesh.indexCount = static_cast<uint32>(indices.size());
+std::vector<entt::entity> ModelImporter::LoadBox(const Vector3& pos, const float& scale /*1.0f*/,
+                                                 const Vector2& texScale /*Vector2(1.0f)*/, bool invertNormals /*false*/)
+{
+    float flag = 1.0f;
+    if (invertNormals)
+        flag *= -1.0f;
+
+    PrimitiveGeometry const& geometry =
+        GetPrimitive({PrimitiveType::Box, scale, flag, 0, 0},
+                     [&](auto& vertices, auto& indices) { BoxGeometry(scale, flag, vertices, indices); });
 
-    m_registry.emplace<Mesh>(entity, mesh);
+    entt::entity entity = m_registry.create();
+    m_registry.emplace<Mesh>(entity, geometry.mesh);
+    m_registry.emplace<MeshCollider>(entity, geometry.collider);
 
     Material material{};
     material.shader = ShaderProgram::ForwardPhong;
@@ -238,12 +305,11 @@ std::vector<entt::entity> ModelImporter::LoadBox(const Vector3& pos, const float
     m_registry.emplace<Transform>(entity, transform);
 
     AABB aabb{};
-    BoundingBox _boundingBox = AABBFromVertices(vertices);
+    BoundingBox _boundingBox = geometry.bounds;
     aabb.orginalBox = _boundingBox;
     _boundingBox.Transform(_boundingBox, transform.currentTransform);
     aabb.boundingBox = _boundingBox;
     aabb.isDrawAABB = false;
-    aabb.UpdateBuffer(m_device);
     m_registry.emplace<AABB>(entity, aabb);
 
     Tag tag{};
@@ -253,13 +319,12 @@ std::vector<entt::entity> ModelImporter::LoadBox(const Vector3& pos, const float
     return std::vector<entt::entity>{entity};
 }
 
-std::vector<entt::entity> ModelImporter::LoadSqhere(Vector3 const& pos, float const& radius /*= 1.0f*/, uint32 numSlices,
-                                                    uint32 numStacks)
+static void SphereGeometry(float radius, uint32 numSlices, uint32 numStacks, std::vector<Vertex>& vertices,
+                           std::vector<uint32>& indices)
 {
     const float dTheta = -XM_2PI / float(numSlices);
     const float dPhi = -XM_PI / float(numStacks);
 
-    std::vector<Vertex> vertices;
     for (uint32 j = 0; j <= numStacks; ++j)
     {
         Vector3 stackStartPoint = Vector3::Transform(Vector3(0.0f, -radius, 0.0f), Matrix::CreateRotationZ(dPhi * float(j)));
@@ -281,8 +346,6 @@ std::vector<entt::entity> ModelImporter::LoadSqhere(Vector3 const& pos, float co
         }
     }
 
-    std::vector<uint32> indices;
-
     for (uint32 j = 0; j < numStacks; ++j)
     {
         const int offset = (numSlices + 1) * j;
@@ -297,15 +360,18 @@ std::vector<entt::entity> ModelImporter::LoadSqhere(Vector3 const& pos, float co
             indices.push_back(offset + i + 1);
         }
     }
+}
 
-    entt::entity entity = m_registry.create();
-    Mesh mesh{};
-    mesh.vertexBuffer = std::make_shared<DXBuffer>(m_device, VertexBufferDesc(vertices.size(), sizeof(Vertex)), vertices.data());
-    mesh.indexBuffer = std::make_shared<DXBuffer>(m_device, IndexBufferDesc(indices.size(), false), indices.data());
-    mesh.vertexCount = static_cast<uint32>(vertices.size());
-    mesh.indexCount = static_cast<uint32>(indices.size());
+std::vector<entt::entity> ModelImporter::LoadSqhere(Vector3 const& pos, float const& radius /*= 1.0f*/, uint32 numSlices,
+                                                    uint32 numStacks)
+{
+    PrimitiveGeometry const& geometry =
+        GetPrimitive({PrimitiveType::Sphere, radius, 0.0f, numSlices, numStacks},
+                     [&](auto& vertices, auto& indices) { SphereGeometry(radius, numSlices, numStacks, vertices, indices); });
 
-    m_registry.emplace<Mesh>(entity, mesh);
+    entt::entity entity = m_registry.create();
+    m_registry.emplace<Mesh>(entity, geometry.mesh);
+    m_registry.emplace<MeshCollider>(entity, geometry.collider);
 
     Material material{};
     material.shader = ShaderProgram::ForwardPhong;
@@ -320,12 +386,11 @@ std::vector<entt::entity> ModelImporter::LoadSqhere(Vector3 const& pos, float co
     m_registry.emplace<Transform>(entity, transform);
 
     AABB aabb{};
-    BoundingBox _boundingBox = AABBFromVertices(vertices);
+    BoundingBox _boundingBox = geometry.bounds;
     aabb.orginalBox = _boundingBox;
     _boundingBox.Transform(_boundingBox, transform.currentTransform);
     aabb.boundingBox = _boundingBox;
     aabb.isDrawAABB = false;
-    aabb.UpdateBuffer(m_device);
     m_registry.emplace<AABB>(entity, aabb);
 
     Tag tag{};
@@ -353,12 +418,11 @@ std::vector<entt::entity> ModelImporter::LoadLight(Light& lightData, LightMesh m
                                                     {{0.5f * size, 0.5f * size, 0.0f}, {1.0f, 1.0f}},
                                                     {{-0.5f * size, 0.5f * size, 0.0f}, {0.0f, 1.0f}}};
 
-        std::vector<uint16> indices{0, 2, 1, 2, 0, 3};
+        std::vector<uint32> indices{0, 2, 1, 2, 0, 3};
 
         Mesh mesh{};
-        mesh.vertexBuffer =
-            std::make_shared<DXBuffer>(m_device, VertexBufferDesc(vertices.size(), sizeof(SimpleVertex)), vertices.data());
-        mesh.indexBuffer = std::make_shared<DXBuffer>(m_device, IndexBufferDesc(indices.size(), true), indices.data());
+        mesh.geometry = g_GeometryArena.Allocate(vertices, indices);
+        mesh.vertexCount = static_cast<uint32>(vertices.size());
         mesh.indexCount = static_cast<uint32>(indices.size());
         m_registry.emplace<Mesh>(light, mesh);
 
@@ -453,9 +517,7 @@ std::vector<entt::entity> ModelImporter::LoadLight(Light& lightData, LightMesh m
                                     12, 13, 14, 12, 14, 15, 16, 17, 18, 16, 18, 19, 20, 21, 22, 20, 22, 23};
 
         Mesh mesh{};
-        mesh.vertexBuffer =
-            std::make_shared<DXBuffer>(m_device, VertexBufferDesc(vertices.size(), sizeof(SimpleVertex)), vertices.data());
-        mesh.indexBuffer = std::make_shared<DXBuffer>(m_device, IndexBufferDesc(indices.size(), false), indices.data());
+        mesh.geometry = g_GeometryArena.Allocate(vertices, indices);
         mesh.vertexCount = static_cast<uint32>(vertices.size());
         mesh.indexCount = static_cast<uint32>(indices.size());
         m_registry.emplace<Mesh>(light, mesh);
@@ -496,130 +558,379 @@ std::vector<entt::entity> ModelImporter::LoadModel(std::string basePath, std::st
 {
     timer.Mark();
 
-    std::vector<Model> model = ReadFromFile(basePath, filename, revertNormals);
+    const std::string cachePath = CookedMesh::CachePath(filename);
+    const uint64 key = CookedMesh::Key(basePath, filename, revertNormals, m_nativeGLTF, m_lodSettings);
+    {
+        // the geometry is uploaded straight from the mapped pages, the mapping is closed once the entities exist
+        MappedFile cache(cachePath);
+        if (std::optional<CookedModelView> cooked = CookedMesh::Read(cache, key))
+        {
+            std::vector<entt::entity> entities = CreateModel(filename, *cooked, pos, scale);
+            RI_INFO("{:s} {:f}s loaded from {:s}, {:f}s when it was imported", filename, timer.MarkInSeconds(), cachePath,
+                    cooked->importSeconds);
+            return entities;
+        }
+    }
 
-    std::vector<Vertex> vertices{};
-    std::vector<uint32> indices{};
-    std::vector<entt::entity> entities{};
-    std::unordered_map<std::string, std::vector<entt::entity>> meshNameToEntitiesMap;
+    const CookedModel model = ImportModel(basePath, filename, revertNormals);
+    const CookedModelView view = model.View(timer.PeekInSeconds());
+    if (!CookedMesh::Write(cachePath, key, view))
+        RI_WARN("{:s} could not be cooked to {:s}", filename, cachePath);
 
-    uint32 vertexOffset = 0;
-    uint32 indexOffset = 0;
+    std::vector<entt::entity> entities = CreateModel(filename, view, pos, scale);
+    RI_INFO("{:s} {:f}s sucessfully loaded!", filename, timer.MarkInSeconds());
+    return entities;
+}
 
-    entities.reserve(model.size());
-    for (auto& data : model)
-    {
-        std::vector<entt::entity>& meshEntities = meshNameToEntitiesMap[data.meshData.name];
-        assert(data.meshData.indices.size() >= 0);
-        // vertices = data.meshData.vertices;
-        // indices = data.meshData.indices;
+CookedModel ModelImporter::ImportModel(std::string const& basePath, std::string const& filename, bool revertNormals) const
+{
+    SceneData scene = ReadFromFile(basePath, filename, revertNormals, m_nativeGLTF);
+    std::vector<Model>& model = scene.meshes;
 
+    // what a submesh produces before its place in the streams of the model is known
+    struct ImportedSubmesh
+    {
+        VertexCacheStats cacheBefore;
+        VertexCacheStats cacheAfter;
+        size_t importedVertices = 0;
+        std::vector<MeshLODLevel> lodLevels;
+        std::vector<Meshlet> meshlets;
+        BoundingBox bounds;
+    };
+    std::vector<ImportedSubmesh> imported(model.size());
+    std::vector<uint32> submeshIds(model.size());
+    std::iota(submeshIds.begin(), submeshIds.end(), 0u);
+
+    // submeshes share nothing while they are processed, each one runs through every pass on its own
+    std::for_each(std::execution::par, submeshIds.begin(), submeshIds.end(), [&](uint32 i) {
+        MeshData& data = model[i].meshData;
+        ImportedSubmesh& result = imported[i];
         // ComputeAndSetNormals(indices, vertices);
-        ComputeAndSetTangets(data.meshData.indices, data.meshData.vertices);
+        ComputeAndSetTangets(data.indices, data.vertices);
+
+        result.importedVertices = data.vertices.size();
+        result.cacheBefore = MeshOptimizer::AnalyzeVertexCache(data.indices, static_cast<uint32>(data.vertices.size()));
+        result.cacheAfter = MeshOptimizer::Optimize(data.vertices, data.indices);
+        result.lodLevels = MeshSimplifier::BuildLODChain(data.vertices, data.indices, m_lodSettings);
+        // regroups the base triangles into meshlets, the levels above were simplified from the same triangles
+        result.meshlets = MeshletBuilder::Build(data.vertices, data.indices);
+        result.bounds = AABBFromVertices(data.vertices);
+    });
+
+    // the streams are laid out up front so the submeshes can be written into them in parallel
+    CookedModel cooked{};
+    cooked.submeshes.resize(model.size());
+    uint32 vertexCount = 0;
+    uint32 indexCount = 0;
+    uint32 meshletCount = 0;
+    for (uint32 i = 0; i < model.size(); ++i)
+    {
+        MeshData const& data = model[i].meshData;
+        MaterialData const& materialData = model[i].materialData;
+        ImportedSubmesh const& result = imported[i];
+        CookedSubmesh& submesh = cooked.submeshes[i];
+
+        submesh.name = data.name;
+        submesh.albedoTexture = materialData.albeodoTextureFilename;
+        submesh.normalTexture = materialData.normalTextureFilename;
+        submesh.metallicRoughnessTexture = materialData.pbrMetallicRoughnessTextureFilename;
+        submesh.emissiveTexture = materialData.emissiveTextureFilename;
+        submesh.alphaMode = materialData.alphaMode;
+        submesh.alphaCutoff = materialData.alphaCutoff;
+        submesh.doubleSided = materialData.doubleSided;
+
+        // each submesh is quantized to its own bounds, its indices stay relative to baseVertexLoc so a model whose
+        // submeshes have at most 65536 vertices each gets 16 bit indices
+        const Vector3 positionBias = VertexCompression::PositionBias(result.bounds);
+        const Vector3 positionScale = VertexCompression::PositionScale(result.bounds);
+        submesh.positionBias = {positionBias.x, positionBias.y, positionBias.z};
+        submesh.positionScale = {positionScale.x, positionScale.y, positionScale.z};
+        submesh.boundsCenter = {result.bounds.Center.x, result.bounds.Center.y, result.bounds.Center.z};
+        submesh.boundsExtents = {result.bounds.Extents.x, result.bounds.Extents.y, result.bounds.Extents.z};
 
-        entt::entity e = m_registry.create();
-        entities.push_back(e);
-        meshEntities.push_back(e);
+        // TODO
+        // Vertex, index 버퍼 생성을 최소화하기 위해 offset을 이용하였다.
+        // DirectX11에서 vertexBuffer 생성하는 속도가 느리지 않기 때문에 오히려 느려지는 현상이 발생함.
+        // 스폰자 모델 기준 약 0.06초 정도가 차이나는 것으로 보인다. (insert 사용)
 
-        Material material{};
-        if (!data.materialData.albeodoTextureFilename.empty())
+        submesh.vertexCount = static_cast<uint32>(data.vertices.size());
+        submesh.indexCount = static_cast<uint32>(data.indices.size());
+        submesh.baseVertexLoc = vertexCount;
+        submesh.startIndexLoc = indexCount;
+        submesh.firstMeshlet = meshletCount;
+        submesh.meshletCount = static_cast<uint32>(result.meshlets.size());
+        vertexCount += submesh.vertexCount;
+        indexCount += submesh.indexCount;
+        meshletCount += submesh.meshletCount;
+
+        // the levels follow the base indices of the submesh
+        for (MeshLODLevel const& level : result.lodLevels)
+        {
+            MeshLOD& lod = submesh.lods[submesh.lodCount++];
+            lod.startIndexLoc = indexCount;
+            lod.indexCount = static_cast<uint32>(level.indices.size());
+            lod.error = level.error;
+            indexCount += lod.indexCount;
+        }
+    }
+    cooked.nodes.reserve(scene.nodes.size());
+    for (NodeData const& node : scene.nodes)
+    {
+        CookedNode& cookedNode = cooked.nodes.emplace_back();
+        cookedNode.name = node.name;
+        cookedNode.parent = node.parent;
+        std::copy_n(&node.transform._11, 16, cookedNode.transform.begin());
+        cookedNode.submeshes = node.meshes;
+    }
+    cooked.vertices.resize(vertexCount);
+    cooked.positions.resize(vertexCount);
+    cooked.indices.resize(indexCount);
+    cooked.meshlets.resize(meshletCount);
+
+    std::for_each(std::execution::par, submeshIds.begin(), submeshIds.end(), [&](uint32 i) {
+        MeshData const& data = model[i].meshData;
+        ImportedSubmesh const& result = imported[i];
+        CookedSubmesh const& submesh = cooked.submeshes[i];
+
+        std::span<CompactVertex> compactVertices = std::span(cooked.vertices).subspan(submesh.baseVertexLoc, submesh.vertexCount);
+        for (uint32 v = 0; v < submesh.vertexCount; ++v)
+        {
+            compactVertices[v] = VertexCompression::Encode(data.vertices[v], result.bounds);
+            cooked.positions[submesh.baseVertexLoc + v] = data.vertices[v].position;
+        }
+        CheckCompressionError(data.name, VertexCompression::MeasureError(data.vertices, compactVertices, result.bounds));
+
+        std::copy(data.indices.begin(), data.indices.end(), cooked.indices.begin() + submesh.startIndexLoc);
+        for (uint32 level = 0; level < submesh.lodCount; ++level)
+        {
+            std::vector<uint32> const& levelIndices = result.lodLevels[level].indices;
+            std::copy(levelIndices.begin(), levelIndices.end(), cooked.indices.begin() + submesh.lods[level].startIndexLoc);
+        }
+        std::copy(result.meshlets.begin(), result.meshlets.end(), cooked.meshlets.begin() + submesh.firstMeshlet);
+    });
+
+    VertexCacheStats cacheBefore{};
+    VertexCacheStats cacheAfter{};
+    size_t importedVertices = 0;
+    // per level over all submeshes, the worst errors are relative to the radius of their submesh. A submesh that could
+    // not be simplified keeps its triangles in the statistics of the coarser levels as it is drawn at full resolution there
+    std::array<size_t, MAX_MESH_LODS + 1> lodTriangles{};
+    std::array<float, MAX_MESH_LODS + 1> lodErrors{};
+    std::array<float, MAX_MESH_LODS + 1> lodHausdorff{};
+    for (uint32 i = 0; i < model.size(); ++i)
+    {
+        ImportedSubmesh const& result = imported[i];
+        CookedSubmesh const& submesh = cooked.submeshes[i];
+        cacheBefore += result.cacheBefore;
+        cacheAfter += result.cacheAfter;
+        importedVertices += result.importedVertices;
+
+        lodTriangles[0] += submesh.indexCount / 3;
+        for (uint32 level = 0; level < MAX_MESH_LODS; ++level)
+        {
+            if (level < submesh.lodCount)
+            {
+                lodErrors[level + 1] = std::max(lodErrors[level + 1], result.lodLevels[level].error);
+                lodHausdorff[level + 1] = std::max(lodHausdorff[level + 1], result.lodLevels[level].hausdorff);
+            }
+            lodTriangles[level + 1] +=
+                (submesh.lodCount > 0 ? submesh.lods[std::min(level, submesh.lodCount - 1)].indexCount : submesh.indexCount) / 3;
+        }
+    }
+
+    RI_INFO("{:s} optimized : {:d} -> {:d} vertices, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", filename, importedVertices,
+            cooked.vertices.size(), cacheBefore.ACMR(), cacheAfter.ACMR(), cacheBefore.ATVR(), cacheAfter.ATVR());
+    uint32 meshletCones = 0;
+    for (Meshlet const& meshlet : cooked.meshlets)
+        meshletCones += meshlet.coneCutoff <= 1.0f;
+    RI_INFO("{:s} meshlets : {:d}, {:.1f} triangles on average, {:d} with a normal cone", filename, cooked.meshlets.size(),
+            lodTriangles[0] / std::max<double>(cooked.meshlets.size(), 1.0), meshletCones);
+    for (uint32 level = 1; level <= MAX_MESH_LODS; ++level)
+    {
+        const double percent = 100.0 * lodTriangles[level] / std::max<size_t>(lodTriangles[0], 1);
+        if (m_lodSettings.measureError)
+        {
+            RI_INFO("{:s} LOD{:d} : {:d} triangles ({:.1f}%), error {:.4f}, hausdorff {:.4f}", filename, level, lodTriangles[level],
+                    percent, lodErrors[level], lodHausdorff[level]);
+        }
+        else
+        {
+            RI_INFO("{:s} LOD{:d} : {:d} triangles ({:.1f}%), error {:.4f}", filename, level, lodTriangles[level], percent,
+                    lodErrors[level]);
+        }
+    }
+    return cooked;
+}
+
+std::vector<entt::entity> ModelImporter::CreateModel(std::string const& filename, CookedModelView const& model, Vector3 const& pos,
+                                                     float scale)
+{
+    const size_t submeshCount = model.submeshes.size();
+    const GeometryHandle geometry =
+        g_GeometryArena.Allocate(model.vertices.data(), static_cast<uint32>(model.vertices.size()), sizeof(CompactVertex),
+                                 model.indices.data(), static_cast<uint32>(model.indices.size()));
+    RI_INFO("{:s} vertices : {:d} x {:d} bytes compressed from {:d} bytes", filename, model.vertices.size(), sizeof(CompactVertex),
+            sizeof(Vertex));
+
+    // the collider keeps the whole model too, each submesh addresses it with the same offsets as its Mesh
+    MeshCollider modelCollider = CreateCollider(model.positions, model.indices);
+    auto modelMeshlets = std::make_shared<std::vector<Meshlet>>(model.meshlets.begin(), model.meshlets.end());
+
+    // the components of a submesh are built once and copied to every node that draws it
+    std::vector<Material> materials(submeshCount);
+    std::vector<AABB> aabbs(submeshCount);
+    std::vector<Mesh> meshes(submeshCount);
+    std::vector<MeshCollider> colliders(submeshCount, modelCollider);
+    std::vector<MeshClusters> clusters(submeshCount);
+    for (size_t i = 0; i < submeshCount; ++i)
+    {
+        CookedSubmesh const& submesh = model.submeshes[i];
+
+        Material& material = materials[i];
+        if (!submesh.albedoTexture.empty())
         {
-            material.albedoTexture = g_TextureManager.LoadTexture(ToWideString(data.materialData.albeodoTextureFilename));
+            material.albedoTexture = g_TextureManager.LoadTexture(ToWideString(submesh.albedoTexture));
         }
-        if (!data.materialData.normalTextureFilename.empty())
+        if (!submesh.normalTexture.empty())
         {
-            material.normalTexture = g_TextureManager.LoadTexture(ToWideString(data.materialData.normalTextureFilename));
+            material.normalTexture = g_TextureManager.LoadTexture(ToWideString(submesh.normalTexture));
         }
-        if (!data.materialData.pbrMetallicRoughnessTextureFilename.empty())
+        if (!submesh.metallicRoughnessTexture.empty())
         {
-            material.metallicRoughnessTexture =
-                g_TextureManager.LoadTexture(ToWideString(data.materialData.pbrMetallicRoughnessTextureFilename));
+            material.metallicRoughnessTexture = g_TextureManager.LoadTexture(ToWideString(submesh.metallicRoughnessTexture));
         }
-        if (!data.materialData.emissiveTextureFilename.empty())
+        if (!submesh.emissiveTexture.empty())
         {
-            material.emissiveTexture = g_TextureManager.LoadTexture(ToWideString(data.materialData.emissiveTextureFilename));
+            material.emissiveTexture = g_TextureManager.LoadTexture(ToWideString(submesh.emissiveTexture));
         }
 
         material.shader = ShaderProgram::GBuffer;
-        material.alphaCutoff = data.materialData.alphaCutoff;
-        material.doubleSided = data.materialData.doubleSided;
-        if (data.materialData.alphaMode == "OPAQUE")
+        material.alphaCutoff = submesh.alphaCutoff;
+        material.doubleSided = submesh.doubleSided;
+        if (submesh.alphaMode == "OPAQUE")
         {
             material.alphaMode = MaterialAlphaMode::Opaque;
             material.shader = ShaderProgram::GBuffer;
         }
         // TODO : Add the AlphaMode(Blend, Mask)
 
-        m_registry.emplace<Material>(e, material);
-
-        Mesh meshComponent{};
-        meshComponent.indexCount = static_cast<uint32>(data.meshData.indices.size());
-        meshComponent.vertexCount = static_cast<uint32>(data.meshData.vertices.size());
-        meshComponent.baseVertexLoc = vertexOffset;
-        meshComponent.startIndexLoc = indexOffset;
-
-        // TODO
-        // Vertex, index 버퍼 생성을 최소화하기 위해 offset을 이용하였다.
-        // DirectX11에서 vertexBuffer 생성하는 속도가 느리지 않기 때문에 오히려 느려지는 현상이 발생함.
-        // 스폰자 모델 기준 약 0.06초 정도가 차이나는 것으로 보인다. (insert 사용)
-
-        vertexOffset += meshComponent.vertexCount;
-        indexOffset += meshComponent.indexCount;
-        vertices.insert(vertices.end(), std::make_move_iterator(data.meshData.vertices.begin()),
-                        std::make_move_iterator(data.meshData.vertices.end()));
-        indices.insert(indices.end(), std::make_move_iterator(data.meshData.indices.begin()),
-                       std::make_move_iterator(data.meshData.indices.end()));
-
-        m_registry.emplace<Mesh>(e, meshComponent);
-
-        // TODO : transform을 node 형태로 만들어, 모델의 각 부위의 matrix를 변환시킬 수 있도록 설정.
-        Transform transform{};
-        transform.currentTransform = Matrix::CreateScale(scale) * Matrix::CreateTranslation(pos);
-        transform.startingTransform = Matrix::CreateScale(scale) * Matrix::CreateTranslation(pos);
-
-        m_registry.emplace<Transform>(e, transform);
-
-        AABB aabb{};
-        BoundingBox _boundingBox = AABBFromVertices(data.meshData.vertices);
-        aabb.orginalBox = _boundingBox;
-        _boundingBox.Transform(_boundingBox, transform.currentTransform);
-        aabb.boundingBox = _boundingBox;
-        aabb.isDrawAABB = false;
-        aabb.UpdateBuffer(m_device);
-        m_registry.emplace<AABB>(e, aabb);
+        aabbs[i].orginalBox = BoundingBox(XMFLOAT3(submesh.boundsCenter.data()), XMFLOAT3(submesh.boundsExtents.data()));
+        aabbs[i].isDrawAABB = false;
+
+        // copies of it take no reference, the ones in the registry take it on construction
+        Mesh& mesh = meshes[i];
+        mesh.geometry = geometry;
+        mesh.indexCount = submesh.indexCount;
+        mesh.vertexCount = submesh.vertexCount;
+        mesh.baseVertexLoc = submesh.baseVertexLoc;
+        mesh.startIndexLoc = submesh.startIndexLoc;
+        mesh.positionBias = Vector3(submesh.positionBias.data());
+        mesh.positionScale = Vector3(submesh.positionScale.data());
+        mesh.lods = submesh.lods;
+        mesh.lodCount = submesh.lodCount;
+
+        MeshCollider& collider = colliders[i];
+        collider.vertexCount = mesh.vertexCount;
+        collider.indexCount = mesh.indexCount;
+        collider.startIndexLoc = mesh.startIndexLoc;
+        collider.baseVertexLoc = mesh.baseVertexLoc;
+
+        clusters[i] = MeshClusters{modelMeshlets, submesh.firstMeshlet, submesh.meshletCount};
     }
 
-    entt::entity root = m_registry.create();
-    m_registry.emplace<Transform>(root);
-    m_registry.emplace<Tag>(root, filename);
-
-    Relationship relationship;
-    relationship.childrenCount = static_cast<uint32>(entities.size());
-    assert(relationship.childrenCount <= Relationship::MAX_CHILDREN);
-    for (size_t i = 0; i < relationship.childrenCount; ++i)
+    // the root places the model, every node below it keeps its transform relative to its parent. A node drawing one
+    // submesh carries it, the submeshes of a node drawing several get a child each
+    Transform rootTransform{};
+    rootTransform.currentTransform = Matrix::CreateScale(scale) * Matrix::CreateTranslation(pos);
+    rootTransform.startingTransform = rootTransform.currentTransform;
+
+    std::vector<entt::entity> nodeEntities(model.nodes.size());
+    std::vector<Transform> nodeTransforms(model.nodes.size());
+    std::vector<Tag> nodeTags(model.nodes.size());
+    std::vector<Matrix> nodeWorlds(model.nodes.size());
+    m_registry.create(nodeEntities.begin(), nodeEntities.end());
+
+    std::vector<uint32> entityNodes; // one per drawn submesh
+    std::vector<uint32> entitySubmeshes;
+    for (uint32 i = 0; i < model.nodes.size(); ++i)
     {
-        relationship.children[i] = entities[i];
+        CookedNode const& node = model.nodes[i];
+        Transform& transform = nodeTransforms[i];
+        transform.currentTransform = Matrix(node.transform.data());
+        transform.startingTransform = transform.currentTransform;
+        nodeWorlds[i] = transform.currentTransform *
+                        (node.parent != CookedNode::NO_PARENT ? nodeWorlds[node.parent] : rootTransform.currentTransform);
+        nodeTags[i].name = node.name.empty() ? filename + " node" + std::to_string(i) : node.name;
+
+        for (uint32 submesh : node.submeshes)
+        {
+            entityNodes.push_back(i);
+            entitySubmeshes.push_back(submesh);
+        }
     }
-    m_registry.emplace<Relationship>(root, relationship);
 
-    size_t i = 0;
+    std::vector<entt::entity> entities(entitySubmeshes.size());
+    std::vector<entt::entity> primitiveEntities; // children of the nodes drawing several submeshes
+    std::vector<entt::entity> primitiveParents;
+    std::vector<Tag> primitiveTags;
+    // the components are inserted per type, each pool grows once instead of once per entity
+    std::vector<Material> entityMaterials;
+    std::vector<AABB> entityAABBs;
+    std::vector<Mesh> entityMeshes;
+    std::vector<MeshCollider> entityColliders;
+    std::vector<MeshClusters> entityClusters;
+    for (size_t i = 0; i < entities.size(); ++i)
+    {
+        const uint32 node = entityNodes[i];
+        const uint32 submesh = entitySubmeshes[i];
+        if (model.nodes[node].submeshes.size() == 1)
+        {
+            entities[i] = nodeEntities[node];
+        }
+        else
+        {
+            entities[i] = m_registry.create();
+            primitiveEntities.push_back(entities[i]);
+            primitiveParents.push_back(nodeEntities[node]);
+            std::string const& name = model.submeshes[submesh].name;
+            primitiveTags.push_back(Tag{name.empty() ? filename + " submesh" + std::to_string(submesh) : name});
+        }
+
+        entityMaterials.push_back(materials[submesh]);
+        AABB& aabb = entityAABBs.emplace_back(aabbs[submesh]);
+        aabb.orginalBox.Transform(aabb.boundingBox, nodeWorlds[node]);
+        entityMeshes.push_back(meshes[submesh]);
+        entityColliders.push_back(colliders[submesh]);
+        entityClusters.push_back(clusters[submesh]);
+    }
 
-    std::shared_ptr<DXBuffer> vertexBuffer =
-        std::make_shared<DXBuffer>(m_device, VertexBufferDesc(vertices.size(), sizeof(Vertex)), vertices.data());
-    std::shared_ptr<DXBuffer> indexBuffer =
-        std::make_shared<DXBuffer>(m_device, IndexBufferDesc(indices.size(), false), indices.data());
+    m_registry.insert<Transform>(nodeEntities.begin(), nodeEntities.end(), nodeTransforms.begin());
+    m_registry.insert<Tag>(nodeEntities.begin(), nodeEntities.end(), nodeTags.begin());
+    m_registry.insert<Relationship>(nodeEntities.begin(), nodeEntities.end());
+    m_registry.insert<Transform>(primitiveEntities.begin(), primitiveEntities.end(), Transform{});
+    m_registry.insert<Tag>(primitiveEntities.begin(), primitiveEntities.end(), primitiveTags.begin());
+    m_registry.insert<Relationship>(primitiveEntities.begin(), primitiveEntities.end());
+    m_registry.insert<Material>(entities.begin(), entities.end(), entityMaterials.begin());
+    m_registry.insert<AABB>(entities.begin(), entities.end(), entityAABBs.begin());
+    m_registry.insert<Mesh>(entities.begin(), entities.end(), entityMeshes.begin());
+    m_registry.insert<MeshCollider>(entities.begin(), entities.end(), entityColliders.begin());
+    m_registry.insert<MeshClusters>(entities.begin(), entities.end(), entityClusters.begin());
 
-    for (entt::entity& e : entities)
+    entt::entity root = m_registry.create();
+    m_registry.emplace<Transform>(root, rootTransform);
+    m_registry.emplace<Tag>(root, filename);
+    m_registry.emplace<Relationship>(root);
+    for (uint32 i = 0; i < model.nodes.size(); ++i)
     {
-        auto& mesh = m_registry.get<Mesh>(e);
-        mesh.vertexBuffer = vertexBuffer;
-        mesh.indexBuffer = indexBuffer;
-
-        m_registry.emplace<Tag>(e, filename + " submesh" + std::to_string(i++));
-        m_registry.emplace<Relationship>(e, root);
+        const uint32 parent = model.nodes[i].parent;
+        AttachChild(m_registry, parent != CookedNode::NO_PARENT ? nodeEntities[parent] : root, nodeEntities[i]);
     }
+    for (size_t i = 0; i < primitiveEntities.size(); ++i)
+        AttachChild(m_registry, primitiveParents[i], primitiveEntities[i]);
+    OcclusionCuller::SelectOccluders(m_registry, entities);
 
-    RI_INFO("{:s} {:f}s sucessfully loaded!", filename, timer.MarkInSeconds());
+    RI_INFO("{:s} instancing : {:d} submeshes drawn by {:d} entities under {:d} nodes", filename, submeshCount, entities.size(),
+            nodeEntities.size());
     return entities;
 }
 
@@ -3,6 +3,9 @@
 #include "../Core/Rendering.h"
 #include "../Math/MathTypes.h"
 #include "Components.h"
+#include "CookedMesh.h"
+#include <functional>
+#include <tuple>
 
 /** About std::optional
  * https://occamsrazr.net/tt/317
@@ -18,12 +21,19 @@ enum class LightMesh
     Cube
 };
 
+struct PrimitiveGeometry
+{
+    Mesh mesh;
+    MeshCollider collider;
+    BoundingBox bounds;
+};
+
 class ModelImporter
 {
   public:
     ModelImporter() = default;
     ModelImporter(ID3D11Device* device, entt::registry& reg);
-    ~ModelImporter() = default;
+    ~ModelImporter();
 
     std::vector<entt::entity> LoadSquare(const Vector3& pos, const float& scale = 1.0f, const float& rotate = 0.0f);
 
@@ -33,11 +43,49 @@ class ModelImporter
     std::vector<entt::entity> LoadSqhere(Vector3 const& pos, float const& radius = 1.0f, uint32 numSlices = 20, uint32 numStacks = 5);
 
     std::vector<entt::entity> LoadLight(Light& lightData, LightMesh meshType, const float& scale = 1.0f);
+    // The first load of a model cooks it into CookedMesh::CACHE_DIRECTORY, later loads of the same source files with the
+    // same options map the cooked file instead of importing it again
     std::vector<entt::entity> LoadModel(std::string basePath, std::string filename, bool revertNormals = false,
                                         const Vector3& pos = Vector3(0.0f), const float& scale = 1.0f);
 
+    // LODs built for the submeshes of the models loaded from now on
+    void SetLODSettings(LODChainSettings const& settings)
+    {
+        m_lodSettings = settings;
+    }
+    // Off reads glTF files with assimp like any other format, to compare the two
+    void SetNativeGLTF(bool nativeGLTF)
+    {
+        m_nativeGLTF = nativeGLTF;
+    }
+
+  private:
+    enum class PrimitiveType : uint8
+    {
+        Square,
+        Box,
+        Sphere
+    };
+    using PrimitiveKey = std::tuple<PrimitiveType, float, float, uint32, uint32>;
+    using PrimitiveBuilder = std::function<void(std::vector<Vertex>&, std::vector<uint32>&)>;
+
+    // Builds the buffers of a primitive the first time its parameters are seen
+    PrimitiveGeometry const& GetPrimitive(PrimitiveKey const& key, PrimitiveBuilder const& build);
+
+    // Runs assimp and every import pass over a model, what comes out is what the cache stores
+    CookedModel ImportModel(std::string const& basePath, std::string const& filename, bool revertNormals) const;
+    // Uploads a cooked model and mirrors its node tree under a root entity, returns one entity per drawn submesh. Nodes
+    // drawing the same submesh share its geometry
+    std::vector<entt::entity> CreateModel(std::string const& filename, CookedModelView const& model, Vector3 const& pos, float scale);
+
   private:
     entt::registry& m_registry;
     ID3D11Device* m_device;
+    // Entities loaded with the same parameters share one geometry allocation, which is what lets
+    // the renderer batch them into instanced draws
+    std::map<PrimitiveKey, PrimitiveGeometry> m_primitives;
+    // imports measure the Hausdorff distance of their levels for the log, only cooking a model pays for it
+    LODChainSettings m_lodSettings{.measureError = true};
+    bool m_nativeGLTF = true;
 };
 } // namespace Riley
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include "../Math/ComputeVectors.h"
 #include "../Utilities/FileUtil.h"
 #include "../Utilities/StringUtil.h"
+#include <execution>
+#include <numeric>
 
 namespace Riley
 {
@@ -27,12 +29,21 @@ void ModelLoader::Load(std::string basePath, std::string filename, bool revertNo
     }
     else
     {
-        Matrix tr = Matrix::Identity;
-        ProcessNode(pScene->mRootNode, pScene, tr);
+        meshIds.assign(pScene->mNumMeshes, UINT32_MAX);
+        ProcessNode(pScene->mRootNode, pScene, NodeData::NO_PARENT);
+
+        // the scene is only read from here on, every mesh referenced by a node is extracted once on its own
+        std::vector<uint32> jobs(uniqueMeshes.size());
+        std::iota(jobs.begin(), jobs.end(), 0u);
+        model.resize(uniqueMeshes.size());
+        std::for_each(std::execution::par, jobs.begin(), jobs.end(),
+                      [&](uint32 i) { model[i] = ProcessMesh(uniqueMeshes[i], pScene); });
+        uniqueMeshes.clear();
+        meshIds.clear();
     }
 }
 
-void ModelLoader::ProcessNode(aiNode* node, const aiScene* scene, Matrix tr)
+void ModelLoader::ProcessNode(aiNode* node, const aiScene* scene, uint32 parent)
 {
     Matrix m;
     ai_real* temp = &node->mTransformation.a1;
@@ -41,35 +52,33 @@ void ModelLoader::ProcessNode(aiNode* node, const aiScene* scene, Matrix tr)
     {
         mTemp[t] = float(temp[t]);
     }
-    m = m.Transpose() * tr;
 
+    const uint32 nodeId = static_cast<uint32>(nodes.size());
+    NodeData& data = nodes.emplace_back();
+    data.name = node->mName.C_Str();
+    data.transform = m.Transpose();
+    data.parent = parent;
     for (uint32 i = 0; i < node->mNumMeshes; ++i)
     {
-        aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-        auto newModelData = this->ProcessMesh(mesh, scene);
-
-        for (auto& v : newModelData.meshData.vertices)
+        // a mesh drawn by several nodes is kept once, the nodes refer to it
+        uint32& meshId = meshIds[node->mMeshes[i]];
+        if (meshId == UINT32_MAX)
         {
-            v.position = Vector3::Transform(v.position, m);
+            meshId = static_cast<uint32>(uniqueMeshes.size());
+            uniqueMeshes.push_back(scene->mMeshes[node->mMeshes[i]]);
         }
-
-        model.push_back(newModelData);
-
-        // for (uint32 i = 0; i < node->mNumChildren; ++i)
-        //{
-        //     this->ProcessNode(node->mChildren[i], scene, m);
-        // }
+        data.meshes.push_back(meshId);
     }
     if (node->mNumChildren > 0)
     {
         for (uint32 i = 0; i < node->mNumChildren; ++i)
         {
-            this->ProcessNode(node->mChildren[i], scene, m);
+            this->ProcessNode(node->mChildren[i], scene, nodeId);
         }
     }
 }
 
-Model ModelLoader::ProcessMesh(aiMesh* mesh, const aiScene* scene)
+Model ModelLoader::ProcessMesh(aiMesh* mesh, const aiScene* scene) const
 {
     std::vector<Vertex> vertices;
     std::vector<uint32> indices;
@@ -136,8 +145,8 @@ Model ModelLoader::ProcessMesh(aiMesh* mesh, const aiScene* scene)
     }
 
     Model newModelData;
-    newModelData.meshData.vertices = vertices;
-    newModelData.meshData.indices = indices;
+    newModelData.meshData.vertices = std::move(vertices);
+    newModelData.meshData.indices = std::move(indices);
     newModelData.meshData.name = mesh->mName.C_Str();
 
     if (mesh->mMaterialIndex >= 0)
@@ -175,7 +184,7 @@ Model ModelLoader::ProcessMesh(aiMesh* mesh, const aiScene* scene)
     return newModelData;
 }
 
-std::string ModelLoader::ReadFilename(aiMaterial* material, aiTextureType type)
+std::string ModelLoader::ReadFilename(aiMaterial* material, aiTextureType type) const
 {
     if (material->GetTextureCount(type) > 0)
     {
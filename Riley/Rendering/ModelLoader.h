@@ -1,14 +1,17 @@
 #pragma once
 
-#include <assimp\Importer.hpp>
-#include <assimp\pbrmaterial.h>
-#include <assimp\postprocess.h>
-#include <assimp\scene.h>
+#include <assimp/Importer.hpp>
+#include <assimp/pbrmaterial.h>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <execution>
 #include <iostream>
+#include <numeric>
 #include <string>
 #include <vector>
 
-#include "Components.h"
+#include "../Utilities/FileUtil.h"
+#include "GLTFLoader.h"
 #include "MeshData.h"
 
 namespace Riley
@@ -22,57 +25,94 @@ class ModelLoader
     ModelLoader() = default;
     ~ModelLoader() = default;
 
+    // Meshes are extracted in parallel once the node tree has been walked, model keeps the order they were first met in
     void Load(std::string basePath, std::string filename, bool revertNormals = false);
-    void ProcessNode(aiNode* node, const aiScene* scene, Matrix tr);
-    Model ProcessMesh(aiMesh* mesh, const aiScene* scene);
-    std::string ReadFilename(aiMaterial* material, aiTextureType type);
+    // Appends node and its children to nodes, the meshes they draw are collected once however often they are referenced
+    void ProcessNode(aiNode* node, const aiScene* scene, uint32 parent);
+    Model ProcessMesh(aiMesh* mesh, const aiScene* scene) const;
+    std::string ReadFilename(aiMaterial* material, aiTextureType type) const;
 
   public:
     std::string basePath;
     std::vector<Model> model;
+    std::vector<NodeData> nodes;
     bool m_isGLTF = false;
     bool m_revertNormals = false;
+
+  private:
+    std::vector<aiMesh*> uniqueMeshes;
+    std::vector<uint32> meshIds; // scene mesh index -> index in model
 };
 
-// Normalize Vertex coordinates
-static std::vector<Model> ReadFromFile(std::string basePath, std::string filename, bool revertNormals)
+// Fits the model into the unit cube around the origin. The vertices stay in the space of their mesh, the normalization
+// is folded into the transforms of the top level nodes. glTF files are read by GLTFLoader unless nativeGLTF is off,
+// assimp reads every other format and the glTF files GLTFLoader leaves to it
+static SceneData ReadFromFile(std::string basePath, std::string filename, bool revertNormals, bool nativeGLTF = true)
 {
     using namespace DirectX;
 
-    ModelLoader modelLoader;
-    modelLoader.Load(basePath, filename, revertNormals);
-    std::vector<Model> model = modelLoader.model;
+    RileyTimer readTimer;
+    std::optional<SceneData> native =
+        nativeGLTF && GetExtension(filename) == ".gltf" ? GLTFLoader::Load(basePath, filename, revertNormals) : std::nullopt;
+    SceneData scene{};
+    if (native)
+    {
+        scene = std::move(*native);
+    }
+    else
+    {
+        ModelLoader modelLoader;
+        modelLoader.Load(basePath, filename, revertNormals);
+        scene = SceneData{std::move(modelLoader.model), std::move(modelLoader.nodes)};
+    }
+    RI_INFO("{:s} read in {:f}s by {:s}", filename, readTimer.MarkInSeconds(), native ? "GLTFLoader" : "assimp");
 
-    Vector3 vmin(1000, 1000, 1000);
-    Vector3 vmax(-1000, -1000, -1000);
-    for (auto& data : model)
+    std::vector<Matrix> nodeWorlds(scene.nodes.size());
+    std::vector<std::pair<uint32, uint32>> instances; // node, mesh
+    for (uint32 i = 0; i < scene.nodes.size(); ++i)
     {
-        for (auto& v : data.meshData.vertices)
+        NodeData const& node = scene.nodes[i];
+        nodeWorlds[i] = node.parent != NodeData::NO_PARENT ? node.transform * nodeWorlds[node.parent] : node.transform;
+        for (uint32 mesh : node.meshes)
+            instances.emplace_back(i, mesh);
+    }
+
+    // bounds per instance in parallel, reduced to the bounds of the model
+    std::vector<std::pair<Vector3, Vector3>> instanceBounds(instances.size(),
+                                                            {Vector3(1000, 1000, 1000), Vector3(-1000, -1000, -1000)});
+    std::vector<uint32> instanceIds(instances.size());
+    std::iota(instanceIds.begin(), instanceIds.end(), 0u);
+    std::for_each(std::execution::par, instanceIds.begin(), instanceIds.end(), [&](uint32 i) {
+        auto& [vmin, vmax] = instanceBounds[i];
+        Matrix const& world = nodeWorlds[instances[i].first];
+        for (auto& v : scene.meshes[instances[i].second].meshData.vertices)
         {
-            vmin.x = XMMin(vmin.x, v.position.x);
-            vmin.y = XMMin(vmin.y, v.position.y);
-            vmin.z = XMMin(vmin.z, v.position.z);
-            vmax.x = XMMax(vmax.x, v.position.x);
-            vmax.y = XMMax(vmax.y, v.position.y);
-            vmax.z = XMMax(vmax.z, v.position.z);
+            const Vector3 position = Vector3::Transform(v.position, world);
+            vmin = Vector3::Min(vmin, position);
+            vmax = Vector3::Max(vmax, position);
         }
+    });
+
+    Vector3 vmin(1000, 1000, 1000);
+    Vector3 vmax(-1000, -1000, -1000);
+    for (auto const& [instanceMin, instanceMax] : instanceBounds)
+    {
+        vmin = Vector3::Min(vmin, instanceMin);
+        vmax = Vector3::Max(vmax, instanceMax);
     }
 
     float dx = vmax.x - vmin.x, dy = vmax.y - vmin.y, dz = vmax.z - vmin.z;
     float dl = XMMax(XMMax(dx, dy), dz);
     float cx = (vmax.x + vmin.x) * 0.5f, cy = (vmax.y + vmin.y) * 0.5f, cz = (vmax.z + vmin.z) * 0.5f;
 
-    for (auto& data : model)
+    const Matrix normalize = Matrix::CreateTranslation(-cx, -cy, -cz) * Matrix::CreateScale(1.0f / dl);
+    for (NodeData& node : scene.nodes)
     {
-        for (auto& v : data.meshData.vertices)
-        {
-            v.position.x = (v.position.x - cx) / dl;
-            v.position.y = (v.position.y - cy) / dl;
-            v.position.z = (v.position.z - cz) / dl;
-        }
+        if (node.parent == NodeData::NO_PARENT)
+            node.transform *= normalize;
     }
 
-    return model;
+    return scene;
 }
 
 } // namespace Riley
\ No newline at end of file
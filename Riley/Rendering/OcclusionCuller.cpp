@@ -0,0 +1,385 @@
+#include "OcclusionCuller.h"
+#include "../Core/Rendering.h"
+#include <execution>
+#include <numeric>
+#include <xmmintrin.h>
+
+namespace Riley
+{
+
+static constexpr uint32 TILES_X = OcclusionCuller::WIDTH / OcclusionCuller::TILE_SIZE;
+static constexpr uint32 TILES_Y = OcclusionCuller::HEIGHT / OcclusionCuller::TILE_SIZE;
+static constexpr uint32 BLOCKS_X = OcclusionCuller::WIDTH / OcclusionCuller::BLOCK_SIZE;
+static constexpr uint32 BLOCKS_Y = OcclusionCuller::HEIGHT / OcclusionCuller::BLOCK_SIZE;
+static_assert(OcclusionCuller::WIDTH % OcclusionCuller::TILE_SIZE == 0 && OcclusionCuller::HEIGHT % OcclusionCuller::TILE_SIZE == 0);
+static_assert(OcclusionCuller::TILE_SIZE % OcclusionCuller::BLOCK_SIZE == 0 && OcclusionCuller::BLOCK_SIZE % 4 == 0);
+
+// vertices closer than this in clip w are behind or on the near plane, their triangles are dropped as occluders
+static constexpr float NEAR_W = 1e-3f;
+static constexpr uint32 MAX_OCCLUDERS_PER_MODEL = 64;
+static constexpr float OCCLUDER_AREA_RATIO = 0.02f;
+
+static float SurfaceArea(DirectX::BoundingBox const& box)
+{
+    const Vector3 e = box.Extents;
+    return 8.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+}
+
+OcclusionCuller::OcclusionCuller()
+    : depth(WIDTH * HEIGHT, 1.0f), blockMax(BLOCKS_X * BLOCKS_Y, 1.0f), bins(TILES_X * TILES_Y), tileIndices(TILES_X * TILES_Y)
+{
+    std::iota(tileIndices.begin(), tileIndices.end(), 0u);
+}
+
+void OcclusionCuller::Cull(entt::registry const& reg, TransformSystem const& transforms, Matrix const& viewProjRow,
+                           VisibilityBits& visibility)
+{
+    RileyTimer cullTimer;
+    cullTimer.Mark();
+
+    Clear(viewProjRow);
+    RenderOccluders(reg, transforms, visibility);
+    stats.rasterMs = cullTimer.MarkInSeconds() * 1000.0f;
+
+    BoundsSoA const& bounds = transforms.Bounds();
+    uint32 visibleBefore = 0, visibleAfter = 0;
+    for (uint64 word : visibility)
+        visibleBefore += static_cast<uint32>(std::popcount(word));
+
+    // one word per job, so workers never touch the same bits
+    std::vector<uint32> words(visibility.size());
+    std::iota(words.begin(), words.end(), 0u);
+    std::for_each(std::execution::par, words.begin(), words.end(), [&](uint32 w) {
+        for (uint64 bits = visibility[w]; bits; bits &= bits - 1)
+        {
+            const uint32 slot = w * 64 + static_cast<uint32>(std::countr_zero(bits));
+            const DirectX::BoundingBox box(Vector3(bounds.centerX[slot], bounds.centerY[slot], bounds.centerZ[slot]),
+                                           Vector3(bounds.extentX[slot], bounds.extentY[slot], bounds.extentZ[slot]));
+            if (IsOccluded(box))
+                visibility[w] &= ~(1ull << (slot & 63));
+        }
+    });
+
+    for (uint64 word : visibility)
+        visibleAfter += static_cast<uint32>(std::popcount(word));
+
+    stats.candidates = visibleBefore;
+    stats.rejected = visibleBefore - visibleAfter;
+    stats.testMs = cullTimer.MarkInSeconds() * 1000.0f;
+}
+
+void OcclusionCuller::Clear(Matrix const& viewProjRow)
+{
+    viewProj = viewProjRow;
+    std::fill(depth.begin(), depth.end(), 1.0f);
+    std::fill(blockMax.begin(), blockMax.end(), 1.0f);
+    triangles.clear();
+    for (auto& bin : bins)
+        bin.clear();
+    stats = OcclusionStats{};
+}
+
+void OcclusionCuller::RenderOccluders(entt::registry const& reg, TransformSystem const& transforms, VisibilityBits const& visibility)
+{
+    auto occluderView = reg.view<Occluder, MeshCollider>();
+    for (auto e : occluderView)
+    {
+        const uint32 slot = transforms.GetSlot(e);
+        if (slot == TransformSystem::INVALID_SLOT || !IsVisible(visibility, slot))
+            continue;
+
+        MeshCollider const& collider = occluderView.get<MeshCollider>(e);
+        const Matrix worldViewProj = transforms.Get(e).world.Transpose() * viewProj;
+
+        clipVertices.resize(collider.vertexCount);
+        DirectX::XMVector3TransformStream(clipVertices.data(), sizeof(Vector4), collider.positions->data() + collider.baseVertexLoc,
+                                          sizeof(Vector3), collider.vertexCount, worldViewProj);
+
+        std::vector<uint32> const& indices = *collider.indices;
+        for (uint32 i = collider.startIndexLoc; i + 2 < collider.startIndexLoc + collider.indexCount; i += 3)
+            AddTriangle(clipVertices[indices[i]], clipVertices[indices[i + 1]], clipVertices[indices[i + 2]]);
+
+        ++stats.occluders;
+    }
+    stats.occluderTriangles = static_cast<uint32>(triangles.size());
+
+    std::for_each(std::execution::par, tileIndices.begin(), tileIndices.end(), [this](uint32 tile) { RasterizeTile(tile); });
+}
+
+// Projects the triangle, sets up its edge and depth planes and bins it into every tile its bounds touch
+void OcclusionCuller::AddTriangle(Vector4 const& c0, Vector4 const& c1, Vector4 const& c2)
+{
+    if (c0.w < NEAR_W || c1.w < NEAR_W || c2.w < NEAR_W)
+        return;
+
+    Vector3 v[3];
+    Vector4 const* clip[3] = {&c0, &c1, &c2};
+    for (uint32 i = 0; i < 3; ++i)
+    {
+        const float invW = 1.0f / clip[i]->w;
+        v[i] = Vector3((clip[i]->x * invW * 0.5f + 0.5f) * WIDTH, (0.5f - clip[i]->y * invW * 0.5f) * HEIGHT, clip[i]->z * invW);
+    }
+
+    // both windings are rasterized, flip to make the area positive
+    float area = (v[2].x - v[0].x) * (v[1].y - v[0].y) - (v[2].y - v[0].y) * (v[1].x - v[0].x);
+    if (area < 0.0f)
+    {
+        std::swap(v[1], v[2]);
+        area = -area;
+    }
+    if (area < 1e-6f)
+        return;
+
+    const float minX = std::min({v[0].x, v[1].x, v[2].x});
+    const float maxX = std::max({v[0].x, v[1].x, v[2].x});
+    const float minY = std::min({v[0].y, v[1].y, v[2].y});
+    const float maxY = std::max({v[0].y, v[1].y, v[2].y});
+    if (maxX < 0.0f || maxY < 0.0f || minX >= WIDTH || minY >= HEIGHT)
+        return;
+
+    ScreenTriangle tri;
+    for (uint32 i = 0; i < 3; ++i)
+    {
+        // E(p) = A * x + B * y + C, positive inside. Pixels are only written when the whole pixel is inside,
+        // i.e. E at the pixel center is at least half the pixel's extent along the edge normal
+        Vector3 const& a = v[i];
+        Vector3 const& b = v[(i + 1) % 3];
+        tri.edgeA[i] = b.y - a.y;
+        tri.edgeB[i] = a.x - b.x;
+        tri.edgeC[i] = -a.x * tri.edgeA[i] - a.y * tri.edgeB[i] - 0.5f * (fabs(tri.edgeA[i]) + fabs(tri.edgeB[i]));
+    }
+
+    // z = z0 + (z1 - z0) * l1 + (z2 - z0) * l2, with l1 from the edge 2->0 and l2 from the edge 0->1
+    const float invArea = 1.0f / area;
+    const float dz1 = (v[1].z - v[0].z) * invArea;
+    const float dz2 = (v[2].z - v[0].z) * invArea;
+    auto EdgeAt = [](float A, float B, Vector3 const& a) { return -a.x * A - a.y * B; };
+    tri.zA = dz1 * tri.edgeA[2] + dz2 * tri.edgeA[0];
+    tri.zB = dz1 * tri.edgeB[2] + dz2 * tri.edgeB[0];
+    tri.zC = v[0].z + dz1 * EdgeAt(tri.edgeA[2], tri.edgeB[2], v[2]) + dz2 * EdgeAt(tri.edgeA[0], tri.edgeB[0], v[0]);
+    // store the farthest depth the triangle reaches inside a pixel, never more than its farthest vertex
+    tri.zC += 0.5f * (fabs(tri.zA) + fabs(tri.zB));
+    tri.zMax = std::max({v[0].z, v[1].z, v[2].z});
+
+    tri.minX = std::max(0, static_cast<int32>(minX));
+    tri.minY = std::max(0, static_cast<int32>(minY));
+    tri.maxX = std::min(static_cast<int32>(WIDTH) - 1, static_cast<int32>(maxX));
+    tri.maxY = std::min(static_cast<int32>(HEIGHT) - 1, static_cast<int32>(maxY));
+
+    const uint32 index = static_cast<uint32>(triangles.size());
+    triangles.push_back(tri);
+    for (int32 ty = tri.minY / TILE_SIZE; ty <= tri.maxY / static_cast<int32>(TILE_SIZE); ++ty)
+    {
+        for (int32 tx = tri.minX / TILE_SIZE; tx <= tri.maxX / static_cast<int32>(TILE_SIZE); ++tx)
+            bins[ty * TILES_X + tx].push_back(index);
+    }
+}
+
+void OcclusionCuller::RasterizeTile(uint32 tile)
+{
+    const int32 tileX0 = static_cast<int32>((tile % TILES_X) * TILE_SIZE);
+    const int32 tileY0 = static_cast<int32>((tile / TILES_X) * TILE_SIZE);
+    const int32 tileX1 = tileX0 + TILE_SIZE - 1;
+    const int32 tileY1 = tileY0 + TILE_SIZE - 1;
+    const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+    for (uint32 index : bins[tile])
+    {
+        ScreenTriangle const& tri = triangles[index];
+        const int32 x0 = std::max(tileX0, tri.minX) & ~3;
+        const int32 x1 = std::min(tileX1, tri.maxX);
+        const int32 y0 = std::max(tileY0, tri.minY);
+        const int32 y1 = std::min(tileY1, tri.maxY);
+
+        const __m128 A0 = _mm_set1_ps(tri.edgeA[0]), A1 = _mm_set1_ps(tri.edgeA[1]), A2 = _mm_set1_ps(tri.edgeA[2]);
+        const __m128 zA = _mm_set1_ps(tri.zA);
+        const __m128 zMax = _mm_set1_ps(tri.zMax);
+        const __m128 zero = _mm_setzero_ps();
+
+        for (int32 y = y0; y <= y1; ++y)
+        {
+            const float py = y + 0.5f;
+            const __m128 rowE0 = _mm_set1_ps(tri.edgeB[0] * py + tri.edgeC[0]);
+            const __m128 rowE1 = _mm_set1_ps(tri.edgeB[1] * py + tri.edgeC[1]);
+            const __m128 rowE2 = _mm_set1_ps(tri.edgeB[2] * py + tri.edgeC[2]);
+            const __m128 rowZ = _mm_set1_ps(tri.zB * py + tri.zC);
+            float* row = &depth[y * WIDTH];
+
+            for (int32 x = x0; x <= x1; x += 4)
+            {
+                const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+                const __m128 e0 = _mm_add_ps(_mm_mul_ps(A0, px), rowE0);
+                const __m128 e1 = _mm_add_ps(_mm_mul_ps(A1, px), rowE1);
+                const __m128 e2 = _mm_add_ps(_mm_mul_ps(A2, px), rowE2);
+                const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+                if (_mm_movemask_ps(inside) == 0)
+                    continue;
+
+                const __m128 z = _mm_min_ps(_mm_add_ps(_mm_mul_ps(zA, px), rowZ), zMax);
+                const __m128 old = _mm_loadu_ps(row + x);
+                const __m128 result = _mm_or_ps(_mm_and_ps(inside, _mm_min_ps(old, z)), _mm_andnot_ps(inside, old));
+                _mm_storeu_ps(row + x, result);
+            }
+        }
+    }
+
+    // refresh the block maxima covered by this tile
+    for (int32 by = tileY0; by <= tileY1; by += BLOCK_SIZE)
+    {
+        for (int32 bx = tileX0; bx <= tileX1; bx += BLOCK_SIZE)
+        {
+            __m128 blockDepth = _mm_setzero_ps();
+            for (int32 y = by; y < by + static_cast<int32>(BLOCK_SIZE); ++y)
+            {
+                for (int32 x = bx; x < bx + static_cast<int32>(BLOCK_SIZE); x += 4)
+                    blockDepth = _mm_max_ps(blockDepth, _mm_loadu_ps(&depth[y * WIDTH + x]));
+            }
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, blockDepth);
+            blockMax[(by / BLOCK_SIZE) * BLOCKS_X + bx / BLOCK_SIZE] = std::max({lanes[0], lanes[1], lanes[2], lanes[3]});
+        }
+    }
+}
+
+bool OcclusionCuller::IsOccluded(DirectX::BoundingBox const& box) const
+{
+    Vector3 corners[DirectX::BoundingBox::CORNER_COUNT];
+    box.GetCorners(corners);
+    Vector4 clip[DirectX::BoundingBox::CORNER_COUNT];
+    DirectX::XMVector3TransformStream(clip, sizeof(Vector4), corners, sizeof(Vector3), DirectX::BoundingBox::CORNER_COUNT, viewProj);
+
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, minZ = FLT_MAX;
+    for (Vector4 const& c : clip)
+    {
+        // crossing the near plane, treat as visible
+        if (c.w < NEAR_W)
+            return false;
+
+        const float invW = 1.0f / c.w;
+        const float x = (c.x * invW * 0.5f + 0.5f) * WIDTH;
+        const float y = (0.5f - c.y * invW * 0.5f) * HEIGHT;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        minZ = std::min(minZ, c.z * invW);
+    }
+    if (maxX < 0.0f || maxY < 0.0f || minX >= WIDTH || minY >= HEIGHT)
+        return false;
+
+    const int32 px0 = std::max(0, static_cast<int32>(minX));
+    const int32 py0 = std::max(0, static_cast<int32>(minY));
+    const int32 px1 = std::min(static_cast<int32>(WIDTH) - 1, static_cast<int32>(maxX));
+    const int32 py1 = std::min(static_cast<int32>(HEIGHT) - 1, static_cast<int32>(maxY));
+
+    for (int32 by = py0 / BLOCK_SIZE; by <= py1 / static_cast<int32>(BLOCK_SIZE); ++by)
+    {
+        for (int32 bx = px0 / BLOCK_SIZE; bx <= px1 / static_cast<int32>(BLOCK_SIZE); ++bx)
+        {
+            // everything in this block is nearer than the box
+            if (blockMax[by * BLOCKS_X + bx] < minZ)
+                continue;
+
+            const int32 y0 = std::max(py0, by * static_cast<int32>(BLOCK_SIZE));
+            const int32 y1 = std::min(py1, (by + 1) * static_cast<int32>(BLOCK_SIZE) - 1);
+            const int32 x0 = std::max(px0, bx * static_cast<int32>(BLOCK_SIZE));
+            const int32 x1 = std::min(px1, (bx + 1) * static_cast<int32>(BLOCK_SIZE) - 1);
+            for (int32 y = y0; y <= y1; ++y)
+            {
+                for (int32 x = x0; x <= x1; ++x)
+                {
+                    if (depth[y * WIDTH + x] >= minZ)
+                        return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void OcclusionCuller::SelectOccluders(entt::registry& reg, std::span<entt::entity const> entities)
+{
+    DirectX::BoundingBox modelBox;
+    std::vector<std::pair<float, entt::entity>> candidates;
+    for (entt::entity e : entities)
+    {
+        auto aabb = reg.try_get<AABB>(e);
+        if (!aabb || !reg.all_of<MeshCollider>(e))
+            continue;
+
+        if (candidates.empty())
+            modelBox = aabb->orginalBox;
+        else
+            DirectX::BoundingBox::CreateMerged(modelBox, modelBox, aabb->orginalBox);
+        candidates.emplace_back(SurfaceArea(aabb->orginalBox), e);
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](auto const& lhs, auto const& rhs) { return lhs.first > rhs.first; });
+
+    const float minArea = SurfaceArea(modelBox) * OCCLUDER_AREA_RATIO;
+    uint32 count = 0;
+    for (auto const& [area, e] : candidates)
+    {
+        if (area < minArea || count == MAX_OCCLUDERS_PER_MODEL)
+            break;
+        reg.emplace_or_replace<Occluder>(e);
+        ++count;
+    }
+    RI_INFO("Occluders : {:d} of {:d} submeshes", count, candidates.size());
+}
+
+void RunOcclusionBenchmark(entt::registry const& reg, TransformSystem const& transforms)
+{
+    static constexpr uint32 frameCount = 240;
+
+    auto aabbView = reg.view<AABB>();
+    if (aabbView.empty())
+        return;
+
+    DirectX::BoundingBox sceneBox = aabbView.get<AABB>(*aabbView.begin()).boundingBox;
+    for (auto e : aabbView)
+        DirectX::BoundingBox::CreateMerged(sceneBox, sceneBox, aabbView.get<AABB>(e).boundingBox);
+
+    // walk along the longer horizontal axis near the floor, sweeping the view left and right
+    const Vector3 center = sceneBox.Center;
+    const Vector3 extents = sceneBox.Extents;
+    const bool alongX = extents.x >= extents.z;
+    const Vector3 axis = alongX ? Vector3(1.0f, 0.0f, 0.0f) : Vector3(0.0f, 0.0f, 1.0f);
+    const float length = alongX ? extents.x : extents.z;
+    const float height = center.y - extents.y * 0.7f;
+    const Matrix proj = DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(60.0f), 16.0f / 9.0f, 0.05f, extents.Length() * 2.0f);
+
+    OcclusionCuller culler;
+    VisibilityBits visibility;
+    uint64 frustumVisible = 0, rejected = 0, triangleCount = 0;
+    float rasterMs = 0.0f, testMs = 0.0f;
+
+    for (uint32 frame = 0; frame < frameCount; ++frame)
+    {
+        const float t = static_cast<float>(frame) / (frameCount - 1);
+        const Vector3 eye = Vector3(center.x, height, center.z) + axis * (length * 0.9f * (2.0f * t - 1.0f));
+        const float yaw = DirectX::XM_PIDIV4 * sinf(t * DirectX::XM_2PI * 3.0f);
+        const Vector3 forward = Vector3::Transform(axis, Matrix::CreateRotationY(yaw));
+        const Matrix viewProj = DirectX::XMMatrixLookToLH(eye, forward, Vector3::Up) * proj;
+
+        DirectX::BoundingFrustum frustum(proj);
+        frustum.Transform(frustum, DirectX::XMMatrixLookToLH(eye, forward, Vector3::Up).Invert());
+        Culling::FrustumCullSIMD(transforms.Bounds(), CullPlanes::FromFrustum(frustum), visibility);
+
+        culler.Cull(reg, transforms, viewProj, visibility);
+        OcclusionStats const& stats = culler.Stats();
+        frustumVisible += stats.candidates;
+        rejected += stats.rejected;
+        triangleCount += stats.occluderTriangles;
+        rasterMs += stats.rasterMs;
+        testMs += stats.testMs;
+    }
+
+    RI_INFO("Occlusion path ({:d} frames, {:d}x{:d}) : {:.1f} frustum visible, {:.1f} rejected ({:.1f}%) per frame", frameCount,
+            OcclusionCuller::WIDTH, OcclusionCuller::HEIGHT, static_cast<float>(frustumVisible) / frameCount,
+            static_cast<float>(rejected) / frameCount, frustumVisible ? 100.0f * rejected / frustumVisible : 0.0f);
+    RI_INFO("    {:.0f} occluder triangles, raster {:.3f}ms, test {:.3f}ms per frame", static_cast<float>(triangleCount) / frameCount,
+            rasterMs / frameCount, testMs / frameCount);
+}
+
+} // namespace Riley
@@ -0,0 +1,82 @@
+#pragma once
+#include "TransformSystem.h"
+
+namespace Riley
+{
+
+// Entities whose triangles are rasterized as occluders, picked at import by SelectOccluders
+struct COMPONENT Occluder
+{
+};
+
+struct OcclusionStats
+{
+    uint32 occluders = 0;
+    uint32 occluderTriangles = 0;
+    uint32 candidates = 0;
+    uint32 rejected = 0;
+    float rasterMs = 0.0f;
+    float testMs = 0.0f;
+
+    float RejectedRatio() const
+    {
+        return candidates ? static_cast<float>(rejected) / candidates : 0.0f;
+    }
+};
+
+/* CPU occlusion culling against a low resolution depth buffer.
+ * Occluder triangles are binned into screen tiles and the tiles are rasterized in parallel with SSE, 4 pixels at a time.
+ * Rasterization is inner conservative (only fully covered pixels are written) and stores the farthest depth of the
+ * triangle over each pixel, so a box is only rejected when it is really hidden. Each tile also keeps the max depth of
+ * its 8x8 blocks, which lets most box tests finish without touching individual pixels. No device is needed. */
+class OcclusionCuller
+{
+  public:
+    static constexpr uint32 WIDTH = 320;
+    static constexpr uint32 HEIGHT = 192;
+    static constexpr uint32 TILE_SIZE = 32;
+    static constexpr uint32 BLOCK_SIZE = 8;
+
+    OcclusionCuller();
+
+    // Clears bits of camera-visible slots whose bounds are hidden behind the occluders
+    void Cull(entt::registry const& reg, TransformSystem const& transforms, Matrix const& viewProjRow, VisibilityBits& visibility);
+
+    void Clear(Matrix const& viewProjRow);
+    void RenderOccluders(entt::registry const& reg, TransformSystem const& transforms, VisibilityBits const& visibility);
+    bool IsOccluded(DirectX::BoundingBox const& box) const;
+
+    OcclusionStats const& Stats() const
+    {
+        return stats;
+    }
+
+    // Marks the submeshes with the largest bounds (relative to the whole model) as occluders
+    static void SelectOccluders(entt::registry& reg, std::span<entt::entity const> entities);
+
+  private:
+    struct ScreenTriangle
+    {
+        float edgeA[3], edgeB[3], edgeC[3];
+        float zA, zB, zC, zMax;
+        int32 minX, minY, maxX, maxY;
+    };
+
+    void AddTriangle(Vector4 const& c0, Vector4 const& c1, Vector4 const& c2);
+    void RasterizeTile(uint32 tile);
+
+  private:
+    Matrix viewProj;
+    std::vector<float> depth;    // WIDTH x HEIGHT, farthest occluder depth per pixel, 1 = empty
+    std::vector<float> blockMax; // max depth of each BLOCK_SIZE x BLOCK_SIZE block
+    std::vector<ScreenTriangle> triangles;
+    std::vector<std::vector<uint32>> bins; // triangle indices per tile
+    std::vector<Vector4> clipVertices;
+    std::vector<uint32> tileIndices;
+    OcclusionStats stats;
+};
+
+// Flies a camera through the loaded scene and logs frustum + occlusion culling results per frame on average
+void RunOcclusionBenchmark(entt::registry const& reg, TransformSystem const& transforms);
+
+} // namespace Riley
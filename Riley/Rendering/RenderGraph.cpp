@@ -0,0 +1,196 @@
+#include "RenderGraph.h"
+#include <algorithm>
+
+namespace Riley
+{
+
+RGResourceId RenderGraph::CreateTexture(std::string name, RGTextureDesc const& desc)
+{
+    resources.push_back(RGResource{std::move(name), desc, false});
+    return static_cast<RGResourceId>(resources.size() - 1);
+}
+
+RGResourceId RenderGraph::ImportTexture(std::string name, RGTextureDesc const& desc)
+{
+    resources.push_back(RGResource{std::move(name), desc, true});
+    return static_cast<RGResourceId>(resources.size() - 1);
+}
+
+RGPass& RenderGraph::AddPass(std::string name, bool sideEffect)
+{
+    RGPass& pass = passes.emplace_back();
+    pass.name = std::move(name);
+    pass.sideEffect = sideEffect;
+    return pass;
+}
+
+void RenderGraph::Compile()
+{
+    CullPasses();
+    ComputeLifetimes();
+    AssignPhysicalTextures();
+    ComputeTransitions();
+}
+
+// Reference counting from the outputs back: a transient nobody reads releases its writers,
+// a pass left without referenced outputs is culled and releases what it reads
+void RenderGraph::CullPasses()
+{
+    std::vector<uint32> resourceRefs(resources.size(), 0);
+    std::vector<uint32> passRefs(passes.size(), 0);
+    std::vector<std::vector<uint32>> writers(resources.size());
+
+    for (uint32 p = 0; p < passes.size(); ++p)
+    {
+        RGPass& pass = passes[p];
+        pass.culled = false;
+        for (RGPass::Use const& use : pass.reads)
+            ++resourceRefs[use.resource];
+        for (RGPass::Use const& use : pass.writes)
+        {
+            writers[use.resource].push_back(p);
+            pass.sideEffect |= resources[use.resource].imported;
+        }
+        passRefs[p] = static_cast<uint32>(pass.writes.size());
+    }
+
+    std::vector<RGResourceId> unreferenced;
+    for (RGResourceId r = 0; r < resources.size(); ++r)
+    {
+        if (!resources[r].imported && resourceRefs[r] == 0)
+            unreferenced.push_back(r);
+    }
+    while (!unreferenced.empty())
+    {
+        const RGResourceId r = unreferenced.back();
+        unreferenced.pop_back();
+        for (uint32 p : writers[r])
+        {
+            RGPass& pass = passes[p];
+            if (--passRefs[p] > 0 || pass.sideEffect || pass.culled)
+                continue;
+
+            pass.culled = true;
+            for (RGPass::Use const& use : pass.reads)
+            {
+                if (--resourceRefs[use.resource] == 0 && !resources[use.resource].imported)
+                    unreferenced.push_back(use.resource);
+            }
+        }
+    }
+}
+
+void RenderGraph::ComputeLifetimes()
+{
+    for (RGResource& resource : resources)
+    {
+        resource.firstPass = RG_INVALID_INDEX;
+        resource.lastPass = RG_INVALID_INDEX;
+    }
+    auto Touch = [this](RGPass::Use const& use, uint32 p) {
+        RGResource& resource = resources[use.resource];
+        if (resource.firstPass == RG_INVALID_INDEX)
+            resource.firstPass = p;
+        resource.lastPass = p;
+    };
+    for (uint32 p = 0; p < passes.size(); ++p)
+    {
+        if (passes[p].culled)
+            continue;
+        for (RGPass::Use const& use : passes[p].reads)
+            Touch(use, p);
+        for (RGPass::Use const& use : passes[p].writes)
+            Touch(use, p);
+    }
+}
+
+// Interval assignment in order of first use. A physical texture is reused by the first transient with the same
+// desc that starts after its current occupant ends
+void RenderGraph::AssignPhysicalTextures()
+{
+    physicalTextures.clear();
+    std::vector<uint32> physicalLastPass;
+
+    std::vector<RGResourceId> order;
+    for (RGResourceId r = 0; r < resources.size(); ++r)
+    {
+        resources[r].physical = RG_INVALID_INDEX;
+        if (!resources[r].imported && resources[r].firstPass != RG_INVALID_INDEX)
+            order.push_back(r);
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [this](RGResourceId a, RGResourceId b) { return resources[a].firstPass < resources[b].firstPass; });
+
+    for (RGResourceId r : order)
+    {
+        RGResource& resource = resources[r];
+        for (uint32 i = 0; i < physicalTextures.size(); ++i)
+        {
+            if (physicalTextures[i] == resource.desc && physicalLastPass[i] < resource.firstPass)
+            {
+                resource.physical = i;
+                break;
+            }
+        }
+        if (resource.physical == RG_INVALID_INDEX)
+        {
+            resource.physical = static_cast<uint32>(physicalTextures.size());
+            physicalTextures.push_back(resource.desc);
+            physicalLastPass.push_back(0);
+        }
+        physicalLastPass[resource.physical] = resource.lastPass;
+    }
+}
+
+void RenderGraph::ComputeTransitions()
+{
+    std::vector<RGAccess> states(resources.size(), RGAccess::Undefined);
+    std::vector<RGResourceId> owners(physicalTextures.size(), RG_INVALID_INDEX);
+
+    for (RGPass& pass : passes)
+    {
+        pass.transitions.clear();
+        if (pass.culled)
+            continue;
+
+        auto Transition = [&](RGPass::Use const& use) {
+            RGResource const& resource = resources[use.resource];
+            bool aliased = false;
+            if (resource.physical != RG_INVALID_INDEX && owners[resource.physical] != use.resource)
+            {
+                aliased = owners[resource.physical] != RG_INVALID_INDEX;
+                owners[resource.physical] = use.resource;
+            }
+            if (states[use.resource] != use.access || aliased)
+            {
+                const RGAccess before = aliased ? RGAccess::Undefined : states[use.resource];
+                pass.transitions.push_back(RGTransition{use.resource, before, use.access, aliased});
+                states[use.resource] = use.access;
+            }
+        };
+        for (RGPass::Use const& use : pass.reads)
+            Transition(use);
+        for (RGPass::Use const& use : pass.writes)
+            Transition(use);
+    }
+}
+
+RGMemoryStats RenderGraph::MemoryStats() const
+{
+    RGMemoryStats stats{};
+    stats.resources = static_cast<uint32>(resources.size());
+    stats.physical = static_cast<uint32>(physicalTextures.size());
+    for (RGResource const& resource : resources)
+    {
+        stats.dedicatedBytes += resource.desc.SizeInBytes();
+        if (resource.imported)
+            stats.aliasedBytes += resource.desc.SizeInBytes();
+        else if (resource.physical == RG_INVALID_INDEX)
+            ++stats.culled;
+    }
+    for (RGTextureDesc const& desc : physicalTextures)
+        stats.aliasedBytes += desc.SizeInBytes();
+    return stats;
+}
+
+} // namespace Riley
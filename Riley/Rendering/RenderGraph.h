@@ -0,0 +1,146 @@
+#pragma once
+#include "../Core/CoreTypes.h"
+#include "../Graphics/DXFormat.h"
+#include "../Graphics/DXResourceCommon.h"
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Riley
+{
+
+using RGResourceId = uint32;
+static constexpr uint32 RG_INVALID_INDEX = ~0u;
+
+struct RGTextureDesc
+{
+    uint32 width = 0;
+    uint32 height = 0;
+    uint32 arraySize = 1;
+    DXFormat format = DXFormat::UNKNOWN;
+    DXBindFlag bindFlags = DXBindFlag::None;
+    DXTextureMiscFlag miscFlags = DXTextureMiscFlag::None;
+
+    bool operator==(RGTextureDesc const& other) const = default;
+    uint64 SizeInBytes() const
+    {
+        return uint64(width) * height * arraySize * GetDXFormatStride(format);
+    }
+};
+
+// How a pass uses a resource, also the state a resource is in after the pass
+enum class RGAccess : uint8
+{
+    Undefined,
+    ShaderResource,
+    RenderTarget,
+    DepthStencil,
+    UnorderedAccess
+};
+
+struct RGTransition
+{
+    RGResourceId resource;
+    RGAccess before;
+    RGAccess after;
+    bool aliased; // the physical texture held another resource before, its contents are undefined
+};
+
+struct RGResource
+{
+    std::string name;
+    RGTextureDesc desc;
+    bool imported = false;
+
+    // filled by Compile
+    uint32 firstPass = RG_INVALID_INDEX;
+    uint32 lastPass = RG_INVALID_INDEX;
+    uint32 physical = RG_INVALID_INDEX; // transients only
+};
+
+struct RGPass
+{
+    struct Use
+    {
+        RGResourceId resource;
+        RGAccess access;
+    };
+
+    std::string name;
+    std::vector<Use> reads;
+    std::vector<Use> writes;
+    bool sideEffect = false; // kept even when nothing reads what it writes
+
+    // filled by Compile
+    bool culled = false;
+    std::vector<RGTransition> transitions; // to issue before the pass runs
+
+    RGPass& Read(RGResourceId resource, RGAccess access = RGAccess::ShaderResource)
+    {
+        reads.push_back({resource, access});
+        return *this;
+    }
+    RGPass& Write(RGResourceId resource, RGAccess access = RGAccess::RenderTarget)
+    {
+        writes.push_back({resource, access});
+        return *this;
+    }
+};
+
+struct RGMemoryStats
+{
+    uint32 resources = 0;  // declared, transient and imported
+    uint32 culled = 0;     // transients no surviving pass uses
+    uint32 physical = 0;   // textures backing the surviving transients
+    uint64 dedicatedBytes = 0; // every declared resource in its own texture
+    uint64 aliasedBytes = 0;   // imported resources plus the physical textures
+};
+
+/* Frame description where passes declare the textures they read and write.
+ * Compile() is pure CPU: it culls passes whose results nobody reads, computes the lifetime of every resource,
+ * assigns the transients to physical textures and lists the state transitions each pass needs.
+ * D3D11 cannot place resources in shared heap memory, so transients alias by sharing a texture: two resources
+ * with the same desc and disjoint lifetimes get the same physical index. Imported resources live across frames
+ * and are never culled or aliased, writing one counts as a side effect. */
+class RenderGraph
+{
+  public:
+    RGResourceId CreateTexture(std::string name, RGTextureDesc const& desc);
+    RGResourceId ImportTexture(std::string name, RGTextureDesc const& desc);
+    // the returned reference is valid until the next AddPass
+    RGPass& AddPass(std::string name, bool sideEffect = false);
+
+    void Compile();
+
+    RGResource const& Resource(RGResourceId id) const
+    {
+        return resources[id];
+    }
+    std::span<RGResource const> Resources() const
+    {
+        return resources;
+    }
+    std::span<RGPass const> Passes() const
+    {
+        return passes;
+    }
+    // descs of the textures to create for the transients, indexed by RGResource::physical
+    std::span<RGTextureDesc const> PhysicalTextures() const
+    {
+        return physicalTextures;
+    }
+    RGMemoryStats MemoryStats() const;
+
+  private:
+    void CullPasses();
+    void ComputeLifetimes();
+    void AssignPhysicalTextures();
+    void ComputeTransitions();
+
+  private:
+    std::vector<RGResource> resources;
+    std::vector<RGPass> passes;
+    std::vector<RGTextureDesc> physicalTextures;
+};
+
+} // namespace Riley
@@ -0,0 +1,94 @@
+#include "RenderQueue.h"
+#include "../Core/Rendering.h"
+
+namespace Riley
+{
+
+uint32 DrawKey::DepthBucket(float viewDepth, float nearZ, float farZ)
+{
+    static constexpr uint32 maxBucket = (1u << DEPTH_BITS) - 1;
+    const float t = std::clamp((viewDepth - nearZ) / std::max(farZ - nearZ, 1e-6f), 0.0f, 1.0f);
+    return static_cast<uint32>(t * maxBucket);
+}
+
+void RenderQueue::Clear()
+{
+    packets.clear();
+}
+
+void RenderQueue::Push(uint64 key, uint32 payload)
+{
+    packets.push_back(DrawPacket{key, payload});
+}
+
+void RenderQueue::Sort()
+{
+    RileyTimer sortTimer;
+    sortTimer.Mark();
+
+    stats.draws = static_cast<uint32>(packets.size());
+    stats.unsorted = CountStateChanges(packets);
+    RadixSort(packets, scratch);
+    stats.sorted = CountStateChanges(packets);
+    stats.sortMs = sortTimer.MarkInSeconds() * 1000.0f;
+}
+
+uint32 RenderQueue::MaterialId(TextureSet const& textures)
+{
+    auto [it, inserted] = materialIds.try_emplace(textures, static_cast<uint32>(materialIds.size()));
+    return it->second;
+}
+
+StateChanges RenderQueue::CountStateChanges(std::span<DrawPacket const> packets)
+{
+    StateChanges changes{};
+    for (size_t i = 0; i < packets.size(); ++i)
+    {
+        const uint64 key = packets[i].key;
+        const bool first = i == 0;
+        const uint64 prev = first ? 0 : packets[i - 1].key;
+        changes.programs += first || DrawKey::Program(key) != DrawKey::Program(prev) || DrawKey::Pass(key) != DrawKey::Pass(prev);
+        changes.materials += first || DrawKey::Material(key) != DrawKey::Material(prev);
+        changes.meshes += first || DrawKey::Mesh(key) != DrawKey::Mesh(prev);
+    }
+    return changes;
+}
+
+// LSD radix sort on 8 bit digits. Stable, so equal keys keep their push order.
+// Digits where every key has the same value are skipped, which is most of them for a single pass
+void RenderQueue::RadixSort(std::vector<DrawPacket>& packets, std::vector<DrawPacket>& scratch)
+{
+    static constexpr uint32 digitCount = sizeof(uint64);
+    if (packets.size() < 2)
+        return;
+
+    // all histograms in one read of the keys
+    uint32 histograms[digitCount][256] = {};
+    for (DrawPacket const& packet : packets)
+    {
+        for (uint32 d = 0; d < digitCount; ++d)
+            ++histograms[d][(packet.key >> (d * 8)) & 0xff];
+    }
+
+    scratch.resize(packets.size());
+    const uint32 count = static_cast<uint32>(packets.size());
+    for (uint32 d = 0; d < digitCount; ++d)
+    {
+        uint32* histogram = histograms[d];
+        if (histogram[(packets[0].key >> (d * 8)) & 0xff] == count)
+            continue;
+
+        uint32 offset = 0;
+        for (uint32 b = 0; b < 256; ++b)
+        {
+            const uint32 bucket = histogram[b];
+            histogram[b] = offset;
+            offset += bucket;
+        }
+        for (DrawPacket const& packet : packets)
+            scratch[histogram[(packet.key >> (d * 8)) & 0xff]++] = packet;
+        packets.swap(scratch);
+    }
+}
+
+} // namespace Riley
@@ -0,0 +1,138 @@
+#pragma once
+#include "../Core/CoreTypes.h"
+#include <array>
+#include <map>
+#include <span>
+#include <vector>
+
+namespace Riley
+{
+
+enum class DrawPass : uint8
+{
+    Shadow,
+    GBuffer,
+    Forward,
+    Transparent
+};
+
+/* 64 bit sort key of a draw, most significant field first
+ * | pass 4 | shader program 6 | material 20 | depth 16 | mesh 18 |
+ * so a sorted queue groups draws by program, then by texture set, then goes front to back. */
+namespace DrawKey
+{
+static constexpr uint32 PASS_BITS = 4;
+static constexpr uint32 PROGRAM_BITS = 6;
+static constexpr uint32 MATERIAL_BITS = 20;
+static constexpr uint32 DEPTH_BITS = 16;
+static constexpr uint32 MESH_BITS = 18;
+static_assert(PASS_BITS + PROGRAM_BITS + MATERIAL_BITS + DEPTH_BITS + MESH_BITS == 64);
+
+static constexpr uint32 MESH_SHIFT = 0;
+static constexpr uint32 DEPTH_SHIFT = MESH_SHIFT + MESH_BITS;
+static constexpr uint32 MATERIAL_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+static constexpr uint32 PROGRAM_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+static constexpr uint32 PASS_SHIFT = PROGRAM_SHIFT + PROGRAM_BITS;
+
+constexpr uint64 Field(uint64 value, uint32 bits, uint32 shift)
+{
+    return (value & ((1ull << bits) - 1)) << shift;
+}
+constexpr uint32 Extract(uint64 key, uint32 bits, uint32 shift)
+{
+    return static_cast<uint32>((key >> shift) & ((1ull << bits) - 1));
+}
+
+constexpr uint64 Make(DrawPass pass, uint32 program, uint32 material, uint32 depth, uint32 mesh)
+{
+    return Field(static_cast<uint64>(pass), PASS_BITS, PASS_SHIFT) | Field(program, PROGRAM_BITS, PROGRAM_SHIFT) |
+           Field(material, MATERIAL_BITS, MATERIAL_SHIFT) | Field(depth, DEPTH_BITS, DEPTH_SHIFT) | Field(mesh, MESH_BITS, MESH_SHIFT);
+}
+
+constexpr DrawPass Pass(uint64 key)
+{
+    return static_cast<DrawPass>(Extract(key, PASS_BITS, PASS_SHIFT));
+}
+constexpr uint32 Program(uint64 key)
+{
+    return Extract(key, PROGRAM_BITS, PROGRAM_SHIFT);
+}
+constexpr uint32 Material(uint64 key)
+{
+    return Extract(key, MATERIAL_BITS, MATERIAL_SHIFT);
+}
+constexpr uint32 Depth(uint64 key)
+{
+    return Extract(key, DEPTH_BITS, DEPTH_SHIFT);
+}
+constexpr uint32 Mesh(uint64 key)
+{
+    return Extract(key, MESH_BITS, MESH_SHIFT);
+}
+
+// Quantizes a view depth in [nearZ, farZ] to the depth field, 0 is nearest
+uint32 DepthBucket(float viewDepth, float nearZ, float farZ);
+} // namespace DrawKey
+
+struct DrawPacket
+{
+    uint64 key;
+    uint32 payload; // index of the draw in the pass, usually the entity
+};
+
+struct StateChanges
+{
+    uint32 programs = 0;
+    uint32 materials = 0;
+    uint32 meshes = 0;
+
+    uint32 Total() const
+    {
+        return programs + materials + meshes;
+    }
+};
+
+struct RenderQueueStats
+{
+    uint32 draws = 0;
+    StateChanges unsorted;
+    StateChanges sorted;
+    float sortMs = 0.0f;
+};
+
+/* Collects the draws of a pass as sort keys and sorts them with a stable LSD radix sort.
+ * Nothing here touches the device, the pass walks Packets() afterwards and binds state only when a key field changes.
+ * Material ids are handed out in first seen order and kept across frames, mesh ids are the slots of the geometry
+ * arena, so the same scene always produces the same keys and the same draw order. */
+class RenderQueue
+{
+  public:
+    using TextureSet = std::array<uint64, 4>;
+
+    void Clear();
+    void Push(uint64 key, uint32 payload);
+    void Sort();
+
+    std::span<DrawPacket const> Packets() const
+    {
+        return packets;
+    }
+    RenderQueueStats const& Stats() const
+    {
+        return stats;
+    }
+
+    uint32 MaterialId(TextureSet const& textures);
+
+    // Program, material and mesh switches needed to issue the packets in the given order
+    static StateChanges CountStateChanges(std::span<DrawPacket const> packets);
+    static void RadixSort(std::vector<DrawPacket>& packets, std::vector<DrawPacket>& scratch);
+
+  private:
+    std::vector<DrawPacket> packets;
+    std::vector<DrawPacket> scratch;
+    std::map<TextureSet, uint32> materialIds;
+    RenderQueueStats stats;
+};
+
+} // namespace Riley
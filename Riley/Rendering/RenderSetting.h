@@ -30,5 +30,21 @@ struct RenderSetting
    // fxaa
    bool fxaa = true;
 
+   // picking, the CPU ray query is the default and the entity id pass only runs on click when this is set
+   bool gpuPicking = false;
+
+   // occlusion culling, rejects camera draws hidden behind the occluders picked at import (CPU depth buffer)
+   bool occlusionCulling = false;
+
+   // mesh LODs, the coarsest level whose error covers at most lodPixelError pixels is drawn.
+   // Shadow views go shadowLODBias levels coarser than what their views need
+   bool meshLODs = true;
+   float lodPixelError = 1.0f;
+   uint32 shadowLODBias = 1;
+
+   // cluster culling, meshes drawn at full resolution only draw the meshlets inside their views. The camera also
+   // culls backfacing meshlets, and hidden ones when occlusion culling is on
+   bool clusterCulling = true;
+
 };
 } // namespace Riley
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "Renderer.h"
 #include "../Editor/Editor.h"
 #include "../Graphics/DXBuffer.h"
+#include "../Graphics/DXCommandList.h"
 #include "../Graphics/DXScopedAnnotation.h"
 #include "../Graphics/DXShaderCompiler.h"
 #include "../Graphics/DXShaderProgram.h"
@@ -11,6 +12,9 @@
 #include "../Utilities/StringUtil.h"
 #include "Camera.h"
 #include "ModelImporter.h"
+#include "OcclusionCuller.h"
+#include "SceneQuery.h"
+#include <execution>
 #include <random>
 
 namespace Riley
@@ -23,6 +27,9 @@ Renderer::Renderer(entt::registry& reg, ID3D11Device* device, ID3D11DeviceContex
     ShaderManager::Initialize(m_device);
     timer.Mark();
 
+    transformSystem = new TransformSystem(m_reg);
+    occlusionCuller = new OcclusionCuller();
+
     CreateBuffers();
     RI_TRACE("Create Buffers {:f}s", AppTimer.ElapsedInSeconds());
     AppTimer.Mark();
@@ -32,6 +39,7 @@ Renderer::Renderer(entt::registry& reg, ID3D11Device* device, ID3D11DeviceContex
     CreateDepthStencilBuffers(m_width, m_height);
     CreateRenderTargets(m_width, m_height);
     CreateRenderPasses(m_width, m_height);
+    ReportFrameGraphMemory();
 
     /*SetSceneViewport(static_cast<float>(m_width), static_cast<float>(m_height));*/
 
@@ -47,8 +55,14 @@ Renderer::~Renderer()
     shadowCubeMapPass.Destroy();
     ShaderManager::Destroy();
 
+    SAFE_DELETE(occlusionCuller);
+    SAFE_DELETE(transformSystem);
     SAFE_DELETE(ssaoNoiseTex);
     SAFE_DELETE(blurTextureIntermediate);
+    SAFE_DELETE(uavTarget);
+    SAFE_DELETE(debugTiledTexture);
+    SAFE_DELETE(debugLineVB);
+    SAFE_DELETE(instanceVB);
 
     SAFE_DELETE(frameBufferGPU);
     SAFE_DELETE(objectConstsGPU);
@@ -56,6 +70,7 @@ Renderer::~Renderer()
     SAFE_DELETE(lightConstsGPU);
     SAFE_DELETE(shadowConstsGPU);
     SAFE_DELETE(entityIdConstsGPU);
+    SAFE_DELETE(constantRing);
     SAFE_DELETE(postProcessGPU);
 
     SAFE_DELETE(solidRS);
@@ -105,6 +120,13 @@ Renderer::~Renderer()
 void Renderer::Update(float dt)
 {
     m_currentDeltaTime = dt;
+    constantRing->BeginFrame();
+    g_GeometryArena.Compact();
+    transformSystem->Update();
+    CollectViews();
+    Culling::FrustumCullViews(transformSystem->Bounds(), cullPlanes, viewVisibility);
+    if (renderSetting.occlusionCulling)
+        occlusionCuller->Cull(m_reg, *transformSystem, m_camera->GetViewProj().Transpose(), viewVisibility[CAMERA_VIEW]);
     UpdateLights();
 }
 
@@ -113,7 +135,17 @@ void Renderer::Render(RenderSetting& _setting)
     renderSetting = _setting;
 
     // PassForward();
-    PassGBuffer();
+    CollectGBufferBatches();
+    ReserveInstanceBuffer();
+    gbufferCommands.Reset();
+    PassGBuffer(gbufferCommands);
+
+    // every per draw constant of the frame is recorded by now, one upload serves the shadow and GBuffer lists
+    constantRing->Upload(m_context);
+    DXContextBackend backend(m_context, &m_annotation);
+    for (DXCommandList const& list : shadowCommands)
+        backend.Execute(list);
+    backend.Execute(gbufferCommands);
     PassSSAO();
 
     PassAmbient();
@@ -126,7 +158,9 @@ void Renderer::Render(RenderSetting& _setting)
 
     PassAABB();
     //PassLight();
-    PassEntityID();
+
+    // the editor samples the final target next, clear what the passes left bound lazily
+    g_StateCache.Flush(m_context);
 }
 
 void Renderer::OnResize(uint32 width, uint32 height)
@@ -135,6 +169,7 @@ void Renderer::OnResize(uint32 width, uint32 height)
     {
         m_width = width;
         m_height = height;
+        g_StateCache.Flush(m_context);
         CreateDepthStencilBuffers(width, height);
         CreateRenderTargets(width, height);
         CreateRenderPasses(width, height);
@@ -144,91 +179,77 @@ void Renderer::OnResize(uint32 width, uint32 height)
 
 void Renderer::OnLeftMouseClicked(uint32 mx, uint32 my)
 {
-    if (m_currentSceneViewport.isViewportFocused)
-    {
-        // [unused] 화면 내 영역을 통한 물체 선택 코드
-        /* [unused] 화면 내 영역을 통한 물체 선택 코드
-        //float cursorNdcX = m_currentSceneViewport.m_mousePositionX * 2.0f / m_currentSceneViewport.m_widthImGui - 1.0f;
-        //float cursorNdcY = -m_currentSceneViewport.m_mousePositionY * 2.0f / m_currentSceneViewport.m_heightImGui + 1.0f;
-
-        // std::cout << cursorNdcX << "," << cursorNdcY << std::endl;
-
-        // Vector3 cursorNdcNear = Vector3(cursorNdcX, cursorNdcY, 0.0f);
-        // Vector3 cursorNdcFar = Vector3(cursorNdcX, cursorNdcY, 1.0f);
-
-        //// NDC -> World
-        // Vector3 cursorNearWS = Vector3::Transform(cursorNdcNear, frameBufferCPU.invViewProj.Transpose());
-        // Vector3 cursorFarWS = Vector3::Transform(cursorNdcFar, frameBufferCPU.invViewProj.Transpose());
-        // Vector3 cursorDir = (cursorFarWS - cursorNearWS);
-        // cursorDir.Normalize();
-
-        // Ray cursorRay = Ray(cursorNearWS, cursorDir);
-        //{
-        //     auto aabbView = m_reg.view<Transform, AABB>();
-        //     float dist = 0.0f;
-
-        //    for (auto& entity : aabbView)
-        //    {
-        //        auto [transform, aabb] = aabbView.get<Transform, AABB>(entity);
-        //        m_seleted = cursorRay.Intersects(aabb.boundingBox, dist);
-        //        if (m_seleted)
-        //        {
-        //            if (!aabb.isDrawAABB)
-        //                aabb.isDrawAABB = true;
-        //            else
-        //                aabb.isDrawAABB = false;
-        //        }
-        //    }
-        //}
-        */
-        if (m_currentSceneViewport.m_mousePositionX < 0.0f || m_currentSceneViewport.m_mousePositionY < 0.0f ||
-            m_currentSceneViewport.m_mousePositionX > m_currentSceneViewport.m_widthImGui ||
-            m_currentSceneViewport.m_mousePositionY > m_currentSceneViewport.m_heightImGui)
-            return;
+    if (!m_currentSceneViewport.isViewportFocused)
+        return;
+
+    if (m_currentSceneViewport.m_mousePositionX < 0.0f || m_currentSceneViewport.m_mousePositionY < 0.0f ||
+        m_currentSceneViewport.m_mousePositionX > m_currentSceneViewport.m_widthImGui ||
+        m_currentSceneViewport.m_mousePositionY > m_currentSceneViewport.m_heightImGui)
+        return;
 
-        D3D11_TEXTURE2D_DESC stagedDesc = {
-            1,                              // UINT Width;
-            1,                              // UINT Height;
-            1,                              // UINT MipLevels;
-            1,                              // UINT ArraySize;
-            DXGI_FORMAT_R32G32B32A32_FLOAT, // DXGI_FORMAT Format;
-            1,
-            0,                     // DXGI_SAMPLE_DESC SampleDesc;
-            D3D11_USAGE_STAGING,   // D3D11_USAGE Usage;
-            0,                     // UINT BindFlags;
-            D3D11_CPU_ACCESS_READ, // UINT CPUAccessFlags;
-            0                      // UINT MiscFlags;
-        };
-
-        ID3D11Texture2D* stagingTexture = nullptr;
-        m_device->CreateTexture2D(&stagedDesc, nullptr, &stagingTexture);
-
-        D3D11_BOX srcBox;
-        srcBox.left = (UINT)(m_currentSceneViewport.m_mousePositionX / m_currentSceneViewport.m_widthImGui * m_width);
-        srcBox.right = srcBox.left + 1;
-        srcBox.top = (UINT)(m_currentSceneViewport.m_mousePositionY / m_currentSceneViewport.m_heightImGui * m_height);
-        srcBox.bottom = srcBox.top + 1;
-        srcBox.front = 0;
-        srcBox.back = 1;
-
-        std::cout << "mx : " << m_currentSceneViewport.m_mousePositionX << " my :" << srcBox.top << std::endl;
-
-        m_context->CopySubresourceRegion(reinterpret_cast<ID3D11Resource*>(stagingTexture), 0, 0, 0, 0, entityIdRTV->GetResource(), 0,
-                                         &srcBox);
-
-        D3D11_MAPPED_SUBRESOURCE ms;
-        m_context->Map(reinterpret_cast<ID3D11Resource*>(stagingTexture), 0, D3D11_MAP_READ, 0, &ms);
-        auto pData = *(Vector4*)ms.pData;
-        m_context->Unmap(reinterpret_cast<ID3D11Resource*>(stagingTexture), 0);
-
-        selectedEntity = static_cast<entt::entity>(pData.x);
-
-        SAFE_RELEASE(stagingTexture);
+    if (renderSetting.gpuPicking)
+    {
+        selectedEntity = PickEntityGPU();
+        return;
     }
+
+    const float ndcX = m_currentSceneViewport.m_mousePositionX / m_currentSceneViewport.m_widthImGui * 2.0f - 1.0f;
+    const float ndcY = 1.0f - m_currentSceneViewport.m_mousePositionY / m_currentSceneViewport.m_heightImGui * 2.0f;
+    const Ray ray = SceneQuery::ScreenRay(m_camera->GetViewProj().Transpose(), ndcX, ndcY);
+
+    std::optional<RayHit> hit = SceneQuery::RayCast(m_reg, *transformSystem, ray);
+    selectedEntity = hit ? hit->entity : entt::null;
+}
+
+// Renders the entity id pass and reads back the pixel under the cursor, stalls until the GPU catches up
+entt::entity Renderer::PickEntityGPU()
+{
+    // runs outside the frame, after ImGui and the editor have bound their own state behind the cache's back
+    g_StateCache.Invalidate();
+    PassEntityID();
+    g_StateCache.Flush(m_context);
+
+    D3D11_TEXTURE2D_DESC stagedDesc = {
+        1,                              // UINT Width;
+        1,                              // UINT Height;
+        1,                              // UINT MipLevels;
+        1,                              // UINT ArraySize;
+        DXGI_FORMAT_R32G32B32A32_FLOAT, // DXGI_FORMAT Format;
+        1,
+        0,                     // DXGI_SAMPLE_DESC SampleDesc;
+        D3D11_USAGE_STAGING,   // D3D11_USAGE Usage;
+        0,                     // UINT BindFlags;
+        D3D11_CPU_ACCESS_READ, // UINT CPUAccessFlags;
+        0                      // UINT MiscFlags;
+    };
+
+    ID3D11Texture2D* stagingTexture = nullptr;
+    m_device->CreateTexture2D(&stagedDesc, nullptr, &stagingTexture);
+
+    D3D11_BOX srcBox;
+    srcBox.left = (UINT)(m_currentSceneViewport.m_mousePositionX / m_currentSceneViewport.m_widthImGui * m_width);
+    srcBox.right = srcBox.left + 1;
+    srcBox.top = (UINT)(m_currentSceneViewport.m_mousePositionY / m_currentSceneViewport.m_heightImGui * m_height);
+    srcBox.bottom = srcBox.top + 1;
+    srcBox.front = 0;
+    srcBox.back = 1;
+
+    m_context->CopySubresourceRegion(reinterpret_cast<ID3D11Resource*>(stagingTexture), 0, 0, 0, 0, entityIdRTV->GetResource(), 0,
+                                     &srcBox);
+
+    D3D11_MAPPED_SUBRESOURCE ms;
+    m_context->Map(reinterpret_cast<ID3D11Resource*>(stagingTexture), 0, D3D11_MAP_READ, 0, &ms);
+    auto pData = *(Vector4*)ms.pData;
+    m_context->Unmap(reinterpret_cast<ID3D11Resource*>(stagingTexture), 0);
+
+    SAFE_RELEASE(stagingTexture);
+    return static_cast<entt::entity>(pData.x);
 }
 
 void Renderer::Tick(Camera* camera)
 {
+    // ImGui and the editor use the context directly between frames
+    g_StateCache.BeginFrame();
     BindGlobals();
 
     m_camera = camera;
@@ -289,6 +310,10 @@ void Renderer::CreateBuffers()
     shadowConstsGPU = new DXConstantBuffer<ShadowConsts>(m_device, true);
     postProcessGPU = new DXConstantBuffer<PostprocessConsts>(m_device, true);
     entityIdConstsGPU = new DXConstantBuffer<EntityIdConsts>(m_device, true);
+
+    // 4096 windows per frame, grown when a frame runs out
+    constantRing = new DXConstantRing(m_device, 4096 * DXUploadRing::CONSTANT_ALIGNMENT);
+    drawConstants = constantRing->IsSupported() ? constantRing : nullptr;
 }
 
 void Renderer::CreateRenderStates()
@@ -346,40 +371,16 @@ void Renderer::CreateRenderStates()
 
 void Renderer::CreateDepthStencilBuffers(uint32 width, uint32 height)
 {
-    /// DXDepthStencilBuffer Initialize
-    SAFE_DELETE(hdrDSV);
-    hdrDSV = new DXDepthStencilBuffer(m_device, width, height, true);
-
-    SAFE_DELETE(gbufferDSV);
-    gbufferDSV = new DXDepthStencilBuffer(m_device, width, height);
-    D3D11_SHADER_RESOURCE_VIEW_DESC gbufferSRVDesc;
-    ZeroMemory(&gbufferSRVDesc, sizeof(gbufferSRVDesc));
-    gbufferSRVDesc.Format = DXGI_FORMAT_R24_UNORM_X8_TYPELESS;
-    gbufferSRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-    gbufferSRVDesc.Texture2D.MipLevels = 1;
-    gbufferDSV->CreateSRV(m_device, &gbufferSRVDesc);
-
-    SAFE_DELETE(ambientLightingDSV);
-    ambientLightingDSV = new DXDepthStencilBuffer(m_device, width, height);
-
-    SAFE_DELETE(depthMapDSV);
-    depthMapDSV = new DXDepthStencilBuffer(m_device, width, height, false);
+    // the transient depth buffers come from the frame graph, see CreateFrameGraphTargets
     D3D11_SHADER_RESOURCE_VIEW_DESC defaultDepthMapDesc;
     ZeroMemory(&defaultDepthMapDesc, sizeof(defaultDepthMapDesc));
     defaultDepthMapDesc.Format = DXGI_FORMAT_R32_FLOAT;
     defaultDepthMapDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
     defaultDepthMapDesc.Texture2D.MipLevels = 1;
-    depthMapDSV->CreateSRV(m_device, &defaultDepthMapDesc);
 
     SAFE_DELETE(entityIdDSV);
     entityIdDSV = new DXDepthStencilBuffer(m_device, width, height, false);
 
-    // AO
-    SAFE_DELETE(ssaoDSV);
-    ssaoDSV = new DXDepthStencilBuffer(m_device, width, height);
-    SAFE_DELETE(ssaoBlurDSV);
-    ssaoBlurDSV = new DXDepthStencilBuffer(m_device, width, height);
-
     // SHADOW MAP
     {
         SAFE_DELETE(shadowDepthMapDSV);
@@ -427,14 +428,6 @@ void Renderer::CreateDepthStencilBuffers(uint32 width, uint32 height)
         shadowCubeMapDesc.TextureCube.MipLevels = 1;
         shadowDepthCubeMapDSV->CreateSRV(m_device, &shadowCubeMapDesc);
     }
-
-    // Postprocess
-    {
-        SAFE_DELETE(pingPostprocessDSV);
-        SAFE_DELETE(pongPostprocessDSV);
-        pingPostprocessDSV = new DXDepthStencilBuffer(m_device, width, height);
-        pongPostprocessDSV = new DXDepthStencilBuffer(m_device, width, height);
-    }
 }
 
 void Renderer::CreateRenderTargets(uint32 width, uint32 height)
@@ -445,49 +438,7 @@ void Renderer::CreateRenderTargets(uint32 width, uint32 height)
     tex2dSRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
     tex2dSRVDesc.Texture2D.MipLevels = 1;
 
-    SAFE_DELETE(hdrRTV);
-    hdrRTV = new DXRenderTarget(m_device, width, height, DXFormat::R8G8B8A8_UNORM, hdrDSV);
-    hdrRTV->CreateSRV(m_device, nullptr);
-
-    // GBuffer Pass
-    {
-        SAFE_DELETE(gbufferRTV);
-        gbufferRTV = new DXRenderTarget(m_device, width, height, DXFormat::R8G8B8A8_UNORM, gbufferDSV);
-        gbufferRTV->CreateSRV(m_device, &tex2dSRVDesc);
-        gbufferRTV->DestoryResource();
-        gbufferRTV->CreateRenderTarget(m_device);
-        gbufferRTV->CreateSRV(m_device, &tex2dSRVDesc);
-        gbufferRTV->DestoryResource();
-        gbufferRTV->CreateRenderTarget(m_device);
-        gbufferRTV->CreateSRV(m_device, &tex2dSRVDesc);
-    }
-
-    // DeferredLighting
-    {
-        SAFE_DELETE(ambientLightingRTV);
-        ambientLightingRTV = new DXRenderTarget(m_device, width, height, DXFormat::R8G8B8A8_UNORM, ambientLightingDSV);
-        ambientLightingRTV->CreateSRV(m_device, &tex2dSRVDesc);
-    }
-
-    // SSAO
-    {
-        SAFE_DELETE(ssaoRTV);
-        ssaoRTV = new DXRenderTarget(m_device, width, height, DXFormat::R8G8B8A8_UNORM, ssaoDSV);
-        ssaoRTV->CreateSRV(m_device, nullptr);
-        ssaoRTV->CreateUAV(m_device, nullptr);
-
-        SAFE_DELETE(ssaoBlurRTV);
-        ssaoBlurRTV = new DXRenderTarget(m_device, width, height, DXFormat::R8G8B8A8_UNORM, ssaoBlurDSV);
-        ssaoBlurRTV->CreateSRV(m_device, &tex2dSRVDesc);
-        ssaoBlurRTV->CreateUAV(m_device, nullptr);
-    }
-
-    // Sun
-    {
-        SAFE_DELETE(sunRTV);
-        sunRTV = new DXRenderTarget(m_device, width, height, DXFormat::R8G8B8A8_UNORM, gbufferDSV);
-        sunRTV->CreateSRV(m_device, nullptr);
-    }
+    CreateFrameGraphTargets(width, height);
 
     // Postprocess
     {
@@ -547,36 +498,303 @@ void Renderer::CreateOtherResources()
         ssaoNoiseTex->CreateSRV(m_device, &tex2dSRVDesc);
     }
 
-    // Blur
+    // Sun
     {
-        SAFE_DELETE(blurTextureIntermediate);
-        blurTextureIntermediate = new DXResource();
-        blurTextureIntermediate->Initialize(m_device, m_width, m_height, DXFormat::R16G16B16A16_FLOAT);
-        blurTextureIntermediate->CreateSRV(m_device, nullptr);
-        blurTextureIntermediate->CreateUAV(m_device, nullptr);
+        sunTex = g_TextureManager.LoadTexture(ToWideString("Resources/Models/Sun/Sun.png"));
     }
+}
 
-    // Sun
+// Declares the frame as Render() runs it. Without a setting every optional pass is declared: lifetimes only shrink
+// when passes are left out, so targets aliased for that graph stay valid whatever the settings are.
+// The forward path is not part of the frame, its HDR targets are culled
+FrameGraphResources Renderer::BuildFrameGraph(RenderGraph& graph, uint32 width, uint32 height, RenderSetting const* setting)
+{
+    const DXBindFlag colorFlags = DXBindFlag::RenderTarget | DXBindFlag::ShaderResource | DXBindFlag::UnorderedAccess;
+    const DXBindFlag depthFlags = DXBindFlag::DepthStencil | DXBindFlag::ShaderResource;
+    auto Target = [width, height](DXFormat format, DXBindFlag bindFlags) {
+        return RGTextureDesc{width, height, 1, format, bindFlags};
+    };
+    const RGTextureDesc color = Target(DXFormat::R8G8B8A8_UNORM, colorFlags);
+    const RGTextureDesc hdrColor = Target(DXFormat::R16G16B16A16_FLOAT, colorFlags);
+    const RGTextureDesc gbufferColor = Target(DXFormat::R8G8B8A8_UNORM, DXBindFlag::RenderTarget | DXBindFlag::ShaderResource);
+    const RGTextureDesc depthStencil = Target(DXFormat::R24G8_TYPELESS, depthFlags);
+    const RGTextureDesc depth = Target(DXFormat::R32_TYPELESS, depthFlags);
+
+    FrameGraphResources r{};
+    // cached shadow maps, the output the editor samples after the frame and the picking target
+    r.shadowMap = graph.ImportTexture("Shadow Map", {SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, 1, DXFormat::R32_TYPELESS, depthFlags});
+    r.shadowCascadeMap = graph.ImportTexture(
+        "Shadow Cascade Map", {SHADOW_CASCADE_SIZE, SHADOW_CASCADE_SIZE, CASCADE_COUNT, DXFormat::R32_TYPELESS, depthFlags});
+    const DXTextureMiscFlag cube = DXTextureMiscFlag::TextureCube;
+    const RGTextureDesc shadowCubeMap{SHADOW_CUBE_SIZE, SHADOW_CUBE_SIZE, 6, DXFormat::R32_TYPELESS, depthFlags, cube};
+    r.shadowCubeMap = graph.ImportTexture("Shadow Cube Map", shadowCubeMap);
+    r.postprocess[0] = graph.ImportTexture("Postprocess Ping", color);
+    r.postprocess[1] = graph.ImportTexture("Postprocess Pong", color);
+    r.entityId = graph.ImportTexture("Entity ID", Target(DXFormat::R32G32B32A32_FLOAT, colorFlags));
+    r.entityIdDepth = graph.ImportTexture("Entity ID Depth", depth);
+
+    r.hdr = graph.CreateTexture("HDR", color);
+    r.hdrDepth = graph.CreateTexture("HDR Depth", depthStencil);
+    for (uint32 i = 0; i < r.gbuffer.size(); ++i)
+        r.gbuffer[i] = graph.CreateTexture("GBuffer " + std::to_string(i), gbufferColor);
+    r.gbufferDepth = graph.CreateTexture("GBuffer Depth", depthStencil);
+    r.depthMap = graph.CreateTexture("Depth Map", depth);
+    r.ambientLighting = graph.CreateTexture("Ambient Lighting", color);
+    r.ambientLightingDepth = graph.CreateTexture("Ambient Lighting Depth", depthStencil);
+    r.ssao = graph.CreateTexture("SSAO", color);
+    r.ssaoDepth = graph.CreateTexture("SSAO Depth", depthStencil);
+    r.ssaoBlur = graph.CreateTexture("SSAO Blur", color);
+    r.ssaoBlurDepth = graph.CreateTexture("SSAO Blur Depth", depthStencil);
+    r.sun = graph.CreateTexture("Sun", color);
+    r.blurIntermediate = graph.CreateTexture("Blur Intermediate", hdrColor);
+    r.tiledLighting = graph.CreateTexture("Tiled Lighting", hdrColor);
+    r.tiledLightingDebug = graph.CreateTexture("Tiled Lighting Debug", hdrColor);
+    r.postprocessDepth[0] = graph.CreateTexture("Postprocess Ping Depth", depthStencil);
+    r.postprocessDepth[1] = graph.CreateTexture("Postprocess Pong Depth", depthStencil);
+
+    const bool allPasses = setting == nullptr;
+    const bool tiled = allPasses || setting->lighting != LightingType::Deferred;
+    auto ReadGBuffer = [&r](RGPass& pass) -> RGPass& {
+        for (RGResourceId id : r.gbuffer)
+            pass.Read(id);
+        return pass;
+    };
+    auto ReadShadowMaps = [&r](RGPass& pass) -> RGPass& {
+        return pass.Read(r.shadowMap).Read(r.shadowCubeMap).Read(r.shadowCascadeMap);
+    };
+
+    graph.AddPass("Shadow Maps")
+        .Write(r.shadowMap, RGAccess::DepthStencil)
+        .Write(r.shadowCascadeMap, RGAccess::DepthStencil)
+        .Write(r.shadowCubeMap, RGAccess::DepthStencil);
     {
-        sunTex = g_TextureManager.LoadTexture(ToWideString("Resources/Models/Sun/Sun.png"));
+        RGPass& gbuffer = graph.AddPass("GBuffer");
+        for (RGResourceId id : r.gbuffer)
+            gbuffer.Write(id);
+        gbuffer.Write(r.gbufferDepth, RGAccess::DepthStencil);
+    }
+    ReadGBuffer(graph.AddPass("SSAO")).Read(r.gbufferDepth).Write(r.ssao).Write(r.ssaoDepth, RGAccess::DepthStencil);
+    graph.AddPass("SSAO Blur X").Read(r.ssao).Write(r.blurIntermediate, RGAccess::UnorderedAccess);
+    graph.AddPass("SSAO Blur Y").Read(r.blurIntermediate).Write(r.ssao, RGAccess::UnorderedAccess);
+    ReadGBuffer(graph.AddPass("Ambient"))
+        .Read(r.ssao)
+        .Write(r.ambientLighting)
+        .Write(r.ambientLightingDepth, RGAccess::DepthStencil);
+
+    if (allPasses || setting->lighting == LightingType::Deferred)
+    {
+        ReadShadowMaps(ReadGBuffer(graph.AddPass("Deferred Lighting")).Read(r.gbufferDepth))
+            .Write(r.ambientLighting)
+            .Write(r.ambientLightingDepth, RGAccess::DepthStencil);
+    }
+    if (tiled)
+    {
+        ReadShadowMaps(ReadGBuffer(graph.AddPass("Tiled Deferred Lighting")).Read(r.gbufferDepth))
+            .Write(r.tiledLighting, RGAccess::UnorderedAccess)
+            .Write(r.tiledLightingDebug, RGAccess::UnorderedAccess);
+
+        RGPass& composite = graph.AddPass("Tiled Lighting Composite");
+        if (allPasses || setting->lighting == LightingType::TiledDeferred)
+            composite.Read(r.tiledLighting);
+        if (allPasses || setting->lighting == LightingType::TiledDeferred_DEBUG)
+            composite.Read(r.tiledLightingDebug);
+        composite.Write(r.ambientLighting).Write(r.ambientLightingDepth, RGAccess::DepthStencil);
     }
 
-    // uav
+    if (allPasses || setting->ssr)
     {
-        SAFE_DELETE(uavTarget);
-        uavTarget = new DXResource();
-        uavTarget->Initialize(m_device, m_width, m_height, DXFormat::R16G16B16A16_FLOAT);
-        uavTarget->CreateSRV(m_device, nullptr);
-        uavTarget->CreateUAV(m_device, nullptr);
+        ReadGBuffer(graph.AddPass("SSR"))
+            .Read(r.gbufferDepth)
+            .Read(r.ambientLighting)
+            .Write(r.postprocess[0])
+            .Write(r.postprocessDepth[0], RGAccess::DepthStencil);
     }
+    graph.AddPass("Draw Sun").Write(r.sun).Write(r.gbufferDepth, RGAccess::DepthStencil);
+    graph.AddPass("Sun Blur X").Read(r.sun).Write(r.blurIntermediate, RGAccess::UnorderedAccess);
+    graph.AddPass("Sun Blur Y").Read(r.blurIntermediate).Write(r.sun, RGAccess::UnorderedAccess);
+    graph.AddPass("Halo and Gods Ray")
+        .Read(r.gbufferDepth)
+        .Read(r.sun)
+        .Write(r.postprocess[0])
+        .Write(r.postprocessDepth[0], RGAccess::DepthStencil);
+
+    // PassPostprocessing starts every frame on ping, FXAA resolves into pong and the frame ends on the last target
+    // written. The graph with every pass declares both ends so neither depth buffer is aliased before the AABB pass
+    if (allPasses || setting->fxaa)
+        graph.AddPass("FXAA").Read(r.postprocess[0]).Write(r.postprocess[1]).Write(r.postprocessDepth[1], RGAccess::DepthStencil);
+    RGPass& aabb = graph.AddPass("AABB");
+    for (uint32 output = 0; output < 2; ++output)
+    {
+        if (allPasses || setting->fxaa == (output == 1))
+            aabb.Write(r.postprocess[output]).Write(r.postprocessDepth[output], RGAccess::DepthStencil);
+    }
+    return r;
+}
+
+// Creates one texture per physical slot of the compiled frame graph. Every transient target is a set of views
+// on the texture of its slot, so targets the graph aliased share memory. Culled targets stay null
+void Renderer::CreateFrameGraphTargets(uint32 width, uint32 height)
+{
+    SAFE_DELETE(hdrRTV);
+    SAFE_DELETE(gbufferRTV);
+    SAFE_DELETE(ambientLightingRTV);
+    SAFE_DELETE(ssaoRTV);
+    SAFE_DELETE(ssaoBlurRTV);
+    SAFE_DELETE(sunRTV);
+    SAFE_DELETE(blurTextureIntermediate);
+    SAFE_DELETE(uavTarget);
+    SAFE_DELETE(debugTiledTexture);
+    SAFE_DELETE(hdrDSV);
+    SAFE_DELETE(gbufferDSV);
+    SAFE_DELETE(depthMapDSV);
+    SAFE_DELETE(ambientLightingDSV);
+    SAFE_DELETE(ssaoDSV);
+    SAFE_DELETE(ssaoBlurDSV);
+    SAFE_DELETE(pingPostprocessDSV);
+    SAFE_DELETE(pongPostprocessDSV);
+
+    frameGraph = RenderGraph{};
+    const FrameGraphResources r = BuildFrameGraph(frameGraph, width, height, nullptr);
+    frameGraph.Compile();
+
+    std::vector<ID3D11Texture2D*> textures;
+    for (RGTextureDesc const& desc : frameGraph.PhysicalTextures())
+    {
+        D3D11_TEXTURE2D_DESC texDesc{};
+        texDesc.Width = desc.width;
+        texDesc.Height = desc.height;
+        texDesc.MipLevels = 1;
+        texDesc.ArraySize = desc.arraySize;
+        texDesc.Format = ConvertDXFormat(desc.format);
+        texDesc.SampleDesc.Count = 1;
+        texDesc.Usage = D3D11_USAGE_DEFAULT;
+        texDesc.BindFlags = ParseBindFlags(desc.bindFlags);
+        texDesc.MiscFlags = ParseMiscFlags(desc.miscFlags);
+
+        ID3D11Texture2D* texture = nullptr;
+        HR(m_device->CreateTexture2D(&texDesc, nullptr, &texture));
+        textures.push_back(texture);
+    }
+
+    // a new reference to the texture of a resource, null when the graph culled it
+    auto Texture = [&](RGResourceId id) -> ID3D11Texture2D* {
+        const uint32 physical = frameGraph.Resource(id).physical;
+        if (physical == RG_INVALID_INDEX)
+            return nullptr;
+        textures[physical]->AddRef();
+        return textures[physical];
+    };
+    auto DepthBuffer = [&](RGResourceId id, bool isStencilEnable, D3D11_SHADER_RESOURCE_VIEW_DESC* srvDesc) -> DXDepthStencilBuffer* {
+        ID3D11Texture2D* texture = Texture(id);
+        if (!texture)
+            return nullptr;
+        DXDepthStencilBuffer* buffer = new DXDepthStencilBuffer(m_device, texture, isStencilEnable);
+        if (srvDesc)
+            buffer->CreateSRV(m_device, srvDesc);
+        return buffer;
+    };
+    // the target keeps the reference of its current texture, the views keep the others alive (as the GBuffer always did)
+    auto RenderTarget = [&](std::initializer_list<RGResourceId> ids, DXDepthStencilBuffer* dsv,
+                            D3D11_SHADER_RESOURCE_VIEW_DESC* srvDesc, bool uav) -> DXRenderTarget* {
+        DXRenderTarget* target = nullptr;
+        for (RGResourceId id : ids)
+        {
+            ID3D11Texture2D* texture = Texture(id);
+            if (!texture)
+                break;
+            ID3D11RenderTargetView* rtv = nullptr;
+            HR(m_device->CreateRenderTargetView(texture, nullptr, &rtv));
+            if (target == nullptr)
+            {
+                target = new DXRenderTarget(m_device, rtv, dsv);
+            }
+            else
+            {
+                target->DestoryResource();
+                target->CreateRenderTarget(m_device, rtv);
+            }
+            target->CreateSRV(m_device, srvDesc);
+            if (uav)
+                target->CreateUAV(m_device, nullptr);
+        }
+        return target;
+    };
+    auto Resource = [&](RGResourceId id) -> DXResource* {
+        ID3D11Texture2D* texture = Texture(id);
+        if (!texture)
+            return nullptr;
+        DXResource* resource = new DXResource();
+        resource->Initialize(texture);
+        resource->CreateSRV(m_device, nullptr);
+        resource->CreateUAV(m_device, nullptr);
+        return resource;
+    };
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC tex2dSRVDesc;
+    ZeroMemory(&tex2dSRVDesc, sizeof(tex2dSRVDesc));
+    tex2dSRVDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    tex2dSRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    tex2dSRVDesc.Texture2D.MipLevels = 1;
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC gbufferSRVDesc;
+    ZeroMemory(&gbufferSRVDesc, sizeof(gbufferSRVDesc));
+    gbufferSRVDesc.Format = DXGI_FORMAT_R24_UNORM_X8_TYPELESS;
+    gbufferSRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    gbufferSRVDesc.Texture2D.MipLevels = 1;
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC defaultDepthMapDesc;
+    ZeroMemory(&defaultDepthMapDesc, sizeof(defaultDepthMapDesc));
+    defaultDepthMapDesc.Format = DXGI_FORMAT_R32_FLOAT;
+    defaultDepthMapDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    defaultDepthMapDesc.Texture2D.MipLevels = 1;
+
+    hdrDSV = DepthBuffer(r.hdrDepth, true, nullptr);
+    gbufferDSV = DepthBuffer(r.gbufferDepth, true, &gbufferSRVDesc);
+    depthMapDSV = DepthBuffer(r.depthMap, false, &defaultDepthMapDesc);
+    ambientLightingDSV = DepthBuffer(r.ambientLightingDepth, true, nullptr);
+    ssaoDSV = DepthBuffer(r.ssaoDepth, true, nullptr);
+    ssaoBlurDSV = DepthBuffer(r.ssaoBlurDepth, true, nullptr);
+    pingPostprocessDSV = DepthBuffer(r.postprocessDepth[0], true, nullptr);
+    pongPostprocessDSV = DepthBuffer(r.postprocessDepth[1], true, nullptr);
+
+    hdrRTV = RenderTarget({r.hdr}, hdrDSV, nullptr, false);
+    gbufferRTV = RenderTarget({r.gbuffer[0], r.gbuffer[1], r.gbuffer[2]}, gbufferDSV, &tex2dSRVDesc, false);
+    ambientLightingRTV = RenderTarget({r.ambientLighting}, ambientLightingDSV, &tex2dSRVDesc, false);
+    ssaoRTV = RenderTarget({r.ssao}, ssaoDSV, nullptr, true);
+    ssaoBlurRTV = RenderTarget({r.ssaoBlur}, ssaoBlurDSV, &tex2dSRVDesc, true);
+    sunRTV = RenderTarget({r.sun}, gbufferDSV, nullptr, false);
+
+    blurTextureIntermediate = Resource(r.blurIntermediate);
+    uavTarget = Resource(r.tiledLighting);
+    debugTiledTexture = Resource(r.tiledLightingDebug);
+
+    for (ID3D11Texture2D* texture : textures)
+        SAFE_RELEASE(texture);
+
+    RGMemoryStats const stats = frameGraph.MemoryStats();
+    RI_TRACE("Frame graph {}x{}: {} targets, {} culled, {} textures, {:.1f}MB instead of {:.1f}MB", width, height, stats.resources,
+             stats.culled, stats.physical, stats.aliasedBytes / (1024.0 * 1024.0), stats.dedicatedBytes / (1024.0 * 1024.0));
+}
 
-    // debug tile teuxture
+void Renderer::ReportFrameGraphMemory() const
+{
+    static constexpr std::pair<uint32, uint32> resolutions[] = {{1920, 1080}, {2560, 1440}, {3840, 2160}};
+    auto MB = [](uint64 bytes) { return bytes / (1024.0 * 1024.0); };
+
+    RI_INFO("Render Target Memory (dedicated -> aliased)");
+    for (auto [width, height] : resolutions)
     {
-        SAFE_DELETE(debugTiledTexture);
-        debugTiledTexture = new DXResource();
-        debugTiledTexture->Initialize(m_device, m_width, m_height, DXFormat::R16G16B16A16_FLOAT);
-        debugTiledTexture->CreateSRV(m_device, nullptr);
-        debugTiledTexture->CreateUAV(m_device, nullptr);
+        RenderGraph allPasses;
+        BuildFrameGraph(allPasses, width, height, nullptr);
+        allPasses.Compile();
+        RenderGraph current;
+        BuildFrameGraph(current, width, height, &renderSetting);
+        current.Compile();
+
+        RGMemoryStats const all = allPasses.MemoryStats();
+        RGMemoryStats const now = current.MemoryStats();
+        RI_INFO("  {}x{}: {:.1f}MB -> {:.1f}MB allocated ({} textures for {} targets), {:.1f}MB with the current settings", width,
+                height, MB(all.dedicatedBytes), MB(all.aliasedBytes), all.physical, all.resources - all.culled, MB(now.aliasedBytes));
     }
 }
 
@@ -687,6 +905,7 @@ void Renderer::BindGlobals()
         postProcessGPU->Bind(m_context, DXShaderStage::PS, 4);
 
         // GS
+        objectConstsGPU->Bind(m_context, DXShaderStage::GS, 1);
         shadowConstsGPU->Bind(m_context, DXShaderStage::GS, 3);
 
         // CS
@@ -717,29 +936,340 @@ void Renderer::BindGlobals()
     }
 }
 
-void Renderer::LightFrustumCulling(const Light& light)
+static CullPlanes PlanesFromViewProj(Matrix const& viewRow, Matrix const& projRow)
+{
+    BoundingFrustum frustum(projRow);
+    frustum.Transform(frustum, viewRow.Invert());
+    return CullPlanes::FromFrustum(frustum);
+}
+
+uint32 Renderer::AddView(Matrix const& viewRow, Matrix const& projRow, CullPlanes const& planes, float resolution, float split)
+{
+    cullViews.push_back(CullView{viewRow, projRow, resolution, split});
+    cullPlanes.push_back(planes);
+    return static_cast<uint32>(cullViews.size() - 1);
+}
+
+void Renderer::CollectViews()
 {
-    auto visibiltiyView = m_reg.view<AABB>();
-    for (auto& e : visibiltiyView)
+    cullViews.clear();
+    cullPlanes.clear();
+    shadowViews.clear();
+
+    AddView(m_camera->GetView().Transpose(), m_camera->GetProj().Transpose(), CullPlanes::FromFrustum(m_camera->Frustum()),
+            static_cast<float>(m_height));
+
+    auto lightView = m_reg.view<Light>();
+    for (auto e : lightView)
     {
-        if (m_reg.try_get<Light>(e))
-            continue;
+        auto& light = lightView.get<Light>(e);
+        if (!light.shadowMappingFlag)
+            AddShadowViews(e, light);
+    }
+    viewDrawCounts.assign(cullViews.size(), 0);
+}
+
+void Renderer::AddShadowViews(entt::entity e, const Light& light)
+{
+    // only directional, spot and point lights have shadow maps, the others get no views
+    if (light.type != LightType::Directional && light.type != LightType::Spot && light.type != LightType::Point)
+        return;
 
-        auto& aabb = visibiltiyView.get<AABB>(e);
+    ShadowViews views{e, static_cast<uint32>(cullViews.size()), 0};
+    BoundingBox cullBox;
 
-        switch (light.type)
+    if (light.type == LightType::Directional && light.useCascades)
+    {
+        std::array<float, CASCADE_COUNT> splitDistances{};
+        std::array<Matrix, CASCADE_COUNT> cascadeFrustumProjRow =
+            LightFrustum::RecalcProjectionMatrices(m_camera, SPLIT_LAMBDA, splitDistances);
+
+        for (uint32 i = 0; i < CASCADE_COUNT; ++i)
         {
-        case LightType::Directional:
-            aabb.isLightVisible = aabb.isLightVisible ? true : lightBoundingBox.Intersects(aabb.boundingBox);
-            break;
-        case LightType::Point:
-        case LightType::Spot:
-            aabb.isLightVisible = aabb.isLightVisible ? true : lightBoundingFrustum.Intersects(aabb.boundingBox);
-            break;
-        default:
-            assert(false && "LightFrustumCulling Error!");
+            const auto& [V, P] =
+                LightFrustum::CascadeDirectionalLightViewProjection(light, m_camera, cascadeFrustumProjRow[i], cullBox);
+            AddView(V, P, CullPlanes::FromBox(cullBox), static_cast<float>(SHADOW_CASCADE_SIZE), splitDistances[i]);
         }
     }
+    else if (light.type == LightType::Directional)
+    {
+        const auto& [V, P] = LightFrustum::DirectionalLightViewProjection(light, m_camera, cullBox);
+        AddView(V, P, CullPlanes::FromBox(cullBox), static_cast<float>(SHADOW_MAP_SIZE));
+    }
+    else if (light.type == LightType::Spot)
+    {
+        Vector3 lightDir = Vector3(light.direction);
+        lightDir.Normalize();
+        Vector3 lightPos = Vector3(light.position);
+        Vector3 targetPos = lightPos + lightDir * light.range;
+        Vector3 up = Vector3::Up;
+        if (abs(up.Dot(lightDir) + 1.0f) < 1e-5)
+            up = Vector3(1.0f, 0.0f, 0.0f);
+
+        Matrix lightViewRow = DirectX::XMMatrixLookAtLH(lightPos, targetPos, up);
+        float fovAngle = 2.0f * acos(light.outer_cosine);
+        Matrix lightProjRow = DirectX::XMMatrixPerspectiveFovLH(fovAngle, 1.0f, 0.5f, light.range);
+        AddView(lightViewRow, lightProjRow, PlanesFromViewProj(lightViewRow, lightProjRow), static_cast<float>(SHADOW_MAP_SIZE));
+    }
+    else if (light.type == LightType::Point)
+    {
+        Vector3 directions[6] = {{1.0f, 0.0f, 0.0f},  {-1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f},
+                                 {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f},  {0.0f, 0.0f, -1.0f}};
+        Vector3 up[6] = {{0.0f, 1.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f},
+                         {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+
+        const float fov = 2.0f * acos(light.outer_cosine);
+        Matrix lightProjRow = DirectX::XMMatrixPerspectiveFovLH(fov, 1.0f, 0.5f, light.range);
+        for (uint32 face = 0; face < 6; ++face)
+        {
+            Matrix lightViewRow = DirectX::XMMatrixLookAtLH(light.position, light.position + directions[face] * light.range, up[face]);
+            AddView(lightViewRow, lightProjRow, PlanesFromViewProj(lightViewRow, lightProjRow), static_cast<float>(SHADOW_CUBE_SIZE));
+        }
+    }
+
+    views.viewCount = static_cast<uint32>(cullViews.size()) - views.firstView;
+    assert(views.viewCount <= 32 && "viewMask holds at most 32 views per light");
+    shadowViews.push_back(views);
+}
+
+// Coarsest level whose error stays under lodPixelError pixels in the view, from the bounding sphere of the mesh
+uint32 Renderer::SelectLOD(Mesh const& mesh, WorldTransform const& world, CullView const& view) const
+{
+    if (!renderSetting.meshLODs || mesh.lodCount == 0)
+        return 0;
+
+    const float radius = Vector3(world.boundingBox.Extents).Length();
+    const Vector3 center = Vector3::Transform(Vector3(world.boundingBox.Center), view.viewRow);
+    // orthographic projections have the same scale at every depth
+    float depth = 1.0f;
+    if (view.projRow._34 != 0.0f)
+    {
+        if (center.z <= radius)
+            return 0;
+        depth = center.z;
+    }
+    const float pixelRadius = radius * view.projRow._22 / depth * 0.5f * view.resolution;
+
+    uint32 lod = 0;
+    while (lod < mesh.lodCount && mesh.lods[lod].error * pixelRadius <= renderSetting.lodPixelError)
+        ++lod;
+    return lod;
+}
+
+void Renderer::DrawShadowCasters(ShadowViews const& views, ShadowCasterView const& casters, DXCommandList& list)
+{
+    // each caster is drawn once, the geometry shader only emits it into the views that see it
+    ClusterCullStats& clusterStats = shadowClusterStats[&views - shadowViews.data()];
+    const ClusterCullView cullView{std::span(cullPlanes).subspan(views.firstView, views.viewCount)};
+    std::vector<ClusterRange> ranges;
+    ForEachVisible(viewVisibility, views.firstView, views.viewCount, [&](uint32 slot, uint32 viewMask) {
+        entt::entity e = transformSystem->GetEntity(slot);
+        if (!casters.contains(e))
+            return;
+
+        WorldTransform const& world = transformSystem->Get(e);
+        Mesh const& mesh = casters.get<Mesh>(e);
+        ObjectConsts objectConsts{};
+        objectConsts.world = world.world;
+        objectConsts.worldInvTranspose = world.worldInvTranspose;
+        objectConsts.viewMask = viewMask;
+        objectConsts.positionBias = mesh.positionBias;
+        objectConsts.positionScale = mesh.positionScale;
+        PushDrawConstants(list, objectConstsGPU, &objectConsts, sizeof(objectConsts), 1, {DXShaderStage::VS, DXShaderStage::GS});
+
+        // the finest level any of the views needs, shadows can go coarser than that
+        uint32 lod = mesh.lodCount;
+        for (uint32 mask = viewMask; mask; mask &= mask - 1)
+            lod = std::min(lod, SelectLOD(mesh, world, cullViews[views.firstView + std::countr_zero(mask)]));
+        const uint32 bias = renderSetting.meshLODs ? renderSetting.shadowLODBias : 0;
+        lod = std::min(lod + bias, mesh.lodCount);
+
+        // clusters outside every view of the light are skipped, shadows have no eye to cull backfaces against
+        MeshClusters const* clusters = m_reg.try_get<MeshClusters>(e);
+        if (renderSetting.clusterCulling && lod == 0 && clusters && clusters->meshletCount > 0)
+        {
+            ranges.clear();
+            ClusterCulling::Cull(*clusters, mesh, world, cullView, ranges, clusterStats);
+            for (ClusterRange const& range : ranges)
+                mesh.DrawRange(list, range.startIndexLoc, range.indexCount);
+        }
+        else
+            mesh.DrawLOD(list, lod);
+
+        for (uint32 mask = viewMask; mask; mask &= mask - 1)
+            ++viewDrawCounts[views.firstView + std::countr_zero(mask)];
+    });
+    RestoreDrawConstants(list);
+}
+
+// Constants of a recorded draw go to a window of the upload ring. Without a ring, or once it is full, they are
+// copied into the list and the shared constant buffer is bound again in place of the windows
+void Renderer::PushDrawConstants(DXCommandList& list, DXBuffer* fallback, void const* data, uint32 size, uint32 slot,
+                                 std::initializer_list<DXShaderStage> stages)
+{
+    DXUploadAllocation window = drawConstants ? drawConstants->Allocate(size) : DXUploadAllocation{};
+    if (window.IsValid())
+    {
+        memcpy(window.data, data, size);
+        for (DXShaderStage stage : stages)
+            list.BindConstants(constantRing->GetBuffer(), stage, slot, window.offset, window.size);
+        return;
+    }
+
+    if (drawConstants)
+    {
+        for (DXShaderStage stage : stages)
+            list.BindConstants(fallback, stage, slot);
+    }
+    fallback->Update(list, data, size);
+}
+
+// The immediate passes keep updating the shared constant buffers, bind them back where the windows went
+void Renderer::RestoreDrawConstants(DXCommandList& list)
+{
+    if (!drawConstants)
+        return;
+    list.BindConstants(objectConstsGPU, DXShaderStage::VS, 1);
+    list.BindConstants(objectConstsGPU, DXShaderStage::GS, 1);
+    list.BindConstants(materialConstsGPU, DXShaderStage::PS, 1);
+}
+
+// Writes the fields of the light's shadow maps, the fields of other light types are left as they are
+void Renderer::FillShadowConsts(Light const& light, ShadowViews const& views, ShadowConsts& shadowConsts) const
+{
+    const Matrix cameraViewInverse = m_camera->GetView().Invert();
+    if (light.type == LightType::Directional && light.useCascades)
+    {
+        for (uint32 i = 0; i < CASCADE_COUNT; ++i)
+        {
+            CullView const& view = cullViews[views.firstView + i];
+            shadowConsts.shadowCascadeMapViewProj[i] = (view.viewRow * view.projRow).Transpose();
+            shadowConsts.shadowMatrices[i] = shadowConsts.shadowCascadeMapViewProj[i] * cameraViewInverse;
+            shadowConsts.splits[i] = view.split;
+        }
+        shadowConsts.shadowMapSize = SHADOW_CASCADE_SIZE;
+    }
+    else if (light.type == LightType::Directional || light.type == LightType::Spot)
+    {
+        CullView const& view = cullViews[views.firstView];
+        shadowConsts.lightViewProj = (view.viewRow * view.projRow).Transpose();
+        shadowConsts.lightView = view.viewRow.Transpose();
+        shadowConsts.shadowMatrices[0] = shadowConsts.lightViewProj * cameraViewInverse;
+        shadowConsts.shadowMapSize = SHADOW_MAP_SIZE;
+    }
+    else if (light.type == LightType::Point)
+    {
+        for (uint32 face = 0; face < 6; ++face)
+        {
+            CullView const& view = cullViews[views.firstView + face];
+            shadowConsts.shadowCubeMapViewProj[face] = (view.viewRow * view.projRow).Transpose();
+        }
+        shadowConsts.shadowMapSize = SHADOW_CUBE_SIZE;
+    }
+}
+
+// Lights record into their own lists, in parallel when asked. Only per light state is written while recording:
+// the lists, the draw counts of the light's views and the constants copied into its list
+void Renderer::RecordShadowMaps(std::vector<DXCommandList>& lists, bool parallel)
+{
+    lists.resize(shadowViews.size());
+    shadowClusterStats.assign(shadowViews.size(), ClusterCullStats{});
+    auto lightView = m_reg.view<Light>();
+    const ShadowCasterView casters = m_reg.view<Mesh>(entt::exclude<Light>);
+
+    /* The lighting passes read the constants the last shadow list uploaded, so every upload carries the matrices of
+     * all lights, gathered here in list order before the lights record. A light overwrites its own fields in its copy,
+     * the depth pass of a spot light needs its lightViewProj even when a directional light comes after it */
+    for (ShadowViews const& views : shadowViews)
+        FillShadowConsts(lightView.get<Light>(views.light), views, shadowConstsCPU);
+
+    auto RecordLight = [&](ShadowViews const& views) {
+        DXCommandList& list = lists[&views - shadowViews.data()];
+        list.Reset();
+        std::fill_n(viewDrawCounts.begin() + views.firstView, views.viewCount, 0u);
+
+        Light const& light = lightView.get<Light>(views.light);
+        if (light.type == LightType::Spot)
+        {
+            PassShadowMapSpot(light, views, casters, list);
+        }
+        else if (light.type == LightType::Directional)
+        {
+            light.useCascades ? PassShadowMapCascade(light, views, casters, list)
+                              : PassShadowMapDirectional(light, views, casters, list);
+        }
+        else if (light.type == LightType::Point)
+        {
+            PassShadowMapPoint(light, views, casters, list);
+        }
+    };
+    if (parallel)
+        std::for_each(std::execution::par, shadowViews.begin(), shadowViews.end(), RecordLight);
+    else
+        std::for_each(shadowViews.begin(), shadowViews.end(), RecordLight);
+}
+
+void Renderer::RunCommandListBenchmark(uint32 iterations)
+{
+    DXNullBackend nullBackend;
+    DXCommandList gbufferList;
+    std::vector<DXCommandList> shadowLists;
+    RileyTimer timer;
+
+    // the frame's ring may still be waiting for its upload, record into one of our own
+    DXUploadRing benchmarkRing(constantRing->FrameCapacity(), 1);
+    DXUploadRing* frameConstants = std::exchange(drawConstants, &benchmarkRing);
+
+    auto Average = [iterations](float seconds) { return seconds * 1000.0f / iterations; };
+    auto Measure = [&](auto&& f) {
+        timer.Mark();
+        for (uint32 i = 0; i < iterations; ++i)
+            f();
+        return Average(timer.MarkInSeconds());
+    };
+
+    const float collectMs = Measure([&] { CollectGBufferBatches(); });
+    ReserveInstanceBuffer();
+    const float gbufferMs = Measure([&] {
+        benchmarkRing.Rewind();
+        gbufferList.Reset();
+        PassGBuffer(gbufferList);
+    });
+    const uint32 gbufferConstants = benchmarkRing.UsedBytes();
+    const float shadowSerialMs = Measure([&] {
+        benchmarkRing.Rewind();
+        RecordShadowMaps(shadowLists, false);
+    });
+    const float shadowParallelMs = Measure([&] {
+        benchmarkRing.Rewind();
+        RecordShadowMaps(shadowLists, true);
+    });
+    const uint32 shadowConstants = benchmarkRing.UsedBytes();
+    drawConstants = frameConstants;
+    const float executeMs = Measure([&] {
+        nullBackend.Execute(gbufferList);
+        for (DXCommandList const& list : shadowLists)
+            nullBackend.Execute(list);
+    });
+
+    uint32 commands = gbufferList.CommandCount();
+    size_t bytes = gbufferList.SizeInBytes();
+    for (DXCommandList const& list : shadowLists)
+    {
+        commands += list.CommandCount();
+        bytes += list.SizeInBytes();
+    }
+    DXNullBackendStats const& stats = nullBackend.Stats();
+
+    RI_INFO("Command List Benchmark ({} iterations, {} shadow lights)", iterations, shadowLists.size());
+    RI_INFO("  collect GBuffer batches {:.3f}ms, record GBuffer {:.3f}ms, shadows serial {:.3f}ms, parallel {:.3f}ms", collectMs,
+            gbufferMs, shadowSerialMs, shadowParallelMs);
+    RI_INFO("  null execute {:.3f}ms, {} commands, {} KB per frame", executeMs, commands, bytes / 1024);
+    auto PerFrame = [&](DXCommandType type) { return stats.commands[static_cast<size_t>(type)] / iterations; };
+    RI_INFO("  per frame: {} draws, {} buffer updates ({} KB), {} program binds", PerFrame(DXCommandType::DrawIndexed),
+            PerFrame(DXCommandType::UpdateBuffer), stats.uploadBytes / iterations / 1024, PerFrame(DXCommandType::BindProgram));
+    RI_INFO("  per frame: {} constant windows bound, {} KB packed into the upload ring", PerFrame(DXCommandType::BindConstants),
+            (gbufferConstants + shadowConstants) / 1024);
 }
 
 void Renderer::UpdateLights()
@@ -754,7 +1284,10 @@ void Renderer::UpdateLights()
     {
         s_lightCount = currentLightCount;
         if (!s_lightCount)
+        {
+            shadowCommands.clear();
             return;
+        }
 
         SAFE_DELETE(lights);
 
@@ -789,23 +1322,21 @@ void Renderer::UpdateLights()
         l.position = Vector4::Transform(l.position, cameraView);
 
         lightsData.push_back(l);
+    }
 
-        // Shadow Mapping
-        if (!light.shadowMappingFlag)
+    // Shadow Mapping, the views of every light were culled together in Update. The lists run in Render,
+    // after the constants of the frame are uploaded
+    RecordShadowMaps(shadowCommands, true);
+    for (ShadowViews const& views : shadowViews)
+        m_reg.get<Light>(views.light).shadowMappingFlag = true;
+
+    if (!shadowViews.empty())
+    {
+        shadowDrawStats.clear();
+        for (ShadowViews const& views : shadowViews)
         {
-            if (light.type == LightType::Spot)
-            {
-                PassShadowMapSpot(light);
-            }
-            else if (light.type == LightType::Directional)
-            {
-                light.useCascades ? PassShadowMapCascade(light) : PassShadowMapDirectional(light);
-            }
-            else if (light.type == LightType::Point)
-            {
-                PassShadowMapPoint(light);
-            }
-            light.shadowMappingFlag = true;
+            for (uint32 i = 0; i < views.viewCount; ++i)
+                shadowDrawStats.push_back(ViewDrawStats{views.light, i, viewDrawCounts[views.firstView + i]});
         }
     }
 
@@ -863,6 +1394,8 @@ void Renderer::PassForwardPhong()
 
                 objectConstsCPU.world = transform.currentTransform.Transpose();
                 objectConstsCPU.worldInvTranspose = transform.currentTransform.Invert().Transpose();
+                objectConstsCPU.positionBias = mesh.positionBias;
+                objectConstsCPU.positionScale = mesh.positionScale;
                 objectConstsGPU->Update(m_context, &objectConstsCPU, sizeof(objectConstsCPU));
 
                 materialConstsCPU.diffuse = material.diffuse;
@@ -880,71 +1413,205 @@ void Renderer::PassForwardPhong()
     additiveBS->Unbind(m_context);
 }
 
-void Renderer::PassGBuffer()
+// Visible meshes that only differ in their transform are folded into one batch, the instances of a batch are packed
+// next to each other in gbufferInstances
+void Renderer::CollectGBufferBatches()
 {
-    RILEY_SCOPED_ANNOTATION(m_annotation, "GBuffer Pass");
-    SetSceneViewport(static_cast<float>(gbufferPass.width), static_cast<float>(gbufferPass.height));
-    gbufferPass.BeginRenderPass(m_context);
-
-    // Mesh Render
-    int draw = 0, total = 0;
+    // geometry range, material and constants, everything an instanced draw shares
+    using BatchKey = std::tuple<GeometryHandle, uint32, uint32, int32, uint32, uint32, uint32, uint32, uint32, std::array<float, 8>>;
+    std::map<BatchKey, uint32> batchIds;
+    std::vector<std::pair<entt::entity, uint32>> visible;
+
+    gbufferBatches.clear();
+    const Vector3 eye = m_camera->Position();
+    const Vector3 forward = m_camera->Forward();
     auto entityView = m_reg.view<Mesh, Material, Transform, AABB>();
     for (auto& entity : entityView)
     {
-        auto [mesh, material, transform, aabb] = entityView.get<Mesh, Material, Transform, AABB>(entity);
-        Matrix parent = Matrix::Identity;
-        if (auto root = m_reg.try_get<Relationship>(entity))
-        {
-            if (auto rootTransform = m_reg.try_get<Transform>(root->parent))
-                parent = rootTransform->currentTransform;
-        }
-        aabb.boundingBox = aabb.orginalBox;
-        aabb.boundingBox.Transform(aabb.boundingBox, transform.currentTransform * parent);
-        aabb.UpdateBuffer(m_device);
+        if (!IsVisible(viewVisibility[CAMERA_VIEW], transformSystem->GetSlot(entity)))
+            continue;
 
-        if (m_camera->Frustum().Contains(aabb.boundingBox)) // m_camera->Frustum().Contains(aabb.boundingBox)
-        {
-            if (material.albedoTexture != INVALID_TEXTURE_HANDLE)
-                g_TextureManager.GetTextureView(material.albedoTexture)->BindSRV(m_context, 0, DXShaderStage::PS);
-            if (material.normalTexture != INVALID_TEXTURE_HANDLE)
-                g_TextureManager.GetTextureView(material.normalTexture)->BindSRV(m_context, 1, DXShaderStage::PS);
-            if (material.metallicRoughnessTexture != INVALID_TEXTURE_HANDLE)
-                g_TextureManager.GetTextureView(material.metallicRoughnessTexture)->BindSRV(m_context, 2, DXShaderStage::PS);
-            if (material.emissiveTexture != INVALID_TEXTURE_HANDLE)
-                g_TextureManager.GetTextureView(material.emissiveTexture)->BindSRV(m_context, 3, DXShaderStage::PS);
-
-            draw++;
-            ShaderManager::GetShaderProgram(ShaderProgram::GBuffer)->Bind(m_context);
-
-            objectConstsCPU.world = (transform.currentTransform * parent).Transpose();
-            objectConstsCPU.worldInvTranspose = objectConstsCPU.world.Invert();
-            objectConstsGPU->Update(m_context, &objectConstsCPU, sizeof(objectConstsCPU));
+        auto [mesh, material] = entityView.get<Mesh, Material>(entity);
+        WorldTransform const& world = transformSystem->Get(entity);
+        const float viewDepth = (Vector3(world.boundingBox.Center) - eye).Dot(forward);
+        const uint32 lod = SelectLOD(mesh, world, cullViews[CAMERA_VIEW]);
+        const uint32 materialId = gbufferQueue.MaterialId(
+            {material.albedoTexture, material.normalTexture, material.metallicRoughnessTexture, material.emissiveTexture});
+        const BatchKey key{mesh.geometry,
+                           mesh.startIndexLoc,
+                           mesh.indexCount,
+                           mesh.baseVertexLoc,
+                           mesh.startVertexLoc,
+                           mesh.vertexCount,
+                           static_cast<uint32>(mesh.topology),
+                           lod,
+                           materialId,
+                           {material.diffuse.x, material.diffuse.y, material.diffuse.z, material.albedoFactor,
+                            material.metallicFactor, material.roughnessFactor, material.emissiveFactor,
+                            material.useNormalMap ? 1.0f : 0.0f}};
+
+        // meshes bringing their own instance buffer are drawn as they are
+        uint32 batchId = static_cast<uint32>(gbufferBatches.size());
+        if (!mesh.instanceBuffer)
+            batchId = batchIds.try_emplace(key, batchId).first->second;
+        if (batchId == gbufferBatches.size())
+            gbufferBatches.push_back(InstanceBatch{entity, 0, 0, lod, viewDepth});
+        InstanceBatch& batch = gbufferBatches[batchId];
+        batch.instanceCount++;
+        batch.viewDepth = std::min(batch.viewDepth, viewDepth);
+        visible.emplace_back(entity, batchId);
+    }
 
-            materialConstsCPU.diffuse = material.diffuse;
-            materialConstsCPU.albedoFactor = material.albedoFactor;
-            materialConstsCPU.useNormalMap = material.useNormalMap;
-            materialConstsCPU.metallicFactor = material.metallicFactor;
-            materialConstsCPU.roughnessFactor = material.roughnessFactor;
-            materialConstsCPU.emissiveFactor = material.emissiveFactor;
-            materialConstsCPU.ambient = material.diffuse;
-            materialConstsGPU->Update(m_context, &materialConstsCPU, sizeof(materialConstsCPU));
+    uint32 instanceCount = 0;
+    for (InstanceBatch& batch : gbufferBatches)
+    {
+        batch.firstInstance = instanceCount;
+        instanceCount += batch.instanceCount;
+        batch.instanceCount = 0;
+    }
+    gbufferInstances.resize(instanceCount);
+    for (auto [entity, batchId] : visible)
+    {
+        InstanceBatch& batch = gbufferBatches[batchId];
+        WorldTransform const& world = transformSystem->Get(entity);
+        gbufferInstances[batch.firstInstance + batch.instanceCount++] = InstanceData{world.world, world.worldInvTranspose};
+    }
 
-            mesh.Draw(m_context);
+    // instances share one draw, only single meshes at full resolution are split into their visible clusters
+    clusterRanges.clear();
+    cameraClusterStats = ClusterCullStats{};
+    if (!renderSetting.clusterCulling)
+        return;
+    ClusterCullView view{std::span(cullPlanes).subspan(CAMERA_VIEW, 1), eye,
+                         renderSetting.occlusionCulling ? occlusionCuller : nullptr};
+    for (InstanceBatch& batch : gbufferBatches)
+    {
+        MeshClusters const* clusters = m_reg.try_get<MeshClusters>(batch.entity);
+        if (batch.instanceCount != 1 || batch.lod != 0 || !clusters || clusters->meshletCount == 0)
+            continue;
+
+        auto [mesh, material] = m_reg.get<Mesh, Material>(batch.entity);
+        view.eye = material.doubleSided ? std::nullopt : std::optional<Vector3>(eye);
+        batch.clustered = true;
+        batch.firstRange = static_cast<uint32>(clusterRanges.size());
+        batch.rangeCount = ClusterCulling::Cull(*clusters, mesh, transformSystem->Get(batch.entity), view, clusterRanges,
+                                                cameraClusterStats);
+    }
+}
+
+// Grows the instance buffer to the largest frame before recording: lists recorded earlier still point at the buffer,
+// replacing it while a list records would leave them with a deleted one
+void Renderer::ReserveInstanceBuffer()
+{
+    const uint32 instanceCount = static_cast<uint32>(gbufferInstances.size());
+    if (instanceCount == 0 || (instanceVB && instanceVB->GetCount() >= instanceCount))
+        return;
+
+    uint32 capacity = instanceVB ? instanceVB->GetCount() : 1024;
+    while (capacity < instanceCount)
+        capacity *= 2;
+    SAFE_DELETE(instanceVB);
+    instanceVB = new DXBuffer(m_device, VertexBufferDesc(capacity, sizeof(InstanceData), true));
+}
+
+void Renderer::PassGBuffer(DXCommandList& list)
+{
+    list.BeginEvent("GBuffer Pass");
+    list.SetViewport(static_cast<float>(gbufferPass.width), static_cast<float>(gbufferPass.height));
+    gbufferPass.BeginRenderPass(list);
+
+    // Sort the visible batches by key, then issue them grouped by program and texture set, front to back
+    gbufferQueue.Clear();
+    bool instanced = false;
+    for (uint32 i = 0; i < gbufferBatches.size(); ++i)
+    {
+        InstanceBatch const& batch = gbufferBatches[i];
+        if (batch.clustered && batch.rangeCount == 0)
+            continue;
+        auto [mesh, material] = m_reg.get<Mesh, Material>(batch.entity);
+        const ShaderProgram program = batch.instanceCount > 1 ? ShaderProgram::GBufferInstanced : ShaderProgram::GBuffer;
+        const uint32 materialId = gbufferQueue.MaterialId(
+            {material.albedoTexture, material.normalTexture, material.metallicRoughnessTexture, material.emissiveTexture});
+        const uint64 key = DrawKey::Make(DrawPass::GBuffer, static_cast<uint32>(program), materialId,
+                                         DrawKey::DepthBucket(batch.viewDepth, m_camera->Near(), m_camera->Far()),
+                                         GeometryArena::SlotIndex(mesh.geometry));
+        gbufferQueue.Push(key, i);
+        instanced |= batch.instanceCount > 1;
+    }
+    gbufferQueue.Sort();
 
-            if (material.albedoTexture != INVALID_TEXTURE_HANDLE)
-                g_TextureManager.GetTextureView(material.albedoTexture)->UnbindSRV(m_context, 0, DXShaderStage::PS);
-            if (material.normalTexture != INVALID_TEXTURE_HANDLE)
-                g_TextureManager.GetTextureView(material.normalTexture)->UnbindSRV(m_context, 1, DXShaderStage::PS);
-            if (material.metallicRoughnessTexture != INVALID_TEXTURE_HANDLE)
-                g_TextureManager.GetTextureView(material.metallicRoughnessTexture)->UnbindSRV(m_context, 2, DXShaderStage::PS);
-            if (material.emissiveTexture != INVALID_TEXTURE_HANDLE)
-                g_TextureManager.GetTextureView(material.emissiveTexture)->UnbindSRV(m_context, 3, DXShaderStage::PS);
-            ShaderManager::GetShaderProgram(ShaderProgram::GBuffer)->Unbind(m_context);
+    // one upload holds the transforms of every instanced draw of the pass
+    if (instanced)
+    {
+        assert(instanceVB && instanceVB->GetCount() >= gbufferInstances.size() && "ReserveInstanceBuffer was not called!");
+        instanceVB->Update(list, gbufferInstances.data(), static_cast<uint32>(gbufferInstances.size() * sizeof(InstanceData)));
+    }
+
+    // slots of a texture the material does not have are cleared, as the shader expects
+    auto BindMaterialTexture = [&list](TextureHandle texture, uint32 slot) {
+        DXResource* view = texture != INVALID_TEXTURE_HANDLE ? g_TextureManager.GetTextureView(texture) : nullptr;
+        list.BindSRV(view, slot, DXShaderStage::PS);
+    };
+
+    uint32 drawCalls = 0;
+    uint64 prevKey = 0;
+    for (DrawPacket const& packet : gbufferQueue.Packets())
+    {
+        InstanceBatch const& batch = gbufferBatches[packet.payload];
+        auto [mesh, material] = m_reg.get<Mesh, Material>(batch.entity);
+
+        if (drawCalls == 0 || DrawKey::Program(packet.key) != DrawKey::Program(prevKey))
+            list.BindProgram(ShaderManager::GetShaderProgram(static_cast<ShaderProgram>(DrawKey::Program(packet.key))));
+        if (drawCalls == 0 || DrawKey::Material(packet.key) != DrawKey::Material(prevKey))
+        {
+            BindMaterialTexture(material.albedoTexture, 0);
+            BindMaterialTexture(material.normalTexture, 1);
+            BindMaterialTexture(material.metallicRoughnessTexture, 2);
+            BindMaterialTexture(material.emissiveTexture, 3);
         }
-        total++;
+        prevKey = packet.key;
+        drawCalls++;
+
+        // batches read their matrices from the instance stream but still decode positions with the mesh bounds
+        InstanceData const& instance = gbufferInstances[batch.firstInstance];
+        objectConstsCPU.world = instance.world;
+        objectConstsCPU.worldInvTranspose = instance.worldInvTranspose;
+        objectConstsCPU.positionBias = mesh.positionBias;
+        objectConstsCPU.positionScale = mesh.positionScale;
+        PushDrawConstants(list, objectConstsGPU, &objectConstsCPU, sizeof(objectConstsCPU), 1, {DXShaderStage::VS});
+
+        materialConstsCPU.diffuse = material.diffuse;
+        materialConstsCPU.albedoFactor = material.albedoFactor;
+        materialConstsCPU.useNormalMap = material.useNormalMap;
+        materialConstsCPU.metallicFactor = material.metallicFactor;
+        materialConstsCPU.roughnessFactor = material.roughnessFactor;
+        materialConstsCPU.emissiveFactor = material.emissiveFactor;
+        materialConstsCPU.ambient = material.diffuse;
+        PushDrawConstants(list, materialConstsGPU, &materialConstsCPU, sizeof(materialConstsCPU), 1, {DXShaderStage::PS});
+
+        if (batch.clustered)
+        {
+            for (uint32 r = batch.firstRange; r < batch.firstRange + batch.rangeCount; ++r)
+                mesh.DrawRange(list, clusterRanges[r].startIndexLoc, clusterRanges[r].indexCount);
+            drawCalls += batch.rangeCount - 1;
+        }
+        else if (batch.instanceCount == 1)
+            mesh.DrawLOD(list, batch.lod);
+        else
+            mesh.DrawInstanced(list, instanceVB, batch.instanceCount, batch.firstInstance, batch.lod);
+    }
+    if (drawCalls > 0)
+    {
+        for (uint32 slot = 0; slot < 4; ++slot)
+            BindMaterialTexture(INVALID_TEXTURE_HANDLE, slot);
+        list.UnbindProgram(ShaderManager::GetShaderProgram(static_cast<ShaderProgram>(DrawKey::Program(prevKey))));
+        RestoreDrawConstants(list);
     }
-    // std::cout << draw << "," << total << std::endl;
-    gbufferPass.EndRenderPass(m_context);
+    viewDrawCounts[CAMERA_VIEW] = static_cast<uint32>(gbufferInstances.size());
+    cameraDrawStats.draws = static_cast<uint32>(gbufferInstances.size());
+    cameraDrawStats.drawCalls = drawCalls;
+    gbufferPass.EndRenderPass(list);
+    list.EndEvent();
 }
 
 void Renderer::PassAmbient()
@@ -960,8 +1627,8 @@ void Renderer::PassAmbient()
 
         ShaderManager::GetShaderProgram(ShaderProgram::Ambient)->Bind(m_context);
 
-        m_context->IASetInputLayout(nullptr);
-        m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        g_StateCache.SetInputLayout(m_context, nullptr);
+        g_StateCache.SetPrimitiveTopology(m_context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
         m_context->Draw(4, 0);
 
         gbufferPass.attachmentRTVs->UnbindSRV(m_context, 0, DXShaderStage::PS);
@@ -1014,8 +1681,8 @@ void Renderer::PassDeferredLighting()
 
             ShaderManager::GetShaderProgram(ShaderProgram::DeferredLighting)->Bind(m_context);
 
-            m_context->IASetInputLayout(nullptr);
-            m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+            g_StateCache.SetInputLayout(m_context, nullptr);
+            g_StateCache.SetPrimitiveTopology(m_context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
             m_context->Draw(4, 0);
 
             gbufferPass.attachmentRTVs->UnbindSRV(m_context, 0, DXShaderStage::PS);
@@ -1087,8 +1754,8 @@ void Renderer::PassHalo()
 
         ShaderManager::GetShaderProgram(ShaderProgram::Halo)->Bind(m_context);
 
-        m_context->IASetInputLayout(nullptr);
-        m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        g_StateCache.SetInputLayout(m_context, nullptr);
+        g_StateCache.SetPrimitiveTopology(m_context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
         m_context->Draw(4, 0);
 
         gbufferPass.attachmentDSVs->UnbindSRV(m_context, 0, DXShaderStage::PS);
@@ -1123,8 +1790,8 @@ void Renderer::PassGodsRay(const Light& light)
 
         sunRTV->BindSRV(m_context, 0, DXShaderStage::PS);
 
-        m_context->IASetInputLayout(nullptr);
-        m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        g_StateCache.SetInputLayout(m_context, nullptr);
+        g_StateCache.SetPrimitiveTopology(m_context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
         m_context->Draw(4, 0);
 
         sunRTV->UnbindSRV(m_context, 0, DXShaderStage::PS);
@@ -1136,6 +1803,8 @@ void Renderer::PassPostprocessing()
 {
     RILEY_SCOPED_ANNOTATION(m_annotation, "Postprocessing Pass");
 
+    // the roles of ping and pong must match BuildFrameGraph, not depend on the frames before
+    postprocessIndex = false;
     if (renderSetting.ssr)
     {
         postprocessPasses[postprocessIndex].BeginRenderPass(m_context);
@@ -1198,8 +1867,8 @@ void Renderer::PassPostprocessing()
 
         postprocessPasses[!postprocessIndex].attachmentRTVs->BindSRV(m_context, 0, DXShaderStage::PS);
 
-        m_context->IASetInputLayout(nullptr);
-        m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        g_StateCache.SetInputLayout(m_context, nullptr);
+        g_StateCache.SetPrimitiveTopology(m_context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
         m_context->Draw(4, 0);
 
         postprocessPasses[!postprocessIndex].attachmentRTVs->UnbindSRV(m_context, 0, DXShaderStage::PS);
@@ -1233,8 +1902,8 @@ void Renderer::PassSSAO()
         postProcessCPU.ssaoRadius = renderSetting.ssaoRadius;
         postProcessGPU->Update(m_context, &postProcessCPU, sizeof(postProcessCPU));
 
-        m_context->IASetInputLayout(nullptr);
-        m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        g_StateCache.SetInputLayout(m_context, nullptr);
+        g_StateCache.SetPrimitiveTopology(m_context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
         m_context->Draw(4, 0);
 
         gbufferPass.attachmentRTVs->UnbindSRV(m_context, 0, DXShaderStage::PS);
@@ -1263,8 +1932,8 @@ void Renderer::PassSSR()
         postProcessCPU.ssrThickness = renderSetting.ssrThickness;
         postProcessGPU->Update(m_context, &postProcessCPU, sizeof(postProcessCPU));
 
-        m_context->IASetInputLayout(nullptr);
-        m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        g_StateCache.SetInputLayout(m_context, nullptr);
+        g_StateCache.SetPrimitiveTopology(m_context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
         m_context->Draw(4, 0);
 
         gbufferPass.attachmentRTVs->UnbindSRV(m_context, 0, DXShaderStage::PS);
@@ -1275,264 +1944,127 @@ void Renderer::PassSSR()
     }
 }
 
-void Renderer::PassShadowMapDirectional(const Light& light)
+void Renderer::PassShadowMapDirectional(const Light& light, ShadowViews const& views, ShadowCasterView const& casters,
+                                        DXCommandList& list)
 {
     assert(light.type == LightType::Directional);
-    RILEY_SCOPED_ANNOTATION(m_annotation, "Directional Shadow Map Pass");
-    // ShadowConstantBuffer Update about Light View
-    {
-        const auto& [V, P] = LightFrustum::DirectionalLightViewProjection(light, m_camera, lightBoundingBox);
-
-        shadowConstsCPU.lightViewProj = (V * P).Transpose();
-        shadowConstsCPU.lightView = V.Transpose();
-        shadowConstsCPU.shadowMapSize = SHADOW_MAP_SIZE;
-        shadowConstsCPU.shadowMatrices[0] = shadowConstsCPU.lightViewProj * m_camera->GetView().Invert();
-        shadowConstsGPU->Update(m_context, &shadowConstsCPU, sizeof(shadowConstsCPU));
-    }
-
-    SetSceneViewport(static_cast<float>(shadowMapPass.width), static_cast<float>(shadowMapPass.height));
-    shadowMapPass.BeginRenderPass(m_context);
-    LightFrustumCulling(light);
-
-    auto entityView = m_reg.view<Mesh, Material, Transform, AABB>(entt::exclude<Light>);
-    for (auto& e : entityView)
-    {
-        auto [mesh, material, transform, aabb] = entityView.get<Mesh, Material, Transform, AABB>(e);
-        if (aabb.isLightVisible)
-        {
-            ShaderManager::GetShaderProgram(ShaderProgram::ShadowDepthMap)->Bind(m_context);
-
-            Matrix parent = Matrix::Identity;
-            if (auto root = m_reg.try_get<Relationship>(e))
-            {
-                if (auto rootTransform = m_reg.try_get<Transform>(root->parent))
-                    parent = rootTransform->currentTransform;
-            }
-
-            objectConstsCPU.world = (transform.currentTransform * parent).Transpose();
-            objectConstsCPU.worldInvTranspose = transform.currentTransform.Invert();
-            objectConstsGPU->Update(m_context, &objectConstsCPU, sizeof(objectConstsCPU));
-
-            mesh.Draw(m_context);
-            aabb.isLightVisible = false;
-        }
-    }
-    ShaderManager::GetShaderProgram(ShaderProgram::ShadowDepthMap)->Unbind(m_context);
-    shadowMapPass.EndRenderPass(m_context);
+    list.BeginEvent("Directional Shadow Map Pass");
+    ShadowConsts shadowConsts = shadowConstsCPU;
+    FillShadowConsts(light, views, shadowConsts);
+    shadowConstsGPU->Update(list, &shadowConsts, sizeof(shadowConsts));
+
+    list.SetViewport(static_cast<float>(shadowMapPass.width), static_cast<float>(shadowMapPass.height));
+    shadowMapPass.BeginRenderPass(list);
+    list.BindProgram(ShaderManager::GetShaderProgram(ShaderProgram::ShadowDepthMap));
+    DrawShadowCasters(views, casters, list);
+    list.UnbindProgram(ShaderManager::GetShaderProgram(ShaderProgram::ShadowDepthMap));
+    shadowMapPass.EndRenderPass(list);
+    list.EndEvent();
 }
 
-void Renderer::PassShadowMapCascade(const Light& light)
+void Renderer::PassShadowMapCascade(const Light& light, ShadowViews const& views, ShadowCasterView const& casters,
+                                    DXCommandList& list)
 {
-    assert(light.type == LightType::Directional);
-    RILEY_SCOPED_ANNOTATION(m_annotation, "Directional Shadow Cascade Map Pass");
-    // Light Frustum Part
-    std::array<float, CASCADE_COUNT> splitDistances{};
-    std::array<Matrix, CASCADE_COUNT> cascadeFrustumProjRow =
-        LightFrustum::RecalcProjectionMatrices(m_camera, SPLIT_LAMBDA, splitDistances);
-
-    for (uint32 i = 0; i < CASCADE_COUNT; ++i)
-    {
-        const auto& [V, P] =
-            LightFrustum::CascadeDirectionalLightViewProjection(light, m_camera, cascadeFrustumProjRow[i], lightBoundingBox);
-
-        shadowConstsCPU.shadowCascadeMapViewProj[i] = (V * P).Transpose();
-        shadowConstsCPU.shadowMapSize = SHADOW_CASCADE_SIZE;
-        shadowConstsCPU.shadowMatrices[i] = shadowConstsCPU.shadowCascadeMapViewProj[i] * m_camera->GetView().Invert();
-        shadowConstsCPU.splits[i] = splitDistances[i];
-        LightFrustumCulling(light);
-    }
-    shadowConstsGPU->Update(m_context, &shadowConstsCPU, sizeof(shadowConstsCPU));
+    assert(light.type == LightType::Directional && views.viewCount == CASCADE_COUNT);
+    list.BeginEvent("Directional Shadow Cascade Map Pass");
+    ShadowConsts shadowConsts = shadowConstsCPU;
+    FillShadowConsts(light, views, shadowConsts);
+    shadowConstsGPU->Update(list, &shadowConsts, sizeof(shadowConsts));
 
     // Mesh Render Part
-    SetSceneViewport(static_cast<float>(shadowCascadeMapPass.width), static_cast<float>(shadowCascadeMapPass.height));
-    shadowCascadeMapPass.BeginRenderPass(m_context);
-
-    auto entitiesView = m_reg.view<Mesh, Transform, AABB>(entt::exclude<Light>);
-    for (auto& e : entitiesView)
-    {
-        auto [mesh, transform, aabb] = entitiesView.get<Mesh, Transform, AABB>(e);
-        if (aabb.isLightVisible)
-        {
-
-            ShaderManager::GetShaderProgram(ShaderProgram::ShadowCascadeMap)->Bind(m_context);
-
-            Matrix parent = Matrix::Identity;
-            if (auto root = m_reg.try_get<Relationship>(e))
-            {
-                if (auto rootTransform = m_reg.try_get<Transform>(root->parent))
-                    parent = rootTransform->currentTransform;
-            }
-
-            objectConstsCPU.world = (transform.currentTransform * parent).Transpose();
-            objectConstsCPU.worldInvTranspose = transform.currentTransform.Invert().Transpose();
-            objectConstsGPU->Update(m_context, &objectConstsCPU, sizeof(objectConstsCPU));
-
-            mesh.Draw(m_context);
-            aabb.isLightVisible = false;
-        }
-    }
-    ShaderManager::GetShaderProgram(ShaderProgram::ShadowCascadeMap)->Unbind(m_context);
-    shadowCascadeMapPass.EndRenderPass(m_context);
+    list.SetViewport(static_cast<float>(shadowCascadeMapPass.width), static_cast<float>(shadowCascadeMapPass.height));
+    shadowCascadeMapPass.BeginRenderPass(list);
+
+    list.BindProgram(ShaderManager::GetShaderProgram(ShaderProgram::ShadowCascadeMap));
+    DrawShadowCasters(views, casters, list);
+    list.UnbindProgram(ShaderManager::GetShaderProgram(ShaderProgram::ShadowCascadeMap));
+    shadowCascadeMapPass.EndRenderPass(list);
+    list.EndEvent();
 }
 
-void Renderer::PassShadowMapSpot(const Light& light)
+void Renderer::PassShadowMapSpot(const Light& light, ShadowViews const& views, ShadowCasterView const& casters,
+                                 DXCommandList& list)
 {
     assert(light.type == LightType::Spot);
-    RILEY_SCOPED_ANNOTATION(m_annotation, "Spot Shadow Map Pass");
-
-    // ShadowConstantBuffer Update about Light View
-    {
-        Vector3 lightDir = Vector3(light.direction);
-        lightDir.Normalize();
-        Vector3 lightPos = Vector3(light.position);
-        Vector3 targetPos = lightPos + lightDir * light.range;
-        Vector3 up = Vector3::Up;
-        if (abs(up.Dot(lightDir) + 1.0f) < 1e-5)
-            up = Vector3(1.0f, 0.0f, 0.0f);
-
-        Matrix lightViewRow = DirectX::XMMatrixLookAtLH(lightPos, targetPos, up);
-        float fovAngle = 2.0f * acos(light.outer_cosine);
-        Matrix lightProjRow = DirectX::XMMatrixPerspectiveFovLH(fovAngle, 1.0f, 0.5f, light.range);
-
-        shadowConstsCPU.lightViewProj = (lightViewRow * lightProjRow).Transpose();
-        shadowConstsCPU.lightView = lightViewRow.Transpose();
-        shadowConstsCPU.shadowMapSize = SHADOW_MAP_SIZE;
-        shadowConstsCPU.shadowMatrices[0] = shadowConstsCPU.lightViewProj * m_camera->GetView().Invert();
-        shadowConstsGPU->Update(m_context, &shadowConstsCPU, sizeof(shadowConstsCPU));
-
-        lightBoundingFrustum = BoundingFrustum(lightProjRow);
-        lightBoundingFrustum.Transform(lightBoundingFrustum, lightViewRow.Invert());
-    }
-
-    SetSceneViewport(static_cast<float>(shadowMapPass.width), static_cast<float>(shadowMapPass.height));
-    shadowMapPass.BeginRenderPass(m_context);
-    LightFrustumCulling(light);
-
-    // Render Mesh
-    auto entityView = m_reg.view<Mesh, Material, Transform, AABB>(entt::exclude<Light>);
-    for (auto& e : entityView)
-    {
-        auto [mesh, material, transform, aabb] = entityView.get<Mesh, Material, Transform, AABB>(e);
-        if (aabb.isLightVisible)
-        {
-
-            ShaderManager::GetShaderProgram(ShaderProgram::ShadowDepthMap)->Bind(m_context);
-
-            Matrix parent = Matrix::Identity;
-            if (auto root = m_reg.try_get<Relationship>(e))
-            {
-                if (auto rootTransform = m_reg.try_get<Transform>(root->parent))
-                    parent = rootTransform->currentTransform;
-            }
-
-            objectConstsCPU.world = (transform.currentTransform * parent).Transpose();
-            objectConstsCPU.worldInvTranspose = transform.currentTransform.Invert().Transpose();
-            objectConstsGPU->Update(m_context, &objectConstsCPU, sizeof(objectConstsCPU));
-
-            mesh.Draw(m_context);
-            aabb.isLightVisible = false;
-        }
-    }
-    ShaderManager::GetShaderProgram(ShaderProgram::ShadowDepthMap)->Unbind(m_context);
-    shadowMapPass.EndRenderPass(m_context);
+    list.BeginEvent("Spot Shadow Map Pass");
+    ShadowConsts shadowConsts = shadowConstsCPU;
+    FillShadowConsts(light, views, shadowConsts);
+    shadowConstsGPU->Update(list, &shadowConsts, sizeof(shadowConsts));
+
+    list.SetViewport(static_cast<float>(shadowMapPass.width), static_cast<float>(shadowMapPass.height));
+    shadowMapPass.BeginRenderPass(list);
+    list.BindProgram(ShaderManager::GetShaderProgram(ShaderProgram::ShadowDepthMap));
+    DrawShadowCasters(views, casters, list);
+    list.UnbindProgram(ShaderManager::GetShaderProgram(ShaderProgram::ShadowDepthMap));
+    shadowMapPass.EndRenderPass(list);
+    list.EndEvent();
 }
 
-void Renderer::PassShadowMapPoint(const Light& light)
+void Renderer::PassShadowMapPoint(const Light& light, ShadowViews const& views, ShadowCasterView const& casters,
+                                  DXCommandList& list)
 {
-    assert(light.type == LightType::Point);
-    RILEY_SCOPED_ANNOTATION(m_annotation, "Point Shadow Cube Map Pass");
-
-    {
-        Matrix lightViewRow = Matrix::Identity;
-        Matrix lightProjRow = Matrix::Identity;
+    assert(light.type == LightType::Point && views.viewCount == 6);
+    list.BeginEvent("Point Shadow Cube Map Pass");
+    ShadowConsts shadowConsts = shadowConstsCPU;
+    FillShadowConsts(light, views, shadowConsts);
+    shadowConstsGPU->Update(list, &shadowConsts, sizeof(shadowConsts));
+
+    list.SetViewport(static_cast<float>(shadowCubeMapPass.width), static_cast<float>(shadowCubeMapPass.height));
+    shadowCubeMapPass.BeginRenderPass(list);
+
+    list.BindProgram(ShaderManager::GetShaderProgram(ShaderProgram::ShadowDepthCubeMap));
+    DrawShadowCasters(views, casters, list);
+    list.UnbindProgram(ShaderManager::GetShaderProgram(ShaderProgram::ShadowDepthCubeMap));
+    shadowCubeMapPass.EndRenderPass(list);
+    list.EndEvent();
+}
 
-        Vector3 directions[6] = {{1.0f, 0.0f, 0.0f},  {-1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f},
-                                 {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f},  {0.0f, 0.0f, -1.0f}};
-        Vector3 up[6] = {{0.0f, 1.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f},
-                         {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+void Renderer::PassAABB()
+{
+    RILEY_SCOPED_ANNOTATION(m_annotation, "AABB Pass");
 
-        const float fov = 2.0f * acos(light.outer_cosine);
-        lightProjRow = DirectX::XMMatrixPerspectiveFovLH(fov, 1.0f, 0.5f, light.range);
+    if (auto aabb = m_reg.try_get<AABB>(selectedEntity))
+        debugDraw.AddBox(aabb->boundingBox, Vector4(0.0f, 1.0f, 0.0f, 1.0f));
 
-        for (uint32 face = 0; face < 6; ++face)
-        {
-            lightViewRow = DirectX::XMMatrixLookAtLH(light.position, light.position + directions[face] * light.range, up[face]);
-            shadowConstsCPU.shadowCubeMapViewProj[face] = (lightViewRow * lightProjRow).Transpose();
-
-            lightBoundingFrustumCube[face] = BoundingFrustum(lightProjRow);
-            lightBoundingFrustumCube[face].Transform(lightBoundingFrustumCube[face], lightViewRow.Invert());
-            lightBoundingFrustum = BoundingFrustum(lightProjRow);
-            lightBoundingFrustum.Transform(lightBoundingFrustum, lightViewRow.Invert());
-            LightFrustumCulling(light);
-        }
-        shadowConstsCPU.shadowMapSize = SHADOW_CUBE_SIZE;
-        shadowConstsGPU->Update(m_context, &shadowConstsCPU, sizeof(shadowConstsCPU));
+    auto aabbView = m_reg.view<AABB>();
+    for (auto& e : aabbView)
+    {
+        auto& aabb = aabbView.get<AABB>(e);
+        if (aabb.isDrawAABB && e != selectedEntity)
+            debugDraw.AddBox(aabb.boundingBox, Vector4(1.0f, 1.0f, 0.0f, 1.0f));
     }
 
-    SetSceneViewport(static_cast<float>(shadowCubeMapPass.width), static_cast<float>(shadowCubeMapPass.height));
-    shadowCubeMapPass.BeginRenderPass(m_context);
+    if (debugDraw.Empty())
+        return;
 
-    // Render Mesh
-    auto entityView = m_reg.view<Mesh, Material, Transform, AABB>(entt::exclude<Light>);
-    for (auto& e : entityView)
+    // grow by doubling so the buffer is recreated only a handful of times
+    const uint32 vertexCount = debugDraw.VertexCount();
+    if (!debugLineVB || debugLineVB->GetCount() < vertexCount)
     {
-        auto [mesh, material, transform, aabb] = entityView.get<Mesh, Material, Transform, AABB>(e);
+        uint32 capacity = debugLineVB ? debugLineVB->GetCount() : 1024;
+        while (capacity < vertexCount)
+            capacity *= 2;
 
-        if (aabb.isLightVisible)
-        {
-            ShaderManager::GetShaderProgram(ShaderProgram::ShadowDepthCubeMap)->Bind(m_context);
-
-            Matrix parent = Matrix::Identity;
-            if (auto root = m_reg.try_get<Relationship>(e))
-            {
-                if (auto rootTransform = m_reg.try_get<Transform>(root->parent))
-                    parent = rootTransform->currentTransform;
-            }
-
-            objectConstsCPU.world = (transform.currentTransform * parent).Transpose();
-            objectConstsCPU.worldInvTranspose = transform.currentTransform.Invert().Transpose();
-            objectConstsGPU->Update(m_context, &objectConstsCPU, sizeof(objectConstsCPU));
-
-            mesh.Draw(m_context);
-            aabb.isLightVisible = false;
-        }
+        SAFE_DELETE(debugLineVB);
+        debugLineVB = new DXBuffer(m_device, VertexBufferDesc(capacity, sizeof(DebugVertex), true));
     }
-    ShaderManager::GetShaderProgram(ShaderProgram::ShadowDepthCubeMap)->Unbind(m_context);
-    shadowCubeMapPass.EndRenderPass(m_context);
-}
-
-void Renderer::PassAABB()
-{
-    RILEY_SCOPED_ANNOTATION(m_annotation, "AABB Pass");
+    debugLineVB->Update(m_context, debugDraw.Data(), vertexCount * sizeof(DebugVertex));
 
     SetSceneViewport(static_cast<float>(m_width), static_cast<float>(m_height));
     postprocessPasses[!postprocessIndex].BeginRenderPass(m_context, false, false);
-    wireframeRS->Bind(m_context);
     noneDepthDSS->Bind(m_context, 0);
-    // Mesh Render
     {
-        auto aabb = m_reg.try_get<AABB>(selectedEntity);
+        ShaderManager::GetShaderProgram(ShaderProgram::DebugLine)->Bind(m_context);
 
-        if (aabb)
-        {
-            ShaderManager::GetShaderProgram(ShaderProgram::Solid)->Bind(m_context);
+        g_StateCache.SetPrimitiveTopology(m_context, D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
+        BindVertexBuffer(m_context, debugLineVB);
+        m_context->Draw(vertexCount, 0);
 
-            aabb->SetAABBIndexBuffer(m_device);
-
-            objectConstsCPU.world = Matrix::Identity;
-            objectConstsCPU.worldInvTranspose = Matrix::Identity;
-            objectConstsGPU->Update(m_context, &objectConstsCPU, sizeof(objectConstsCPU));
-
-            materialConstsCPU.diffuse = Vector3(0.0f, 1.0f, 0.0f);
-            materialConstsGPU->Update(m_context, &materialConstsCPU, sizeof(materialConstsCPU));
-
-            m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
-            BindVertexBuffer(m_context, aabb->aabbVertexBuffer.get());
-            BindIndexBuffer(m_context, aabb->aabbIndexBuffer.get());
-            m_context->DrawIndexed(aabb->aabbIndexBuffer->GetCount(), 0, 0);
-        }
+        ShaderManager::GetShaderProgram(ShaderProgram::DebugLine)->Unbind(m_context);
     }
     postprocessPasses[!postprocessIndex].EndRenderPass(m_context);
+
+    debugDraw.Clear();
 }
 
 void Renderer::PassLight()
@@ -1581,20 +2113,16 @@ void Renderer::PassEntityID()
     auto entityView = m_reg.view<Mesh, Transform, AABB>();
     for (auto& e : entityView)
     {
-        auto [mesh, transform, aabb] = entityView.get<Mesh, Transform, AABB>(e);
-        if (m_camera->Frustum().Contains(aabb.boundingBox))
+        auto& mesh = entityView.get<Mesh>(e);
+        if (IsVisible(viewVisibility[CAMERA_VIEW], transformSystem->GetSlot(e)))
         {
             ShaderManager::GetShaderProgram(ShaderProgram::Picking)->Bind(m_context);
 
-            Matrix parent = Matrix::Identity;
-            if (auto root = m_reg.try_get<Relationship>(e))
-            {
-                if (auto rootTransform = m_reg.try_get<Transform>(root->parent))
-                    parent = rootTransform->currentTransform;
-            }
-
-            objectConstsCPU.world = (transform.currentTransform * parent).Transpose();
-            objectConstsCPU.worldInvTranspose = transform.currentTransform.Invert().Transpose();
+            WorldTransform const& world = transformSystem->Get(e);
+            objectConstsCPU.world = world.world;
+            objectConstsCPU.worldInvTranspose = world.worldInvTranspose;
+            objectConstsCPU.positionBias = mesh.positionBias;
+            objectConstsCPU.positionScale = mesh.positionScale;
             objectConstsGPU->Update(m_context, &objectConstsCPU, sizeof(objectConstsCPU));
 
             entityIdConstsCPU.entityID = entt::to_entity(e);
@@ -1638,8 +2166,7 @@ void Renderer::DrawSun(entt::entity light)
 
     BlurTexture(sunRTV);
 
-    ID3D11RenderTargetView* nullRTV[1] = {nullptr};
-    m_context->OMSetRenderTargets(0, nullRTV, nullptr);
+    g_StateCache.ReleaseRenderTargets();
 }
 
 void Renderer::BlurTexture(DXRenderTarget* src)
@@ -1667,8 +2194,8 @@ void Renderer::AddTexture(DXRenderTarget* dest, DXResource* src)
     dest->BindSRV(m_context, 0, DXShaderStage::PS);
     src->BindSRV(m_context, 1, DXShaderStage::PS);
 
-    m_context->IASetInputLayout(nullptr);
-    m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    g_StateCache.SetInputLayout(m_context, nullptr);
+    g_StateCache.SetPrimitiveTopology(m_context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
     m_context->Draw(4, 0);
 
     dest->UnbindSRV(m_context, 0, DXShaderStage::PS);
@@ -1681,8 +2208,8 @@ void Renderer::CopyTexture(DXResource* src)
     ShaderManager::GetShaderProgram(ShaderProgram::Copy)->Bind(m_context);
     src->BindSRV(m_context, 0, DXShaderStage::PS);
 
-    m_context->IASetInputLayout(nullptr);
-    m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    g_StateCache.SetInputLayout(m_context, nullptr);
+    g_StateCache.SetPrimitiveTopology(m_context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
     m_context->Draw(4, 0);
 
     src->UnbindSRV(m_context, 0, DXShaderStage::PS);
@@ -1,17 +1,24 @@
 #pragma once
 #include "../Core/Window.h"
 #include "../Graphics/DXBuffer.h"
+#include "../Graphics/DXCommandList.h"
 #include "../Graphics/DXConstantBuffer.h"
+#include "../Graphics/DXConstantRing.h"
 #include "../Graphics/DXDepthStencilBuffer.h"
 #include "../Graphics/DXRenderPass.h"
 #include "../Graphics/DXRenderTarget.h"
 #include "Camera.h"
+#include "ClusterCuller.h"
 #include "Components.h"
 #include "ConstantBuffers.h"
+#include "DebugDraw.h"
+#include "RenderGraph.h"
+#include "RenderQueue.h"
 #include "RenderSetting.h"
 #include "SceneViewport.h"
 #include "ShaderManager.h"
 #include "TextureManager.h"
+#include "TransformSystem.h"
 
 namespace Riley
 {
@@ -23,8 +30,75 @@ class DXDepthStencilState;
 
 class Engine;
 class Camera;
+class OcclusionCuller;
 class Input;
 
+// A frustum of the frame, all of them are culled together in one sweep. View 0 is the main camera.
+struct CullView
+{
+    Matrix viewRow = Matrix::Identity;
+    Matrix projRow = Matrix::Identity;
+    float resolution = 0.0f; // height of the target in pixels, for LOD selection
+    float split = 0.0f;      // far distance of a cascade
+};
+
+// The range of views a shadow casting light renders into this frame
+struct ShadowViews
+{
+    entt::entity light = entt::null;
+    uint32 firstView = 0;
+    uint32 viewCount = 0;
+};
+
+// Objects drawn into one view, light is null for the main camera
+struct ViewDrawStats
+{
+    entt::entity light = entt::null;
+    uint32 face = 0; // cascade or cube face within the light
+    uint32 draws = 0;
+    uint32 drawCalls = 0; // fewer than draws once identical meshes are instanced
+};
+
+// Per instance vertex stream of GBufferInstancedVS, transposed like ObjectConsts
+struct InstanceData
+{
+    Matrix world;
+    Matrix worldInvTranspose;
+};
+
+// Visible GBuffer draws that only differ in their transform, issued as one instanced draw
+struct InstanceBatch
+{
+    entt::entity entity = entt::null; // first instance, supplies the mesh and the material
+    uint32 firstInstance = 0;
+    uint32 instanceCount = 0;
+    uint32 lod = 0;
+    float viewDepth = 0.0f; // of the nearest instance
+    // a single instance at full resolution draws clusterRanges[firstRange, firstRange + rangeCount) instead
+    bool clustered = false;
+    uint32 firstRange = 0;
+    uint32 rangeCount = 0;
+};
+
+// Textures declared in the frame graph, see Renderer::BuildFrameGraph
+struct FrameGraphResources
+{
+    // imported, they live across frames
+    RGResourceId shadowMap, shadowCascadeMap, shadowCubeMap;
+    std::array<RGResourceId, 2> postprocess;
+    RGResourceId entityId, entityIdDepth;
+
+    // transient
+    RGResourceId hdr, hdrDepth;
+    std::array<RGResourceId, 3> gbuffer;
+    RGResourceId gbufferDepth, depthMap;
+    RGResourceId ambientLighting, ambientLightingDepth;
+    RGResourceId ssao, ssaoDepth, ssaoBlur, ssaoBlurDepth;
+    RGResourceId sun, blurIntermediate;
+    RGResourceId tiledLighting, tiledLightingDebug;
+    std::array<RGResourceId, 2> postprocessDepth;
+};
+
 class Renderer
 {
     friend class Engine;
@@ -62,6 +136,52 @@ class Renderer
     {
         selectedEntity = e;
     }
+    DebugDraw& GetDebugDraw()
+    {
+        return debugDraw;
+    }
+    // camera stats are refreshed every frame, shadow views whenever their shadow maps are redrawn
+    ViewDrawStats const& GetCameraDrawStats() const
+    {
+        return cameraDrawStats;
+    }
+    std::vector<ViewDrawStats> const& GetShadowDrawStats() const
+    {
+        return shadowDrawStats;
+    }
+    // camera meshlets of the last frame, shadow ones of the last redraw summed over the lights
+    ClusterCullStats const& GetCameraClusterStats() const
+    {
+        return cameraClusterStats;
+    }
+    ClusterCullStats GetShadowClusterStats() const
+    {
+        ClusterCullStats total{};
+        for (ClusterCullStats const& stats : shadowClusterStats)
+            total += stats;
+        return total;
+    }
+    RenderQueueStats const& GetGBufferQueueStats() const
+    {
+        return gbufferQueue.Stats();
+    }
+    OcclusionCuller const& GetOcclusionCuller() const
+    {
+        return *occlusionCuller;
+    }
+    TransformSystem const& GetTransformSystem() const
+    {
+        return *transformSystem;
+    }
+    // compiled with every optional pass, the transient targets are allocated from it
+    RenderGraph const& GetFrameGraph() const
+    {
+        return frameGraph;
+    }
+    // logs the render target memory at 1080p/1440p/4K with and without aliasing
+    void ReportFrameGraphMemory() const;
+    // re-records the GBuffer and the pending shadow maps on the null backend, results are written to the log
+    void RunCommandListBenchmark(uint32 iterations = 100);
 
   protected:
     uint32 m_width, m_height;
@@ -83,10 +203,27 @@ class Renderer
     ////////////////////////////
     RenderSetting renderSetting; // It's created in Editor Class
     entt::entity selectedEntity = entt::null;
-    DirectX::BoundingBox lightBoundingBox;
-    DirectX::BoundingFrustum lightBoundingFrustum;
-    DirectX::BoundingFrustum lightBoundingFrustumCube[6];
     std::array<Vector4, SSAO_KERNEL_SIZE> ssaoKernel;
+    TransformSystem* transformSystem = nullptr;
+    OcclusionCuller* occlusionCuller = nullptr;
+    static constexpr uint32 CAMERA_VIEW = 0;
+    std::vector<CullView> cullViews;
+    std::vector<CullPlanes> cullPlanes;
+    VisibilityTable viewVisibility;
+    std::vector<ShadowViews> shadowViews;
+    std::vector<uint32> viewDrawCounts;
+    ViewDrawStats cameraDrawStats;
+    std::vector<ViewDrawStats> shadowDrawStats;
+    RenderQueue gbufferQueue;
+    std::vector<InstanceBatch> gbufferBatches;
+    std::vector<InstanceData> gbufferInstances;
+    std::vector<ClusterRange> clusterRanges;
+    ClusterCullStats cameraClusterStats;
+    std::vector<ClusterCullStats> shadowClusterStats; // one per ShadowViews
+    RenderGraph frameGraph;
+    DXCommandList gbufferCommands;
+    std::vector<DXCommandList> shadowCommands; // one per ShadowViews
+    DebugDraw debugDraw;
 
     // Resources
     DXBuffer* lights = nullptr;
@@ -95,6 +232,8 @@ class Renderer
     DXResource* debugTiledTexture = nullptr;
     DXResource* ssaoNoiseTex = nullptr;
     DXResource* blurTextureIntermediate = nullptr;
+    DXBuffer* debugLineVB = nullptr;
+    DXBuffer* instanceVB = nullptr; // GBuffer instance data, grown to the largest frame
     TextureHandle sunTex = INVALID_TEXTURE_HANDLE;
 
     // cbuffers
@@ -112,6 +251,9 @@ class Renderer
     DXConstantBuffer<ShadowConsts>* shadowConstsGPU = nullptr;
     EntityIdConsts entityIdConstsCPU{};
     DXConstantBuffer<EntityIdConsts>* entityIdConstsGPU = nullptr;
+    // per draw object and material constants of the recorded passes, uploaded once per frame
+    DXConstantRing* constantRing = nullptr;
+    DXUploadRing* drawConstants = nullptr; // ring the passes record into, null when windows cannot be bound
 
     // Render States
     DXRasterizerState* solidRS;
@@ -172,6 +314,8 @@ class Renderer
     bool postprocessIndex = false;
 
   private:
+    using ShadowCasterView = decltype(std::declval<entt::registry&>().view<Mesh>(entt::exclude<Light>));
+
     void CreateBuffers();
     void CreateSamplers();
     void CreateRenderStates();
@@ -181,14 +325,28 @@ class Renderer
     void CreateRenderPasses(uint32 width, uint32 height);
 
     void CreateGBuffer(uint32 width, uint32 height);
+    void CreateFrameGraphTargets(uint32 width, uint32 height);
+    static FrameGraphResources BuildFrameGraph(RenderGraph& graph, uint32 width, uint32 height, RenderSetting const* setting);
     void CreateOtherResources();
 
     void BindGlobals();
-    void LightFrustumCulling(const Light& light);
+    uint32 AddView(Matrix const& viewRow, Matrix const& projRow, CullPlanes const& planes, float resolution, float split = 0.0f);
+    void CollectViews();
+    void AddShadowViews(entt::entity e, const Light& light);
+    void PushDrawConstants(DXCommandList& list, DXBuffer* fallback, void const* data, uint32 size, uint32 slot,
+                           std::initializer_list<DXShaderStage> stages);
+    void RestoreDrawConstants(DXCommandList& list);
+    uint32 SelectLOD(Mesh const& mesh, WorldTransform const& world, CullView const& view) const;
+    void DrawShadowCasters(ShadowViews const& views, ShadowCasterView const& casters, DXCommandList& list);
+    void FillShadowConsts(Light const& light, ShadowViews const& views, ShadowConsts& shadowConsts) const;
+    void RecordShadowMaps(std::vector<DXCommandList>& lists, bool parallel);
 
     void PassForward();
     void PassForwardPhong();
-    void PassGBuffer();
+    void CollectGBufferBatches();
+    void ReserveInstanceBuffer();
+    // records the batches CollectGBufferBatches gathered, records nothing but the list and the ring allocations
+    void PassGBuffer(DXCommandList& list);
     void PassAmbient();
     void PassDeferredLighting();
     void PassTiledDeferredLighting();
@@ -200,14 +358,15 @@ class Renderer
     void PassSSAO();
     void PassSSR();
 
-    void PassShadowMapDirectional(const Light& light);
-    void PassShadowMapCascade(const Light& light);
-    void PassShadowMapSpot(const Light& light);
-    void PassShadowMapPoint(const Light& light);
+    void PassShadowMapDirectional(const Light& light, ShadowViews const& views, ShadowCasterView const& casters, DXCommandList& list);
+    void PassShadowMapCascade(const Light& light, ShadowViews const& views, ShadowCasterView const& casters, DXCommandList& list);
+    void PassShadowMapSpot(const Light& light, ShadowViews const& views, ShadowCasterView const& casters, DXCommandList& list);
+    void PassShadowMapPoint(const Light& light, ShadowViews const& views, ShadowCasterView const& casters, DXCommandList& list);
 
     void PassAABB();
     void PassLight();
     void PassEntityID();
+    entt::entity PickEntityGPU();
 
     void DrawSun(entt::entity light);
     void BlurTexture(DXRenderTarget* src);
@@ -0,0 +1,111 @@
+#include "SceneQuery.h"
+
+namespace Riley
+{
+
+namespace SceneQuery
+{
+
+Ray ScreenRay(Matrix const& viewProjRow, float ndcX, float ndcY)
+{
+    const Matrix invViewProj = viewProjRow.Invert();
+    const Vector3 nearWS = Vector3::Transform(Vector3(ndcX, ndcY, 0.0f), invViewProj);
+    const Vector3 farWS = Vector3::Transform(Vector3(ndcX, ndcY, 1.0f), invViewProj);
+
+    Vector3 dir = farWS - nearWS;
+    dir.Normalize();
+    return Ray(nearWS, dir);
+}
+
+bool RayTriangle(Vector3 const& origin, Vector3 const& dir, Vector3 const& v0, Vector3 const& v1, Vector3 const& v2, float& t)
+{
+    static constexpr float EPSILON = 1e-8f;
+
+    const Vector3 edge1 = v1 - v0;
+    const Vector3 edge2 = v2 - v0;
+    const Vector3 p = dir.Cross(edge2);
+    const float det = edge1.Dot(p);
+    if (fabs(det) < EPSILON)
+        return false;
+
+    const float invDet = 1.0f / det;
+    const Vector3 s = origin - v0;
+    const float u = s.Dot(p) * invDet;
+    if (u < 0.0f || u > 1.0f)
+        return false;
+
+    const Vector3 q = s.Cross(edge1);
+    const float v = dir.Dot(q) * invDet;
+    if (v < 0.0f || u + v > 1.0f)
+        return false;
+
+    t = edge2.Dot(q) * invDet;
+    return t >= 0.0f;
+}
+
+// Closest triangle of the collider, the ray is moved to model space so no vertex has to be transformed
+static bool RayCollider(MeshCollider const& collider, Matrix const& worldRow, Ray const& ray, float maxDistance, float& distance)
+{
+    const Matrix invWorld = worldRow.Invert();
+    const Vector3 origin = Vector3::Transform(ray.position, invWorld);
+    // not normalized on purpose, t along it is then the same as the world space distance
+    const Vector3 dir = Vector3::TransformNormal(ray.direction, invWorld);
+
+    std::vector<Vector3> const& positions = *collider.positions;
+    std::vector<uint32> const& indices = *collider.indices;
+
+    bool hit = false;
+    distance = maxDistance;
+    for (uint32 i = collider.startIndexLoc; i + 2 < collider.startIndexLoc + collider.indexCount; i += 3)
+    {
+        Vector3 const& v0 = positions[collider.baseVertexLoc + indices[i]];
+        Vector3 const& v1 = positions[collider.baseVertexLoc + indices[i + 1]];
+        Vector3 const& v2 = positions[collider.baseVertexLoc + indices[i + 2]];
+
+        float t = 0.0f;
+        if (RayTriangle(origin, dir, v0, v1, v2, t) && t < distance)
+        {
+            distance = t;
+            hit = true;
+        }
+    }
+    return hit;
+}
+
+std::optional<RayHit> RayCast(entt::registry const& reg, TransformSystem const& transforms, Ray const& ray, float maxDistance)
+{
+    RayHit closest{};
+    closest.distance = maxDistance;
+
+    transforms.Tree().RayCast(ray, maxDistance, [&](uint32 id, float boxDistance) {
+        // the tree clips the ray to the closest hit so far, so farther boxes are never visited
+        const entt::entity e = static_cast<entt::entity>(id);
+        if (boxDistance >= closest.distance)
+            return closest.distance;
+
+        WorldTransform const& world = transforms.Get(e);
+        float distance = 0.0f;
+        bool hit = false;
+        if (auto collider = reg.try_get<MeshCollider>(e))
+            hit = RayCollider(*collider, world.world.Transpose(), ray, closest.distance, distance);
+        else
+            hit = ray.Intersects(world.boundingBox, distance) && distance < closest.distance;
+
+        if (hit)
+        {
+            closest.entity = e;
+            closest.distance = distance;
+        }
+        return closest.distance;
+    });
+
+    if (closest.entity == entt::null)
+        return std::nullopt;
+
+    closest.position = Vector3(ray.position) + Vector3(ray.direction) * closest.distance;
+    return closest;
+}
+
+} // namespace SceneQuery
+
+} // namespace Riley
@@ -0,0 +1,30 @@
+#pragma once
+#include "TransformSystem.h"
+
+namespace Riley
+{
+
+struct RayHit
+{
+    entt::entity entity = entt::null;
+    float distance = FLT_MAX;
+    Vector3 position;
+};
+
+/* CPU scene queries. They only need the registry and the TransformSystem (no device),
+ * so they work the same in the editor and in headless tools. */
+namespace SceneQuery
+{
+// World space ray through a point in normalized device coordinates
+Ray ScreenRay(Matrix const& viewProjRow, float ndcX, float ndcY);
+
+/* Closest hit along the ray. Candidates come from the AABB tree, entities with a MeshCollider are tested
+ * against their triangles and the rest against their world AABB. */
+std::optional<RayHit> RayCast(entt::registry const& reg, TransformSystem const& transforms, Ray const& ray,
+                              float maxDistance = FLT_MAX);
+
+// Moller-Trumbore without backface culling, t is measured in units of dir
+bool RayTriangle(Vector3 const& origin, Vector3 const& dir, Vector3 const& v0, Vector3 const& v1, Vector3 const& v2, float& t);
+} // namespace SceneQuery
+
+} // namespace Riley
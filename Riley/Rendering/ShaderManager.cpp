@@ -57,11 +57,13 @@ constexpr DXShaderStage GetStage(ShaderId shader)
     case VS_Solid:
     case VS_Phong:
     case VS_GBuffer:
+    case VS_GBufferInstanced:
     case VS_Shadow:
     case VS_ShadowCascade:
     case VS_ShadowCube:
     case VS_Picking:
     case VS_Sun:
+    case VS_DebugLine:
         return DXShaderStage::VS;
     case PS_Solid:
     case PS_Phong:
@@ -82,6 +84,7 @@ constexpr DXShaderStage GetStage(ShaderId shader)
     case PS_CopyTexture:
     case PS_TiledDeferredLightingPS:
     case PS_FXAA:
+    case PS_DebugLine:
         return DXShaderStage::PS;
     case GS_ShadowCascade:
     case GS_ShadowCube:
@@ -108,6 +111,7 @@ constexpr std::string GetShaderSource(ShaderId shader)
     case PS_Phong:
         return "Resources/Shaders/Lighting/ForwardPhong.hlsl";
     case VS_GBuffer:
+    case VS_GBufferInstanced:
     case PS_GBuffer:
         return "Resources/Shaders/GBuffer/GBuffer.hlsl";
     case PS_Ambient:
@@ -143,6 +147,9 @@ constexpr std::string GetShaderSource(ShaderId shader)
     case VS_Picking:
     case PS_Picking:
         return "Resources/Shaders/Util/Picking.hlsl";
+    case VS_DebugLine:
+    case PS_DebugLine:
+        return "Resources/Shaders/Util/DebugLine.hlsl";
     case PS_AddTexture:
         return "Resources/Shaders/Postprocess/AddTexture.hlsl";
     case PS_CopyTexture:
@@ -176,6 +183,8 @@ constexpr std::string GetEntryPoint(ShaderId shader)
         return "PhongPS";
     case VS_GBuffer:
         return "GBufferVS";
+    case VS_GBufferInstanced:
+        return "GBufferInstancedVS";
     case PS_GBuffer:
         return "GBUfferPS";
     case PS_Ambient:
@@ -218,6 +227,10 @@ constexpr std::string GetEntryPoint(ShaderId shader)
         return "PickingVS";
     case PS_Picking:
         return "PickingPS";
+    case VS_DebugLine:
+        return "DebugLineVS";
+    case PS_DebugLine:
+        return "DebugLinePS";
     case PS_AddTexture:
         return "AddTexture";
     case PS_CopyTexture:
@@ -307,6 +320,10 @@ void CreateAllPrograms()
         .SetVertexShader(vsShaderMap[VS_GBuffer].get())
         .SetPixelShader(psShaderMap[PS_GBuffer].get())
         .SetInputLayout(inputLayoutMap[VS_GBuffer].get());
+    DXShaderProgramMap[ShaderProgram::GBufferInstanced]
+        .SetVertexShader(vsShaderMap[VS_GBufferInstanced].get())
+        .SetPixelShader(psShaderMap[PS_GBuffer].get())
+        .SetInputLayout(inputLayoutMap[VS_GBufferInstanced].get());
     DXShaderProgramMap[ShaderProgram::Ambient]
         .SetVertexShader(vsShaderMap[VS_ScreenQuad].get())
         .SetPixelShader(psShaderMap[PS_Ambient].get())
@@ -365,6 +382,10 @@ void CreateAllPrograms()
         .SetVertexShader(vsShaderMap[VS_Picking].get())
         .SetPixelShader(psShaderMap[PS_Picking].get())
         .SetInputLayout(inputLayoutMap[VS_Picking].get());
+    DXShaderProgramMap[ShaderProgram::DebugLine]
+        .SetVertexShader(vsShaderMap[VS_DebugLine].get())
+        .SetPixelShader(psShaderMap[PS_DebugLine].get())
+        .SetInputLayout(inputLayoutMap[VS_DebugLine].get());
     DXShaderProgramMap[ShaderProgram::Add]
         .SetVertexShader(vsShaderMap[VS_ScreenQuad].get())
         .SetPixelShader(psShaderMap[PS_AddTexture].get())
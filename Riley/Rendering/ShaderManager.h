@@ -11,11 +11,13 @@ enum ShaderId : uint8
     VS_Solid,
     VS_Phong,
     VS_GBuffer,
+    VS_GBufferInstanced,
     VS_Shadow,
     VS_ShadowCascade,
     VS_ShadowCube,
     VS_Picking,
     VS_Sun,
+    VS_DebugLine,
     PS_Solid,
     PS_Phong,
     PS_GBuffer,
@@ -35,6 +37,7 @@ enum ShaderId : uint8
     PS_CopyTexture,
     PS_Picking,
     PS_FXAA,
+    PS_DebugLine,
     GS_ShadowCascade,
     GS_ShadowCube,
     CS_TiledDeferredLighting,
@@ -48,6 +51,7 @@ enum class ShaderProgram : uint8
     Solid,
     ForwardPhong,
     GBuffer,
+    GBufferInstanced,
     Ambient,
     DeferredLighting,
     Halo,
@@ -67,6 +71,7 @@ enum class ShaderProgram : uint8
     BlurX,
     BlurY,
     FXAA,
+    DebugLine,
     UnKnown
 };
 
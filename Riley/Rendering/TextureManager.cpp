@@ -73,10 +73,44 @@ void TextureManager::Initialize(ID3D11Device* device, ID3D11DeviceContext* conte
     m_device = device;
     m_context = context;
     mipmaps = true;
+
+    const uint32 white = 0xFFFFFFFF;
+    D3D11_SUBRESOURCE_DATA initData{&white, sizeof(white), 0};
+    placeholder = std::make_unique<DXResource>();
+    placeholder->Initialize(m_device, 1, 1, DXFormat::R8G8B8A8_UNORM, &initData);
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+    srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MipLevels = 1;
+    placeholder->CreateSRV(m_device, &srvDesc);
+
+    stopping = false;
+    const uint32 workerCount = std::max(1u, std::thread::hardware_concurrency() / 2);
+    for (uint32 i = 0; i < workerCount; ++i)
+        workers.emplace_back(&TextureManager::WorkerLoop, this);
 }
 
 void TextureManager::Destroy()
 {
+    // what is still queued is dropped, one stop request per worker wakes them all
+    stopping = true;
+    for (size_t i = 0; i < workers.size(); ++i)
+        requests.Push(TextureRequest{});
+    for (std::thread& worker : workers)
+        worker.join();
+    workers.clear();
+
+    TextureRequest request;
+    while (requests.TryPop(request))
+        ;
+    DecodedTexture texture;
+    while (decoded.TryPop(texture))
+    {
+        SAFE_RELEASE(texture.srv);
+        SAFE_RELEASE(texture.texture);
+    }
+    pending = 0;
+
     m_device = nullptr;
     m_context = nullptr;
     auto FreeContainer = []<typename T>(T& container) {
@@ -84,12 +118,22 @@ void TextureManager::Destroy()
         T empty;
         std::swap(container, empty);
     };
+    std::lock_guard<std::mutex> lock(textureMutex);
     FreeContainer(textureMap);
+    FreeContainer(loadedTextures);
+    placeholder.reset();
 }
 
 DXResource* TextureManager::GetTextureView(TextureHandle texHandle) const
 {
-    return textureMap.find(texHandle)->second.get();
+    std::lock_guard<std::mutex> lock(textureMutex);
+    auto iter = textureMap.find(texHandle);
+    return iter != textureMap.end() ? iter->second.get() : placeholder.get();
+}
+
+uint32 TextureManager::PendingTextures() const
+{
+    return pending;
 }
 
 TextureHandle TextureManager::LoadTexture(std::wstring const& name)
@@ -114,30 +158,104 @@ TextureHandle TextureManager::LoadTexture(std::wstring const& name)
 
 TextureHandle TextureManager::LoadWICTexture(std::wstring const& name)
 {
-    if (auto iter = loadedTextures.find(name); iter == loadedTextures.end())
+    TextureHandle newHandle = INVALID_TEXTURE_HANDLE;
+    bool generateMips = true;
+    {
+        std::lock_guard<std::mutex> lock(textureMutex);
+        if (auto iter = loadedTextures.find(name); iter != loadedTextures.end())
+            return iter->second;
+
+        newHandle = ++handle;
+        generateMips = mipmaps;
+        loadedTextures.insert({name, newHandle});
+    }
+    ++pending;
+    requests.Push(TextureRequest{newHandle, name, generateMips});
+    return newHandle;
+}
+
+void TextureManager::WorkerLoop()
+{
+    // WIC is COM, every thread decoding with it has to initialize it
+    const bool comInitialized = SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+    while (true)
     {
-        ++handle;
+        TextureRequest request;
+        requests.WaitPop(request);
+        if (request.handle == INVALID_TEXTURE_HANDLE)
+            break;
+        if (stopping)
+            continue;
+
+        DecodedTexture texture{request.handle, nullptr, nullptr, request.mipmaps};
+        HRESULT hr = CreateWICTextureFromFileEx(m_device, request.name.c_str(), 0, D3D11_USAGE_DEFAULT,
+                                                D3D11_BIND_SHADER_RESOURCE, 0, 0, WIC_LOADER_DEFAULT,
+                                                reinterpret_cast<ID3D11Resource**>(&texture.texture),
+                                                request.mipmaps ? nullptr : &texture.srv);
+        if (FAILED(hr))
+        {
+            RI_WARN("Failed to load texture {}, keeping the placeholder", ToString(request.name));
+            SAFE_RELEASE(texture.texture);
+            --pending;
+            continue;
+        }
+        decoded.Push(texture);
+    }
+    if (comInitialized)
+        CoUninitialize();
+}
 
-        ID3D11ShaderResourceView* _srv = nullptr;
-        ID3D11Texture2D* _tex = nullptr;
+void TextureManager::ProcessUploads(uint32 maxUploads)
+{
+    DecodedTexture texture;
+    for (uint32 i = 0; i < maxUploads && decoded.TryPop(texture); ++i)
+    {
+        Publish(texture);
+        --pending;
+    }
+}
 
-        if (mipmaps)
+void TextureManager::Publish(DecodedTexture& texture)
+{
+    /* The mip chain is generated on the GPU from the base level the worker made, like CreateWICTextureFromFile does
+     * with a context. Formats the GPU cannot generate mips for keep their single level */
+    D3D11_TEXTURE2D_DESC desc{};
+    texture.texture->GetDesc(&desc);
+    UINT support = 0;
+    const bool autogen = texture.mipmaps && SUCCEEDED(m_device->CheckFormatSupport(desc.Format, &support)) &&
+                         (support & D3D11_FORMAT_SUPPORT_MIP_AUTOGEN);
+    if (autogen)
+    {
+        desc.MipLevels = MipmapLevels(desc.Width, desc.Height);
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+        desc.MiscFlags |= D3D11_RESOURCE_MISC_GENERATE_MIPS;
+        ID3D11Texture2D* mipped = nullptr;
+        ID3D11ShaderResourceView* srv = nullptr;
+        if (SUCCEEDED(m_device->CreateTexture2D(&desc, nullptr, &mipped)) &&
+            SUCCEEDED(m_device->CreateShaderResourceView(mipped, nullptr, &srv)))
         {
-            HR(CreateWICTextureFromFile(m_device, m_context, name.c_str(), reinterpret_cast<ID3D11Resource**>(&_tex), &_srv));
+            m_context->CopySubresourceRegion(mipped, 0, 0, 0, 0, texture.texture, 0, nullptr);
+            m_context->GenerateMips(srv);
+            SAFE_RELEASE(texture.texture);
+            texture.texture = mipped;
+            texture.srv = srv;
         }
         else
         {
-            HR(CreateWICTextureFromFile(m_device, name.c_str(), reinterpret_cast<ID3D11Resource**>(&_tex), &_srv));
+            SAFE_RELEASE(mipped);
         }
-
-        loadedTextures.insert({name, handle});
-        textureMap[handle] = std::make_unique<DXResource>();
-        textureMap[handle]->Initialize(reinterpret_cast<ID3D11Resource*>(_tex), _srv);
-
-        return handle;
     }
-    else
-        return iter->second;
+    if (!texture.srv && FAILED(m_device->CreateShaderResourceView(texture.texture, nullptr, &texture.srv)))
+    {
+        RI_WARN("Failed to create the view of texture {}, keeping the placeholder", texture.handle);
+        SAFE_RELEASE(texture.texture);
+        return;
+    }
+
+    auto resource = std::make_unique<DXResource>();
+    resource->Initialize(reinterpret_cast<ID3D11Resource*>(texture.texture), texture.srv);
+    std::lock_guard<std::mutex> lock(textureMutex);
+    textureMap[texture.handle] = std::move(resource);
 }
 
 } // namespace Riley
\ No newline at end of file
@@ -1,33 +1,68 @@
 #pragma once
 #include "../Graphics/DXResource.h"
+#include "../Utilities/ConcurrentQueue.h"
 #include "../Utilities/Singleton.h"
+#include <atomic>
 
 namespace Riley
 {
 using TextureHandle = uint64;
 inline constexpr TextureHandle const INVALID_TEXTURE_HANDLE = uint64(-1);
 
+/* Textures are loaded in the background. LoadTexture hands out the handle right away and until the file is read the
+ * handle shows a 1x1 white texture. Workers read and decode the files and create the base level, the device is free
+ * threaded. What needs the immediate context, the mip chain, is left to ProcessUploads, which the render thread calls
+ * once a frame and which publishes at most a bounded number of textures, a large texture set is spread over frames
+ * instead of stalling one. LoadTexture and GetTextureView can be called from any thread */
 class TextureManager : public Singleton<TextureManager>
 {
     friend class Singleton<TextureManager>;
 
   public:
+    static constexpr uint32 MAX_UPLOADS_PER_FRAME = 4;
+
     void Initialize(ID3D11Device* device, ID3D11DeviceContext* context);
     void Destroy();
 
     TextureHandle LoadTexture(std::wstring const& name);
     TextureHandle LoadTexture(std::string const& name);
+    // render thread only, publishes up to maxUploads textures the workers finished
+    void ProcessUploads(uint32 maxUploads = MAX_UPLOADS_PER_FRAME);
+    uint32 PendingTextures() const;
 
+    // the placeholder while the texture is still loading or when it failed to load
     DXResource* GetTextureView(TextureHandle texHandle) const;
     void SetMipMaps(bool mipmaps);
 
   private:
+    struct TextureRequest
+    {
+        TextureHandle handle = INVALID_TEXTURE_HANDLE; // a request without a handle stops the worker
+        std::wstring name;
+        bool mipmaps = true;
+    };
+    struct DecodedTexture
+    {
+        TextureHandle handle = INVALID_TEXTURE_HANDLE;
+        ID3D11Texture2D* texture = nullptr; // base level only
+        ID3D11ShaderResourceView* srv = nullptr; // only made by the worker when no mips are wanted
+        bool mipmaps = true;
+    };
+
     ID3D11Device* m_device;
     ID3D11DeviceContext* m_context;
     bool mipmaps = true;
     TextureHandle handle = INVALID_TEXTURE_HANDLE;
     std::unordered_map<TextureHandle, std::unique_ptr<DXResource>> textureMap{};
     std::unordered_map<std::wstring, TextureHandle> loadedTextures{};
+    std::unique_ptr<DXResource> placeholder;
+    mutable std::mutex textureMutex; // guards handle, textureMap and loadedTextures
+
+    std::vector<std::thread> workers;
+    ConcurrentQueue<TextureRequest> requests;
+    ConcurrentQueue<DecodedTexture> decoded;
+    std::atomic<uint32> pending = 0;
+    std::atomic<bool> stopping = false;
 
   private:
     TextureManager() = default;
@@ -36,6 +71,8 @@ class TextureManager : public Singleton<TextureManager>
     ~TextureManager() = default;
 
     TextureHandle LoadWICTexture(std::wstring const& name);
+    void WorkerLoop();
+    void Publish(DecodedTexture& texture);
 };
 #define g_TextureManager TextureManager::Get()
 } // namespace Riley
\ No newline at end of file
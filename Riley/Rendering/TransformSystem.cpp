@@ -0,0 +1,136 @@
+#include "TransformSystem.h"
+
+namespace Riley
+{
+
+TransformSystem::TransformSystem(entt::registry& reg) : m_reg(reg)
+{
+    m_reg.on_construct<Transform>().connect<&TransformSystem::OnHierarchyChanged>(*this);
+    m_reg.on_destroy<Transform>().connect<&TransformSystem::OnHierarchyChanged>(*this);
+    m_reg.on_construct<Relationship>().connect<&TransformSystem::OnHierarchyChanged>(*this);
+    m_reg.on_update<Relationship>().connect<&TransformSystem::OnHierarchyChanged>(*this);
+    m_reg.on_destroy<Relationship>().connect<&TransformSystem::OnHierarchyChanged>(*this);
+    m_reg.on_construct<AABB>().connect<&TransformSystem::OnHierarchyChanged>(*this);
+    m_reg.on_destroy<AABB>().connect<&TransformSystem::OnAABBDestroyed>(*this);
+}
+
+TransformSystem::~TransformSystem()
+{
+    m_reg.on_construct<Transform>().disconnect(this);
+    m_reg.on_destroy<Transform>().disconnect(this);
+    m_reg.on_construct<Relationship>().disconnect(this);
+    m_reg.on_update<Relationship>().disconnect(this);
+    m_reg.on_destroy<Relationship>().disconnect(this);
+    m_reg.on_construct<AABB>().disconnect(this);
+    m_reg.on_destroy<AABB>().disconnect(this);
+}
+
+void TransformSystem::Update()
+{
+    bool forceUpdate = false;
+    if (hierarchyDirty)
+    {
+        RebuildOrder();
+        hierarchyDirty = false;
+        forceUpdate = true;
+    }
+
+    for (uint32 i = 0; i < order.size(); ++i)
+    {
+        auto& transform = m_reg.get<Transform>(order[i]);
+        const uint32 parentSlot = parentSlots[i];
+        const bool parentUpdated = parentSlot != INVALID_SLOT && updated[parentSlot];
+
+        updated[i] = forceUpdate || transform.dirty || parentUpdated;
+        if (!updated[i])
+            continue;
+
+        worldRows[i] = parentSlot != INVALID_SLOT ? transform.currentTransform * worldRows[parentSlot] : transform.currentTransform;
+        transform.dirty = false;
+
+        WorldTransform& world = worlds[i];
+        world.world = worldRows[i].Transpose();
+        world.worldInvTranspose = worldRows[i].Invert().Transpose();
+
+        if (auto aabb = m_reg.try_get<AABB>(order[i]))
+        {
+            aabb->orginalBox.Transform(world.boundingBox, worldRows[i]);
+            aabb->boundingBox = world.boundingBox;
+            bounds.Set(i, world.boundingBox);
+
+            // static objects never get here, moving ones only touch the tree once they leave their fat box
+            if (aabb->treeProxy == DynamicAABBTree::NULL_NODE)
+                aabb->treeProxy = tree.CreateProxy(world.boundingBox, entt::to_integral(order[i]));
+            else
+                tree.MoveProxy(aabb->treeProxy, world.boundingBox);
+        }
+    }
+
+    // bulk loads insert one leaf at a time, rebuild them into a proper SAH tree
+    if (forceUpdate)
+        tree.Rebuild();
+}
+
+void TransformSystem::OnAABBDestroyed(entt::registry& reg, entt::entity e)
+{
+    auto& aabb = reg.get<AABB>(e);
+    if (aabb.treeProxy != DynamicAABBTree::NULL_NODE)
+    {
+        tree.DestroyProxy(aabb.treeProxy);
+        aabb.treeProxy = DynamicAABBTree::NULL_NODE;
+    }
+    hierarchyDirty = true;
+}
+
+void TransformSystem::RebuildOrder()
+{
+    auto transformView = m_reg.view<Transform>();
+
+    auto ParentOf = [&](entt::entity e) -> entt::entity {
+        auto relationship = m_reg.try_get<Relationship>(e);
+        if (!relationship || !m_reg.valid(relationship->parent) || !m_reg.all_of<Transform>(relationship->parent))
+            return entt::null;
+        return relationship->parent;
+    };
+
+    std::vector<std::pair<uint32, entt::entity>> depthSorted;
+    depthSorted.reserve(transformView.size());
+
+    uint32 maxIndex = 0;
+    for (auto e : transformView)
+    {
+        uint32 depth = 0;
+        for (entt::entity p = ParentOf(e); p != entt::null; p = ParentOf(p))
+        {
+            ++depth;
+            assert(depth <= transformView.size() && "Cycle in Relationship hierarchy!");
+        }
+        depthSorted.emplace_back(depth, e);
+        maxIndex = std::max(maxIndex, static_cast<uint32>(entt::to_entity(e)));
+    }
+    std::stable_sort(depthSorted.begin(), depthSorted.end(),
+                     [](auto const& lhs, auto const& rhs) { return lhs.first < rhs.first; });
+
+    const size_t count = depthSorted.size();
+    order.resize(count);
+    parentSlots.resize(count);
+    worldRows.resize(count);
+    worlds.resize(count);
+    updated.assign(count, 0);
+    bounds.Resize(static_cast<uint32>(count));
+    slots.assign(count ? maxIndex + 1 : 0, INVALID_SLOT);
+
+    for (uint32 i = 0; i < count; ++i)
+    {
+        order[i] = depthSorted[i].second;
+        slots[entt::to_entity(order[i])] = i;
+        bounds.SetEmpty(i);
+    }
+    for (uint32 i = 0; i < count; ++i)
+    {
+        entt::entity parent = ParentOf(order[i]);
+        parentSlots[i] = parent != entt::null ? slots[entt::to_entity(parent)] : INVALID_SLOT;
+    }
+}
+
+} // namespace Riley
@@ -0,0 +1,76 @@
+#pragma once
+#include "../Math/DynamicAABBTree.h"
+#include "Components.h"
+
+namespace Riley
+{
+
+/* World space data computed once per frame by TransformSystem.
+ * Matrices are stored transposed so they can be copied straight into ObjectConsts. */
+struct WorldTransform
+{
+    Matrix world = Matrix::Identity;
+    Matrix worldInvTranspose = Matrix::Identity;
+    DirectX::BoundingBox boundingBox;
+};
+
+class TransformSystem
+{
+  public:
+    static constexpr uint32 INVALID_SLOT = uint32(-1);
+
+    explicit TransformSystem(entt::registry& reg);
+    ~TransformSystem();
+
+    // Walks the Relationship hierarchy parents first and recomputes only dirty subtrees.
+    void Update();
+
+    WorldTransform const& Get(entt::entity e) const
+    {
+        return worlds[slots[entt::to_entity(e)]];
+    }
+    uint32 GetSlot(entt::entity e) const
+    {
+        return slots[entt::to_entity(e)];
+    }
+    entt::entity GetEntity(uint32 slot) const
+    {
+        return order[slot];
+    }
+    // world AABBs by slot, entities without an AABB are stored as empty bounds
+    BoundsSoA const& Bounds() const
+    {
+        return bounds;
+    }
+    // fat world AABBs of every entity with an AABB, user data is the entity
+    DynamicAABBTree const& Tree() const
+    {
+        return tree;
+    }
+
+  private:
+    void OnHierarchyChanged(entt::registry&, entt::entity)
+    {
+        hierarchyDirty = true;
+    }
+    void OnAABBDestroyed(entt::registry& reg, entt::entity e);
+    void RebuildOrder();
+
+  private:
+    entt::registry& m_reg;
+
+    // Dense arrays in topological order (parents always before their children)
+    std::vector<entt::entity> order;
+    std::vector<uint32> parentSlots;
+    std::vector<Matrix> worldRows;
+    std::vector<WorldTransform> worlds;
+    std::vector<uint8> updated;
+    BoundsSoA bounds;
+    DynamicAABBTree tree;
+
+    // entity index -> slot in the dense arrays
+    std::vector<uint32> slots;
+    bool hierarchyDirty = true;
+};
+
+} // namespace Riley
@@ -0,0 +1,167 @@
+#include "VertexCompression.h"
+#include <DirectXPackedVector.h>
+
+namespace Riley
+{
+namespace VertexCompression
+{
+
+static float SignNotZero(float value)
+{
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+// Same mapping as OctDecode in Common.hlsli
+Vector2 OctEncode(Vector3 const& direction)
+{
+    const float l1 = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+    if (l1 == 0.0f)
+        return Vector2(0.0f, 0.0f);
+
+    Vector2 encoded(direction.x / l1, direction.y / l1);
+    if (direction.z < 0.0f)
+    {
+        encoded = Vector2((1.0f - std::abs(encoded.y)) * SignNotZero(encoded.x),
+                          (1.0f - std::abs(encoded.x)) * SignNotZero(encoded.y));
+    }
+    return encoded;
+}
+
+Vector3 OctDecode(Vector2 const& encoded)
+{
+    Vector3 direction(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+    const float t = std::clamp(-direction.z, 0.0f, 1.0f);
+    direction.x += direction.x >= 0.0f ? -t : t;
+    direction.y += direction.y >= 0.0f ? -t : t;
+    direction.Normalize();
+    return direction;
+}
+
+uint16 PackUnorm16(float value)
+{
+    return static_cast<uint16>(std::round(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+float UnpackUnorm16(uint16 value)
+{
+    return value / 65535.0f;
+}
+
+int16 PackSnorm16(float value)
+{
+    return static_cast<int16>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+float UnpackSnorm16(int16 value)
+{
+    // -32768 maps to -1 as well, like the GPU conversion
+    return std::max(value / 32767.0f, -1.0f);
+}
+
+uint16 PackHalf(float value)
+{
+    return DirectX::PackedVector::XMConvertFloatToHalf(value);
+}
+
+float UnpackHalf(uint16 value)
+{
+    return DirectX::PackedVector::XMConvertHalfToFloat(value);
+}
+
+Vector3 PositionBias(BoundingBox const& bounds)
+{
+    return Vector3(bounds.Center) - Vector3(bounds.Extents);
+}
+
+Vector3 PositionScale(BoundingBox const& bounds)
+{
+    // flat meshes keep a unit scale on their flat axis, every position encodes to 0 there
+    Vector3 scale = 2.0f * Vector3(bounds.Extents);
+    scale.x = scale.x > 0.0f ? scale.x : 1.0f;
+    scale.y = scale.y > 0.0f ? scale.y : 1.0f;
+    scale.z = scale.z > 0.0f ? scale.z : 1.0f;
+    return scale;
+}
+
+CompactVertex Encode(Vertex const& vertex, BoundingBox const& bounds)
+{
+    const Vector3 position = (vertex.position - PositionBias(bounds)) / PositionScale(bounds);
+    const Vector2 normal = OctEncode(vertex.normal);
+    const Vector2 tangent = OctEncode(vertex.tangent);
+    // the bitangent is rebuilt as cross(normal, tangent), only its handedness is kept
+    const bool flipped = vertex.normal.Cross(vertex.tangent).Dot(vertex.bitangent) < 0.0f;
+
+    CompactVertex compact{};
+    compact.position[0] = PackUnorm16(position.x);
+    compact.position[1] = PackUnorm16(position.y);
+    compact.position[2] = PackUnorm16(position.z);
+    compact.position[3] = flipped ? 0 : 65535;
+    compact.normal[0] = PackSnorm16(normal.x);
+    compact.normal[1] = PackSnorm16(normal.y);
+    compact.tangent[0] = PackSnorm16(tangent.x);
+    compact.tangent[1] = PackSnorm16(tangent.y);
+    compact.texcoord[0] = PackHalf(vertex.texcoord.x);
+    compact.texcoord[1] = PackHalf(vertex.texcoord.y);
+    return compact;
+}
+
+Vertex Decode(CompactVertex const& compact, Vector3 const& positionBias, Vector3 const& positionScale)
+{
+    Vertex vertex{};
+    const Vector3 position(UnpackUnorm16(compact.position[0]), UnpackUnorm16(compact.position[1]),
+                           UnpackUnorm16(compact.position[2]));
+    vertex.position = positionBias + position * positionScale;
+    vertex.normal = OctDecode(Vector2(UnpackSnorm16(compact.normal[0]), UnpackSnorm16(compact.normal[1])));
+    vertex.tangent = OctDecode(Vector2(UnpackSnorm16(compact.tangent[0]), UnpackSnorm16(compact.tangent[1])));
+    vertex.bitangent = vertex.normal.Cross(vertex.tangent) * (UnpackUnorm16(compact.position[3]) * 2.0f - 1.0f);
+    vertex.texcoord = Vector2(UnpackHalf(compact.texcoord[0]), UnpackHalf(compact.texcoord[1]));
+    return vertex;
+}
+
+void Encode(std::span<Vertex const> vertices, BoundingBox const& bounds, std::vector<CompactVertex>& out)
+{
+    out.reserve(out.size() + vertices.size());
+    for (Vertex const& vertex : vertices)
+        out.push_back(Encode(vertex, bounds));
+}
+
+static float DirectionError(Vector3 original, Vector3 const& decoded)
+{
+    // degenerate directions have nothing to preserve
+    if (original.LengthSquared() < 1e-12f)
+        return 0.0f;
+    original.Normalize();
+    return (original - decoded).Length();
+}
+
+CompressionError MeasureError(std::span<Vertex const> vertices, std::span<CompactVertex const> compact, BoundingBox const& bounds)
+{
+    assert(vertices.size() == compact.size());
+    const Vector3 bias = PositionBias(bounds);
+    const Vector3 scale = PositionScale(bounds);
+
+    CompressionError error{};
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        Vertex const& original = vertices[i];
+        const Vertex decoded = Decode(compact[i], bias, scale);
+
+        const Vector3 position = (decoded.position - original.position) / scale;
+        error.position = std::max({error.position, std::abs(position.x), std::abs(position.y), std::abs(position.z)});
+        error.normal = std::max(error.normal, DirectionError(original.normal, decoded.normal));
+        error.tangent = std::max(error.tangent, DirectionError(original.tangent, decoded.tangent));
+
+        const Vector2 texcoord = decoded.texcoord - original.texcoord;
+        const float texcoordScale = std::max({1.0f, std::abs(original.texcoord.x), std::abs(original.texcoord.y)});
+        error.texcoord = std::max({error.texcoord, std::abs(texcoord.x) / texcoordScale, std::abs(texcoord.y) / texcoordScale});
+
+        // nearly coplanar frames have no reliable handedness to keep
+        const float handedness = original.normal.Cross(original.tangent).Dot(original.bitangent);
+        if (std::abs(handedness) > 1e-3f && (handedness > 0.0f) != (compact[i].position[3] != 0))
+            ++error.bitangentFlips;
+    }
+    return error;
+}
+
+} // namespace VertexCompression
+} // namespace Riley
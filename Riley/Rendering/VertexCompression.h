@@ -0,0 +1,63 @@
+#pragma once
+#include "Components.h"
+
+namespace Riley
+{
+
+/* 20 byte vertex the mesh passes read, see MeshVertex in Common.hlsli.
+ * Positions are 16 bit unorm inside the bounds of their mesh, Mesh::positionBias/positionScale map them back.
+ * Normal and tangent are octahedral encoded to two 16 bit snorms, the bitangent is rebuilt from them with
+ * the sign kept in position[3]. Texcoords are half floats. */
+struct CompactVertex
+{
+    uint16 position[4];
+    int16 normal[2];
+    int16 tangent[2];
+    uint16 texcoord[2];
+};
+static_assert(sizeof(CompactVertex) == 20);
+
+// Largest round trip error of a vertex set, positions in units of the bounds extent
+struct CompressionError
+{
+    float position = 0.0f; // fraction of the extent on the worst axis
+    float normal = 0.0f;   // length of the difference of the unit vectors
+    float tangent = 0.0f;
+    float texcoord = 0.0f; // relative to max(1, |uv|)
+    uint32 bitangentFlips = 0;
+
+    // Bounds of the encoding, anything above is a bug in the encoders
+    static constexpr float POSITION_BOUND = 0.5f / 65535.0f + 1e-6f;
+    static constexpr float DIRECTION_BOUND = 1e-3f;
+    static constexpr float TEXCOORD_BOUND = 1.0f / 1024.0f;
+
+    bool WithinBounds() const
+    {
+        return position <= POSITION_BOUND && normal <= DIRECTION_BOUND && tangent <= DIRECTION_BOUND &&
+               texcoord <= TEXCOORD_BOUND && bitangentFlips == 0;
+    }
+};
+
+namespace VertexCompression
+{
+Vector2 OctEncode(Vector3 const& direction);
+Vector3 OctDecode(Vector2 const& encoded);
+uint16 PackUnorm16(float value);
+float UnpackUnorm16(uint16 value);
+int16 PackSnorm16(float value);
+float UnpackSnorm16(int16 value);
+uint16 PackHalf(float value);
+float UnpackHalf(uint16 value);
+
+// Quantizes positions to bounds, the mesh draws them back with PositionBias/PositionScale of the same bounds
+CompactVertex Encode(Vertex const& vertex, BoundingBox const& bounds);
+Vertex Decode(CompactVertex const& vertex, Vector3 const& positionBias, Vector3 const& positionScale);
+void Encode(std::span<Vertex const> vertices, BoundingBox const& bounds, std::vector<CompactVertex>& out);
+
+Vector3 PositionBias(BoundingBox const& bounds);
+Vector3 PositionScale(BoundingBox const& bounds);
+
+CompressionError MeasureError(std::span<Vertex const> vertices, std::span<CompactVertex const> compact, BoundingBox const& bounds);
+} // namespace VertexCompression
+
+} // namespace Riley
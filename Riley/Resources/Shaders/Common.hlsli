@@ -29,6 +29,49 @@ cbuffer MeshConsts : register(b1)
     MeshData meshData;
 };
 
+// Compressed vertex of the meshes, CompactVertex on the CPU. The _UNORM/_SNORM/_HALF semantics make the
+// input layout read 16 bit components, see FillInputLayoutDesc
+struct MeshVertex
+{
+    float4 position : POSITION_UNORM; // xyz inside the mesh bounds, w the bitangent sign
+    float2 normal : NORMAL_SNORM;     // octahedral
+    float2 tangent : TANGENT_SNORM;   // octahedral
+    float2 texcoord : TEXCOORD_HALF;
+};
+
+struct ModelVertex
+{
+    float3 posModel;
+    float3 normalModel;
+    float2 texcoord;
+    float3 tangentModel;
+    float3 bitangentModel;
+};
+
+static float3 OctDecode(float2 e)
+{
+    float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += n.xy >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+static float3 DecodePosition(MeshVertex input)
+{
+    return meshData.positionBias + input.position.xyz * meshData.positionScale;
+}
+
+static ModelVertex DecodeMeshVertex(MeshVertex input)
+{
+    ModelVertex output;
+    output.posModel = DecodePosition(input);
+    output.normalModel = OctDecode(input.normal);
+    output.tangentModel = OctDecode(input.tangent);
+    output.bitangentModel = cross(output.normalModel, output.tangentModel) * (input.position.w * 2.0 - 1.0);
+    output.texcoord = input.texcoord;
+    return output;
+}
+
 cbuffer MaterialConsts : register(b1)
 {
     MaterialData materialData;
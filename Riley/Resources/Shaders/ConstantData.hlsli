@@ -67,6 +67,10 @@ struct MeshData
 {
     matrix world;
     matrix worldInvTranspose;
+    uint viewMask;
+    float3 positionBias; // maps MeshVertex positions to model space
+    float3 positionScale;
+    float _dummy;
 };
 
 struct MaterialData
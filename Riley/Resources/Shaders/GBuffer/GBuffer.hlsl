@@ -1,14 +1,5 @@
 #include "../Common.hlsli"
 
-struct VSInput
-{
-    float3 posModel : POSITION;
-    float3 normalModel : NORMAL0;
-    float2 texcoord : TEXCOORD0;
-    float3 tangentModel : TANGENT0;
-    float3 bitangentModel : BITANGENT0;
-};
-
 struct VSToPS
 {
     float4 posProj : SV_POSITION; // Screen position
@@ -19,23 +10,50 @@ struct VSToPS
     float3 bitangentWS : BITANGENT0;
 };
 
-VSToPS GBufferVS(VSInput input)
+// Per instance copy of MeshData, rows as uploaded to the constant buffer
+struct InstanceInput
+{
+    float4 world0 : INSTANCE0;
+    float4 world1 : INSTANCE1;
+    float4 world2 : INSTANCE2;
+    float4 world3 : INSTANCE3;
+    float4 worldInvTranspose0 : INSTANCE4;
+    float4 worldInvTranspose1 : INSTANCE5;
+    float4 worldInvTranspose2 : INSTANCE6;
+    float4 worldInvTranspose3 : INSTANCE7;
+};
+
+VSToPS TransformVertex(MeshVertex packed, matrix world, matrix worldInvTranspose)
 {
     VSToPS output;
+    ModelVertex input = DecodeMeshVertex(packed);
     
     float4 pos = float4(input.posModel, 1.0);
-    pos = mul(pos, meshData.world);
+    pos = mul(pos, world);
     output.posProj = mul(pos, frameData.viewProj);
     
-    output.normalWS = mul(input.normalModel, (float3x3) meshData.worldInvTranspose);
+    output.normalWS = mul(input.normalModel, (float3x3) worldInvTranspose);
     output.normalVS = mul(output.normalWS, (float3x3) frameData.view);
-    output.tangentWS = mul(input.tangentModel, (float3x3) meshData.world);
-    output.bitangentWS = mul(input.bitangentModel, (float3x3) meshData.world);
+    output.tangentWS = mul(input.tangentModel, (float3x3) world);
+    output.bitangentWS = mul(input.bitangentModel, (float3x3) world);
     output.texcoord = input.texcoord;
 
     return output;
 }
 
+VSToPS GBufferVS(MeshVertex input)
+{
+    return TransformVertex(input, meshData.world, meshData.worldInvTranspose);
+}
+
+VSToPS GBufferInstancedVS(MeshVertex input, InstanceInput instance)
+{
+    matrix world = transpose(float4x4(instance.world0, instance.world1, instance.world2, instance.world3));
+    matrix worldInvTranspose = transpose(float4x4(instance.worldInvTranspose0, instance.worldInvTranspose1,
+                                                  instance.worldInvTranspose2, instance.worldInvTranspose3));
+    return TransformVertex(input, world, worldInvTranspose);
+}
+
 Texture2D AlbedoTex : register(t0);
 Texture2D NormalTex : register(t1);
 Texture2D MetallicRoughnessTex : register(t2);
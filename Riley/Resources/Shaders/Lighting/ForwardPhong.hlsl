@@ -5,15 +5,6 @@
 Texture2D ShadowMap : register(t0);
 TextureCube ShadowCubeMap : register(t1);
 
-struct VSInput
-{
-    float3 posModel : POSITION; //¸ðµ¨ ÁÂÇ¥°èÀÇ À§Ä¡ position
-    float3 normalModel : NORMAL0; // ¸ðµ¨ ÁÂÇ¥°èÀÇ normal    
-    float2 texcoord : TEXCOORD0;
-    float3 tangentModel : TANGENT0;
-    float3 bitangentModel : BITANGENT0;
-};
-
 struct VSToPS
 {
     float4 posProj : SV_POSITION; // Screen position
@@ -25,9 +16,10 @@ struct VSToPS
     float3 bitangentWorld : BITANGENT0;
 };
 
-VSToPS PhongVS(VSInput input)
+VSToPS PhongVS(MeshVertex packed)
 {
     VSToPS output;
+    ModelVertex input = DecodeMeshVertex(packed);
     
     float4 pos = float4(input.posModel, 1.0);
     pos = mul(pos, meshData.world);
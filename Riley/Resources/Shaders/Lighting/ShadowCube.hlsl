@@ -1,21 +1,15 @@
 #include "../Common.hlsli"
 
-struct VSInput
-{
-    float3 posModel : POSITION; //¸ðµ¨ ÁÂÇ¥°èÀÇ À§Ä¡ position
-    float2 texcoord : TEXCOORD0;
-};
-
 struct VSToGS
 {
     float4 posWorld : SV_POSITION;
     float2 texcoord : TEXCOORD0;
 };
 
-VSToGS ShadowCubeVS(VSInput input)
+VSToGS ShadowCubeVS(MeshVertex input)
 {
     VSToGS output;
-    output.posWorld = mul(float4(input.posModel, 1.0), meshData.world);
+    output.posWorld = mul(float4(DecodePosition(input), 1.0), meshData.world);
     output.texcoord = input.texcoord;
     
     return output;
@@ -33,6 +27,10 @@ void ShadowCubeGS(triangle VSToGS input[3], inout TriangleStream<GSToPS> triStre
 {
     for (int face = 0; face < 6; ++face)
     {
+        // only the faces whose view actually sees the object
+        if (!(meshData.viewMask & (1u << face)))
+            continue;
+
         GSToPS output;
         output.layer = face;
         for (int i = 0; i < 3; ++i)
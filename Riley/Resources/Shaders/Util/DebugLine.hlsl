@@ -0,0 +1,27 @@
+#include "../Common.hlsli"
+
+struct VSInput
+{
+    float3 posWorld : POSITION; // DebugDraw vertices are already in world space
+    float4 color : COLOR;
+};
+
+struct VSToPS
+{
+    float4 posProj : SV_POSITION;
+    float4 color : COLOR;
+};
+
+VSToPS DebugLineVS(VSInput input)
+{
+    VSToPS output;
+    output.posProj = mul(float4(input.posWorld, 1.0), frameData.viewProj);
+    output.color = input.color;
+
+    return output;
+}
+
+float4 DebugLinePS(VSToPS input) : SV_TARGET
+{
+    return input.color;
+}
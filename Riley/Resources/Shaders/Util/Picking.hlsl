@@ -1,22 +1,16 @@
 #include "../Common.hlsli"
 
-struct VSInput
-{
-    float3 posModel : POSITION;
-    float2 texcoord : TEXCOORD0;
-};
-
 struct VSToPS
 {
     float4 posProj : SV_POSITION; // Screen position
     float2 texcoord : TEXCOORD0;
 };
 
-VSToPS PickingVS(VSInput input)
+VSToPS PickingVS(MeshVertex input)
 {
     VSToPS output;
     
-    float4 pos = float4(input.posModel, 1.0);
+    float4 pos = float4(DecodePosition(input), 1.0);
     pos = mul(pos, meshData.world);
     output.posProj = mul(pos, frameData.viewProj);
     output.texcoord = input.texcoord;
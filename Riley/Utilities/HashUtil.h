@@ -7,6 +7,15 @@ template <typename T> constexpr void HashCombine(size_t& seed, T const& v) {
     seed ^= hasher(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
 }
 
+// FNV-1a over a byte range, pass the previous result as seed to hash several ranges as one
+inline uint64_t HashBytes(void const* data, size_t size,
+                          uint64_t seed = 14695981039346656037ull) {
+    uint8_t const* bytes = static_cast<uint8_t const*>(data);
+    for (size_t i = 0; i < size; ++i)
+        seed = (seed ^ bytes[i]) * 1099511628211ull;
+    return seed;
+}
+
 namespace crc {
 // https://stackoverflow.com/questions/28675727/using-crc32-algorithm-to-hash-string-at-compile-time
 template <uint64_t c, int32_t k = 8>
@@ -0,0 +1,90 @@
+#include "MappedFile.h"
+#include "StringUtil.h"
+#include <utility>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Riley {
+
+#ifdef _WIN32
+MappedFile::MappedFile(std::string const& path) {
+    HANDLE handle = CreateFileW(ToWideString(path).c_str(), GENERIC_READ,
+                                FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return;
+    file = handle;
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0) {
+        Close();
+        return;
+    }
+    size = static_cast<uint64_t>(fileSize.QuadPart);
+
+    mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping != nullptr)
+        view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr)
+        Close();
+}
+#else
+// the mapping outlives the descriptor, so neither file nor mapping is kept
+MappedFile::MappedFile(std::string const& path) {
+    const int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+        return;
+
+    struct stat fileStat {};
+    if (fstat(descriptor, &fileStat) == 0 && fileStat.st_size > 0) {
+        void* mapped = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (mapped != MAP_FAILED) {
+            view = mapped;
+            size = static_cast<uint64_t>(fileStat.st_size);
+        }
+    }
+    close(descriptor);
+}
+#endif
+
+MappedFile::~MappedFile() { Close(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : file(std::exchange(other.file, nullptr)),
+      mapping(std::exchange(other.mapping, nullptr)),
+      view(std::exchange(other.view, nullptr)),
+      size(std::exchange(other.size, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        file = std::exchange(other.file, nullptr);
+        mapping = std::exchange(other.mapping, nullptr);
+        view = std::exchange(other.view, nullptr);
+        size = std::exchange(other.size, 0);
+    }
+    return *this;
+}
+
+void MappedFile::Close() {
+#ifdef _WIN32
+    if (view != nullptr)
+        UnmapViewOfFile(view);
+    if (mapping != nullptr)
+        CloseHandle(mapping);
+    if (file != nullptr)
+        CloseHandle(file);
+#else
+    if (view != nullptr)
+        munmap(const_cast<void*>(view), size);
+#endif
+    file = mapping = nullptr;
+    view = nullptr;
+    size = 0;
+}
+
+} // namespace Riley
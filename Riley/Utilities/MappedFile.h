@@ -0,0 +1,34 @@
+#pragma once
+#include <span>
+#include <string>
+
+namespace Riley {
+
+// Read only view of a whole file mapped into memory, pages are read in on
+// first touch. Empty when the file cannot be opened or has no bytes.
+class MappedFile {
+  public:
+    MappedFile() = default;
+    explicit MappedFile(std::string const& path);
+    ~MappedFile();
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool IsOpen() const { return view != nullptr; }
+    uint8_t const* Data() const { return static_cast<uint8_t const*>(view); }
+    uint64_t Size() const { return size; }
+    std::span<uint8_t const> Bytes() const { return {Data(), size}; }
+
+    void Close();
+
+  private:
+    void* file = nullptr;
+    void* mapping = nullptr;
+    void const* view = nullptr;
+    uint64_t size = 0;
+};
+
+} // namespace Riley
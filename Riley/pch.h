@@ -16,10 +16,13 @@
 #include <type_traits>
 #include <unordered_map>
 #include <map>
+// everything win32/d3d is left out of the portable RileyTests build, see RileyTests/CMakeLists.txt
+#ifdef _WIN32
 #include <d3d11_3.h>
 #include <wrl.h>
 #include <dxgi1_3.h>
 #include <windows.h>
+#endif
 
 //external utility
 #include <DirectXMath.h>
@@ -32,12 +35,16 @@
 
 #define IMGUI_DEFINE_MATH_OPERATORS
 #include "ImGui/imgui.h"
+#ifdef _WIN32
 #include "ImGui/imgui_impl_dx11.h"
 #include "ImGui/imgui_impl_win32.h"
+#endif
 #include "ImGui/imgui_internal.h"
 
 //project utility
 #include "Core/CoreTypes.h"
 #include "Core/Log.h"
+#ifdef _WIN32
 #include "Core/Input.h"
+#endif
 #include "Math/MathTypes.h"
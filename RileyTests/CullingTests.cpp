@@ -0,0 +1,191 @@
+#include "Test.h"
+#include "Math/Culling.h"
+#include "Rendering/RenderSetting.h"
+#include "Utilities/Timer.h"
+#include <random>
+
+using namespace Riley;
+
+namespace
+{
+// camera at the origin looking down +z
+DirectX::BoundingFrustum CameraFrustum()
+{
+    return DirectX::BoundingFrustum(
+        DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(90.0f), 16.0f / 9.0f, 0.1f, 100.0f));
+}
+
+// boxes scattered around the camera, many of them crossing a plane
+BoundsSoA RandomBounds(uint32 boxCount, uint32 seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> extent(0.1f, 2.0f);
+
+    BoundsSoA bounds;
+    bounds.Resize(boxCount);
+    for (uint32 i = 0; i < boxCount; ++i)
+    {
+        bounds.Set(i, DirectX::BoundingBox(Vector3(position(rng), position(rng), position(rng)),
+                                           Vector3(extent(rng), extent(rng), extent(rng))));
+    }
+    return bounds;
+}
+
+// the camera, the cascades and the cube faces, each rotated a bit around y so the views differ
+std::vector<CullPlanes> FrameViews(DirectX::BoundingFrustum const& frustum)
+{
+    static constexpr uint32 viewCount = 1 + CASCADE_COUNT + 6;
+    std::vector<CullPlanes> views;
+    for (uint32 v = 0; v < viewCount; ++v)
+    {
+        DirectX::BoundingFrustum view;
+        frustum.Transform(view, DirectX::XMMatrixRotationY(DirectX::XM_2PI * v / viewCount));
+        views.push_back(CullPlanes::FromFrustum(view));
+    }
+    return views;
+}
+
+uint32 VisibleCount(VisibilityBits const& bits)
+{
+    uint32 count = 0;
+    for (uint64 word : bits)
+        count += static_cast<uint32>(std::popcount(word));
+    return count;
+}
+} // namespace
+
+RI_TEST(CullingSIMDMatchesScalar)
+{
+    const CullPlanes planes = CullPlanes::FromFrustum(CameraFrustum());
+
+    // counts off the batch size check the padding, which must never be visible
+    for (uint32 boxCount : {1u, 7u, 8u, 63u, 64u, 65u, 1000u, 4099u})
+    {
+        BoundsSoA bounds = RandomBounds(boxCount, boxCount);
+        if (boxCount > 2)
+            bounds.SetEmpty(boxCount / 2);
+
+        VisibilityBits scalarBits, simdBits;
+        Culling::FrustumCullScalar(bounds, planes, scalarBits);
+        Culling::FrustumCullSIMD(bounds, planes, simdBits);
+        RI_CHECK(scalarBits == simdBits);
+        if (boxCount > 2)
+            RI_CHECK(!IsVisible(simdBits, boxCount / 2));
+        for (uint32 slot = boxCount; slot < bounds.PaddedCount(); ++slot)
+            RI_CHECK(!IsVisible(simdBits, slot));
+    }
+}
+
+RI_TEST(CullingAgreesWithDirectXCollision)
+{
+    static constexpr uint32 boxCount = 20000;
+    static constexpr float planeEpsilon = 1e-3f;
+
+    const DirectX::BoundingFrustum frustum = CameraFrustum();
+    const CullPlanes planes = CullPlanes::FromFrustum(frustum);
+    const BoundsSoA bounds = RandomBounds(boxCount, 99);
+
+    VisibilityBits bits;
+    Culling::FrustumCullSIMD(bounds, planes, bits);
+
+    // Contains tests the box against the same six planes, the two can only round differently when a box touches one
+    uint32 compared = 0, visible = 0, mismatches = 0;
+    for (uint32 i = 0; i < boxCount; ++i)
+    {
+        const Vector3 center(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]);
+        const Vector3 extents(bounds.extentX[i], bounds.extentY[i], bounds.extentZ[i]);
+
+        bool nearPlane = false;
+        for (Vector4 const& p : planes.planes)
+        {
+            const float dist = p.x * center.x + p.y * center.y + p.z * center.z + p.w;
+            const float radius = fabs(p.x) * extents.x + fabs(p.y) * extents.y + fabs(p.z) * extents.z;
+            nearPlane |= fabs(dist - radius) < planeEpsilon;
+        }
+        if (nearPlane)
+            continue;
+
+        const bool expected = frustum.Contains(DirectX::BoundingBox(center, extents)) != DirectX::DISJOINT;
+        mismatches += IsVisible(bits, i) != expected;
+        visible += expected;
+        ++compared;
+    }
+    RI_CHECK(mismatches == 0);
+    // both outcomes have to be well represented for the comparison to mean anything
+    RI_CHECK(compared > boxCount * 9 / 10);
+    RI_CHECK(visible > compared / 100 && visible < compared / 2);
+}
+
+RI_TEST(CullingViewsMatchSerial)
+{
+    const std::vector<CullPlanes> views = FrameViews(CameraFrustum());
+    for (uint32 boxCount : {100u, 5000u})
+    {
+        const BoundsSoA bounds = RandomBounds(boxCount, 7);
+
+        VisibilityTable serialBits(views.size()), parallelBits;
+        for (uint32 v = 0; v < views.size(); ++v)
+            Culling::FrustumCullSIMD(bounds, views[v], serialBits[v]);
+        Culling::FrustumCullViews(bounds, views, parallelBits);
+        RI_CHECK(serialBits == parallelBits);
+
+        // the view masks ForEachVisible hands out are the union of the views
+        uint32 slots = 0;
+        bool masksMatch = true;
+        ForEachVisible(parallelBits, 0, static_cast<uint32>(views.size()), [&](uint32 slot, uint32 viewMask) {
+            ++slots;
+            for (uint32 v = 0; v < views.size(); ++v)
+                masksMatch &= IsVisible(parallelBits[v], slot) == (((viewMask >> v) & 1u) != 0);
+        });
+        RI_CHECK(masksMatch);
+        RI_CHECK(slots <= boxCount);
+    }
+}
+
+RI_BENCHMARK(CullingBenchmark)
+{
+    static constexpr uint32 boxCounts[] = {1000, 10000, 100000};
+    static constexpr uint32 iterations = 100;
+
+    const DirectX::BoundingFrustum frustum = CameraFrustum();
+    const CullPlanes planes = CullPlanes::FromFrustum(frustum);
+    const std::vector<CullPlanes> views = FrameViews(frustum);
+    for (uint32 boxCount : boxCounts)
+    {
+        const BoundsSoA bounds = RandomBounds(boxCount, 1234);
+
+        VisibilityBits scalarBits, simdBits;
+        RileyTimer benchTimer;
+
+        benchTimer.Mark();
+        for (uint32 it = 0; it < iterations; ++it)
+            Culling::FrustumCullScalar(bounds, planes, scalarBits);
+        const float scalarUs = static_cast<float>(benchTimer.Mark()) / iterations;
+
+        for (uint32 it = 0; it < iterations; ++it)
+            Culling::FrustumCullSIMD(bounds, planes, simdBits);
+        const float simdUs = static_cast<float>(benchTimer.Mark()) / iterations;
+
+        RI_INFO("Culling {:d} boxes : scalar {:.2f}us, simd {:.2f}us ({:.2f}x), visible {:d}", boxCount, scalarUs, simdUs,
+                scalarUs / std::max(simdUs, 1e-3f), VisibleCount(simdBits));
+        RI_CHECK(scalarBits == simdBits);
+
+        VisibilityTable serialBits(views.size()), parallelBits;
+        benchTimer.Mark();
+        for (uint32 it = 0; it < iterations; ++it)
+        {
+            for (uint32 v = 0; v < views.size(); ++v)
+                Culling::FrustumCullSIMD(bounds, views[v], serialBits[v]);
+        }
+        const float serialUs = static_cast<float>(benchTimer.Mark()) / iterations;
+
+        for (uint32 it = 0; it < iterations; ++it)
+            Culling::FrustumCullViews(bounds, views, parallelBits);
+        const float parallelUs = static_cast<float>(benchTimer.Mark()) / iterations;
+
+        RI_INFO("Culling {:d} boxes x {:d} views : serial {:.2f}us, parallel {:.2f}us ({:.2f}x)", boxCount, views.size(), serialUs,
+                parallelUs, serialUs / std::max(parallelUs, 1e-3f));
+        RI_CHECK(serialBits == parallelBits);
+    }
+}
@@ -0,0 +1,185 @@
+#include "Test.h"
+#include "Graphics/DXCommandList.h"
+#include "Graphics/DXUploadRing.h"
+#include "Utilities/Timer.h"
+#include <execution>
+#include <numeric>
+
+using namespace Riley;
+
+namespace
+{
+// per draw constants the size of the renderer's object constants: world, inverse transpose and a few factors
+struct DrawConstants
+{
+    float values[36];
+};
+
+/* One view of a synthetic frame recorded like the renderer records its passes, without any engine object behind the
+ * pointers: a program switch every few draws, the per draw constants in a window of the ring, or copied inline into
+ * the list when there is no ring, and a draw of a few hundred triangles */
+void RecordView(DXCommandList& list, DXUploadRing* ring, uint32 view, uint32 drawCount)
+{
+    list.Reset();
+    list.BeginEvent("View");
+    list.SetViewport(2048.0f, 2048.0f);
+    for (uint32 i = 0; i < drawCount; ++i)
+    {
+        if (i % 32 == 0)
+            list.BindProgram(nullptr);
+
+        DrawConstants constants{};
+        constants.values[0] = float(view);
+        constants.values[1] = float(i);
+        const DXUploadAllocation allocation = ring ? ring->Push(constants) : DXUploadAllocation{};
+        if (allocation.IsValid())
+            list.BindConstants(nullptr, DXShaderStage::VS, 0, allocation.offset, allocation.size);
+        else
+            list.UpdateBuffer(nullptr, &constants, sizeof(constants));
+
+        DXCommandDrawIndexed draw{};
+        draw.vertexCount = 3 * (64 + i % 256);
+        draw.instanceCount = 1;
+        draw.topology = DXPrimitiveTopology::TriangleList;
+        list.DrawIndexed(draw);
+    }
+    list.EndEvent();
+}
+} // namespace
+
+RI_TEST(CommandListRecordsInOrder)
+{
+    DXCommandList list;
+    list.BeginEvent("Pass");
+    list.SetViewport(1280.0f, 720.0f);
+    const uint32 constants[5] = {1, 2, 3, 4, 5};
+    list.UpdateBuffer(nullptr, constants, sizeof(constants));
+    list.Draw(3, 0, DXPrimitiveTopology::TriangleList);
+    list.Dispatch(8, 4, 1);
+    list.EndEvent();
+    RI_CHECK(list.CommandCount() == 6);
+
+    const DXCommandType expected[] = {DXCommandType::BeginEvent, DXCommandType::SetViewport, DXCommandType::UpdateBuffer,
+                                      DXCommandType::Draw,       DXCommandType::Dispatch,    DXCommandType::EndEvent};
+    uint32 index = 0;
+    size_t bytes = 0;
+    list.ForEach([&](DXCommand const& command) {
+        RI_CHECK(index < std::size(expected) && command.type == expected[index]);
+        RI_CHECK(command.size % DXCommandList::COMMAND_ALIGNMENT == 0);
+        RI_CHECK(reinterpret_cast<uintptr_t>(&command) % DXCommandList::COMMAND_ALIGNMENT == 0);
+        if (command.type == DXCommandType::SetViewport)
+        {
+            DXViewport const& viewport = static_cast<DXCommandSetViewport const&>(command).viewport;
+            RI_CHECK(viewport.width == 1280.0f && viewport.height == 720.0f && viewport.maxDepth == 1.0f);
+        }
+        else if (command.type == DXCommandType::UpdateBuffer)
+        {
+            // the data is copied inline, right after the command
+            auto const& update = static_cast<DXCommandUpdateBuffer const&>(command);
+            RI_CHECK(update.dataSize == sizeof(constants));
+            RI_CHECK(memcmp(&update + 1, constants, sizeof(constants)) == 0);
+        }
+        else if (command.type == DXCommandType::Draw)
+        {
+            RI_CHECK(static_cast<DXCommandDraw const&>(command).topology == DXPrimitiveTopology::TriangleList);
+        }
+        ++index;
+        bytes += command.size;
+    });
+    RI_CHECK(index == 6 && bytes == list.SizeInBytes());
+
+    list.Reset();
+    RI_CHECK(list.CommandCount() == 0 && list.SizeInBytes() == 0);
+}
+
+RI_TEST(CommandListNullBackendCounts)
+{
+    DXCommandList list;
+    DXCommandDrawIndexed draw{};
+    draw.vertexCount = 36; // no index buffer, a non indexed draw
+    draw.instanceCount = 4;
+    draw.topology = DXPrimitiveTopology::TriangleList;
+    list.DrawIndexed(draw);
+    RI_CHECK(list.CommandCount() == 1);
+    list.ForEach([](DXCommand const& command) {
+        // the header of the recorded command survives the copy of the draw
+        RI_CHECK(command.type == DXCommandType::DrawIndexed && command.size >= sizeof(DXCommandDrawIndexed));
+    });
+
+    const float constants[16] = {};
+    list.UpdateBuffer(nullptr, constants, sizeof(constants));
+    // a window of a ring, its size must not end up in the header
+    list.BindConstants(nullptr, DXShaderStage::VS, 0, 256, 256);
+
+    DXNullBackend backend;
+    backend.Execute(list);
+    backend.Execute(list);
+    DXNullBackendStats const& stats = backend.Stats();
+    RI_CHECK(stats.commands[static_cast<size_t>(DXCommandType::DrawIndexed)] == 2);
+    RI_CHECK(stats.commands[static_cast<size_t>(DXCommandType::UpdateBuffer)] == 2);
+    RI_CHECK(stats.commands[static_cast<size_t>(DXCommandType::BindConstants)] == 2);
+    RI_CHECK(stats.uploadBytes == 2 * sizeof(constants));
+    RI_CHECK(stats.primitives == 2 * 12 * 4);
+    RI_CHECK(stats.bytes == 2 * list.SizeInBytes());
+
+    backend.ResetStats();
+    RI_CHECK(backend.Stats().bytes == 0 && backend.Stats().primitives == 0);
+}
+
+/* Records and replays a synthetic frame on the null backend, the part of Renderer::RunCommandListBenchmark that needs no
+ * device: one list for the camera and one per shadow view, recorded one after the other and in parallel */
+RI_BENCHMARK(CommandListNullFrameBenchmark)
+{
+    static constexpr uint32 views = 1 + 8;
+    static constexpr uint32 drawsPerView = 4000;
+    static constexpr uint32 iterations = 50;
+
+    std::vector<uint32> viewIds(views);
+    std::iota(viewIds.begin(), viewIds.end(), 0u);
+    std::vector<DXCommandList> lists(views);
+    DXUploadRing ring(views * drawsPerView * DXUploadRing::AlignedSize(sizeof(DrawConstants)), 1);
+    DXNullBackend backend;
+    RileyTimer benchTimer;
+
+    for (bool useRing : {false, true})
+    {
+        DXUploadRing* frameRing = useRing ? &ring : nullptr;
+
+        benchTimer.Mark();
+        for (uint32 it = 0; it < iterations; ++it)
+        {
+            ring.Rewind();
+            for (uint32 view : viewIds)
+                RecordView(lists[view], frameRing, view, drawsPerView);
+        }
+        const float serialMs = benchTimer.MarkInSeconds() * 1000.0f / iterations;
+
+        for (uint32 it = 0; it < iterations; ++it)
+        {
+            ring.Rewind();
+            std::for_each(std::execution::par, viewIds.begin(), viewIds.end(),
+                          [&](uint32 view) { RecordView(lists[view], frameRing, view, drawsPerView); });
+        }
+        const float parallelMs = benchTimer.MarkInSeconds() * 1000.0f / iterations;
+
+        backend.ResetStats();
+        benchTimer.Mark();
+        for (uint32 it = 0; it < iterations; ++it)
+        {
+            for (DXCommandList const& list : lists)
+                backend.Execute(list);
+        }
+        const float executeMs = benchTimer.MarkInSeconds() * 1000.0f / iterations;
+
+        DXNullBackendStats const& stats = backend.Stats();
+        RI_INFO("Null frame, {:s} : record serial {:.3f}ms, parallel {:.3f}ms ({:.2f}x), execute {:.3f}ms, {:d} KB of lists",
+                useRing ? "upload ring" : "inline constants", serialMs, parallelMs, serialMs / std::max(parallelMs, 1e-3f),
+                executeMs, stats.bytes / iterations / 1024);
+
+        // every view drew everything, and the constants went where the mode put them
+        const uint64 draws = uint64(views) * drawsPerView * iterations;
+        RI_CHECK(stats.commands[static_cast<size_t>(DXCommandType::DrawIndexed)] == draws);
+        RI_CHECK(stats.commands[static_cast<size_t>(useRing ? DXCommandType::BindConstants : DXCommandType::UpdateBuffer)] == draws);
+        RI_CHECK(!ring.Overflowed());
+    }
+}
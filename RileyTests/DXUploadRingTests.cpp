@@ -0,0 +1,108 @@
+#include "Test.h"
+#include "Graphics/DXUploadRing.h"
+#include <execution>
+#include <numeric>
+
+using namespace Riley;
+
+RI_TEST(UploadRingAlignment)
+{
+    DXUploadRing ring(1500, 3);
+    RI_CHECK(ring.FrameCapacity() == 1536);
+    RI_CHECK(ring.RingSize() == 3 * 1536);
+    ring.BeginFrame();
+    RI_CHECK(ring.FrameIndex() == 0);
+
+    // every window starts and ends on the binding granularity, one after the other
+    uint32 expectedOffset = 0;
+    for (uint32 size : {1u, 64u, 256u, 257u})
+    {
+        const DXUploadAllocation allocation = ring.Allocate(size);
+        RI_CHECK(allocation.IsValid());
+        RI_CHECK(allocation.offset % DXUploadRing::CONSTANT_ALIGNMENT == 0);
+        RI_CHECK(allocation.size == DXUploadRing::AlignedSize(size) && allocation.size >= size);
+        RI_CHECK(allocation.offset == expectedOffset);
+        expectedOffset += allocation.size;
+    }
+    RI_CHECK(ring.UsedBytes() == 1280);
+
+    const float constants[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+    ring.Rewind();
+    const DXUploadAllocation pushed = ring.Push(constants);
+    RI_CHECK(pushed.IsValid() && pushed.offset == 0 && pushed.size == 256);
+    RI_CHECK(memcmp(ring.FrameData().data(), constants, sizeof(constants)) == 0);
+    RI_CHECK(ring.FrameData().size() == 256);
+}
+
+RI_TEST(UploadRingFrameRetirement)
+{
+    static constexpr uint32 framesInFlight = 3;
+    DXUploadRing ring(512, framesInFlight);
+
+    // a region is only handed out again once the frames in flight after it are done
+    std::vector<uint32> regionOffsets;
+    for (uint32 frame = 0; frame < 2 * framesInFlight; ++frame)
+    {
+        ring.BeginFrame();
+        RI_CHECK(ring.UsedBytes() == 0 && !ring.Overflowed());
+        const DXUploadAllocation allocation = ring.Allocate(100);
+        RI_CHECK(allocation.IsValid() && allocation.offset == ring.RegionOffset());
+        regionOffsets.push_back(allocation.offset);
+    }
+    for (uint32 frame = 0; frame < regionOffsets.size(); ++frame)
+    {
+        RI_CHECK(regionOffsets[frame] == (frame % framesInFlight) * ring.FrameCapacity());
+        for (uint32 other = frame + 1; other < std::min<uint32>(frame + framesInFlight, regionOffsets.size()); ++other)
+            RI_CHECK(regionOffsets[frame] != regionOffsets[other]);
+    }
+}
+
+RI_TEST(UploadRingOverflowGrows)
+{
+    DXUploadRing ring(512, 2);
+    ring.BeginFrame();
+    ring.BeginFrame();
+    RI_CHECK(ring.FrameIndex() == 1);
+
+    RI_CHECK(ring.Allocate(256).IsValid());
+    RI_CHECK(ring.Allocate(256).IsValid());
+    RI_CHECK(!ring.Allocate(1).IsValid());
+    RI_CHECK(ring.Overflowed());
+    RI_CHECK(ring.UsedBytes() == 512);
+
+    // the next frame gets twice the space and the ring restarts, nothing in flight lives in the new layout
+    ring.BeginFrame();
+    RI_CHECK(ring.FrameCapacity() == 1024 && ring.FrameIndex() == 0 && ring.RegionOffset() == 0);
+    RI_CHECK(!ring.Overflowed() && ring.UsedBytes() == 0);
+    for (uint32 i = 0; i < 4; ++i)
+        RI_CHECK(ring.Allocate(256).IsValid());
+    RI_CHECK(!ring.Overflowed());
+
+    ring.BeginFrame();
+    RI_CHECK(ring.FrameIndex() == 1 && ring.RegionOffset() == 1024);
+}
+
+RI_TEST(UploadRingParallelAllocations)
+{
+    static constexpr uint32 count = 4096;
+    DXUploadRing ring(count * DXUploadRing::CONSTANT_ALIGNMENT, 2);
+    ring.BeginFrame();
+
+    // lists record in parallel: every allocation gets its own window and keeps its data
+    std::vector<uint32> values(count);
+    std::iota(values.begin(), values.end(), 0u);
+    std::vector<DXUploadAllocation> allocations(count);
+    std::for_each(std::execution::par, values.begin(), values.end(),
+                  [&](uint32 const& value) { allocations[value] = ring.Push(value); });
+
+    RI_CHECK(!ring.Overflowed() && ring.UsedBytes() == count * DXUploadRing::CONSTANT_ALIGNMENT);
+    std::vector<uint32> offsets;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        RI_CHECK(allocations[i].IsValid());
+        RI_CHECK(*reinterpret_cast<uint32 const*>(allocations[i].data) == i);
+        offsets.push_back(allocations[i].offset);
+    }
+    std::sort(offsets.begin(), offsets.end());
+    RI_CHECK(std::adjacent_find(offsets.begin(), offsets.end()) == offsets.end());
+}
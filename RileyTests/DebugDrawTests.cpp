@@ -0,0 +1,92 @@
+#include "Test.h"
+#include "Rendering/DebugDraw.h"
+
+using namespace Riley;
+
+namespace
+{
+bool Near(Vector3 const& a, Vector3 const& b, float epsilon = 1e-5f)
+{
+    return Vector3::DistanceSquared(a, b) <= epsilon * epsilon;
+}
+} // namespace
+
+RI_TEST(DebugDrawLine)
+{
+    DebugDraw debugDraw;
+    RI_CHECK(debugDraw.Empty());
+
+    const Vector4 color(1.0f, 0.0f, 0.0f, 1.0f);
+    debugDraw.AddLine(Vector3(1.0f, 2.0f, 3.0f), Vector3(4.0f, 5.0f, 6.0f), color);
+    RI_CHECK(debugDraw.VertexCount() == 2);
+    RI_CHECK(Near(debugDraw.Data()[0].position, Vector3(1.0f, 2.0f, 3.0f)));
+    RI_CHECK(Near(debugDraw.Data()[1].position, Vector3(4.0f, 5.0f, 6.0f)));
+    RI_CHECK(debugDraw.Data()[1].color == color);
+}
+
+RI_TEST(DebugDrawBox)
+{
+    DebugDraw debugDraw;
+    const DirectX::BoundingBox box(Vector3(1.0f, 2.0f, 3.0f), Vector3(0.5f, 1.0f, 2.0f));
+    debugDraw.AddBox(box, Vector4(1.0f));
+
+    // 12 edges, each between two corners that differ along one axis only
+    RI_CHECK(debugDraw.VertexCount() == 24);
+    for (uint32 i = 0; i < debugDraw.VertexCount(); i += 2)
+    {
+        const Vector3 from = debugDraw.Data()[i].position, to = debugDraw.Data()[i + 1].position;
+        const Vector3 offset = from - Vector3(box.Center);
+        RI_CHECK(std::abs(std::abs(offset.x) - 0.5f) < 1e-5f && std::abs(std::abs(offset.y) - 1.0f) < 1e-5f &&
+                 std::abs(std::abs(offset.z) - 2.0f) < 1e-5f);
+
+        const Vector3 edge = to - from;
+        const uint32 axes = (std::abs(edge.x) > 1e-5f) + (std::abs(edge.y) > 1e-5f) + (std::abs(edge.z) > 1e-5f);
+        RI_CHECK(axes == 1);
+    }
+}
+
+RI_TEST(DebugDrawFrustum)
+{
+    DebugDraw debugDraw;
+    const DirectX::BoundingFrustum frustum(
+        DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(90.0f), 1.0f, 1.0f, 10.0f));
+    debugDraw.AddFrustum(frustum, Vector4(1.0f));
+
+    // the near quad lies on z = 1, the far quad on z = 10 and the side edges join them
+    RI_CHECK(debugDraw.VertexCount() == 24);
+    uint32 nearEnds = 0, farEnds = 0;
+    for (uint32 i = 0; i < debugDraw.VertexCount(); ++i)
+    {
+        const float z = debugDraw.Data()[i].position.z;
+        nearEnds += std::abs(z - 1.0f) < 1e-4f;
+        farEnds += std::abs(z - 10.0f) < 1e-3f;
+    }
+    RI_CHECK(nearEnds == 12 && farEnds == 12);
+}
+
+RI_TEST(DebugDrawSphere)
+{
+    DebugDraw debugDraw;
+    const Vector3 center(1.0f, -2.0f, 0.5f);
+    const uint32 segments = 16;
+    debugDraw.AddSphere(center, 3.0f, Vector4(1.0f), segments);
+
+    // three closed circles, every vertex on the sphere
+    RI_CHECK(debugDraw.VertexCount() == segments * 3 * 2);
+    for (uint32 i = 0; i < debugDraw.VertexCount(); ++i)
+        RI_CHECK(std::abs(Vector3::Distance(debugDraw.Data()[i].position, center) - 3.0f) < 1e-4f);
+}
+
+RI_TEST(DebugDrawClearKeepsArena)
+{
+    DebugDraw debugDraw;
+    for (uint32 i = 0; i < 100; ++i)
+        debugDraw.AddBox(DirectX::BoundingBox(Vector3(float(i)), Vector3(1.0f)), Vector4(1.0f));
+    DebugVertex const* data = debugDraw.Data();
+
+    // the frame after reuses the same storage
+    debugDraw.Clear();
+    RI_CHECK(debugDraw.Empty());
+    debugDraw.AddBox(DirectX::BoundingBox(Vector3(0.0f), Vector3(1.0f)), Vector4(1.0f));
+    RI_CHECK(debugDraw.Data() == data);
+}
@@ -0,0 +1,254 @@
+#include "Test.h"
+#include "TestModels.h"
+#include "Math/DynamicAABBTree.h"
+#include "Utilities/Timer.h"
+#include <random>
+
+using namespace Riley;
+
+namespace
+{
+/* A scene shaped like the bundled ones: a few large pieces of architecture and many small props, packed into a hall
+ * about 30 x 12 x 15 units */
+std::vector<BoundingBox> SceneBoxes(uint32 count, uint32 seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> x(-15.0f, 15.0f), y(0.0f, 12.0f), z(-7.5f, 7.5f);
+    std::uniform_real_distribution<float> small(0.05f, 0.5f), large(1.0f, 6.0f), pick(0.0f, 1.0f);
+
+    std::vector<BoundingBox> boxes;
+    boxes.reserve(count);
+    for (uint32 i = 0; i < count; ++i)
+    {
+        auto& size = pick(rng) < 0.1f ? large : small;
+        boxes.emplace_back(Vector3(x(rng), y(rng), z(rng)), Vector3(size(rng), size(rng), size(rng)));
+    }
+    return boxes;
+}
+
+// the fat box the tree may keep for a box: the margin of CreateProxy plus the small moves the test makes
+BoundingBox Fattened(BoundingBox const& box)
+{
+    return BoundingBox(box.Center, Vector3(box.Extents) * 1.1f + Vector3(0.02f));
+}
+
+// world AABB of every submesh a node of the model draws, the boxes the editor's scene tree holds for it
+std::vector<BoundingBox> SubmeshBoxes(SceneData const& scene)
+{
+    std::vector<BoundingBox> meshBoxes(scene.meshes.size());
+    for (size_t m = 0; m < scene.meshes.size(); ++m)
+    {
+        std::vector<Vertex> const& vertices = scene.meshes[m].meshData.vertices;
+        if (!vertices.empty())
+            BoundingBox::CreateFromPoints(meshBoxes[m], vertices.size(), &vertices[0].position, sizeof(Vertex));
+    }
+
+    std::vector<Matrix> worlds(scene.nodes.size());
+    std::vector<BoundingBox> boxes;
+    for (uint32 n = 0; n < scene.nodes.size(); ++n)
+    {
+        NodeData const& node = scene.nodes[n];
+        worlds[n] = node.parent == NodeData::NO_PARENT ? node.transform : node.transform * worlds[node.parent];
+        for (uint32 mesh : node.meshes)
+        {
+            BoundingBox& box = boxes.emplace_back();
+            meshBoxes[mesh].Transform(box, worlds[n]);
+        }
+    }
+    return boxes;
+}
+
+std::vector<uint32> Sorted(std::vector<uint32> ids)
+{
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+// the tree answers on fat boxes: it has to return every exact hit and nothing farther than the fat margin
+void CheckBoxQuery(DynamicAABBTree const& tree, std::vector<BoundingBox> const& boxes, std::vector<bool> const& alive,
+                   BoundingBox const& query)
+{
+    std::vector<uint32> hits;
+    tree.QueryBox(query, hits);
+    hits = Sorted(hits);
+    RI_CHECK(std::adjacent_find(hits.begin(), hits.end()) == hits.end());
+
+    for (uint32 i = 0; i < boxes.size(); ++i)
+    {
+        const bool reported = std::binary_search(hits.begin(), hits.end(), i);
+        if (alive[i] && query.Intersects(boxes[i]))
+            RI_CHECK(reported);
+        if (reported)
+            RI_CHECK(alive[i] && query.Intersects(Fattened(boxes[i])));
+    }
+}
+} // namespace
+
+RI_TEST(SceneTreeBoxQueries)
+{
+    std::vector<BoundingBox> boxes = SceneBoxes(2000, 11);
+    std::vector<bool> alive(boxes.size(), true);
+    std::vector<int32> proxies(boxes.size());
+
+    DynamicAABBTree tree;
+    for (uint32 i = 0; i < boxes.size(); ++i)
+        proxies[i] = tree.CreateProxy(boxes[i], i);
+    RI_CHECK(tree.GetProxyCount() == boxes.size());
+
+    const BoundingBox queries[] = {BoundingBox(Vector3(0.0f, 6.0f, 0.0f), Vector3(4.0f)),
+                                   BoundingBox(Vector3(-12.0f, 1.0f, 5.0f), Vector3(1.0f, 0.5f, 2.0f)),
+                                   BoundingBox(Vector3(100.0f), Vector3(1.0f))};
+    for (BoundingBox const& query : queries)
+        CheckBoxQuery(tree, boxes, alive, query);
+
+    // moves inside the fat box leave the tree alone, the others reinsert the leaf
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> jitter(-0.005f, 0.005f), jump(-10.0f, 10.0f);
+    for (uint32 i = 0; i < boxes.size(); i += 3)
+    {
+        const bool far = i % 2 == 0;
+        const Vector3 offset = far ? Vector3(jump(rng), jump(rng), jump(rng)) : Vector3(jitter(rng), jitter(rng), jitter(rng));
+        boxes[i].Center = Vector3(boxes[i].Center) + offset;
+        const bool reinserted = tree.MoveProxy(proxies[i], boxes[i]);
+        if (!far)
+            RI_CHECK(!reinserted);
+    }
+    for (uint32 i = 1; i < boxes.size(); i += 5)
+    {
+        tree.DestroyProxy(proxies[i]);
+        alive[i] = false;
+    }
+    for (BoundingBox const& query : queries)
+        CheckBoxQuery(tree, boxes, alive, query);
+
+    // the SAH build answers the same
+    tree.Rebuild();
+    for (BoundingBox const& query : queries)
+        CheckBoxQuery(tree, boxes, alive, query);
+}
+
+RI_TEST(SceneTreeFrustumAndRayQueries)
+{
+    const std::vector<BoundingBox> boxes = SceneBoxes(3000, 5);
+    DynamicAABBTree tree;
+    for (uint32 i = 0; i < boxes.size(); ++i)
+        tree.CreateProxy(boxes[i], i);
+    tree.Rebuild();
+
+    DirectX::BoundingFrustum frustum(
+        DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(60.0f), 16.0f / 9.0f, 0.1f, 20.0f));
+    frustum.Origin = DirectX::XMFLOAT3(0.0f, 2.0f, -10.0f);
+
+    std::vector<uint32> hits;
+    tree.QueryFrustum(CullPlanes::FromFrustum(frustum), hits);
+    hits = Sorted(hits);
+    for (uint32 i = 0; i < boxes.size(); ++i)
+    {
+        if (frustum.Intersects(boxes[i]))
+            RI_CHECK(std::binary_search(hits.begin(), hits.end(), i));
+    }
+
+    const Ray ray(Vector3(-20.0f, 3.0f, 0.5f), Vector3(1.0f, 0.0f, 0.0f));
+    hits.clear();
+    tree.QueryRay(ray, 100.0f, hits);
+    hits = Sorted(hits);
+    for (uint32 i = 0; i < boxes.size(); ++i)
+    {
+        float distance = 0.0f;
+        if (ray.Intersects(boxes[i], distance) && distance <= 100.0f)
+            RI_CHECK(std::binary_search(hits.begin(), hits.end(), i));
+    }
+}
+
+RI_BENCHMARK(SceneTreeBenchmark)
+{
+    static constexpr uint32 replicaCounts[] = {1, 10, 100};
+    static constexpr uint32 iterations = 20;
+
+    // Sponza replicated N times, its buffers are not in every checkout
+    const std::optional<SceneData> sponza = Tests::LoadTestModel(Tests::TEST_MODELS[1]);
+    if (!sponza)
+        return;
+
+    const std::vector<BoundingBox> sceneBoxes = SubmeshBoxes(*sponza);
+    RI_CHECK(!sceneBoxes.empty());
+    if (sceneBoxes.empty())
+        return;
+
+    BoundingBox sceneBox = sceneBoxes[0];
+    for (BoundingBox const& box : sceneBoxes)
+        BoundingBox::CreateMerged(sceneBox, sceneBox, box);
+
+    DirectX::BoundingFrustum frustum(
+        DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f));
+    frustum.Origin = DirectX::XMFLOAT3(0.0f, 2.0f, -10.0f);
+    const CullPlanes planes = CullPlanes::FromFrustum(frustum);
+    const BoundingBox queryBox(sceneBox.Center, Vector3(sceneBox.Extents) * 0.25f);
+    const Vector3 spacing = Vector3(sceneBox.Extents) * 2.0f;
+
+    for (uint32 replicas : replicaCounts)
+    {
+        // lay the copies out on a square grid around the original
+        const uint32 side = static_cast<uint32>(std::ceil(std::sqrt(static_cast<float>(replicas))));
+        std::vector<BoundingBox> boxes;
+        boxes.reserve(sceneBoxes.size() * replicas);
+        for (uint32 r = 0; r < replicas; ++r)
+        {
+            const Vector3 offset(spacing.x * (r % side), 0.0f, spacing.z * (r / side));
+            for (BoundingBox const& box : sceneBoxes)
+                boxes.emplace_back(Vector3(box.Center) + offset, box.Extents);
+        }
+
+        RileyTimer benchTimer;
+        benchTimer.Mark();
+        DynamicAABBTree tree;
+        for (uint32 i = 0; i < boxes.size(); ++i)
+            tree.CreateProxy(boxes[i], i);
+        const float insertMs = benchTimer.MarkInSeconds() * 1000.0f;
+        const int32 insertHeight = tree.GetHeight();
+        tree.Rebuild();
+        const float rebuildMs = benchTimer.MarkInSeconds() * 1000.0f;
+
+        std::vector<uint32> hits;
+        uint32 linearFrustumHits = 0, linearBoxHits = 0;
+        benchTimer.Mark();
+        for (uint32 it = 0; it < iterations; ++it)
+        {
+            linearFrustumHits = 0;
+            for (BoundingBox const& box : boxes)
+                linearFrustumHits += frustum.Intersects(box) ? 1 : 0;
+        }
+        const float linearFrustumUs = static_cast<float>(benchTimer.Mark()) / iterations;
+
+        for (uint32 it = 0; it < iterations; ++it)
+        {
+            hits.clear();
+            tree.QueryFrustum(planes, hits);
+        }
+        const float treeFrustumUs = static_cast<float>(benchTimer.Mark()) / iterations;
+        const size_t treeFrustumHits = hits.size();
+
+        for (uint32 it = 0; it < iterations; ++it)
+        {
+            linearBoxHits = 0;
+            for (BoundingBox const& box : boxes)
+                linearBoxHits += queryBox.Intersects(box) ? 1 : 0;
+        }
+        const float linearBoxUs = static_cast<float>(benchTimer.Mark()) / iterations;
+
+        for (uint32 it = 0; it < iterations; ++it)
+        {
+            hits.clear();
+            tree.QueryBox(queryBox, hits);
+        }
+        const float treeBoxUs = static_cast<float>(benchTimer.Mark()) / iterations;
+
+        RI_INFO("Scene x{:d} ({:d} boxes) : insert {:.2f}ms (height {:d}), SAH rebuild {:.2f}ms (height {:d})", replicas,
+                boxes.size(), insertMs, insertHeight, rebuildMs, tree.GetHeight());
+        RI_INFO("    frustum : linear {:.2f}us ({:d} hits), tree {:.2f}us ({:d} hits, fat boxes)", linearFrustumUs, linearFrustumHits,
+                treeFrustumUs, treeFrustumHits);
+        RI_INFO("    box     : linear {:.2f}us ({:d} hits), tree {:.2f}us ({:d} hits, fat boxes)", linearBoxUs, linearBoxHits,
+                treeBoxUs, hits.size());
+        RI_CHECK(treeFrustumHits >= linearFrustumHits && hits.size() >= linearBoxHits);
+    }
+}
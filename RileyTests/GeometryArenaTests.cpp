@@ -0,0 +1,132 @@
+#include "Test.h"
+#include "Rendering/GeometryArena.h"
+#include <random>
+
+using namespace Riley;
+
+namespace
+{
+using Ranges = std::vector<std::pair<uint32, uint32>>; // offset, count
+
+// live ranges stay inside the allocator, never overlap, and account for all of its used space
+void CheckRanges(RangeAllocator const& allocator, Ranges ranges)
+{
+    std::sort(ranges.begin(), ranges.end());
+    uint32 used = 0;
+    for (size_t i = 0; i < ranges.size(); ++i)
+    {
+        RI_CHECK(ranges[i].first + ranges[i].second <= allocator.Capacity());
+        if (i + 1 < ranges.size())
+            RI_CHECK(ranges[i].first + ranges[i].second <= ranges[i + 1].first);
+        used += ranges[i].second;
+    }
+    RI_CHECK(allocator.Used() == used);
+}
+
+// applies a step to the ranges and checks every move went down by whole ranges within the budget
+void ApplyMoves(Ranges& ranges, std::vector<RangeMove> const& moves, uint64 budget)
+{
+    uint64 moved = 0;
+    for (RangeMove const& move : moves)
+    {
+        RI_CHECK(move.range < ranges.size() && ranges[move.range].first == move.from);
+        RI_CHECK(move.to < move.from);
+        ranges[move.range].first = move.to;
+        moved += ranges[move.range].second;
+    }
+    RI_CHECK(moves.size() <= 1 || moved <= budget);
+}
+} // namespace
+
+RI_TEST(RangeAllocatorBestFit)
+{
+    RangeAllocator allocator(100);
+    RI_CHECK(allocator.Allocate(10) == 0 && allocator.Allocate(20) == 10 && allocator.Allocate(30) == 30);
+    allocator.Free(10, 20);
+    RI_CHECK(allocator.FreeBlockCount() == 2 && allocator.LargestFreeBlock() == 40);
+
+    // the 20 element hole fits better than the 40 at the end
+    RI_CHECK(allocator.Allocate(15) == 10);
+    RI_CHECK(allocator.Allocate(41) == RangeAllocator::INVALID_OFFSET);
+    RI_CHECK(allocator.FindLowest(5, 60) == 25 && allocator.FindLowest(6, 60) == RangeAllocator::INVALID_OFFSET);
+
+    // freeing merges with both neighbours
+    allocator.Free(0, 10);
+    allocator.Free(30, 30);
+    allocator.Free(10, 15);
+    RI_CHECK(allocator.Used() == 0 && allocator.FreeBlockCount() == 1 && allocator.IsCompact());
+
+    allocator.Grow(150);
+    RI_CHECK(allocator.Capacity() == 150 && allocator.FreeBlockCount() == 1 && allocator.LargestFreeBlock() == 150);
+    allocator.Claim(40, 10);
+    RI_CHECK(allocator.FreeBlockCount() == 2 && allocator.Used() == 10 && !allocator.IsCompact());
+}
+
+RI_TEST(GeometryCompactionPacks)
+{
+    // every hole fits the ranges above it: one step with enough budget packs the allocator
+    RangeAllocator allocator(64);
+    Ranges ranges;
+    for (uint32 i = 0; i < 8; ++i)
+        ranges.emplace_back(allocator.Allocate(8), 8);
+    for (uint32 freed : {1u, 3u, 4u})
+        allocator.Free(ranges[freed].first, ranges[freed].second);
+    ranges = {ranges[0], ranges[2], ranges[5], ranges[6], ranges[7]};
+
+    const std::vector<RangeMove> moves = PlanCompaction(allocator, ranges, 64);
+    ApplyMoves(ranges, moves, 64);
+    CheckRanges(allocator, ranges);
+    RI_CHECK(moves.size() == 3);
+    RI_CHECK(allocator.IsCompact() && allocator.LargestFreeBlock() == 24);
+    RI_CHECK(PlanCompaction(allocator, ranges, 64).empty());
+
+    // a small budget spreads the same work over steps, a range larger than the budget still moves alone
+    RangeAllocator large(100);
+    Ranges largeRanges = {{large.Allocate(40), 40}, {large.Allocate(40), 40}};
+    large.Free(0, 40);
+    largeRanges.erase(largeRanges.begin());
+    const std::vector<RangeMove> alone = PlanCompaction(large, largeRanges, 8);
+    RI_CHECK(alone.size() == 1 && alone[0].from == 40 && alone[0].to == 0);
+}
+
+RI_TEST(GeometryCompactionBookkeeping)
+{
+    static constexpr uint32 capacity = 1 << 14;
+    static constexpr uint64 budget = 512;
+    std::mt19937 rng(21);
+    std::uniform_int_distribution<uint32> size(1, 300);
+
+    for (uint32 round = 0; round < 20; ++round)
+    {
+        RangeAllocator allocator(capacity);
+        Ranges ranges;
+        while (true)
+        {
+            const uint32 count = size(rng);
+            const uint32 offset = allocator.Allocate(count);
+            if (offset == RangeAllocator::INVALID_OFFSET)
+                break;
+            ranges.emplace_back(offset, count);
+        }
+        // free about half, in no particular order
+        std::shuffle(ranges.begin(), ranges.end(), rng);
+        const size_t kept = ranges.size() / 2;
+        for (size_t i = kept; i < ranges.size(); ++i)
+            allocator.Free(ranges[i].first, ranges[i].second);
+        ranges.resize(kept);
+        CheckRanges(allocator, ranges);
+
+        // step until nothing moves, each step keeps the bookkeeping consistent
+        uint32 steps = 0;
+        for (std::vector<RangeMove> moves; !(moves = PlanCompaction(allocator, ranges, budget)).empty(); ++steps)
+        {
+            ApplyMoves(ranges, moves, budget);
+            CheckRanges(allocator, ranges);
+            RI_CHECK(steps < 10000);
+        }
+        RI_CHECK(steps > 0);
+        // no free block below a range is left that could take it
+        for (auto const& [offset, count] : ranges)
+            RI_CHECK(allocator.FindLowest(count, offset) == RangeAllocator::INVALID_OFFSET);
+    }
+}
@@ -0,0 +1,140 @@
+#include "Test.h"
+#include "TestModels.h"
+#include "Rendering/MeshOptimizer.h"
+#include <cfloat>
+
+using namespace Riley;
+using namespace Riley::Tests;
+
+namespace
+{
+struct OverdrawStats
+{
+    uint64 shaded = 0;  // pixels passing the depth test, pixel shader invocations
+    uint64 covered = 0; // pixels covered at the end
+
+    // 1 means no pixel was shaded twice
+    float Ratio() const
+    {
+        return covered ? float(shaded) / covered : 0.0f;
+    }
+    OverdrawStats& operator+=(OverdrawStats const& other)
+    {
+        shaded += other.shaded;
+        covered += other.covered;
+        return *this;
+    }
+};
+
+/* Draws the triangles in index order from the six axis directions, orthographic and without culling, into a small
+ * depth buffer with a less test. Only the order of the triangles changes what gets shaded more than once. */
+OverdrawStats AnalyzeOverdraw(std::vector<Vertex> const& vertices, std::vector<uint32> const& indices)
+{
+    static constexpr uint32 size = 256;
+    Vector3 minCorner(FLT_MAX), maxCorner(-FLT_MAX);
+    for (Vertex const& vertex : vertices)
+    {
+        minCorner = Vector3::Min(minCorner, vertex.position);
+        maxCorner = Vector3::Max(maxCorner, vertex.position);
+    }
+    const Vector3 extent = maxCorner - minCorner;
+
+    OverdrawStats stats;
+    std::vector<float> depth(size * size);
+    for (uint32 axis = 0; axis < 3; ++axis)
+    {
+        const uint32 u = (axis + 1) % 3;
+        const uint32 v = (axis + 2) % 3;
+        const float scale = (size - 1) / std::max({(&extent.x)[u], (&extent.x)[v], 1e-6f});
+        for (float direction : {1.0f, -1.0f})
+        {
+            std::fill(depth.begin(), depth.end(), FLT_MAX);
+            auto Project = [&](uint32 index) {
+                Vector3 const& position = vertices[index].position;
+                return Vector3(((&position.x)[u] - (&minCorner.x)[u]) * scale, ((&position.x)[v] - (&minCorner.x)[v]) * scale,
+                               (&position.x)[axis] * direction);
+            };
+            for (size_t t = 0; t + 2 < indices.size(); t += 3)
+            {
+                const Vector3 p0 = Project(indices[t]), p1 = Project(indices[t + 1]), p2 = Project(indices[t + 2]);
+                const float area = (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x);
+                if (area == 0.0f)
+                    continue;
+
+                const uint32 minX = static_cast<uint32>(std::max(0.0f, std::floor(std::min({p0.x, p1.x, p2.x}))));
+                const uint32 minY = static_cast<uint32>(std::max(0.0f, std::floor(std::min({p0.y, p1.y, p2.y}))));
+                const uint32 maxX = std::min(size - 1, static_cast<uint32>(std::max({p0.x, p1.x, p2.x})));
+                const uint32 maxY = std::min(size - 1, static_cast<uint32>(std::max({p0.y, p1.y, p2.y})));
+                for (uint32 y = minY; y <= maxY; ++y)
+                {
+                    for (uint32 x = minX; x <= maxX; ++x)
+                    {
+                        const float px = x + 0.5f, py = y + 0.5f;
+                        const float w0 = ((p2.x - p1.x) * (py - p1.y) - (p2.y - p1.y) * (px - p1.x)) / area;
+                        const float w1 = ((p0.x - p2.x) * (py - p2.y) - (p0.y - p2.y) * (px - p2.x)) / area;
+                        const float w2 = 1.0f - w0 - w1;
+                        if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                            continue;
+                        const float z = w0 * p0.z + w1 * p1.z + w2 * p2.z;
+                        if (z < depth[y * size + x])
+                        {
+                            depth[y * size + x] = z;
+                            ++stats.shaded;
+                        }
+                    }
+                }
+            }
+            stats.covered += std::count_if(depth.begin(), depth.end(), [](float z) { return z != FLT_MAX; });
+        }
+    }
+    return stats;
+}
+} // namespace
+
+// The passes of MeshOptimizer::Optimize one by one on the bundled models, as the importer runs them
+RI_TEST(MeshOptimizerBundledModels)
+{
+    uint32 loaded = 0;
+    for (TestModel const& testModel : TEST_MODELS)
+    {
+        std::optional<SceneData> scene = LoadTestModel(testModel);
+        if (!scene)
+            continue;
+        ++loaded;
+
+        VertexCacheStats imported, cacheOptimized, optimized;
+        OverdrawStats overdrawCacheOptimized, overdrawOptimized;
+        for (Model& model : scene->meshes)
+        {
+            std::vector<Vertex>& vertices = model.meshData.vertices;
+            std::vector<uint32>& indices = model.meshData.indices;
+            const VertexCacheStats before = MeshOptimizer::AnalyzeVertexCache(indices, static_cast<uint32>(vertices.size()));
+            imported += before;
+
+            MeshOptimizer::WeldVertices(vertices, indices);
+            MeshOptimizer::OptimizeVertexCache(indices, static_cast<uint32>(vertices.size()));
+            const VertexCacheStats cached = MeshOptimizer::AnalyzeVertexCache(indices, static_cast<uint32>(vertices.size()));
+            cacheOptimized += cached;
+            overdrawCacheOptimized += AnalyzeOverdraw(vertices, indices);
+
+            MeshOptimizer::OptimizeOverdraw(indices, vertices);
+            overdrawOptimized += AnalyzeOverdraw(vertices, indices);
+            MeshOptimizer::OptimizeVertexFetch(vertices, indices);
+            const VertexCacheStats after = MeshOptimizer::AnalyzeVertexCache(indices, static_cast<uint32>(vertices.size()));
+            optimized += after;
+
+            RI_CHECK(after.triangles == before.triangles);
+            // the overdraw pass gives back at most its threshold of the cache optimized ACMR
+            RI_CHECK(after.ACMR() <= cached.ACMR() * MeshOptimizer::OVERDRAW_THRESHOLD + 1e-4f);
+        }
+
+        RI_INFO("{:s} : {:d} triangles, ACMR {:.3f} imported, {:.3f} cache optimized, {:.3f} with overdraw", testModel.filename,
+                imported.triangles, imported.ACMR(), cacheOptimized.ACMR(), optimized.ACMR());
+        RI_INFO("    overdraw {:.3f} cache optimized, {:.3f} with overdraw", overdrawCacheOptimized.Ratio(),
+                overdrawOptimized.Ratio());
+        RI_CHECK(optimized.ACMR() < imported.ACMR());
+        RI_CHECK(overdrawOptimized.Ratio() <= overdrawCacheOptimized.Ratio());
+    }
+    // DamagedHelmet is always there, a run without any model would pass on nothing
+    RI_CHECK(loaded > 0);
+}
@@ -0,0 +1,72 @@
+#include "Test.h"
+#include "TestModels.h"
+#include "Rendering/MeshOptimizer.h"
+#include "Rendering/MeshSimplifier.h"
+
+using namespace Riley;
+using namespace Riley::Tests;
+
+// The LOD chains the importer builds for the bundled models, with the error measured
+RI_TEST(MeshSimplifierBundledModels)
+{
+    LODChainSettings settings;
+    settings.measureError = true;
+    uint32 loaded = 0;
+    for (TestModel const& testModel : TEST_MODELS)
+    {
+        std::optional<SceneData> scene = LoadTestModel(testModel);
+        if (!scene)
+            continue;
+        ++loaded;
+
+        std::array<size_t, MAX_MESH_LODS + 1> lodTriangles{};
+        std::array<float, MAX_MESH_LODS + 1> lodErrors{};
+        std::array<float, MAX_MESH_LODS + 1> lodHausdorff{};
+        for (Model& model : scene->meshes)
+        {
+            std::vector<Vertex>& vertices = model.meshData.vertices;
+            std::vector<uint32>& indices = model.meshData.indices;
+            MeshOptimizer::Optimize(vertices, indices);
+            const std::vector<MeshLODLevel> levels = MeshSimplifier::BuildLODChain(vertices, indices, settings);
+
+            RI_CHECK(levels.size() <= settings.lodCount);
+            std::vector<uint32> const* previous = &indices;
+            float previousError = 0.0f;
+            lodTriangles[0] += indices.size() / 3;
+            for (uint32 level = 0; level < MAX_MESH_LODS; ++level)
+            {
+                if (level >= levels.size())
+                {
+                    // drawn at the coarsest level there is
+                    lodTriangles[level + 1] += previous->size() / 3;
+                    continue;
+                }
+                MeshLODLevel const& lod = levels[level];
+                RI_CHECK(!lod.indices.empty() && lod.indices.size() % 3 == 0);
+                RI_CHECK(lod.indices.size() <= previous->size() * settings.minReduction);
+                RI_CHECK(std::all_of(lod.indices.begin(), lod.indices.end(), [&](uint32 index) { return index < vertices.size(); }));
+                // the quadric error adds up along the chain and stays in the budget
+                RI_CHECK(lod.error >= previousError && lod.error <= settings.errorBudget + 1e-5f);
+                RI_CHECK(lod.hausdorff >= 0.0f && std::isfinite(lod.hausdorff));
+
+                lodTriangles[level + 1] += lod.indices.size() / 3;
+                lodErrors[level + 1] = std::max(lodErrors[level + 1], lod.error);
+                lodHausdorff[level + 1] = std::max(lodHausdorff[level + 1], lod.hausdorff);
+                previous = &lod.indices;
+                previousError = lod.error;
+            }
+        }
+
+        for (uint32 level = 1; level <= MAX_MESH_LODS; ++level)
+        {
+            RI_INFO("{:s} LOD{:d} : {:d} triangles ({:.1f}%), error {:.4f}, hausdorff {:.4f}", testModel.filename, level,
+                    lodTriangles[level], 100.0 * lodTriangles[level] / std::max<size_t>(lodTriangles[0], 1), lodErrors[level],
+                    lodHausdorff[level]);
+        }
+        // every model has something to simplify, and a level that moved the surface measures a distance
+        RI_CHECK(lodTriangles[1] < lodTriangles[0]);
+        RI_CHECK(lodErrors[1] == 0.0f || lodHausdorff[1] > 0.0f);
+    }
+    // DamagedHelmet is always there, a run without any model would pass on nothing
+    RI_CHECK(loaded > 0);
+}
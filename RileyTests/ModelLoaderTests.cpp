@@ -0,0 +1,68 @@
+#include "Test.h"
+#include "TestModels.h"
+#include "Rendering/ModelLoader.h"
+#include "Utilities/Timer.h"
+#include <cfloat>
+
+using namespace Riley;
+using namespace Riley::Tests;
+
+namespace
+{
+size_t CountIndices(std::vector<Model> const& meshes)
+{
+    size_t indices = 0;
+    for (Model const& model : meshes)
+        indices += model.meshData.indices.size();
+    return indices;
+}
+} // namespace
+
+// GLTFLoader against assimp on the bundled models, best of a few reads so both see a warm page cache
+RI_BENCHMARK(ModelLoaderBenchmark)
+{
+    static constexpr uint32 runs = 5;
+    uint32 loaded = 0;
+    for (TestModel const& testModel : TEST_MODELS)
+    {
+        RileyTimer benchTimer;
+        float nativeMs = FLT_MAX;
+        std::optional<SceneData> native;
+        for (uint32 run = 0; run < runs; ++run)
+        {
+            benchTimer.Mark();
+            native = GLTFLoader::Load(testModel.basePath, testModel.filename, false);
+            nativeMs = std::min(nativeMs, benchTimer.MarkInSeconds() * 1000.0f);
+            if (!native)
+                break;
+        }
+        // without its buffers assimp cannot read the model either
+        if (!native)
+        {
+            Skip(std::string(testModel.basePath) + testModel.filename + " is missing or incomplete");
+            continue;
+        }
+        ++loaded;
+
+        float assimpMs = FLT_MAX;
+        size_t assimpMeshes = 0, assimpIndices = 0;
+        for (uint32 run = 0; run < runs; ++run)
+        {
+            ModelLoader modelLoader;
+            benchTimer.Mark();
+            modelLoader.Load(testModel.basePath, testModel.filename);
+            assimpMs = std::min(assimpMs, benchTimer.MarkInSeconds() * 1000.0f);
+            assimpMeshes = modelLoader.model.size();
+            assimpIndices = CountIndices(modelLoader.model);
+        }
+
+        const size_t nativeIndices = CountIndices(native->meshes);
+        RI_INFO("{:s} : GLTFLoader {:.2f}ms, assimp {:.2f}ms ({:.1f}x), {:d} meshes, {:d} triangles", testModel.filename, nativeMs,
+                assimpMs, assimpMs / std::max(nativeMs, 1e-3f), native->meshes.size(), nativeIndices / 3);
+        // both read every primitive into a mesh of its own
+        RI_CHECK(assimpMeshes == native->meshes.size());
+        RI_CHECK(assimpIndices == nativeIndices);
+    }
+    // DamagedHelmet is always there, a run without any model would time nothing
+    RI_CHECK(loaded > 0);
+}
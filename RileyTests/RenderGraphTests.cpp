@@ -0,0 +1,198 @@
+#include "Test.h"
+#include "Rendering/RenderGraph.h"
+
+using namespace Riley;
+
+namespace
+{
+const RGTextureDesc colorDesc{1920, 1080, 1, DXFormat::R8G8B8A8_UNORM, DXBindFlag::RenderTarget | DXBindFlag::ShaderResource};
+const RGTextureDesc depthDesc{1920, 1080, 1, DXFormat::R24G8_TYPELESS, DXBindFlag::DepthStencil | DXBindFlag::ShaderResource};
+const RGTextureDesc hdrDesc{1920, 1080, 1, DXFormat::R16G16B16A16_FLOAT, DXBindFlag::RenderTarget | DXBindFlag::ShaderResource};
+
+bool Overlap(RGResource const& a, RGResource const& b)
+{
+    return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+}
+
+// every physical texture matches the desc of its transients, and transients sharing one never live at the same time
+void CheckAliasing(RenderGraph const& graph)
+{
+    std::span<RGResource const> resources = graph.Resources();
+    for (uint32 a = 0; a < resources.size(); ++a)
+    {
+        if (resources[a].physical == RG_INVALID_INDEX)
+            continue;
+        RI_CHECK(!resources[a].imported);
+        RI_CHECK(graph.PhysicalTextures()[resources[a].physical] == resources[a].desc);
+        for (uint32 b = a + 1; b < resources.size(); ++b)
+        {
+            if (resources[a].physical == resources[b].physical)
+                RI_CHECK(!Overlap(resources[a], resources[b]));
+        }
+    }
+}
+
+RGTransition const* FindTransition(RGPass const& pass, RGResourceId resource)
+{
+    for (RGTransition const& transition : pass.transitions)
+    {
+        if (transition.resource == resource)
+            return &transition;
+    }
+    return nullptr;
+}
+} // namespace
+
+RI_TEST(RenderGraphCulling)
+{
+    RenderGraph graph;
+    const RGResourceId backBuffer = graph.ImportTexture("Back Buffer", colorDesc);
+    const RGResourceId scene = graph.CreateTexture("Scene", colorDesc);
+    const RGResourceId unused = graph.CreateTexture("Unused", colorDesc);
+    const RGResourceId unusedInput = graph.CreateTexture("Unused Input", colorDesc);
+
+    graph.AddPass("Scene").Write(scene);
+    graph.AddPass("Unused Input").Write(unusedInput);
+    graph.AddPass("Unused").Read(unusedInput).Write(unused); // nobody reads it, and then nobody reads its input
+    graph.AddPass("Readback", true).Read(unusedInput);
+    graph.AddPass("Present").Read(scene).Write(backBuffer);
+    graph.Compile();
+
+    std::span<RGPass const> passes = graph.Passes();
+    RI_CHECK(!passes[0].culled);
+    RI_CHECK(!passes[1].culled); // the side effect pass keeps its input alive
+    RI_CHECK(passes[2].culled);
+    RI_CHECK(!passes[3].culled);
+    RI_CHECK(!passes[4].culled); // writes an imported resource
+    RI_CHECK(passes[2].transitions.empty());
+
+    RI_CHECK(graph.Resource(unused).physical == RG_INVALID_INDEX);
+    RI_CHECK(graph.Resource(unused).firstPass == RG_INVALID_INDEX);
+    RI_CHECK(graph.Resource(backBuffer).physical == RG_INVALID_INDEX);
+    RI_CHECK(graph.MemoryStats().culled == 1);
+
+    // without the readback the whole chain goes
+    RenderGraph chain;
+    const RGResourceId a = chain.CreateTexture("A", colorDesc);
+    const RGResourceId b = chain.CreateTexture("B", colorDesc);
+    chain.AddPass("A").Write(a);
+    chain.AddPass("B").Read(a).Write(b);
+    chain.Compile();
+    RI_CHECK(chain.Passes()[0].culled && chain.Passes()[1].culled);
+    RI_CHECK(chain.MemoryStats().physical == 0);
+}
+
+RI_TEST(RenderGraphLifetimes)
+{
+    RenderGraph graph;
+    const RGResourceId output = graph.ImportTexture("Output", colorDesc);
+    const RGResourceId gbuffer = graph.CreateTexture("GBuffer", colorDesc);
+    const RGResourceId depth = graph.CreateTexture("Depth", depthDesc);
+    const RGResourceId lighting = graph.CreateTexture("Lighting", hdrDesc);
+    const RGResourceId debug = graph.CreateTexture("Debug", hdrDesc);
+
+    graph.AddPass("GBuffer").Write(gbuffer).Write(depth, RGAccess::DepthStencil); // 0
+    graph.AddPass("Debug").Read(depth).Write(debug);                              // 1, culled
+    graph.AddPass("Lighting").Read(gbuffer).Read(depth).Write(lighting);          // 2
+    graph.AddPass("Tonemap").Read(lighting).Write(output);                        // 3
+    graph.Compile();
+
+    RI_CHECK(graph.Passes()[1].culled);
+    RI_CHECK(graph.Resource(gbuffer).firstPass == 0 && graph.Resource(gbuffer).lastPass == 2);
+    RI_CHECK(graph.Resource(depth).firstPass == 0 && graph.Resource(depth).lastPass == 2);
+    RI_CHECK(graph.Resource(lighting).firstPass == 2 && graph.Resource(lighting).lastPass == 3);
+    RI_CHECK(graph.Resource(output).firstPass == 3 && graph.Resource(output).lastPass == 3);
+    RI_CHECK(graph.Resource(debug).firstPass == RG_INVALID_INDEX);
+    CheckAliasing(graph);
+}
+
+RI_TEST(RenderGraphAliasing)
+{
+    RenderGraph graph;
+    const RGResourceId output = graph.ImportTexture("Output", colorDesc);
+    const RGResourceId a = graph.CreateTexture("A", colorDesc);
+    const RGResourceId b = graph.CreateTexture("B", colorDesc);
+    const RGResourceId c = graph.CreateTexture("C", colorDesc);
+    const RGResourceId hdr = graph.CreateTexture("HDR", hdrDesc);
+
+    graph.AddPass("A").Write(a);                             // 0
+    graph.AddPass("B").Read(a).Write(b);                     // 1
+    graph.AddPass("C").Read(b).Write(c).Write(hdr);          // 2
+    graph.AddPass("Output").Read(c).Read(hdr).Write(output); // 3
+    graph.Compile();
+    CheckAliasing(graph);
+
+    // A ends before C starts, B overlaps both, HDR has its own desc
+    RI_CHECK(graph.Resource(a).physical == graph.Resource(c).physical);
+    RI_CHECK(graph.Resource(a).physical != graph.Resource(b).physical);
+    RI_CHECK(graph.Resource(hdr).physical != graph.Resource(a).physical);
+    RI_CHECK(graph.PhysicalTextures().size() == 3);
+
+    RGMemoryStats const stats = graph.MemoryStats();
+    RI_CHECK(stats.resources == 5 && stats.physical == 3 && stats.culled == 0);
+    RI_CHECK(stats.dedicatedBytes == 4 * colorDesc.SizeInBytes() + hdrDesc.SizeInBytes());
+    RI_CHECK(stats.aliasedBytes == 3 * colorDesc.SizeInBytes() + hdrDesc.SizeInBytes());
+}
+
+RI_TEST(RenderGraphTransitions)
+{
+    RenderGraph graph;
+    const RGResourceId output = graph.ImportTexture("Output", colorDesc);
+    const RGResourceId a = graph.CreateTexture("A", colorDesc);
+    const RGResourceId b = graph.CreateTexture("B", colorDesc);
+    const RGResourceId c = graph.CreateTexture("C", colorDesc);
+
+    graph.AddPass("A").Write(a);
+    graph.AddPass("Blur").Read(a).Write(b, RGAccess::UnorderedAccess);
+    graph.AddPass("C").Read(b).Write(c);
+    graph.AddPass("Output").Read(c).Read(b).Write(output);
+    graph.Compile();
+    std::span<RGPass const> passes = graph.Passes();
+
+    RGTransition const* first = FindTransition(passes[0], a);
+    RI_CHECK(first && first->before == RGAccess::Undefined && first->after == RGAccess::RenderTarget && !first->aliased);
+
+    RGTransition const* read = FindTransition(passes[1], a);
+    RI_CHECK(read && read->before == RGAccess::RenderTarget && read->after == RGAccess::ShaderResource);
+    RGTransition const* uav = FindTransition(passes[1], b);
+    RI_CHECK(uav && uav->before == RGAccess::Undefined && uav->after == RGAccess::UnorderedAccess);
+
+    // C takes over the texture of A, its contents are undefined
+    RI_CHECK(graph.Resource(c).physical == graph.Resource(a).physical);
+    RGTransition const* aliased = FindTransition(passes[2], c);
+    RI_CHECK(aliased && aliased->aliased && aliased->before == RGAccess::Undefined && aliased->after == RGAccess::RenderTarget);
+
+    // B is already a shader resource when the output reads it again
+    RI_CHECK(FindTransition(passes[3], b) == nullptr);
+    RGTransition const* imported = FindTransition(passes[3], output);
+    RI_CHECK(imported && imported->before == RGAccess::Undefined && !imported->aliased);
+}
+
+// The postprocess chain of the renderer: a depth buffer declared for a pass must not share its texture with the
+// scene depth the same pass reads, and the output of the chain must stay live until the last pass
+RI_TEST(RenderGraphPingPong)
+{
+    for (bool fxaa : {false, true})
+    {
+        RenderGraph graph;
+        const RGResourceId ping = graph.ImportTexture("Ping", colorDesc);
+        const RGResourceId pong = graph.ImportTexture("Pong", colorDesc);
+        const RGResourceId sceneDepth = graph.CreateTexture("Scene Depth", depthDesc);
+        const RGResourceId depth[2] = {graph.CreateTexture("Ping Depth", depthDesc), graph.CreateTexture("Pong Depth", depthDesc)};
+
+        graph.AddPass("Scene").Write(sceneDepth, RGAccess::DepthStencil);
+        graph.AddPass("Halo").Read(sceneDepth).Write(ping).Write(depth[0], RGAccess::DepthStencil);
+        if (fxaa)
+            graph.AddPass("FXAA").Read(ping).Write(pong).Write(depth[1], RGAccess::DepthStencil);
+        const uint32 output = fxaa ? 1 : 0;
+        graph.AddPass("AABB").Write(output ? pong : ping).Write(depth[output], RGAccess::DepthStencil);
+        graph.Compile();
+        CheckAliasing(graph);
+
+        const uint32 lastPass = static_cast<uint32>(graph.Passes().size() - 1);
+        RI_CHECK(graph.Resource(depth[0]).physical != graph.Resource(sceneDepth).physical);
+        RI_CHECK(graph.Resource(depth[output]).lastPass == lastPass);
+        if (!fxaa)
+            RI_CHECK(graph.Resource(depth[1]).physical == RG_INVALID_INDEX);
+    }
+}
@@ -0,0 +1,167 @@
+#include "Test.h"
+#include "Rendering/RenderQueue.h"
+#include <random>
+
+using namespace Riley;
+
+namespace
+{
+// the radix sort has to give exactly what a stable comparison sort gives, payloads are the push order
+void CheckRadixSort(std::vector<uint64> const& keys)
+{
+    std::vector<DrawPacket> packets;
+    for (uint32 i = 0; i < keys.size(); ++i)
+        packets.push_back(DrawPacket{keys[i], i});
+
+    std::vector<DrawPacket> expected = packets;
+    std::stable_sort(expected.begin(), expected.end(), [](DrawPacket const& a, DrawPacket const& b) { return a.key < b.key; });
+
+    std::vector<DrawPacket> scratch;
+    RenderQueue::RadixSort(packets, scratch);
+    RI_CHECK(packets.size() == expected.size());
+    for (size_t i = 0; i < std::min(packets.size(), expected.size()); ++i)
+        RI_CHECK(packets[i].key == expected[i].key && packets[i].payload == expected[i].payload);
+}
+} // namespace
+
+RI_TEST(RenderQueueRadixSort)
+{
+    std::mt19937_64 rng(7);
+    std::mt19937 field(7);
+
+    std::vector<uint64> keys(5000);
+    for (uint64& key : keys)
+        key = rng();
+    CheckRadixSort(keys);
+
+    // few distinct keys, most of them equal
+    for (uint64& key : keys)
+        key = DrawKey::Make(DrawPass::GBuffer, field() % 3, field() % 4, 0, field() % 5);
+    CheckRadixSort(keys);
+
+    // only the lowest and highest byte vary, every digit in between is skipped
+    for (uint64& key : keys)
+        key = (rng() % 4) << 56 | rng() % 256;
+    CheckRadixSort(keys);
+
+    // every digit is uniform, nothing moves
+    CheckRadixSort(std::vector<uint64>(100, 0x0123456789abcdefull));
+    CheckRadixSort({});
+    CheckRadixSort({42});
+    CheckRadixSort({2, 1});
+}
+
+RI_TEST(DrawKeyFields)
+{
+    const uint32 maxProgram = (1u << DrawKey::PROGRAM_BITS) - 1;
+    const uint32 maxMaterial = (1u << DrawKey::MATERIAL_BITS) - 1;
+    const uint32 maxDepth = (1u << DrawKey::DEPTH_BITS) - 1;
+    const uint32 maxMesh = (1u << DrawKey::MESH_BITS) - 1;
+
+    const uint64 key = DrawKey::Make(DrawPass::Transparent, 37, 123456, 4321, 98765);
+    RI_CHECK(DrawKey::Pass(key) == DrawPass::Transparent);
+    RI_CHECK(DrawKey::Program(key) == 37);
+    RI_CHECK(DrawKey::Material(key) == 123456);
+    RI_CHECK(DrawKey::Depth(key) == 4321);
+    RI_CHECK(DrawKey::Mesh(key) == 98765);
+
+    const uint64 full = DrawKey::Make(DrawPass::Transparent, maxProgram, maxMaterial, maxDepth, maxMesh);
+    RI_CHECK(DrawKey::Program(full) == maxProgram && DrawKey::Material(full) == maxMaterial);
+    RI_CHECK(DrawKey::Depth(full) == maxDepth && DrawKey::Mesh(full) == maxMesh);
+
+    // values too wide for their field are masked instead of spilling into the next one
+    const uint64 wide = DrawKey::Make(DrawPass::Shadow, maxProgram + 1 + 5, 0, maxDepth + 1, maxMesh + 1 + 9);
+    RI_CHECK(DrawKey::Pass(wide) == DrawPass::Shadow);
+    RI_CHECK(DrawKey::Program(wide) == 5);
+    RI_CHECK(DrawKey::Material(wide) == 0);
+    RI_CHECK(DrawKey::Depth(wide) == 0);
+    RI_CHECK(DrawKey::Mesh(wide) == 9);
+
+    // more significant fields win the ordering
+    RI_CHECK(DrawKey::Make(DrawPass::Shadow, maxProgram, maxMaterial, maxDepth, maxMesh) <
+             DrawKey::Make(DrawPass::GBuffer, 0, 0, 0, 0));
+    RI_CHECK(DrawKey::Make(DrawPass::GBuffer, 1, maxMaterial, 0, 0) < DrawKey::Make(DrawPass::GBuffer, 2, 0, 0, 0));
+    RI_CHECK(DrawKey::Make(DrawPass::GBuffer, 1, 3, maxDepth, 0) < DrawKey::Make(DrawPass::GBuffer, 1, 4, 0, 0));
+    RI_CHECK(DrawKey::Make(DrawPass::GBuffer, 1, 3, 10, maxMesh) < DrawKey::Make(DrawPass::GBuffer, 1, 3, 11, 0));
+}
+
+RI_TEST(DrawKeyDepthBucket)
+{
+    const uint32 maxBucket = (1u << DrawKey::DEPTH_BITS) - 1;
+
+    RI_CHECK(DrawKey::DepthBucket(0.1f, 0.1f, 100.0f) == 0);
+    RI_CHECK(DrawKey::DepthBucket(100.0f, 0.1f, 100.0f) == maxBucket);
+    RI_CHECK(DrawKey::DepthBucket(-5.0f, 0.1f, 100.0f) == 0);
+    RI_CHECK(DrawKey::DepthBucket(1e9f, 0.1f, 100.0f) == maxBucket);
+
+    const uint32 middle = DrawKey::DepthBucket(50.0f, 0.0f, 100.0f);
+    RI_CHECK(middle >= maxBucket / 2 - 1 && middle <= maxBucket / 2 + 1);
+
+    // front to back never goes backwards
+    uint32 previous = 0;
+    for (float depth = 0.1f; depth < 100.0f; depth += 0.37f)
+    {
+        const uint32 bucket = DrawKey::DepthBucket(depth, 0.1f, 100.0f);
+        RI_CHECK(bucket >= previous);
+        previous = bucket;
+    }
+
+    // an empty depth range does not divide by zero
+    RI_CHECK(DrawKey::DepthBucket(1.0f, 1.0f, 1.0f) == 0);
+    RI_CHECK(DrawKey::DepthBucket(2.0f, 1.0f, 1.0f) == maxBucket);
+}
+
+RI_TEST(RenderQueueStateChanges)
+{
+    // program, material, mesh of each draw, interleaved as a scene walk would push them
+    const uint32 draws[][3] = {{1, 0, 0}, {0, 1, 1}, {1, 0, 0}, {0, 1, 1}, {1, 0, 2}, {0, 1, 1}};
+
+    RenderQueue queue;
+    for (uint32 i = 0; i < std::size(draws); ++i)
+        queue.Push(DrawKey::Make(DrawPass::GBuffer, draws[i][0], draws[i][1], 0, draws[i][2]), i);
+
+    const StateChanges unsorted = RenderQueue::CountStateChanges(queue.Packets());
+    RI_CHECK(unsorted.programs == 6 && unsorted.materials == 6 && unsorted.meshes == 6);
+
+    queue.Sort();
+    RenderQueueStats const& stats = queue.Stats();
+    RI_CHECK(stats.draws == std::size(draws));
+    RI_CHECK(stats.unsorted.Total() == unsorted.Total());
+    // program 0: mesh 1 three times, program 1: mesh 0 twice then mesh 2
+    RI_CHECK(stats.sorted.programs == 2 && stats.sorted.materials == 2 && stats.sorted.meshes == 3);
+    RI_CHECK(RenderQueue::CountStateChanges(queue.Packets()).Total() == stats.sorted.Total());
+
+    // a new pass rebinds the program even when the id is the same
+    const DrawPacket passes[] = {{DrawKey::Make(DrawPass::Shadow, 3, 0, 0, 0), 0}, {DrawKey::Make(DrawPass::GBuffer, 3, 0, 0, 0), 1}};
+    RI_CHECK(RenderQueue::CountStateChanges(passes).programs == 2);
+    RI_CHECK(RenderQueue::CountStateChanges({}).Total() == 0);
+
+    // a sorted queue never needs more switches than the unsorted one
+    std::mt19937 rng(3);
+    queue.Clear();
+    for (uint32 i = 0; i < 2000; ++i)
+        queue.Push(DrawKey::Make(DrawPass::GBuffer, rng() % 8, rng() % 64, rng() % 1024, rng() % 256), i);
+    queue.Sort();
+    RI_CHECK(queue.Stats().sorted.Total() <= queue.Stats().unsorted.Total());
+    RI_CHECK(queue.Stats().sorted.programs == 8);
+}
+
+RI_TEST(RenderQueueMaterialIds)
+{
+    const RenderQueue::TextureSet brick = {1, 2, 3, 0};
+    const RenderQueue::TextureSet metal = {4, 5, 0, 0};
+    const RenderQueue::TextureSet glass = {6, 0, 0, 0};
+
+    RenderQueue queue;
+    RI_CHECK(queue.MaterialId(brick) == 0);
+    RI_CHECK(queue.MaterialId(metal) == 1);
+    RI_CHECK(queue.MaterialId(brick) == 0);
+
+    // ids survive the per frame Clear so keys stay the same from frame to frame
+    queue.Push(DrawKey::Make(DrawPass::GBuffer, 0, queue.MaterialId(metal), 0, 0), 0);
+    queue.Clear();
+    RI_CHECK(queue.Packets().empty());
+    RI_CHECK(queue.MaterialId(metal) == 1);
+    RI_CHECK(queue.MaterialId(glass) == 2);
+    RI_CHECK(queue.MaterialId(brick) == 0);
+}
@@ -0,0 +1,178 @@
+#include "Test.h"
+#include "Rendering/SceneQuery.h"
+
+using namespace Riley;
+
+namespace
+{
+/* Two submeshes sharing one buffer like an imported model: a right triangle in the z = 0 plane,
+ * then a unit cube around the origin with its indices relative to its own first vertex */
+MeshCollider SubmeshCollider(uint32 submesh)
+{
+    static const auto positions = [] {
+        auto p = std::make_shared<std::vector<Vector3>>();
+        p->emplace_back(-1.0f, -1.0f, 0.0f);
+        p->emplace_back(1.0f, -1.0f, 0.0f);
+        p->emplace_back(-1.0f, 1.0f, 0.0f);
+        for (uint32 i = 0; i < 8; ++i)
+            p->emplace_back(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f);
+        return p;
+    }();
+    static const auto indices = std::make_shared<std::vector<uint32>>(std::initializer_list<uint32>{
+        0, 1, 2,                                                          // triangle
+        0, 2, 6, 0, 6, 4, 1, 3, 7, 1, 7, 5, 0, 1, 5, 0, 5, 4, 2, 3, 7, 2, 7, 6, 0, 1, 3, 0, 3, 2, 4, 5, 7, 4, 7, 6}); // cube
+
+    if (submesh == 0)
+        return MeshCollider{.positions = positions, .indices = indices, .vertexCount = 3, .indexCount = 3};
+    return MeshCollider{.positions = positions, .indices = indices, .vertexCount = 8, .indexCount = 36, .startIndexLoc = 3,
+                        .baseVertexLoc = 3};
+}
+
+entt::entity CreateEntity(entt::registry& reg, Matrix const& local, BoundingBox const* box = nullptr)
+{
+    const entt::entity e = reg.create();
+    reg.emplace<Transform>(e, local, local);
+    if (box)
+    {
+        AABB aabb{};
+        aabb.orginalBox = *box;
+        reg.emplace<AABB>(e, aabb);
+    }
+    return e;
+}
+
+bool Near(float a, float b)
+{
+    return fabs(a - b) < 1e-4f;
+}
+
+bool Near(Vector3 const& a, Vector3 const& b)
+{
+    return Vector3::Distance(a, b) < 1e-4f;
+}
+
+const BoundingBox UNIT_CUBE(Vector3(0.0f), Vector3(0.5f));
+const BoundingBox TRIANGLE_BOX(Vector3(0.0f), Vector3(1.0f, 1.0f, 0.1f));
+} // namespace
+
+RI_TEST(SceneQueryMeshCollider)
+{
+    entt::registry reg;
+    TransformSystem transforms(reg);
+
+    // the cube ends up scaled by the parent to [1, 3] x [-1, 1] x [9, 11]
+    const entt::entity parent = CreateEntity(reg, Matrix::CreateScale(2.0f) * Matrix::CreateTranslation(0.0f, 0.0f, 10.0f));
+    const entt::entity child = CreateEntity(reg, Matrix::CreateTranslation(1.0f, 0.0f, 0.0f), &UNIT_CUBE);
+    reg.emplace<MeshCollider>(child, SubmeshCollider(1));
+    AttachChild(reg, parent, child);
+    transforms.Update();
+
+    const Ray ray(Vector3(2.0f, 0.5f, 0.0f), Vector3(0.0f, 0.0f, 1.0f));
+    auto hit = SceneQuery::RayCast(reg, transforms, ray);
+    RI_CHECK(hit && hit->entity == child);
+    RI_CHECK(hit && Near(hit->distance, 9.0f));
+    RI_CHECK(hit && Near(hit->position, Vector3(2.0f, 0.5f, 9.0f)));
+
+    // moving the parent moves the child with it
+    auto& parentTransform = reg.get<Transform>(parent);
+    parentTransform.currentTransform = Matrix::CreateScale(2.0f) * Matrix::CreateTranslation(0.0f, 0.0f, 20.0f);
+    parentTransform.dirty = true;
+    transforms.Update();
+    hit = SceneQuery::RayCast(reg, transforms, ray);
+    RI_CHECK(hit && hit->entity == child && Near(hit->distance, 19.0f));
+
+    // a hit past maxDistance is no hit
+    RI_CHECK(!SceneQuery::RayCast(reg, transforms, ray, 18.0f));
+}
+
+RI_TEST(SceneQueryMiss)
+{
+    entt::registry reg;
+    TransformSystem transforms(reg);
+
+    const entt::entity e = CreateEntity(reg, Matrix::CreateTranslation(0.0f, 0.0f, 10.0f), &TRIANGLE_BOX);
+    reg.emplace<MeshCollider>(e, SubmeshCollider(0));
+    transforms.Update();
+
+    const Vector3 forward(0.0f, 0.0f, 1.0f);
+    auto hit = SceneQuery::RayCast(reg, transforms, Ray(Vector3(-0.5f, -0.5f, 0.0f), forward));
+    RI_CHECK(hit && hit->entity == e && Near(hit->distance, 10.0f));
+
+    // inside the AABB but past the hypotenuse, the collider decides
+    RI_CHECK(!SceneQuery::RayCast(reg, transforms, Ray(Vector3(0.8f, 0.8f, 0.0f), forward)));
+    // pointing away and passing beside
+    RI_CHECK(!SceneQuery::RayCast(reg, transforms, Ray(Vector3(-0.5f, -0.5f, 0.0f), -forward)));
+    RI_CHECK(!SceneQuery::RayCast(reg, transforms, Ray(Vector3(5.0f, 0.0f, 0.0f), forward)));
+}
+
+RI_TEST(SceneQueryAABBFallback)
+{
+    entt::registry reg;
+    TransformSystem transforms(reg);
+
+    const BoundingBox box(Vector3(0.0f), Vector3(1.0f, 2.0f, 1.0f));
+    const entt::entity e = CreateEntity(reg, Matrix::CreateTranslation(5.0f, 0.0f, 0.0f), &box);
+    transforms.Update();
+
+    const Ray ray(Vector3(0.0f, 1.5f, 0.0f), Vector3(1.0f, 0.0f, 0.0f));
+    auto hit = SceneQuery::RayCast(reg, transforms, ray);
+    RI_CHECK(hit && hit->entity == e);
+    RI_CHECK(hit && Near(hit->distance, 4.0f));
+    RI_CHECK(hit && Near(hit->position, Vector3(4.0f, 1.5f, 0.0f)));
+
+    RI_CHECK(!SceneQuery::RayCast(reg, transforms, Ray(Vector3(0.0f, 2.5f, 0.0f), Vector3(1.0f, 0.0f, 0.0f))));
+}
+
+RI_TEST(SceneQueryClosestHit)
+{
+    /* The triangle sits in the middle of its AABB, which the ray enters at 9 but the triangle is only hit at 10.
+     * The plain box overlaps it and starts either before or after the triangle. */
+    for (float boxStart : {9.5f, 10.5f})
+    {
+        for (bool boxFirst : {false, true})
+        {
+            entt::registry reg;
+            TransformSystem transforms(reg);
+
+            const BoundingBox box(Vector3(0.0f, 0.0f, boxStart + 1.0f), Vector3(1.0f));
+            entt::entity plain = entt::null;
+            if (boxFirst)
+                plain = CreateEntity(reg, Matrix::Identity, &box);
+            const entt::entity triangle = CreateEntity(reg, Matrix::CreateTranslation(0.0f, 0.0f, 10.0f), &TRIANGLE_BOX);
+            reg.emplace<MeshCollider>(triangle, SubmeshCollider(0));
+            if (!boxFirst)
+                plain = CreateEntity(reg, Matrix::Identity, &box);
+            transforms.Update();
+
+            auto hit = SceneQuery::RayCast(reg, transforms, Ray(Vector3(-0.5f, -0.5f, 0.0f), Vector3(0.0f, 0.0f, 1.0f)));
+            RI_CHECK(hit && hit->entity == (boxStart < 10.0f ? plain : triangle));
+            RI_CHECK(hit && Near(hit->distance, std::min(boxStart, 10.0f)));
+        }
+    }
+}
+
+RI_TEST(SceneQueryRayTriangle)
+{
+    const Vector3 v0(0.0f, 0.0f, 0.0f), v1(1.0f, 0.0f, 0.0f), v2(0.0f, 1.0f, 0.0f);
+    const Vector3 forward(0.0f, 0.0f, 1.0f);
+
+    float t = 0.0f;
+    RI_CHECK(SceneQuery::RayTriangle(Vector3(0.25f, 0.25f, -1.0f), forward, v0, v1, v2, t) && Near(t, 1.0f));
+    // no backface culling
+    RI_CHECK(SceneQuery::RayTriangle(Vector3(0.25f, 0.25f, 1.0f), -forward, v0, v1, v2, t) && Near(t, 1.0f));
+    // t is in units of dir
+    RI_CHECK(SceneQuery::RayTriangle(Vector3(0.25f, 0.25f, -1.0f), forward * 2.0f, v0, v1, v2, t) && Near(t, 0.5f));
+
+    // edges and vertices count as inside, anything past them does not
+    RI_CHECK(SceneQuery::RayTriangle(Vector3(0.5f, 0.0f, -1.0f), forward, v0, v1, v2, t) && Near(t, 1.0f));
+    RI_CHECK(SceneQuery::RayTriangle(Vector3(0.5f, 0.5f, -1.0f), forward, v0, v1, v2, t));
+    RI_CHECK(SceneQuery::RayTriangle(Vector3(0.0f, 1.0f, -1.0f), forward, v0, v1, v2, t));
+    RI_CHECK(!SceneQuery::RayTriangle(Vector3(0.5f, -0.001f, -1.0f), forward, v0, v1, v2, t));
+    RI_CHECK(!SceneQuery::RayTriangle(Vector3(0.501f, 0.501f, -1.0f), forward, v0, v1, v2, t));
+    RI_CHECK(!SceneQuery::RayTriangle(Vector3(0.0f, 1.001f, -1.0f), forward, v0, v1, v2, t));
+
+    // behind the origin, parallel to the plane and degenerate triangles never hit
+    RI_CHECK(!SceneQuery::RayTriangle(Vector3(0.25f, 0.25f, 1.0f), forward, v0, v1, v2, t));
+    RI_CHECK(!SceneQuery::RayTriangle(Vector3(-1.0f, 0.25f, 0.0f), Vector3(1.0f, 0.0f, 0.0f), v0, v1, v2, t));
+    RI_CHECK(!SceneQuery::RayTriangle(Vector3(0.25f, 0.0f, -1.0f), forward, v0, v1, Vector3(2.0f, 0.0f, 0.0f), t));
+}
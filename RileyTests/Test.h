@@ -0,0 +1,45 @@
+#pragma once
+
+namespace Riley
+{
+namespace Tests
+{
+using TestFunction = void (*)();
+
+struct TestCase
+{
+    char const* name;
+    TestFunction function;
+    bool benchmark; // only run with --bench, results go to the log
+};
+
+std::vector<TestCase>& Registry();
+void Fail(char const* file, int line, char const* expression);
+// part of the running test could not run, e.g. an asset missing from the checkout, so it is reported as skipped
+void Skip(std::string const& what);
+
+struct Registrar
+{
+    Registrar(char const* name, TestFunction function, bool benchmark)
+    {
+        Registry().push_back(TestCase{name, function, benchmark});
+    }
+};
+} // namespace Tests
+} // namespace Riley
+
+#define RI_TEST_CASE(name, benchmark)                                                                                              \
+    static void name();                                                                                                            \
+    static ::Riley::Tests::Registrar name##Registrar(#name, &name, benchmark);                                                     \
+    static void name()
+
+#define RI_TEST(name) RI_TEST_CASE(name, false)
+#define RI_BENCHMARK(name) RI_TEST_CASE(name, true)
+
+// a failed check is reported and the test goes on, the run fails at the end
+#define RI_CHECK(expression)                                                                                                       \
+    do                                                                                                                             \
+    {                                                                                                                              \
+        if (!(expression))                                                                                                         \
+            ::Riley::Tests::Fail(__FILE__, __LINE__, #expression);                                                                 \
+    } while (false)
@@ -0,0 +1,29 @@
+#pragma once
+#include "Rendering/GLTFLoader.h"
+
+namespace Riley
+{
+namespace Tests
+{
+// the models bundled under Resources/Models, not every checkout has the buffers of all of them but DamagedHelmet is always there
+struct TestModel
+{
+    char const* basePath;
+    char const* filename;
+};
+
+inline constexpr TestModel TEST_MODELS[] = {{"Resources/Models/DamagedHelmet/", "DamagedHelmet.gltf"},
+                                            {"Resources/Models/Sponza/glTF/", "Sponza.gltf"},
+                                            {"Resources/Models/ToyCar/glTF/", "ToyCar.gltf"},
+                                            {"Resources/Models/Buggy/glTF/", "Buggy.gltf"}};
+
+// reads the model with GLTFLoader, a model it cannot read is reported as skipped and left out by the caller
+inline std::optional<SceneData> LoadTestModel(TestModel const& model)
+{
+    std::optional<SceneData> scene = GLTFLoader::Load(model.basePath, model.filename, false);
+    if (!scene)
+        Skip(std::string(model.basePath) + model.filename + " is missing or incomplete");
+    return scene;
+}
+} // namespace Tests
+} // namespace Riley
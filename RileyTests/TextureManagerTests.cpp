@@ -0,0 +1,117 @@
+#include "Test.h"
+#include "Rendering/TextureManager.h"
+#include "Utilities/FileUtil.h"
+#include "Utilities/StringUtil.h"
+#include "Utilities/Timer.h"
+#include <latch>
+#include <numeric>
+#include <random>
+
+using namespace Riley;
+
+namespace
+{
+// the textures bundled with the models
+std::vector<std::wstring> TestTextures()
+{
+    std::vector<std::wstring> names;
+    std::error_code error;
+    for (std::string directory : {"Resources/Models/DamagedHelmet/", "Resources/Models/ToyCar/glTF/", "Resources/Models/Sun/"})
+    {
+        for (fs::directory_entry const& entry : fs::directory_iterator(directory, error))
+        {
+            const std::string extension = entry.path().extension().string();
+            if (entry.is_regular_file() && (extension == ".png" || extension == ".jpg"))
+                names.push_back(ToWideString(directory + entry.path().filename().string()));
+        }
+    }
+    return names;
+}
+} // namespace
+
+/* Many threads load the same textures at once, every name has to get one handle and every file has to be published.
+ * The device is WARP, which is free threaded like a hardware one and needs no GPU */
+RI_TEST(TextureManagerConcurrentLoads)
+{
+    std::vector<std::wstring> names = TestTextures();
+    // DamagedHelmet's textures are always checked in
+    RI_CHECK(!names.empty());
+    if (names.empty())
+        return;
+    const size_t existing = names.size();
+    names.push_back(L"Resources/Models/Missing.png"); // fails on the worker and keeps the placeholder
+
+    ID3D11Device* device = nullptr;
+    ID3D11DeviceContext* context = nullptr;
+    if (FAILED(D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_WARP, nullptr, 0, nullptr, 0, D3D11_SDK_VERSION, &device, nullptr,
+                                 &context)))
+    {
+        Tests::Skip("no WARP device");
+        return;
+    }
+    g_TextureManager.Initialize(device, context);
+
+    // every thread asks for every name a few times, each in an order of its own
+    static constexpr uint32 threadCount = 8;
+    static constexpr uint32 rounds = 4;
+    std::vector<std::vector<TextureHandle>> handles(threadCount, std::vector<TextureHandle>(names.size(), INVALID_TEXTURE_HANDLE));
+    std::latch start(threadCount);
+    std::vector<std::thread> threads;
+    for (uint32 t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&, t] {
+            std::vector<uint32> order(names.size());
+            std::iota(order.begin(), order.end(), 0u);
+            std::mt19937 rng(t);
+            start.arrive_and_wait();
+            for (uint32 round = 0; round < rounds; ++round)
+            {
+                std::shuffle(order.begin(), order.end(), rng);
+                for (uint32 i : order)
+                {
+                    const TextureHandle handle = g_TextureManager.LoadTexture(names[i]);
+                    RI_CHECK(handles[t][i] == INVALID_TEXTURE_HANDLE || handles[t][i] == handle);
+                    handles[t][i] = handle;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    // one handle per name, the same on every thread
+    std::vector<TextureHandle> distinct;
+    for (uint32 i = 0; i < names.size(); ++i)
+    {
+        RI_CHECK(handles[0][i] != INVALID_TEXTURE_HANDLE);
+        for (uint32 t = 1; t < threadCount; ++t)
+            RI_CHECK(handles[t][i] == handles[0][i]);
+        distinct.push_back(handles[0][i]);
+    }
+    std::sort(distinct.begin(), distinct.end());
+    RI_CHECK(std::adjacent_find(distinct.begin(), distinct.end()) == distinct.end());
+
+    // the render thread publishes a few a frame until the workers are done
+    RileyTimer timeout;
+    while (g_TextureManager.PendingTextures() > 0 && timeout.ElapsedInSeconds() < 60.0f)
+    {
+        g_TextureManager.ProcessUploads();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    RI_CHECK(g_TextureManager.PendingTextures() == 0);
+
+    DXResource* const placeholder = g_TextureManager.GetTextureView(INVALID_TEXTURE_HANDLE);
+    for (uint32 i = 0; i < names.size(); ++i)
+    {
+        DXResource* const view = g_TextureManager.GetTextureView(handles[0][i]);
+        RI_CHECK((view != placeholder) == (i < existing));
+        RI_CHECK(view->SRV() != nullptr);
+        // a name already known is not requested again
+        RI_CHECK(g_TextureManager.LoadTexture(names[i]) == handles[0][i]);
+    }
+    RI_CHECK(g_TextureManager.PendingTextures() == 0);
+
+    g_TextureManager.Destroy();
+    SAFE_RELEASE(context);
+    SAFE_RELEASE(device);
+}
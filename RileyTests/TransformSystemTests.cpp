@@ -0,0 +1,134 @@
+#include "Test.h"
+#include "Rendering/TransformSystem.h"
+
+using namespace Riley;
+
+namespace
+{
+entt::entity CreateNode(entt::registry& reg, Vector3 const& offset)
+{
+    const entt::entity e = reg.create();
+    const Matrix local = Matrix::CreateTranslation(offset);
+    reg.emplace<Transform>(e, local, local);
+    reg.emplace<Relationship>(e);
+    return e;
+}
+
+Vector3 WorldPosition(TransformSystem const& transforms, entt::entity e)
+{
+    return Vector3::Transform(Vector3(0.0f), transforms.Get(e).world.Transpose());
+}
+
+bool Near(Vector3 const& a, Vector3 const& b)
+{
+    return Vector3::Distance(a, b) < 1e-4f;
+}
+
+std::vector<entt::entity> Children(entt::registry const& reg, entt::entity parent)
+{
+    std::vector<entt::entity> children;
+    for (entt::entity child = reg.get<Relationship>(parent).firstChild; child != entt::null;
+         child = reg.get<Relationship>(child).nextSibling)
+        children.push_back(child);
+    return children;
+}
+
+// the list, lastChild and childrenCount describe the same children, who all point back at the parent
+bool Linked(entt::registry const& reg, entt::entity parent, std::vector<entt::entity> const& expected)
+{
+    Relationship const& relationship = reg.get<Relationship>(parent);
+    bool linked = Children(reg, parent) == expected && relationship.childrenCount == expected.size();
+    linked &= relationship.lastChild == (expected.empty() ? entt::null : expected.back());
+    for (entt::entity child : expected)
+        linked &= reg.get<Relationship>(child).parent == parent;
+    return linked;
+}
+} // namespace
+
+RI_TEST(TransformHierarchyUpdates)
+{
+    entt::registry reg;
+    reg.on_destroy<Relationship>().connect<&UnlinkRelationship>();
+    TransformSystem transforms(reg);
+
+    // every node already has its Relationship, as after an import, so only the links change
+    const entt::entity root = CreateNode(reg, Vector3(10.0f, 0.0f, 0.0f));
+    const entt::entity a = CreateNode(reg, Vector3(0.0f, 1.0f, 0.0f));
+    const entt::entity b = CreateNode(reg, Vector3(0.0f, 2.0f, 0.0f));
+    const entt::entity c = CreateNode(reg, Vector3(0.0f, 3.0f, 0.0f));
+    transforms.Update();
+    RI_CHECK(Near(WorldPosition(transforms, b), Vector3(0.0f, 2.0f, 0.0f)));
+
+    AttachChild(reg, root, a);
+    AttachChild(reg, root, b);
+    AttachChild(reg, root, c);
+    RI_CHECK(Linked(reg, root, {a, b, c}));
+    transforms.Update();
+    RI_CHECK(Near(WorldPosition(transforms, a), Vector3(10.0f, 1.0f, 0.0f)));
+    RI_CHECK(Near(WorldPosition(transforms, b), Vector3(10.0f, 2.0f, 0.0f)));
+    RI_CHECK(Near(WorldPosition(transforms, c), Vector3(10.0f, 3.0f, 0.0f)));
+
+    // a grandchild follows both of its parents
+    const entt::entity grandchild = CreateNode(reg, Vector3(0.0f, 0.0f, 5.0f));
+    AttachChild(reg, b, grandchild);
+    transforms.Update();
+    RI_CHECK(Near(WorldPosition(transforms, grandchild), Vector3(10.0f, 2.0f, 5.0f)));
+
+    // detaching the middle child keeps the siblings linked and drops the parent's transform
+    DetachChild(reg, b);
+    RI_CHECK(Linked(reg, root, {a, c}));
+    RI_CHECK(reg.get<Relationship>(b).parent == entt::null && reg.get<Relationship>(b).nextSibling == entt::null);
+    RI_CHECK(Linked(reg, b, {grandchild}));
+    transforms.Update();
+    RI_CHECK(Near(WorldPosition(transforms, b), Vector3(0.0f, 2.0f, 0.0f)));
+    RI_CHECK(Near(WorldPosition(transforms, grandchild), Vector3(0.0f, 2.0f, 5.0f)));
+
+    // and it can be attached again, at the end
+    AttachChild(reg, root, b);
+    RI_CHECK(Linked(reg, root, {a, c, b}));
+    DetachChild(reg, b);
+    DetachChild(reg, a);
+    RI_CHECK(Linked(reg, root, {c}));
+    DetachChild(reg, c);
+    RI_CHECK(Linked(reg, root, {}) && reg.get<Relationship>(root).firstChild == entt::null);
+}
+
+RI_TEST(TransformHierarchyDestroy)
+{
+    entt::registry reg;
+    reg.on_destroy<Relationship>().connect<&UnlinkRelationship>();
+    TransformSystem transforms(reg);
+
+    const entt::entity root = CreateNode(reg, Vector3(10.0f, 0.0f, 0.0f));
+    const entt::entity a = CreateNode(reg, Vector3(0.0f, 1.0f, 0.0f));
+    const entt::entity b = CreateNode(reg, Vector3(0.0f, 2.0f, 0.0f));
+    const entt::entity c = CreateNode(reg, Vector3(0.0f, 3.0f, 0.0f));
+    const entt::entity grandchild = CreateNode(reg, Vector3(0.0f, 0.0f, 5.0f));
+    AttachChild(reg, root, a);
+    AttachChild(reg, root, b);
+    AttachChild(reg, root, c);
+    AttachChild(reg, c, grandchild);
+    transforms.Update();
+
+    // a destroyed sibling is unlinked from the middle and from the end of the list
+    reg.destroy(b);
+    RI_CHECK(Linked(reg, root, {a, c}));
+    reg.destroy(c);
+    RI_CHECK(Linked(reg, root, {a}));
+    RI_CHECK(reg.get<Relationship>(grandchild).parent == entt::null);
+    transforms.Update();
+    RI_CHECK(Near(WorldPosition(transforms, grandchild), Vector3(0.0f, 0.0f, 5.0f)));
+
+    // children of a destroyed parent become roots
+    reg.destroy(root);
+    RI_CHECK(reg.get<Relationship>(a).parent == entt::null && reg.get<Relationship>(a).nextSibling == entt::null);
+    transforms.Update();
+    RI_CHECK(Near(WorldPosition(transforms, a), Vector3(0.0f, 1.0f, 0.0f)));
+
+    // clearing the whole registry runs the hook on every entity at once
+    const entt::entity parent = CreateNode(reg, Vector3(1.0f));
+    AttachChild(reg, parent, CreateNode(reg, Vector3(2.0f)));
+    AttachChild(reg, parent, CreateNode(reg, Vector3(3.0f)));
+    reg.clear();
+    RI_CHECK(reg.storage<Relationship>().empty());
+}
@@ -0,0 +1,195 @@
+#include "Test.h"
+#include "Rendering/VertexCompression.h"
+#include <random>
+
+using namespace Riley;
+using namespace Riley::VertexCompression;
+
+namespace
+{
+// directions spread over the sphere, plus the ones the encoding treats specially: the axes, the z = 0 seam between
+// the two hemispheres and the folds of the lower one
+std::vector<Vector3> TestDirections()
+{
+    std::vector<Vector3> directions = {Vector3(1, 0, 0), Vector3(-1, 0, 0), Vector3(0, 1, 0), Vector3(0, -1, 0),
+                                       Vector3(0, 0, 1), Vector3(0, 0, -1)};
+    for (float z : {0.0f, 1e-4f, -1e-4f, 0.5f, -0.5f, -0.999f})
+    {
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            const float angle = DirectX::XM_2PI * i / 16.0f;
+            const float r = std::sqrt(1.0f - z * z);
+            directions.emplace_back(r * std::cos(angle), r * std::sin(angle), z);
+        }
+    }
+    // Fibonacci sphere
+    static constexpr uint32 count = 2000;
+    const float goldenAngle = DirectX::XM_PI * (3.0f - std::sqrt(5.0f));
+    for (uint32 i = 0; i < count; ++i)
+    {
+        const float z = 1.0f - 2.0f * (i + 0.5f) / count;
+        const float r = std::sqrt(1.0f - z * z);
+        directions.emplace_back(r * std::cos(goldenAngle * i), r * std::sin(goldenAngle * i), z);
+    }
+    for (Vector3& direction : directions)
+        direction.Normalize();
+    return directions;
+}
+
+Vector3 QuantizedRoundTrip(Vector3 const& direction)
+{
+    const Vector2 encoded = OctEncode(direction);
+    return OctDecode(Vector2(UnpackSnorm16(PackSnorm16(encoded.x)), UnpackSnorm16(PackSnorm16(encoded.y))));
+}
+
+Vertex MakeVertex(Vector3 const& position, Vector3 const& normal, Vector2 const& texcoord, bool flipped)
+{
+    Vertex vertex{};
+    vertex.position = position;
+    vertex.normal = normal;
+    // any tangent perpendicular to the normal
+    Vector3 tangent = std::abs(normal.x) < 0.9f ? Vector3(1, 0, 0).Cross(normal) : Vector3(0, 1, 0).Cross(normal);
+    tangent.Normalize();
+    vertex.tangent = tangent;
+    vertex.bitangent = normal.Cross(tangent) * (flipped ? -1.0f : 1.0f);
+    vertex.texcoord = texcoord;
+    return vertex;
+}
+} // namespace
+
+RI_TEST(VertexCompressionPacking)
+{
+    RI_CHECK(PackUnorm16(0.0f) == 0 && PackUnorm16(1.0f) == 65535 && PackUnorm16(-1.0f) == 0 && PackUnorm16(2.0f) == 65535);
+    RI_CHECK(UnpackUnorm16(0) == 0.0f && UnpackUnorm16(65535) == 1.0f);
+    RI_CHECK(PackSnorm16(-1.0f) == -32767 && PackSnorm16(1.0f) == 32767 && PackSnorm16(0.0f) == 0);
+    RI_CHECK(UnpackSnorm16(-32768) == -1.0f && UnpackSnorm16(-32767) == -1.0f && UnpackSnorm16(32767) == 1.0f);
+    for (float value : {0.0f, 0.5f, 1.0f, -2.0f, 1024.0f})
+        RI_CHECK(UnpackHalf(PackHalf(value)) == value);
+}
+
+RI_TEST(VertexCompressionOctahedral)
+{
+    for (Vector3 const& direction : TestDirections())
+    {
+        // the upper hemisphere maps inside the unit diamond, the lower one is folded over the corners of the square
+        const Vector2 encoded = OctEncode(direction);
+        const float l1 = std::abs(encoded.x) + std::abs(encoded.y);
+        RI_CHECK(std::abs(encoded.x) <= 1.0f && std::abs(encoded.y) <= 1.0f);
+        RI_CHECK(direction.z >= 0.0f ? l1 <= 1.0f + 1e-5f : l1 >= 1.0f - 1e-5f);
+        // and decodes back to the direction, before and after quantization
+        RI_CHECK((OctDecode(encoded) - direction).Length() < 1e-5f);
+        RI_CHECK((QuantizedRoundTrip(direction) - direction).Length() <= CompressionError::DIRECTION_BOUND);
+    }
+
+    // the axes land on the corners and the center of the diamond or the corners of the square, exactly
+    for (Vector3 const& axis : {Vector3(1, 0, 0), Vector3(-1, 0, 0), Vector3(0, 1, 0), Vector3(0, -1, 0), Vector3(0, 0, 1),
+                                Vector3(0, 0, -1)})
+        RI_CHECK((QuantizedRoundTrip(axis) - axis).Length() < 1e-6f);
+    RI_CHECK(OctEncode(Vector3(0, 0, 1)) == Vector2(0.0f, 0.0f));
+    RI_CHECK(std::abs(OctEncode(Vector3(0, 0, -1)).x) == 1.0f && std::abs(OctEncode(Vector3(0, 0, -1)).y) == 1.0f);
+
+    // directions just above and just below the seam encode to neighbouring points
+    for (uint32 i = 0; i < 64; ++i)
+    {
+        const float angle = DirectX::XM_2PI * i / 64.0f;
+        Vector3 above(std::cos(angle), std::sin(angle), 1e-4f), below(std::cos(angle), std::sin(angle), -1e-4f);
+        above.Normalize();
+        below.Normalize();
+        RI_CHECK((OctEncode(above) - OctEncode(below)).Length() < 1e-3f);
+    }
+
+    // a zero direction does not produce NaNs
+    const Vector2 zero = OctEncode(Vector3(0.0f));
+    RI_CHECK(zero.x == 0.0f && zero.y == 0.0f);
+}
+
+RI_TEST(VertexCompressionTangentSign)
+{
+    const BoundingBox bounds(Vector3(0.0f), Vector3(1.0f));
+    std::vector<Vertex> vertices;
+    for (Vector3 const& normal : TestDirections())
+    {
+        for (bool flipped : {false, true})
+            vertices.push_back(MakeVertex(Vector3(0.0f), normal, Vector2(0.0f), flipped));
+    }
+
+    std::vector<CompactVertex> compact;
+    Encode(vertices, bounds, compact);
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const Vertex decoded = Decode(compact[i], PositionBias(bounds), PositionScale(bounds));
+        RI_CHECK(decoded.bitangent.Dot(vertices[i].bitangent) > 0.99f);
+    }
+    const CompressionError error = MeasureError(vertices, compact, bounds);
+    RI_CHECK(error.bitangentFlips == 0);
+    RI_CHECK(error.normal <= CompressionError::DIRECTION_BOUND && error.tangent <= CompressionError::DIRECTION_BOUND);
+
+    // a frame without a bitangent has no handedness to keep, it is not counted as a flip
+    Vertex degenerate = MakeVertex(Vector3(0.0f), Vector3(0, 0, 1), Vector2(0.0f), false);
+    degenerate.bitangent = Vector3(0.0f);
+    const CompactVertex compactDegenerate = Encode(degenerate, bounds);
+    RI_CHECK(MeasureError(std::span(&degenerate, 1), std::span(&compactDegenerate, 1), bounds).bitangentFlips == 0);
+}
+
+RI_TEST(VertexCompressionPositionsAndTexcoords)
+{
+    const BoundingBox bounds(Vector3(10.0f, -3.0f, 0.5f), Vector3(25.0f, 0.75f, 4.0f));
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f), uv(-4.0f, 8.0f);
+
+    std::vector<Vertex> vertices;
+    for (uint32 i = 0; i < 5000; ++i)
+    {
+        const Vector3 position = Vector3(bounds.Center) + Vector3(unit(rng), unit(rng), unit(rng)) * Vector3(bounds.Extents);
+        vertices.push_back(MakeVertex(position, Vector3(0, 1, 0), Vector2(uv(rng), uv(rng)), false));
+    }
+    // the corners of the bounds and texcoords a half float holds exactly
+    const Vector3 minCorner = Vector3(bounds.Center) - Vector3(bounds.Extents);
+    const Vector3 maxCorner = Vector3(bounds.Center) + Vector3(bounds.Extents);
+    vertices.push_back(MakeVertex(minCorner, Vector3(0, 1, 0), Vector2(0.0f, 1.0f), false));
+    vertices.push_back(MakeVertex(maxCorner, Vector3(0, 1, 0), Vector2(0.5f, 0.25f), false));
+
+    std::vector<CompactVertex> compact;
+    Encode(vertices, bounds, compact);
+    const CompressionError error = MeasureError(vertices, compact, bounds);
+    RI_CHECK(error.position <= CompressionError::POSITION_BOUND);
+    RI_CHECK(error.texcoord <= CompressionError::TEXCOORD_BOUND);
+    RI_CHECK(error.WithinBounds());
+
+    CompactVertex const& minVertex = compact[compact.size() - 2];
+    CompactVertex const& maxVertex = compact.back();
+    RI_CHECK(minVertex.position[0] == 0 && minVertex.position[1] == 0 && minVertex.position[2] == 0);
+    RI_CHECK(maxVertex.position[0] == 65535 && maxVertex.position[1] == 65535 && maxVertex.position[2] == 65535);
+    const Vertex decoded = Decode(maxVertex, PositionBias(bounds), PositionScale(bounds));
+    RI_CHECK(decoded.texcoord == Vector2(0.5f, 0.25f));
+}
+
+RI_TEST(VertexCompressionDegenerateBounds)
+{
+    // a quad flat on y: the flat axis keeps a unit scale and decodes exactly
+    const BoundingBox flat(Vector3(1.0f, 2.0f, 3.0f), Vector3(5.0f, 0.0f, 5.0f));
+    RI_CHECK(PositionScale(flat).y == 1.0f);
+    std::vector<Vertex> quad;
+    for (Vector3 const& corner : {Vector3(-4.0f, 2.0f, -2.0f), Vector3(6.0f, 2.0f, -2.0f), Vector3(6.0f, 2.0f, 8.0f)})
+        quad.push_back(MakeVertex(corner, Vector3(0, 1, 0), Vector2(0.0f), false));
+    std::vector<CompactVertex> compact;
+    Encode(quad, flat, compact);
+    for (size_t i = 0; i < quad.size(); ++i)
+    {
+        RI_CHECK(compact[i].position[1] == 0);
+        RI_CHECK(Decode(compact[i], PositionBias(flat), PositionScale(flat)).position.y == 2.0f);
+    }
+    RI_CHECK(MeasureError(quad, compact, flat).WithinBounds());
+
+    // every vertex in one point
+    const BoundingBox point(Vector3(-7.0f, 0.25f, 3.0f), Vector3(0.0f));
+    const Vertex vertex = MakeVertex(Vector3(point.Center), Vector3(0, 0, 1), Vector2(0.0f), false);
+    const CompactVertex compactPoint = Encode(vertex, point);
+    RI_CHECK(Decode(compactPoint, PositionBias(point), PositionScale(point)).position == Vector3(point.Center));
+    RI_CHECK(PositionScale(point) == Vector3(1.0f));
+
+    // positions outside the bounds clamp to its faces instead of wrapping
+    const BoundingBox unitBox(Vector3(0.0f), Vector3(1.0f));
+    const CompactVertex outside = Encode(MakeVertex(Vector3(2.0f, -2.0f, 0.0f), Vector3(0, 0, 1), Vector2(0.0f), false), unitBox);
+    RI_CHECK(outside.position[0] == 65535 && outside.position[1] == 0);
+}
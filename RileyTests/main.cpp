@@ -0,0 +1,79 @@
+#include "Test.h"
+#include "Core/Log.h"
+#include <atomic>
+#include <mutex>
+
+using namespace Riley;
+
+namespace Riley
+{
+namespace Tests
+{
+namespace
+{
+std::atomic<uint32> failures = 0;
+std::mutex skippedMutex;
+std::vector<std::string> skipped; // of the running test
+} // namespace
+
+std::vector<TestCase>& Registry()
+{
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+void Fail(char const* file, int line, char const* expression)
+{
+    ++failures;
+    RI_ERROR("{:s}({:d}) : check failed : {:s}", file, line, expression);
+}
+
+void Skip(std::string const& what)
+{
+    std::lock_guard lock(skippedMutex);
+    skipped.push_back(what);
+}
+} // namespace Tests
+} // namespace Riley
+
+/* Runs the CPU tests of the engine without a window or a GPU. Run it from the Riley directory, like the engine, so the
+ * tests reading the bundled assets find them; those tests skip what is not there.
+ *   RileyTests             every test
+ *   RileyTests --bench     every benchmark instead, timings go to the log
+ *   RileyTests <filter>    only the tests or benchmarks whose name contains filter */
+int main(int argc, char** argv)
+{
+    Log::Initialize();
+
+    bool benchmarks = false;
+    std::string filter;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--bench")
+            benchmarks = true;
+        else
+            filter = argv[i];
+    }
+
+    uint32 ran = 0, failed = 0, partial = 0;
+    for (Tests::TestCase const& test : Tests::Registry())
+    {
+        if (test.benchmark != benchmarks || std::string(test.name).find(filter) == std::string::npos)
+            continue;
+
+        const uint32 failuresBefore = Tests::failures;
+        Tests::skipped.clear();
+        RI_INFO("[ RUN  ] {:s}", test.name);
+        test.function();
+        const bool passed = Tests::failures == failuresBefore;
+        RI_INFO("[ {:s} ] {:s}", passed ? " OK " : "FAIL", test.name);
+        // a pass only covers what ran
+        for (std::string const& what : Tests::skipped)
+            RI_INFO("[ SKIP ] {:s} : {:s}", test.name, what);
+        ++ran;
+        failed += passed ? 0 : 1;
+        partial += passed && !Tests::skipped.empty() ? 1 : 0;
+    }
+    RI_INFO("{:d} of {:d} passed, {:d} of them with skipped parts", ran - failed, ran, partial);
+    return failed == 0 ? 0 : 1;
+}